@@ -3,6 +3,8 @@
 
 #include <QString>
 
+class QTextDocument;
+
 enum class CompletionTriggerKind {
 
   Invoked = 1,
@@ -16,6 +18,8 @@ struct CompletionContext {
 
   QString documentUri;
 
+  const QTextDocument *document = nullptr;
+
   QString languageId;
 
   QString prefix;
@@ -1,6 +1,7 @@
 #include "completionengine.h"
 #include "../core/logging/logger.h"
 #include "../language/languagecatalog.h"
+#include <QHash>
 #include <algorithm>
 
 CompletionEngine::CompletionEngine(QObject *parent)
@@ -14,6 +15,21 @@ CompletionEngine::~CompletionEngine() { cancelPendingRequests(); }
 
 void CompletionEngine::setLanguage(const QString &languageId) {
   m_languageId = LanguageCatalog::normalize(languageId);
+  clearCandidates();
+}
+
+void CompletionEngine::clearCandidates() {
+  m_candidates.clear();
+  m_matchingCandidates.clear();
+  m_filterPrefix.clear();
+  m_hasCandidates = false;
+  m_candidatesIncomplete = false;
+}
+
+void CompletionEngine::clearCandidates(const QTextDocument *document) {
+  if (m_candidateContext.document == document) {
+    clearCandidates();
+  }
 }
 
 void CompletionEngine::requestCompletions(const CompletionContext &context) {
@@ -26,6 +42,13 @@ void CompletionEngine::requestCompletions(const CompletionContext &context) {
     return;
   }
 
+  if (context.isAutoComplete && canRefineCandidates(context)) {
+    cancelPendingRequests();
+    refineCandidates(context.prefix);
+    notifyResults();
+    return;
+  }
+
   if (context.isAutoComplete) {
 
     m_debounceTimer->start(m_autoTriggerDelay);
@@ -36,8 +59,27 @@ void CompletionEngine::requestCompletions(const CompletionContext &context) {
   }
 }
 
+bool CompletionEngine::canRefineCandidates(
+    const CompletionContext &context) const {
+  if (!hasReusableCandidates()) {
+    return false;
+  }
+
+  const CompletionContext &origin = m_candidateContext;
+  const int anchor = context.column - static_cast<int>(context.prefix.size());
+  const int originAnchor =
+      origin.column - static_cast<int>(origin.prefix.size());
+  return context.document == origin.document &&
+         context.documentUri == origin.documentUri &&
+         context.languageId == origin.languageId &&
+         context.line == origin.line && anchor == originAnchor &&
+         context.prefix.startsWith(origin.prefix);
+}
+
 void CompletionEngine::executeCompletionRequest() {
   m_pendingItems.clear();
+  m_pendingIncomplete = false;
+  clearCandidates();
   m_currentRequestId++;
 
   QString langId =
@@ -62,10 +104,12 @@ void CompletionEngine::executeCompletionRequest() {
   int requestId = m_currentRequestId;
 
   for (auto &provider : providers) {
+    ICompletionProvider *source = provider.get();
     provider->requestCompletions(
         m_currentContext,
-        [this, requestId](const QList<CompletionItem> &items) {
-          collectProviderResults(requestId, items);
+        [this, requestId, source](const QList<CompletionItem> &items) {
+          collectProviderResults(requestId, items,
+                                 source->lastResultsIncomplete());
         });
   }
 }
@@ -83,13 +127,14 @@ void CompletionEngine::cancelPendingRequests() {
 }
 
 void CompletionEngine::collectProviderResults(
-    int requestId, const QList<CompletionItem> &items) {
+    int requestId, const QList<CompletionItem> &items, bool isIncomplete) {
 
   if (requestId != m_currentRequestId) {
     return;
   }
 
   m_pendingItems.append(items);
+  m_pendingIncomplete = m_pendingIncomplete || isIncomplete;
   m_pendingProviders--;
 
   if (m_pendingProviders <= 0) {
@@ -99,42 +144,105 @@ void CompletionEngine::collectProviderResults(
 }
 
 void CompletionEngine::mergeAndSortResults() {
-
-  QMap<QString, CompletionItem> uniqueItems;
-
-  for (const CompletionItem &item : m_pendingItems) {
-    QString key = item.label.toLower();
-    if (!uniqueItems.contains(key) ||
-        item.priority < uniqueItems[key].priority) {
-      uniqueItems[key] = item;
+  QHash<QString, int> uniqueItems;
+  uniqueItems.reserve(m_pendingItems.size());
+  m_candidates.clear();
+  m_candidates.reserve(m_pendingItems.size());
+
+  for (const CompletionItem &item : std::as_const(m_pendingItems)) {
+    const QString key = item.label.toLower();
+    const auto it = uniqueItems.constFind(key);
+    if (it == uniqueItems.constEnd()) {
+      uniqueItems.insert(key, static_cast<int>(m_candidates.size()));
+      m_candidates.append(item);
+    } else if (item.priority < m_candidates.at(it.value()).priority) {
+      m_candidates[it.value()] = item;
     }
   }
+  m_pendingItems.clear();
 
-  m_lastResults = uniqueItems.values();
+  std::sort(m_candidates.begin(), m_candidates.end());
 
-  std::sort(m_lastResults.begin(), m_lastResults.end());
+  m_candidateContext = m_currentContext;
+  m_hasCandidates = true;
+  m_candidatesIncomplete = m_pendingIncomplete;
+  m_matchingCandidates.clear();
+  m_filterPrefix.clear();
+  refineCandidates(m_currentContext.prefix);
+}
 
-  if (m_lastResults.size() > m_maxResults) {
-    m_lastResults = m_lastResults.mid(0, m_maxResults);
+void CompletionEngine::refineCandidates(const QString &prefix) {
+  const bool narrowing =
+      !m_filterPrefix.isEmpty() &&
+      prefix.startsWith(m_filterPrefix, Qt::CaseInsensitive);
+  const QList<FuzzyMatch> matches =
+      matchCandidates(prefix, narrowing ? &m_matchingCandidates : nullptr);
+
+  m_matchingCandidates.clear();
+  m_matchingCandidates.reserve(matches.size());
+  for (const FuzzyMatch &match : matches) {
+    m_matchingCandidates.append(match.index);
   }
+  m_filterPrefix = prefix;
+  m_lastResults = rankMatches(matches);
 }
 
-void CompletionEngine::notifyResults() { emit completionsReady(m_lastResults); }
+QList<FuzzyMatch>
+CompletionEngine::matchCandidates(const QString &prefix,
+                                  const QList<int> *subset) const {
+  const FuzzyMatcher matcher(prefix);
+  QList<FuzzyMatch> matches;
+  const auto consider = [&](int index) {
+    const int score =
+        matcher.score(m_candidates.at(index).effectiveFilterText());
+    if (score != FUZZY_NO_MATCH) {
+      matches.append({index, score});
+    }
+  };
 
-QList<CompletionItem>
-CompletionEngine::filterResults(const QString &prefix) const {
-  if (prefix.isEmpty()) {
-    return m_lastResults;
+  if (subset) {
+    matches.reserve(subset->size());
+    for (int index : *subset) {
+      consider(index);
+    }
+  } else {
+    matches.reserve(m_candidates.size());
+    for (int index = 0; index < m_candidates.size(); ++index) {
+      consider(index);
+    }
   }
+  return matches;
+}
 
-  QList<CompletionItem> filtered;
-  for (const CompletionItem &item : m_lastResults) {
-    if (item.effectiveFilterText().startsWith(prefix, Qt::CaseInsensitive)) {
-      filtered.append(item);
+QList<CompletionItem>
+CompletionEngine::rankMatches(QList<FuzzyMatch> matches) const {
+  const auto byScore = [](const FuzzyMatch &a, const FuzzyMatch &b) {
+    if (a.score != b.score) {
+      return a.score > b.score;
     }
+    return a.index < b.index;
+  };
+  if (m_maxResults >= 0 && matches.size() > m_maxResults) {
+    std::partial_sort(matches.begin(), matches.begin() + m_maxResults,
+                      matches.end(), byScore);
+    matches.resize(m_maxResults);
+  } else {
+    std::sort(matches.begin(), matches.end(), byScore);
+  }
+
+  QList<CompletionItem> ranked;
+  ranked.reserve(matches.size());
+  for (const FuzzyMatch &match : std::as_const(matches)) {
+    ranked.append(m_candidates.at(match.index));
   }
+  return ranked;
+}
 
-  return filtered;
+void CompletionEngine::notifyResults() { emit completionsReady(m_lastResults); }
+
+QList<CompletionItem>
+CompletionEngine::filterResults(const QString &prefix) const {
+  return rankMatches(matchCandidates(prefix, nullptr));
 }
 
 void CompletionEngine::onDebounceTimeout() {
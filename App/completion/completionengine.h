@@ -4,6 +4,7 @@
 #include "completioncontext.h"
 #include "completionitem.h"
 #include "completionproviderregistry.h"
+#include "fuzzymatcher.h"
 #include <QList>
 #include <QObject>
 #include <QTimer>
@@ -39,6 +40,16 @@ public:
 
   QList<CompletionItem> lastResults() const { return m_lastResults; }
 
+  int candidateCount() const { return static_cast<int>(m_candidates.size()); }
+
+  bool hasReusableCandidates() const {
+    return m_hasCandidates && !m_candidatesIncomplete;
+  }
+
+  void clearCandidates();
+
+  void clearCandidates(const QTextDocument *document);
+
 signals:
 
   void completionsReady(const QList<CompletionItem> &items);
@@ -49,16 +60,28 @@ private slots:
   void onDebounceTimeout();
 
 private:
-  void collectProviderResults(int requestId,
-                              const QList<CompletionItem> &items);
+  void collectProviderResults(int requestId, const QList<CompletionItem> &items,
+                              bool isIncomplete);
   void mergeAndSortResults();
   void notifyResults();
   void executeCompletionRequest();
+  bool canRefineCandidates(const CompletionContext &context) const;
+  void refineCandidates(const QString &prefix);
+  QList<FuzzyMatch> matchCandidates(const QString &prefix,
+                                    const QList<int> *subset) const;
+  QList<CompletionItem> rankMatches(QList<FuzzyMatch> matches) const;
 
   QString m_languageId;
   CompletionContext m_currentContext;
   QList<CompletionItem> m_pendingItems;
   QList<CompletionItem> m_lastResults;
+  QList<CompletionItem> m_candidates;
+  QList<int> m_matchingCandidates;
+  CompletionContext m_candidateContext;
+  QString m_filterPrefix;
+  bool m_hasCandidates = false;
+  bool m_candidatesIncomplete = false;
+  bool m_pendingIncomplete = false;
   int m_pendingProviders = 0;
   int m_currentRequestId = 0;
 
@@ -0,0 +1,112 @@
+#include "fuzzymatcher.h"
+
+#include <QVarLengthArray>
+#include <utility>
+
+FuzzyMatcher::FuzzyMatcher(const QString &pattern)
+    : m_pattern(pattern), m_lowered(pattern.toLower()) {}
+
+bool FuzzyMatcher::matches(const QString &candidate) const {
+  const int length =
+      qMin(static_cast<int>(candidate.size()), FUZZY_MAX_CANDIDATE_LENGTH);
+  const int patternLength = static_cast<int>(m_lowered.size());
+  int matched = 0;
+  for (int i = 0; i < length && matched < patternLength; ++i) {
+    if (candidate.at(i).toLower() == m_lowered.at(matched)) {
+      ++matched;
+    }
+  }
+  return matched == patternLength;
+}
+
+int FuzzyMatcher::score(const QString &candidate) const {
+  const int patternLength = static_cast<int>(m_lowered.size());
+  if (patternLength == 0) {
+    return 0;
+  }
+  if (!matches(candidate)) {
+    return FUZZY_NO_MATCH;
+  }
+
+  const int length =
+      qMin(static_cast<int>(candidate.size()), FUZZY_MAX_CANDIDATE_LENGTH);
+  QVarLengthArray<QChar, 64> lowered(length);
+  QVarLengthArray<int, 64> bonus(length);
+  for (int j = 0; j < length; ++j) {
+    lowered[j] = candidate.at(j).toLower();
+    if (j == 0) {
+      bonus[j] = FUZZY_BONUS_START;
+    } else {
+      bonus[j] = isWordBoundary(candidate, j) ? FUZZY_BONUS_BOUNDARY : 0;
+    }
+  }
+
+  QVarLengthArray<int, 64> rowA(length);
+  QVarLengthArray<int, 64> rowB(length);
+  int *previous = rowA.data();
+  int *current = rowB.data();
+  for (int i = 0; i < patternLength; ++i) {
+    const QChar wanted = m_lowered.at(i);
+    int bestBefore = FUZZY_NO_MATCH;
+    for (int j = 0; j < length; ++j) {
+      if (i > 0 && j > 0) {
+        bestBefore = qMax(bestBefore - FUZZY_PENALTY_GAP, previous[j - 1]);
+      }
+      current[j] = FUZZY_NO_MATCH;
+      if (lowered[j] != wanted) {
+        continue;
+      }
+
+      int value = FUZZY_SCORE_MATCH + bonus[j];
+      if (candidate.at(j) == m_pattern.at(i)) {
+        value += FUZZY_BONUS_CASE;
+      }
+      if (i == 0) {
+        value -= qMin(j * FUZZY_PENALTY_LEADING, FUZZY_MAX_LEADING_PENALTY);
+      } else {
+        int link = bestBefore;
+        if (j > 0 && previous[j - 1] > FUZZY_NO_MATCH) {
+          link = qMax(link, previous[j - 1] + FUZZY_BONUS_CONSECUTIVE);
+        }
+        if (link <= FUZZY_NO_MATCH) {
+          continue;
+        }
+        value += link;
+      }
+      current[j] = value;
+    }
+    std::swap(previous, current);
+  }
+
+  int best = FUZZY_NO_MATCH;
+  for (int j = 0; j < length; ++j) {
+    best = qMax(best, previous[j]);
+  }
+  return best;
+}
+
+bool FuzzyMatcher::isWordBoundary(const QString &text, int position) {
+  if (position < 0 || position >= text.size()) {
+    return false;
+  }
+  const QChar current = text.at(position);
+  if (!current.isLetterOrNumber()) {
+    return false;
+  }
+  if (position == 0) {
+    return true;
+  }
+
+  const QChar previous = text.at(position - 1);
+  if (!previous.isLetterOrNumber()) {
+    return true;
+  }
+  if (previous.isLower() && current.isUpper()) {
+    return true;
+  }
+  if (previous.isLetter() && current.isDigit()) {
+    return true;
+  }
+  return previous.isUpper() && current.isUpper() &&
+         position + 1 < text.size() && text.at(position + 1).isLower();
+}
@@ -0,0 +1,39 @@
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <QString>
+
+constexpr int FUZZY_NO_MATCH = -(1 << 24);
+constexpr int FUZZY_MAX_CANDIDATE_LENGTH = 256;
+constexpr int FUZZY_SCORE_MATCH = 16;
+constexpr int FUZZY_BONUS_START = 24;
+constexpr int FUZZY_BONUS_BOUNDARY = 16;
+constexpr int FUZZY_BONUS_CONSECUTIVE = 12;
+constexpr int FUZZY_BONUS_CASE = 2;
+constexpr int FUZZY_PENALTY_GAP = 1;
+constexpr int FUZZY_PENALTY_LEADING = 3;
+constexpr int FUZZY_MAX_LEADING_PENALTY = 24;
+
+struct FuzzyMatch {
+  int index = 0;
+  int score = 0;
+};
+
+class FuzzyMatcher {
+public:
+  explicit FuzzyMatcher(const QString &pattern);
+
+  const QString &pattern() const { return m_pattern; }
+
+  bool matches(const QString &candidate) const;
+
+  int score(const QString &candidate) const;
+
+  static bool isWordBoundary(const QString &text, int position);
+
+private:
+  QString m_pattern;
+  QString m_lowered;
+};
+
+#endif
@@ -44,6 +44,8 @@ public:
 
   virtual void cancelPendingRequests() {}
 
+  virtual bool lastResultsIncomplete() const { return false; }
+
   virtual bool isEnabled() const { return true; }
 
   virtual void setEnabled(bool enabled) { Q_UNUSED(enabled); }
@@ -0,0 +1,422 @@
+#include "identifierindex.h"
+
+#include <QPair>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <algorithm>
+#include <utility>
+
+namespace {
+bool isIdentifierStart(QChar c) {
+  return c.isLetter() || c == QLatin1Char('_');
+}
+
+bool isIdentifierPart(QChar c) {
+  return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+bool sameLetter(QChar a, QChar b) { return a == b || a.toLower() == b; }
+
+bool ranksBefore(const IdentifierMatch &a, const IdentifierMatch &b) {
+  if (a.score != b.score) {
+    return a.score > b.score;
+  }
+  return a.word < b.word;
+}
+} // namespace
+
+class IdentifierDocumentTracker : public QObject {
+public:
+  IdentifierDocumentTracker(QTextDocument *document, IdentifierIndex *index)
+      : QObject(document), m_document(document), m_index(index),
+        m_suspended(false) {
+    reindex();
+    connect(document, &QTextDocument::contentsChange, this,
+            &IdentifierDocumentTracker::onContentsChange);
+  }
+
+  ~IdentifierDocumentTracker() override {
+    if (m_index) {
+      release();
+      m_index->m_trackers.remove(m_document);
+    }
+  }
+
+  void detach() { m_index = nullptr; }
+
+private:
+  void release() {
+    for (const QStringList &tokens : m_blocks) {
+      m_index->addTokens(tokens, -1);
+    }
+    m_blocks.clear();
+  }
+
+  void reindex() {
+    release();
+    m_suspended =
+        m_document->characterCount() > IDENTIFIER_MAX_DOCUMENT_CHARACTERS;
+    if (m_suspended) {
+      return;
+    }
+
+    ++m_index->m_tick;
+    m_blocks.reserve(m_document->blockCount());
+    for (QTextBlock block = m_document->begin(); block.isValid();
+         block = block.next()) {
+      m_blocks.append(IdentifierIndex::tokenize(block.text()));
+      m_index->addTokens(m_blocks.last(), 1);
+    }
+  }
+
+  void onContentsChange(int position, int charsRemoved, int charsAdded) {
+    Q_UNUSED(charsRemoved);
+    if (!m_index) {
+      return;
+    }
+    const bool tooLarge =
+        m_document->characterCount() > IDENTIFIER_MAX_DOCUMENT_CHARACTERS;
+    if (m_suspended || tooLarge) {
+      if (m_suspended != tooLarge) {
+        reindex();
+      }
+      return;
+    }
+
+    QTextBlock first = m_document->findBlock(position);
+    QTextBlock last = m_document->findBlock(position + charsAdded);
+    if (!first.isValid()) {
+      first = m_document->lastBlock();
+    }
+    if (!last.isValid()) {
+      last = m_document->lastBlock();
+    }
+
+    const int indexedBlocks = static_cast<int>(m_blocks.size());
+    const int firstNumber = first.blockNumber();
+    const int newSpan = last.blockNumber() - firstNumber + 1;
+    const int oldSpan = newSpan - (m_document->blockCount() - indexedBlocks);
+    if (newSpan <= 0 || oldSpan < 0 || firstNumber + oldSpan > indexedBlocks) {
+      reindex();
+      return;
+    }
+
+    ++m_index->m_tick;
+    for (int i = 0; i < oldSpan; ++i) {
+      m_index->addTokens(m_blocks.at(firstNumber + i), -1);
+    }
+    m_blocks.remove(firstNumber, oldSpan);
+    m_blocks.insert(firstNumber, newSpan, QStringList());
+
+    QTextBlock block = first;
+    for (int i = 0; i < newSpan && block.isValid(); ++i, block = block.next()) {
+      QStringList &tokens = m_blocks[firstNumber + i];
+      tokens = IdentifierIndex::tokenize(block.text());
+      m_index->addTokens(tokens, 1);
+    }
+  }
+
+  QTextDocument *m_document;
+  IdentifierIndex *m_index;
+  QList<QStringList> m_blocks;
+  bool m_suspended;
+};
+
+IdentifierTrie::IdentifierTrie() { m_nodes.emplace_back(); }
+
+void IdentifierTrie::clear() {
+  m_nodes.clear();
+  m_nodes.emplace_back();
+}
+
+int IdentifierTrie::child(int node, QChar character) const {
+  for (int index : m_nodes[node].children) {
+    if (m_nodes[index].character == character) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+void IdentifierTrie::add(const QString &word, int delta, quint64 tick) {
+  if (word.isEmpty() || delta == 0) {
+    return;
+  }
+
+  QVarLengthArray<int, IDENTIFIER_MAX_LENGTH + 1> path;
+  int node = 0;
+  path.append(node);
+  for (QChar character : word) {
+    int next = child(node, character);
+    if (next < 0) {
+      if (delta < 0) {
+        return;
+      }
+      next = static_cast<int>(m_nodes.size());
+      m_nodes.emplace_back();
+      m_nodes.back().character = character;
+      m_nodes[node].children.append(next);
+    }
+    node = next;
+    path.append(node);
+  }
+
+  Node &terminal = m_nodes[node];
+  const bool wasPresent = terminal.count > 0;
+  terminal.count = qMax(0, terminal.count + delta);
+  if (delta > 0) {
+    terminal.lastSeen = tick;
+  }
+
+  const int wordDelta = (terminal.count > 0 ? 1 : 0) - (wasPresent ? 1 : 0);
+  if (wordDelta != 0) {
+    for (int index : path) {
+      m_nodes[index].subtreeWords += wordDelta;
+    }
+  }
+
+  if (delta > 0) {
+    for (int index : path) {
+      Node &current = m_nodes[index];
+      current.maxCount = qMax(current.maxCount, terminal.count);
+      current.maxLastSeen = qMax(current.maxLastSeen, tick);
+    }
+    return;
+  }
+  for (int i = static_cast<int>(path.size()) - 1; i >= 0; --i) {
+    Node &current = m_nodes[path[i]];
+    int maxCount = current.count;
+    quint64 maxLastSeen = current.count > 0 ? current.lastSeen : 0;
+    for (int index : current.children) {
+      maxCount = qMax(maxCount, m_nodes[index].maxCount);
+      maxLastSeen = qMax(maxLastSeen, m_nodes[index].maxLastSeen);
+    }
+    current.maxCount = maxCount;
+    current.maxLastSeen = maxLastSeen;
+  }
+}
+
+int IdentifierTrie::count(const QString &word) const {
+  int node = 0;
+  for (QChar character : word) {
+    node = child(node, character);
+    if (node < 0) {
+      return 0;
+    }
+  }
+  return node > 0 ? m_nodes[node].count : 0;
+}
+
+bool IdentifierTrie::TopMatches::accepts(double score) const {
+  if (m_limit < 0 || static_cast<int>(m_heap.size()) < m_limit) {
+    return true;
+  }
+  return m_limit > 0 && score >= m_heap.front().score;
+}
+
+void IdentifierTrie::TopMatches::offer(IdentifierMatch match) {
+  if (m_limit < 0 || static_cast<int>(m_heap.size()) < m_limit) {
+    m_heap.push_back(std::move(match));
+    std::push_heap(m_heap.begin(), m_heap.end(), ranksBefore);
+  } else if (m_limit > 0 && ranksBefore(match, m_heap.front())) {
+    std::pop_heap(m_heap.begin(), m_heap.end(), ranksBefore);
+    m_heap.back() = std::move(match);
+    std::push_heap(m_heap.begin(), m_heap.end(), ranksBefore);
+  }
+}
+
+QList<IdentifierMatch> IdentifierTrie::TopMatches::take() {
+  std::sort_heap(m_heap.begin(), m_heap.end(), ranksBefore);
+  QList<IdentifierMatch> matches(m_heap.begin(), m_heap.end());
+  m_heap.clear();
+  return matches;
+}
+
+double IdentifierTrie::score(int count, quint64 lastSeen, quint64 tick) {
+  const double age = static_cast<double>(tick - lastSeen);
+  return count +
+         IDENTIFIER_RECENCY_WEIGHT / (1.0 + age / IDENTIFIER_RECENCY_SCALE);
+}
+
+IdentifierMatch IdentifierTrie::makeMatch(const Node &node,
+                                          const QString &word,
+                                          quint64 tick) const {
+  IdentifierMatch match;
+  match.word = word;
+  match.count = node.count;
+  match.score = score(node.count, node.lastSeen, tick);
+  return match;
+}
+
+QVarLengthArray<int, 4> IdentifierTrie::rankedChildren(int node,
+                                                       quint64 tick) const {
+  QVarLengthArray<int, 4> children;
+  for (int index : m_nodes[node].children) {
+    if (m_nodes[index].subtreeWords > 0) {
+      children.append(index);
+    }
+  }
+  std::sort(children.begin(), children.end(), [this, tick](int a, int b) {
+    return score(m_nodes[a].maxCount, m_nodes[a].maxLastSeen, tick) >
+           score(m_nodes[b].maxCount, m_nodes[b].maxLastSeen, tick);
+  });
+  return children;
+}
+
+void IdentifierTrie::collect(int node, QString *word, quint64 tick,
+                             TopMatches *matches) const {
+  const Node &current = m_nodes[node];
+  if (!matches->accepts(
+          score(current.maxCount, current.maxLastSeen, tick))) {
+    return;
+  }
+  if (current.count > 0 &&
+      matches->accepts(score(current.count, current.lastSeen, tick))) {
+    matches->offer(makeMatch(current, *word, tick));
+  }
+  for (int index : rankedChildren(node, tick)) {
+    word->append(m_nodes[index].character);
+    collect(index, word, tick, matches);
+    word->chop(1);
+  }
+}
+
+void IdentifierTrie::collectFuzzy(int node, const QString &pattern,
+                                  int matched, QString *word, quint64 tick,
+                                  TopMatches *matches) const {
+  const Node &current = m_nodes[node];
+  if (!matches->accepts(
+          score(current.maxCount, current.maxLastSeen, tick))) {
+    return;
+  }
+  if (matched == pattern.size() && current.count > 0 &&
+      matches->accepts(score(current.count, current.lastSeen, tick))) {
+    matches->offer(makeMatch(current, *word, tick));
+  }
+  if (pattern.size() - matched > IDENTIFIER_MAX_LENGTH - word->size()) {
+    return;
+  }
+  for (int index : rankedChildren(node, tick)) {
+    const Node &next = m_nodes[index];
+    const bool advances = matched < pattern.size() &&
+                          sameLetter(next.character, pattern[matched]);
+    word->append(next.character);
+    collectFuzzy(index, pattern, advances ? matched + 1 : matched, word, tick,
+                 matches);
+    word->chop(1);
+  }
+}
+
+QList<IdentifierMatch> IdentifierTrie::prefixMatches(const QString &prefix,
+                                                     int limit,
+                                                     quint64 tick) const {
+  const QString lowered = prefix.toLower();
+  QList<QPair<int, QString>> frontier{{0, QString()}};
+  for (QChar character : lowered) {
+    QList<QPair<int, QString>> next;
+    for (const auto &entry : frontier) {
+      for (int index : m_nodes[entry.first].children) {
+        const Node &candidate = m_nodes[index];
+        if (candidate.subtreeWords > 0 &&
+            sameLetter(candidate.character, character)) {
+          next.append({index, entry.second + candidate.character});
+        }
+      }
+    }
+    if (next.isEmpty()) {
+      return {};
+    }
+    frontier = next;
+  }
+
+  TopMatches matches(limit);
+  for (auto &entry : frontier) {
+    collect(entry.first, &entry.second, tick, &matches);
+  }
+  return matches.take();
+}
+
+QList<IdentifierMatch> IdentifierTrie::fuzzyMatches(const QString &pattern,
+                                                    int limit,
+                                                    quint64 tick) const {
+  if (pattern.isEmpty()) {
+    return {};
+  }
+
+  const QString lowered = pattern.toLower();
+  TopMatches matches(limit);
+  QString word;
+  for (int index : rankedChildren(0, tick)) {
+    const Node &first = m_nodes[index];
+    if (!sameLetter(first.character, lowered[0])) {
+      continue;
+    }
+    word = first.character;
+    collectFuzzy(index, lowered, 1, &word, tick, &matches);
+  }
+  return matches.take();
+}
+
+IdentifierIndex &IdentifierIndex::instance() {
+  static IdentifierIndex instance;
+  return instance;
+}
+
+IdentifierIndex::IdentifierIndex() : QObject(nullptr), m_tick(0) {}
+
+IdentifierIndex::~IdentifierIndex() {
+  for (IdentifierDocumentTracker *tracker : std::as_const(m_trackers)) {
+    tracker->detach();
+  }
+}
+
+QStringList IdentifierIndex::tokenize(const QString &text) {
+  QStringList tokens;
+  const int length = static_cast<int>(text.size());
+  int i = 0;
+  while (i < length) {
+    const QChar c = text.at(i);
+    if (!isIdentifierPart(c)) {
+      ++i;
+      continue;
+    }
+
+    const int start = i;
+    while (i < length && isIdentifierPart(text.at(i))) {
+      ++i;
+    }
+    const int size = i - start;
+    if (isIdentifierStart(c) && size >= IDENTIFIER_MIN_LENGTH &&
+        size <= IDENTIFIER_MAX_LENGTH) {
+      tokens.append(text.mid(start, size));
+    }
+  }
+  return tokens;
+}
+
+void IdentifierIndex::watchDocument(QTextDocument *document) {
+  if (!document || m_trackers.contains(document)) {
+    return;
+  }
+  m_trackers.insert(document, new IdentifierDocumentTracker(document, this));
+}
+
+bool IdentifierIndex::isWatching(QTextDocument *document) const {
+  return m_trackers.contains(document);
+}
+
+QList<IdentifierMatch> IdentifierIndex::prefixMatches(const QString &prefix,
+                                                      int limit) const {
+  return m_trie.prefixMatches(prefix, limit, m_tick);
+}
+
+QList<IdentifierMatch> IdentifierIndex::fuzzyMatches(const QString &pattern,
+                                                     int limit) const {
+  return m_trie.fuzzyMatches(pattern, limit, m_tick);
+}
+
+void IdentifierIndex::addTokens(const QStringList &tokens, int delta) {
+  for (const QString &token : tokens) {
+    m_trie.add(token, delta, m_tick);
+  }
+}
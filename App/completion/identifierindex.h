@@ -0,0 +1,123 @@
+#ifndef IDENTIFIERINDEX_H
+#define IDENTIFIERINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVarLengthArray>
+#include <vector>
+
+class IdentifierDocumentTracker;
+class QTextDocument;
+
+constexpr int IDENTIFIER_MIN_LENGTH = 3;
+constexpr int IDENTIFIER_MAX_LENGTH = 64;
+constexpr int IDENTIFIER_MAX_DOCUMENT_CHARACTERS = 4 * 1024 * 1024;
+constexpr double IDENTIFIER_RECENCY_WEIGHT = 8.0;
+constexpr double IDENTIFIER_RECENCY_SCALE = 32.0;
+
+struct IdentifierMatch {
+  QString word;
+  int count = 0;
+  double score = 0.0;
+};
+
+class IdentifierTrie {
+public:
+  IdentifierTrie();
+
+  void add(const QString &word, int delta, quint64 tick);
+
+  int count(const QString &word) const;
+
+  int wordCount() const { return m_nodes.front().subtreeWords; }
+
+  QList<IdentifierMatch> prefixMatches(const QString &prefix, int limit,
+                                       quint64 tick) const;
+
+  QList<IdentifierMatch> fuzzyMatches(const QString &pattern, int limit,
+                                      quint64 tick) const;
+
+  void clear();
+
+private:
+  struct Node {
+    QChar character;
+    int count = 0;
+    int subtreeWords = 0;
+    int maxCount = 0;
+    quint64 lastSeen = 0;
+    quint64 maxLastSeen = 0;
+    QVarLengthArray<int, 4> children;
+  };
+
+  class TopMatches {
+  public:
+    explicit TopMatches(int limit) : m_limit(limit) {}
+
+    bool accepts(double score) const;
+
+    void offer(IdentifierMatch match);
+
+    QList<IdentifierMatch> take();
+
+  private:
+    int m_limit;
+    std::vector<IdentifierMatch> m_heap;
+  };
+
+  int child(int node, QChar character) const;
+  QVarLengthArray<int, 4> rankedChildren(int node, quint64 tick) const;
+  void collect(int node, QString *word, quint64 tick,
+               TopMatches *matches) const;
+  void collectFuzzy(int node, const QString &pattern, int matched,
+                    QString *word, quint64 tick, TopMatches *matches) const;
+  static double score(int count, quint64 lastSeen, quint64 tick);
+  IdentifierMatch makeMatch(const Node &node, const QString &word,
+                            quint64 tick) const;
+
+  std::vector<Node> m_nodes;
+};
+
+class IdentifierIndex : public QObject {
+  Q_OBJECT
+
+public:
+  static IdentifierIndex &instance();
+
+  static QStringList tokenize(const QString &text);
+
+  void watchDocument(QTextDocument *document);
+
+  bool isWatching(QTextDocument *document) const;
+
+  int documentCount() const { return static_cast<int>(m_trackers.size()); }
+
+  int wordCount() const { return m_trie.wordCount(); }
+
+  int count(const QString &word) const { return m_trie.count(word); }
+
+  QList<IdentifierMatch> prefixMatches(const QString &prefix,
+                                       int limit) const;
+
+  QList<IdentifierMatch> fuzzyMatches(const QString &pattern,
+                                      int limit) const;
+
+private:
+  friend class IdentifierDocumentTracker;
+
+  IdentifierIndex();
+  ~IdentifierIndex() override;
+  IdentifierIndex(const IdentifierIndex &) = delete;
+  IdentifierIndex &operator=(const IdentifierIndex &) = delete;
+
+  void addTokens(const QStringList &tokens, int delta);
+
+  IdentifierTrie m_trie;
+  quint64 m_tick;
+  QHash<QTextDocument *, IdentifierDocumentTracker *> m_trackers;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "bufferwordcompletionprovider.h"
+#include "../identifierindex.h"
+
+#include <QSet>
+
+void BufferWordCompletionProvider::requestCompletions(
+    const CompletionContext &context,
+    std::function<void(const QList<CompletionItem> &)> callback) {
+  QList<CompletionItem> items;
+  m_lastResultsIncomplete = false;
+
+  if (!m_enabled || context.prefix.size() < minimumPrefixLength()) {
+    callback(items);
+    return;
+  }
+
+  const IdentifierIndex &index = IdentifierIndex::instance();
+  QList<IdentifierMatch> matches =
+      index.prefixMatches(context.prefix, BUFFER_WORD_MAX_RESULTS + 1);
+  if (matches.size() <= BUFFER_WORD_MAX_RESULTS) {
+    matches.append(
+        index.fuzzyMatches(context.prefix, BUFFER_WORD_MAX_RESULTS + 1));
+  }
+
+  QSet<QString> seen;
+  for (const IdentifierMatch &match : matches) {
+    if (items.size() >= BUFFER_WORD_MAX_RESULTS) {
+      m_lastResultsIncomplete = true;
+      break;
+    }
+    if (match.word == context.prefix || seen.contains(match.word)) {
+      continue;
+    }
+    seen.insert(match.word);
+
+    CompletionItem item;
+    item.label = match.word;
+    item.kind = CompletionItemKind::Text;
+    item.detail = QString("%1 in open files").arg(match.count);
+    item.sortText = QString("%1").arg(items.size(), 3, 10, QLatin1Char('0'));
+    item.priority = basePriority();
+    item.providerId = id();
+    items.append(item);
+  }
+
+  callback(items);
+}
@@ -0,0 +1,32 @@
+#ifndef BUFFERWORDCOMPLETIONPROVIDER_H
+#define BUFFERWORDCOMPLETIONPROVIDER_H
+
+#include "../icompletionprovider.h"
+
+constexpr int BUFFER_WORD_MAX_RESULTS = 20;
+
+class BufferWordCompletionProvider : public ICompletionProvider {
+public:
+  QString id() const override { return "bufferWords"; }
+  QString displayName() const override { return "Buffer Words"; }
+  int basePriority() const override { return 200; }
+  QStringList supportedLanguages() const override { return {"*"}; }
+  int minimumPrefixLength() const override { return 2; }
+
+  void requestCompletions(
+      const CompletionContext &context,
+      std::function<void(const QList<CompletionItem> &)> callback) override;
+
+  bool isEnabled() const override { return m_enabled; }
+  void setEnabled(bool enabled) override { m_enabled = enabled; }
+
+  bool lastResultsIncomplete() const override {
+    return m_lastResultsIncomplete;
+  }
+
+private:
+  bool m_enabled = true;
+  bool m_lastResultsIncomplete = false;
+};
+
+#endif
@@ -34,6 +34,7 @@ void LspCompletionProvider::requestCompletions(
     const CompletionContext &context,
     std::function<void(const QList<CompletionItem> &)> callback) {
   if (!isEnabled()) {
+    m_lastResultsIncomplete = false;
     callback({});
     return;
   }
@@ -61,7 +62,7 @@ void LspCompletionProvider::cancelPendingRequests() {
 }
 
 void LspCompletionProvider::onCompletionReceived(
-    int requestId, const QList<LspCompletionItem> &items) {
+    int requestId, const QList<LspCompletionItem> &items, bool isIncomplete) {
 
   Q_UNUSED(requestId);
 
@@ -79,6 +80,7 @@ void LspCompletionProvider::onCompletionReceived(
   }
 
   m_pendingCallbacks.clear();
+  m_lastResultsIncomplete = isIncomplete;
   callback(completionItems);
 }
 
@@ -30,6 +30,10 @@ public:
 
   void cancelPendingRequests() override;
 
+  bool lastResultsIncomplete() const override {
+    return m_lastResultsIncomplete;
+  }
+
   bool isEnabled() const override {
     return m_enabled && m_client && m_client->isReady();
   }
@@ -41,7 +45,8 @@ public:
 
 private slots:
   void onCompletionReceived(int requestId,
-                            const QList<LspCompletionItem> &items);
+                            const QList<LspCompletionItem> &items,
+                            bool isIncomplete);
 
 private:
   CompletionItem convertItem(const LspCompletionItem &lspItem) const;
@@ -49,6 +54,7 @@ private:
 
   LspClient *m_client;
   bool m_enabled = true;
+  bool m_lastResultsIncomplete = false;
 
   QMap<int, std::function<void(const QList<CompletionItem> &)>>
       m_pendingCallbacks;
@@ -1,6 +1,6 @@
 #include "autosavemanager.h"
 #include "../ui/mainwindow.h"
-#include "io/filemanager.h"
+#include "io/filesaver.h"
 #include "lightpadtabwidget.h"
 #include "textarea.h"
 #include <QFileInfo>
@@ -22,6 +22,8 @@ AutoSaveManager::AutoSaveManager(MainWindow *mainWindow, QObject *parent)
     : QObject(parent), m_mainWindow(mainWindow), m_timer(new QTimer(this)),
       m_enabled(false), m_delaySeconds(DEFAULT_DELAY_SECONDS) {
   connect(m_timer, &QTimer::timeout, this, &AutoSaveManager::onTimer);
+  connect(&FileSaver::instance(), &FileSaver::saveFinished, this,
+          &AutoSaveManager::onSaveFinished);
 }
 
 AutoSaveManager::~AutoSaveManager() {
@@ -95,10 +97,7 @@ void AutoSaveManager::saveAllPending() {
       continue;
     }
 
-    if (m_mainWindow->save(filePath, true)) {
-      m_pendingFiles.remove(filePath);
-      emit fileSaved(filePath);
-    } else {
+    if (!m_mainWindow->save(filePath, true)) {
       emit saveError(filePath, "Failed to save file");
     }
   }
@@ -110,6 +109,18 @@ void AutoSaveManager::saveAllPending() {
 
 int AutoSaveManager::pendingCount() const { return m_pendingFiles.size(); }
 
+void AutoSaveManager::onSaveFinished(const FileSaveResult &result) {
+  if (!result.isAutoSave) {
+    return;
+  }
+
+  if (result.success) {
+    emit fileSaved(result.filePath);
+  } else {
+    emit saveError(result.filePath, result.errorMessage);
+  }
+}
+
 void AutoSaveManager::onTimer() {
   if (m_enabled && !m_pendingFiles.isEmpty()) {
     saveAllPending();
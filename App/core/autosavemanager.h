@@ -7,6 +7,7 @@
 #include <QTimer>
 
 class MainWindow;
+struct FileSaveResult;
 
 class AutoSaveManager : public QObject {
   Q_OBJECT
@@ -42,6 +43,8 @@ signals:
 private slots:
   void onTimer();
 
+  void onSaveFinished(const FileSaveResult &result);
+
 private:
   MainWindow *m_mainWindow;
   QTimer *m_timer;
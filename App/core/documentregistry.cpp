@@ -0,0 +1,110 @@
+#include "documentregistry.h"
+
+#include <QPlainTextEdit>
+#include <QTextDocument>
+
+DocumentRegistry::DocumentRegistry(QObject *parent) : QObject(parent) {}
+
+DocumentRegistry::~DocumentRegistry() {}
+
+void DocumentRegistry::registerView(const QString &filePath,
+                                    QPlainTextEdit *view) {
+  if (filePath.isEmpty() || !view) {
+    return;
+  }
+
+  const QString previousPath = m_viewPaths.value(view);
+  if (previousPath == filePath) {
+    return;
+  }
+  if (!previousPath.isEmpty()) {
+    unregisterView(view);
+  }
+
+  QList<QPointer<QPlainTextEdit>> &views = m_views[filePath];
+  views.append(view);
+  m_viewPaths.insert(view, filePath);
+  connect(view, &QObject::destroyed, this, &DocumentRegistry::onViewDestroyed);
+
+  QTextDocument *document = view->document();
+  if (views.size() == 1) {
+    m_documents.insert(filePath, document);
+  } else if (document && document->parent() != this) {
+    document->setParent(this);
+  }
+}
+
+void DocumentRegistry::unregisterView(QPlainTextEdit *view) {
+  if (!view || !m_viewPaths.contains(view)) {
+    return;
+  }
+
+  disconnect(view, &QObject::destroyed, this,
+             &DocumentRegistry::onViewDestroyed);
+  const QString filePath = m_viewPaths.take(view);
+  QList<QPointer<QPlainTextEdit>> &views = m_views[filePath];
+  views.removeAll(view);
+  views.removeAll(nullptr);
+
+  if (views.isEmpty()) {
+    m_views.remove(filePath);
+    releaseDocument(filePath, m_documents.take(filePath));
+  }
+}
+
+QPlainTextEdit *DocumentRegistry::primaryView(const QString &filePath) const {
+  const auto it = m_views.constFind(filePath);
+  if (it == m_views.cend()) {
+    return nullptr;
+  }
+  for (const QPointer<QPlainTextEdit> &view : *it) {
+    if (view) {
+      return view;
+    }
+  }
+  return nullptr;
+}
+
+QList<QPlainTextEdit *> DocumentRegistry::views(const QString &filePath) const {
+  QList<QPlainTextEdit *> result;
+  for (const QPointer<QPlainTextEdit> &view : m_views.value(filePath)) {
+    if (view) {
+      result.append(view);
+    }
+  }
+  return result;
+}
+
+int DocumentRegistry::viewCount(const QString &filePath) const {
+  return views(filePath).size();
+}
+
+QTextDocument *DocumentRegistry::document(const QString &filePath) const {
+  return m_documents.value(filePath);
+}
+
+QString DocumentRegistry::filePathForView(const QPlainTextEdit *view) const {
+  return m_viewPaths.value(view);
+}
+
+void DocumentRegistry::onViewDestroyed(QObject *object) {
+  const QString filePath = m_viewPaths.take(object);
+  if (filePath.isEmpty()) {
+    return;
+  }
+
+  QList<QPointer<QPlainTextEdit>> &views = m_views[filePath];
+  views.removeAll(nullptr);
+  if (views.isEmpty()) {
+    m_views.remove(filePath);
+    releaseDocument(filePath, m_documents.take(filePath));
+  }
+}
+
+void DocumentRegistry::releaseDocument(const QString &filePath,
+                                       QTextDocument *document) {
+  if (document && document->parent() == this) {
+    document->deleteLater();
+  }
+  emit documentReleased(filePath);
+}
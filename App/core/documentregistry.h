@@ -0,0 +1,41 @@
+#ifndef DOCUMENTREGISTRY_H
+#define DOCUMENTREGISTRY_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+class QPlainTextEdit;
+class QTextDocument;
+
+class DocumentRegistry : public QObject {
+  Q_OBJECT
+
+public:
+  explicit DocumentRegistry(QObject *parent = nullptr);
+  ~DocumentRegistry();
+
+  void registerView(const QString &filePath, QPlainTextEdit *view);
+  void unregisterView(QPlainTextEdit *view);
+
+  QPlainTextEdit *primaryView(const QString &filePath) const;
+  QList<QPlainTextEdit *> views(const QString &filePath) const;
+  int viewCount(const QString &filePath) const;
+  QTextDocument *document(const QString &filePath) const;
+  QString filePathForView(const QPlainTextEdit *view) const;
+
+signals:
+  void documentReleased(const QString &filePath);
+
+private:
+  void onViewDestroyed(QObject *object);
+  void releaseDocument(const QString &filePath, QTextDocument *document);
+
+  QHash<QString, QList<QPointer<QPlainTextEdit>>> m_views;
+  QHash<const QObject *, QString> m_viewPaths;
+  QHash<QString, QPointer<QTextDocument>> m_documents;
+};
+
+#endif
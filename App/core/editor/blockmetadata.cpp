@@ -0,0 +1,195 @@
+#include "blockmetadata.h"
+#include <QStringList>
+#include <QTextBlock>
+#include <QTextDocument>
+
+namespace {
+bool startsWithAny(const QString &text, const QStringList &patterns) {
+  for (const QString &pattern : patterns) {
+    if (text.startsWith(pattern)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isSingleLineComment(const QString &trimmedText) {
+  if (trimmedText.startsWith("//")) {
+    return true;
+  }
+  if (trimmedText.startsWith("#") && !trimmedText.startsWith("#include") &&
+      !trimmedText.startsWith("#define") &&
+      !trimmedText.startsWith("#pragma") && !trimmedText.startsWith("#if") &&
+      !trimmedText.startsWith("#else") && !trimmedText.startsWith("#endif") &&
+      !trimmedText.startsWith("#region") &&
+      !trimmedText.startsWith("#endregion")) {
+    return true;
+  }
+  return false;
+}
+} // namespace
+
+void BracketSummary::append(const BracketSummary &next) {
+  for (int type = 0; type < BRACKET_INDEX_TYPE_COUNT; ++type) {
+    minPrefix[type] = qMin(minPrefix[type], sum[type] + next.minPrefix[type]);
+    maxSuffix[type] =
+        qMax(next.maxSuffix[type], next.sum[type] + maxSuffix[type]);
+    sum[type] += next.sum[type];
+  }
+}
+
+BlockMetadata *BlockMetadata::of(const QTextBlock &block) {
+  return block.isValid() ? static_cast<BlockMetadata *>(block.userData())
+                         : nullptr;
+}
+
+BlockMetadata *BlockMetadata::ensure(QTextBlock &block) {
+  BlockMetadata *data = of(block);
+  if (!data && block.isValid()) {
+    data = new BlockMetadata;
+    block.setUserData(data);
+  }
+  return data;
+}
+
+BlockMetadataCache::BlockMetadataCache(QTextDocument *document)
+    : QObject(document), m_document(document),
+      m_blockCount(document->blockCount()), m_levelsValidThrough(-1) {
+  connect(m_document, &QTextDocument::contentsChange, this,
+          &BlockMetadataCache::onContentsChange);
+}
+
+BlockMetadataCache *BlockMetadataCache::forDocument(QTextDocument *document) {
+  if (!document) {
+    return nullptr;
+  }
+  auto *cache = document->findChild<BlockMetadataCache *>(
+      QString(), Qt::FindDirectChildrenOnly);
+  return cache ? cache : new BlockMetadataCache(document);
+}
+
+void BlockMetadataCache::computeLayoutFacts(const QString &text,
+                                            BlockMetadata *data) {
+  static const QStringList regionStartPatterns = {
+      "#region",    "// region", "//region",      "//#region",
+      "// #region", "/* region", "/*region",      "/* #region",
+      "/*#region",  "# region",  "#pragma region"};
+  static const QStringList regionEndPatterns = {
+      "#endregion",    "// endregion", "//endregion",      "//#endregion",
+      "// #endregion", "/* endregion", "/*endregion",      "/* #endregion",
+      "/*#endregion",  "# endregion",  "#pragma endregion"};
+
+  int indent = 0;
+  for (QChar c : text) {
+    if (c == ' ')
+      indent++;
+    else if (c == '\t')
+      indent += BLOCK_METADATA_TAB_WIDTH;
+    else
+      break;
+  }
+
+  int braceDelta = 0;
+  bool hasBrace = false;
+  for (QChar c : text) {
+    if (c == '{') {
+      braceDelta++;
+      hasBrace = true;
+    } else if (c == '}') {
+      braceDelta--;
+    }
+  }
+
+  const QString trimmed = text.trimmed();
+  const QString lower = trimmed.toLower();
+
+  data->indentWidth = indent;
+  data->blank = trimmed.isEmpty();
+  data->hasBrace = hasBrace;
+  data->braceDelta = braceDelta;
+  data->foldMarker = trimmed.endsWith('{') || trimmed.endsWith(':');
+  data->regionStart = startsWithAny(lower, regionStartPatterns);
+  data->regionEnd = startsWithAny(lower, regionEndPatterns);
+  data->lineComment = isSingleLineComment(trimmed);
+  data->blockCommentStart =
+      trimmed.startsWith("/*") && !trimmed.contains("*/");
+  data->blockCommentEnd = text.contains("*/");
+  data->hasLayoutFacts = true;
+}
+
+const BlockMetadata *BlockMetadataCache::facts(const QTextBlock &block) {
+  return ensureFacts(block);
+}
+
+int BlockMetadataCache::braceLevel(const QTextBlock &block) {
+  if (!block.isValid()) {
+    return 0;
+  }
+
+  const int number = block.blockNumber();
+  if (number > m_levelsValidThrough) {
+    int current = m_levelsValidThrough + 1;
+    int level = 0;
+    QTextBlock walk = m_document->begin();
+    if (m_levelsValidThrough >= 0) {
+      QTextBlock previous = m_document->findBlockByNumber(m_levelsValidThrough);
+      const BlockMetadata *data = ensureFacts(previous);
+      level = data->braceLevel + data->braceDelta;
+      walk = previous.next();
+    }
+    for (; walk.isValid() && current <= number;
+         walk = walk.next(), ++current) {
+      BlockMetadata *data = ensureFacts(walk);
+      data->braceLevel = level;
+      level += data->braceDelta;
+    }
+    m_levelsValidThrough = number;
+  }
+  return ensureFacts(block)->braceLevel;
+}
+
+void BlockMetadataCache::onContentsChange(int position, int charsRemoved,
+                                          int charsAdded) {
+  Q_UNUSED(charsRemoved);
+
+  const int blockCount = m_document->blockCount();
+  const bool structureChanged = blockCount != m_blockCount;
+  m_blockCount = blockCount;
+
+  QTextBlock block = m_document->findBlock(position);
+  if (!block.isValid()) {
+    return;
+  }
+  const QTextBlock last = m_document->findBlock(position + charsAdded);
+  const int lastNumber = last.isValid() ? last.blockNumber() : blockCount - 1;
+
+  int number = block.blockNumber();
+  int firstLevelChange = structureChanged ? number : -1;
+  for (; block.isValid() && number <= lastNumber;
+       block = block.next(), ++number) {
+    BlockMetadata *data = BlockMetadata::ensure(block);
+    const bool hadFacts = data->hasLayoutFacts;
+    const int previousDelta = data->braceDelta;
+    computeLayoutFacts(block.text(), data);
+    if (firstLevelChange < 0 &&
+        (!hadFacts || data->braceDelta != previousDelta)) {
+      firstLevelChange = number;
+    }
+  }
+
+  if (firstLevelChange >= 0) {
+    m_levelsValidThrough = qMin(m_levelsValidThrough, firstLevelChange - 1);
+  }
+}
+
+BlockMetadata *BlockMetadataCache::ensureFacts(const QTextBlock &block) {
+  if (!block.isValid()) {
+    return nullptr;
+  }
+  QTextBlock target = block;
+  BlockMetadata *data = BlockMetadata::ensure(target);
+  if (!data->hasLayoutFacts) {
+    computeLayoutFacts(block.text(), data);
+  }
+  return data;
+}
@@ -0,0 +1,75 @@
+#ifndef BLOCKMETADATA_H
+#define BLOCKMETADATA_H
+
+#include <QObject>
+#include <QTextBlockUserData>
+#include <QVector>
+
+class QTextBlock;
+class QTextDocument;
+
+constexpr int BRACKET_INDEX_TYPE_COUNT = 3;
+constexpr int BLOCK_METADATA_TAB_WIDTH = 4;
+
+struct BracketToken {
+  int position;
+  int type;
+  bool opening;
+};
+
+struct BracketSummary {
+  int sum[BRACKET_INDEX_TYPE_COUNT] = {0, 0, 0};
+  int minPrefix[BRACKET_INDEX_TYPE_COUNT] = {0, 0, 0};
+  int maxSuffix[BRACKET_INDEX_TYPE_COUNT] = {0, 0, 0};
+
+  void append(const BracketSummary &next);
+};
+
+class BlockMetadata : public QTextBlockUserData {
+public:
+  static BlockMetadata *of(const QTextBlock &block);
+  static BlockMetadata *ensure(QTextBlock &block);
+
+  bool hasLayoutFacts = false;
+  int indentWidth = 0;
+  bool blank = true;
+  bool hasBrace = false;
+  int braceDelta = 0;
+  bool foldMarker = false;
+  bool regionStart = false;
+  bool regionEnd = false;
+  bool lineComment = false;
+  bool blockCommentStart = false;
+  bool blockCommentEnd = false;
+  int braceLevel = 0;
+
+  bool bracketsIndexed = false;
+  QVector<BracketToken> bracketTokens;
+  BracketSummary bracketSummary;
+  int bracketExitState = 0;
+};
+
+class BlockMetadataCache : public QObject {
+  Q_OBJECT
+
+public:
+  explicit BlockMetadataCache(QTextDocument *document);
+
+  static BlockMetadataCache *forDocument(QTextDocument *document);
+
+  static void computeLayoutFacts(const QString &text, BlockMetadata *data);
+
+  const BlockMetadata *facts(const QTextBlock &block);
+
+  int braceLevel(const QTextBlock &block);
+
+private:
+  void onContentsChange(int position, int charsRemoved, int charsAdded);
+  BlockMetadata *ensureFacts(const QTextBlock &block);
+
+  QTextDocument *m_document;
+  int m_blockCount;
+  int m_levelsValidThrough;
+};
+
+#endif
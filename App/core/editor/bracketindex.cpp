@@ -0,0 +1,567 @@
+#include "bracketindex.h"
+#include <QStringList>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <algorithm>
+
+namespace {
+constexpr int STATE_CODE = 0;
+constexpr int STATE_BLOCK_COMMENT = 1;
+} // namespace
+
+BracketIndex::BracketIndex(QTextDocument *document)
+    : QObject(document), m_document(document), m_languageId("plaintext"),
+      m_blockCount(0), m_bucketCount(0), m_treeValid(false) {
+  connect(m_document, &QTextDocument::contentsChange, this,
+          &BracketIndex::onContentsChange);
+  reindexAll();
+}
+
+BracketIndex *BracketIndex::forDocument(QTextDocument *document) {
+  if (!document) {
+    return nullptr;
+  }
+  auto *index = document->findChild<BracketIndex *>(
+      QString(), Qt::FindDirectChildrenOnly);
+  return index ? index : new BracketIndex(document);
+}
+
+BracketSyntax BracketIndex::syntaxForLanguage(const QString &languageId) {
+  static const QStringList hashCommentLanguages = {
+      "py", "sh", "yaml", "cmake", "make", "bazel", "meson", "ninja",
+      "dockerfile"};
+
+  if (languageId == "cpp" || languageId == "java") {
+    return {"//", "/*", "*/", "\"'"};
+  }
+  if (languageId == "go" || languageId == "js" || languageId == "ts") {
+    return {"//", "/*", "*/", "\"'`"};
+  }
+  if (languageId == "rust") {
+    return {"//", "/*", "*/", "\""};
+  }
+  if (languageId == "css") {
+    return {QString(), "/*", "*/", "\"'"};
+  }
+  if (languageId == "json") {
+    return {QString(), QString(), QString(), "\""};
+  }
+  if (hashCommentLanguages.contains(languageId)) {
+    return {"#", QString(), QString(), "\"'"};
+  }
+  if (languageId == "latex") {
+    return {"%", QString(), QString(), QString()};
+  }
+  return {};
+}
+
+int BracketIndex::bracketType(QChar ch, bool *opening) {
+  static const QString openers = QStringLiteral("([{");
+  static const QString closers = QStringLiteral(")]}");
+
+  int type = openers.indexOf(ch);
+  if (opening) {
+    *opening = type >= 0;
+  }
+  if (type < 0) {
+    type = closers.indexOf(ch);
+  }
+  return type;
+}
+
+void BracketIndex::setLanguage(const QString &languageId) {
+  if (languageId == m_languageId) {
+    return;
+  }
+  m_languageId = languageId;
+  m_syntax = syntaxForLanguage(languageId);
+  reindexAll();
+}
+
+int BracketIndex::findMatchingBracket(int position) {
+  QTextBlock block = m_document->findBlock(position);
+  const BlockMetadata *data = dataFor(block);
+  if (!data) {
+    return -1;
+  }
+
+  const int offset = position - block.position();
+  const auto it = std::lower_bound(
+      data->bracketTokens.cbegin(), data->bracketTokens.cend(), offset,
+      [](const BracketToken &token, int value) {
+        return token.position < value;
+      });
+  if (it == data->bracketTokens.cend() || it->position != offset) {
+    return -1;
+  }
+
+  const BracketToken token = *it;
+  int depth = 1;
+  if (token.opening) {
+    for (auto next = it + 1; next != data->bracketTokens.cend(); ++next) {
+      if (next->type == token.type) {
+        depth += next->opening ? 1 : -1;
+        if (depth == 0) {
+          return block.position() + next->position;
+        }
+      }
+    }
+    return scanForward(block.next(), token.type, depth);
+  }
+
+  for (auto previous = it; previous != data->bracketTokens.cbegin();) {
+    --previous;
+    if (previous->type == token.type) {
+      depth += previous->opening ? -1 : 1;
+      if (depth == 0) {
+        return block.position() + previous->position;
+      }
+    }
+  }
+  return scanBackward(block.previous(), token.type, depth);
+}
+
+void BracketIndex::onContentsChange(int position, int charsRemoved,
+                                    int charsAdded) {
+  Q_UNUSED(charsRemoved);
+
+  QTextBlock block = m_document->findBlock(position);
+  const int blockCount = m_document->blockCount();
+  if (blockCount != m_blockCount) {
+    if (m_treeValid && block.isValid()) {
+      spliceBlocks(block.blockNumber(), blockCount - m_blockCount);
+    } else {
+      m_treeValid = false;
+    }
+    m_blockCount = blockCount;
+  }
+
+  if (!block.isValid()) {
+    return;
+  }
+  const QTextBlock last = m_document->findBlock(position + charsAdded);
+  const int lastNumber =
+      last.isValid() ? last.blockNumber() : m_document->blockCount() - 1;
+
+  int number = block.blockNumber();
+  bool carry = false;
+  while (block.isValid() && (number <= lastNumber || carry)) {
+    carry = reindexBlock(block, entryStateFor(block));
+    markBucketDirty(number);
+    block = block.next();
+    ++number;
+  }
+}
+
+void BracketIndex::reindexAll() {
+  int state = STATE_CODE;
+  for (QTextBlock block = m_document->begin(); block.isValid();
+       block = block.next()) {
+    reindexBlock(block, state);
+    state = dataFor(block)->bracketExitState;
+  }
+  m_blockCount = m_document->blockCount();
+  m_treeValid = false;
+}
+
+bool BracketIndex::reindexBlock(QTextBlock &block, int entryState) {
+  BlockMetadata *data = dataFor(block);
+  const int previousExitState = data ? data->bracketExitState : -1;
+  data = BlockMetadata::ensure(block);
+  data->bracketsIndexed = true;
+  data->bracketTokens.clear();
+  data->bracketSummary = BracketSummary();
+
+  const QString text = block.text();
+  const int length = text.size();
+  int state = entryState;
+  int i = 0;
+  while (i < length) {
+    if (state == STATE_BLOCK_COMMENT) {
+      const int end = text.indexOf(m_syntax.blockCommentEnd, i);
+      if (end < 0) {
+        break;
+      }
+      i = end + m_syntax.blockCommentEnd.size();
+      state = STATE_CODE;
+      continue;
+    }
+
+    const QStringView rest = QStringView(text).mid(i);
+    if (!m_syntax.lineComment.isEmpty() &&
+        rest.startsWith(m_syntax.lineComment)) {
+      break;
+    }
+    if (!m_syntax.blockCommentStart.isEmpty() &&
+        rest.startsWith(m_syntax.blockCommentStart)) {
+      i += m_syntax.blockCommentStart.size();
+      state = STATE_BLOCK_COMMENT;
+      continue;
+    }
+
+    const QChar ch = text.at(i);
+    if (m_syntax.quotes.contains(ch)) {
+      ++i;
+      while (i < length && text.at(i) != ch) {
+        i += text.at(i) == QLatin1Char('\\') ? 2 : 1;
+      }
+      ++i;
+      continue;
+    }
+
+    bool opening = false;
+    const int type = bracketType(ch, &opening);
+    if (type >= 0) {
+      data->bracketTokens.append({i, type, opening});
+      BracketSummary single;
+      single.sum[type] = opening ? 1 : -1;
+      single.minPrefix[type] = qMin(0, single.sum[type]);
+      single.maxSuffix[type] = qMax(0, single.sum[type]);
+      data->bracketSummary.append(single);
+    }
+    ++i;
+  }
+
+  data->bracketExitState = state;
+  return previousExitState != state;
+}
+
+int BracketIndex::entryStateFor(const QTextBlock &block) const {
+  const BlockMetadata *data = dataFor(block.previous());
+  return data ? data->bracketExitState : STATE_CODE;
+}
+
+BlockMetadata *BracketIndex::dataFor(const QTextBlock &block) const {
+  BlockMetadata *data = BlockMetadata::of(block);
+  return data && data->bracketsIndexed ? data : nullptr;
+}
+
+void BracketIndex::markBucketDirty(int blockNumber) {
+  if (!m_treeValid) {
+    return;
+  }
+  int firstBlock = 0;
+  const int bucket = bucketAt(blockNumber, &firstBlock);
+  if (m_dirtyBuckets.isEmpty() || m_dirtyBuckets.last() != bucket) {
+    m_dirtyBuckets.append(bucket);
+  }
+}
+
+void BracketIndex::spliceBlocks(int blockNumber, int delta) {
+  int firstBlock = 0;
+  int bucket = bucketAt(blockNumber, &firstBlock);
+  if (delta > 0) {
+    m_bucketBlocks[bucket] += delta;
+    updateTree(1, 0, m_bucketCount - 1, bucket);
+    m_dirtyBuckets.append(bucket);
+    return;
+  }
+
+  int remaining = -delta;
+  int available = firstBlock + m_bucketBlocks[bucket] - 1 - blockNumber;
+  while (remaining > 0 && bucket < m_bucketCount) {
+    const int taken = qMin(remaining, available);
+    if (taken > 0) {
+      m_bucketBlocks[bucket] -= taken;
+      updateTree(1, 0, m_bucketCount - 1, bucket);
+      m_dirtyBuckets.append(bucket);
+      remaining -= taken;
+    }
+    if (++bucket < m_bucketCount) {
+      available = m_bucketBlocks[bucket];
+    }
+  }
+  if (remaining > 0) {
+    m_treeValid = false;
+  }
+}
+
+void BracketIndex::ensureTree() {
+  if (!m_treeValid) {
+    m_bucketCount = qMax(1, (m_blockCount + BRACKET_INDEX_BUCKET_BLOCKS - 1) /
+                                BRACKET_INDEX_BUCKET_BLOCKS);
+    m_buckets = QVector<BracketSummary>(m_bucketCount);
+    m_bucketBlocks = QVector<int>(m_bucketCount, 0);
+    int number = 0;
+    for (QTextBlock block = m_document->begin(); block.isValid();
+         block = block.next(), ++number) {
+      const int bucket = number / BRACKET_INDEX_BUCKET_BLOCKS;
+      ++m_bucketBlocks[bucket];
+      if (const BlockMetadata *data = dataFor(block)) {
+        m_buckets[bucket].append(data->bracketSummary);
+      }
+    }
+    m_tree = QVector<BracketSummary>(4 * m_bucketCount);
+    m_treeBlocks = QVector<int>(4 * m_bucketCount, 0);
+    buildTree(1, 0, m_bucketCount - 1);
+    m_dirtyBuckets.clear();
+    m_treeValid = true;
+    return;
+  }
+
+  bool rebalance = false;
+  for (int bucket : std::as_const(m_dirtyBuckets)) {
+    m_buckets[bucket] =
+        bucketSummary(bucketStart(bucket), m_bucketBlocks[bucket]);
+    updateTree(1, 0, m_bucketCount - 1, bucket);
+    rebalance =
+        rebalance || m_bucketBlocks[bucket] > BRACKET_INDEX_MAX_BUCKET_BLOCKS;
+  }
+  m_dirtyBuckets.clear();
+  if (rebalance) {
+    rebalanceBuckets();
+  }
+}
+
+void BracketIndex::rebalanceBuckets() {
+  QVector<BracketSummary> buckets;
+  QVector<int> bucketBlocks;
+  buckets.reserve(m_bucketCount);
+  bucketBlocks.reserve(m_bucketCount);
+  int firstBlock = 0;
+  for (int bucket = 0; bucket < m_bucketCount; ++bucket) {
+    const int blocks = m_bucketBlocks[bucket];
+    if (blocks > BRACKET_INDEX_MAX_BUCKET_BLOCKS) {
+      const int pieces = (blocks + BRACKET_INDEX_BUCKET_BLOCKS - 1) /
+                         BRACKET_INDEX_BUCKET_BLOCKS;
+      int start = firstBlock;
+      for (int piece = 0; piece < pieces; ++piece) {
+        const int end = firstBlock + blocks * (piece + 1) / pieces;
+        buckets.append(bucketSummary(start, end - start));
+        bucketBlocks.append(end - start);
+        start = end;
+      }
+    } else if (blocks > 0) {
+      buckets.append(m_buckets[bucket]);
+      bucketBlocks.append(blocks);
+    }
+    firstBlock += blocks;
+  }
+  if (buckets.isEmpty()) {
+    buckets.append(BracketSummary());
+    bucketBlocks.append(0);
+  }
+
+  m_buckets = buckets;
+  m_bucketBlocks = bucketBlocks;
+  m_bucketCount = m_buckets.size();
+  m_tree = QVector<BracketSummary>(4 * m_bucketCount);
+  m_treeBlocks = QVector<int>(4 * m_bucketCount, 0);
+  buildTree(1, 0, m_bucketCount - 1);
+}
+
+BracketSummary BracketIndex::bucketSummary(int firstBlock, int blocks) const {
+  BracketSummary summary;
+  QTextBlock block = m_document->findBlockByNumber(firstBlock);
+  for (int i = 0; i < blocks && block.isValid(); ++i, block = block.next()) {
+    if (const BlockMetadata *data = dataFor(block)) {
+      summary.append(data->bracketSummary);
+    }
+  }
+  return summary;
+}
+
+int BracketIndex::bucketAt(int blockNumber, int *firstBlock) const {
+  int node = 1;
+  int lo = 0;
+  int hi = m_bucketCount - 1;
+  int first = 0;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (blockNumber - first < m_treeBlocks[2 * node]) {
+      node = 2 * node;
+      hi = mid;
+    } else {
+      first += m_treeBlocks[2 * node];
+      node = 2 * node + 1;
+      lo = mid + 1;
+    }
+  }
+  *firstBlock = first;
+  return lo;
+}
+
+int BracketIndex::bucketStart(int bucket) const {
+  int node = 1;
+  int lo = 0;
+  int hi = m_bucketCount - 1;
+  int first = 0;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (bucket <= mid) {
+      node = 2 * node;
+      hi = mid;
+    } else {
+      first += m_treeBlocks[2 * node];
+      node = 2 * node + 1;
+      lo = mid + 1;
+    }
+  }
+  return first;
+}
+
+void BracketIndex::buildTree(int node, int lo, int hi) {
+  if (lo == hi) {
+    m_tree[node] = m_buckets[lo];
+    m_treeBlocks[node] = m_bucketBlocks[lo];
+    return;
+  }
+  const int mid = (lo + hi) / 2;
+  buildTree(2 * node, lo, mid);
+  buildTree(2 * node + 1, mid + 1, hi);
+  m_tree[node] = m_tree[2 * node];
+  m_tree[node].append(m_tree[2 * node + 1]);
+  m_treeBlocks[node] = m_treeBlocks[2 * node] + m_treeBlocks[2 * node + 1];
+}
+
+void BracketIndex::updateTree(int node, int lo, int hi, int leaf) {
+  if (lo == hi) {
+    m_tree[node] = m_buckets[leaf];
+    m_treeBlocks[node] = m_bucketBlocks[leaf];
+    return;
+  }
+  const int mid = (lo + hi) / 2;
+  if (leaf <= mid) {
+    updateTree(2 * node, lo, mid, leaf);
+  } else {
+    updateTree(2 * node + 1, mid + 1, hi, leaf);
+  }
+  m_tree[node] = m_tree[2 * node];
+  m_tree[node].append(m_tree[2 * node + 1]);
+  m_treeBlocks[node] = m_treeBlocks[2 * node] + m_treeBlocks[2 * node + 1];
+}
+
+int BracketIndex::findForward(int node, int lo, int hi, int from, int type,
+                              int &depth) const {
+  if (hi < from) {
+    return -1;
+  }
+  const BracketSummary &summary = m_tree[node];
+  if (lo >= from && depth + summary.minPrefix[type] > 0) {
+    depth += summary.sum[type];
+    return -1;
+  }
+  if (lo == hi) {
+    return lo;
+  }
+  const int mid = (lo + hi) / 2;
+  const int left = findForward(2 * node, lo, mid, from, type, depth);
+  return left >= 0 ? left
+                   : findForward(2 * node + 1, mid + 1, hi, from, type, depth);
+}
+
+int BracketIndex::findBackward(int node, int lo, int hi, int to, int type,
+                               int &depth) const {
+  if (lo > to) {
+    return -1;
+  }
+  const BracketSummary &summary = m_tree[node];
+  if (hi <= to && depth - summary.maxSuffix[type] > 0) {
+    depth -= summary.sum[type];
+    return -1;
+  }
+  if (lo == hi) {
+    return lo;
+  }
+  const int mid = (lo + hi) / 2;
+  const int right = findBackward(2 * node + 1, mid + 1, hi, to, type, depth);
+  return right >= 0 ? right
+                    : findBackward(2 * node, lo, mid, to, type, depth);
+}
+
+int BracketIndex::scanForward(const QTextBlock &start, int type, int depth) {
+  if (!start.isValid()) {
+    return -1;
+  }
+  ensureTree();
+
+  QTextBlock block = start;
+  int number = block.blockNumber();
+  int firstBlock = 0;
+  int next = bucketAt(number, &firstBlock);
+  int boundary = firstBlock;
+  if (firstBlock != number) {
+    boundary = firstBlock + m_bucketBlocks[next];
+    ++next;
+  }
+  bool searchedTree = false;
+  while (block.isValid()) {
+    if (number == boundary && !searchedTree) {
+      const int bucket =
+          findForward(1, 0, m_bucketCount - 1, next, type, depth);
+      if (bucket < 0) {
+        return -1;
+      }
+      number = bucketStart(bucket);
+      block = m_document->findBlockByNumber(number);
+      searchedTree = true;
+      continue;
+    }
+
+    const BlockMetadata *data = dataFor(block);
+    if (data && depth + data->bracketSummary.minPrefix[type] <= 0) {
+      for (const BracketToken &token : data->bracketTokens) {
+        if (token.type == type) {
+          depth += token.opening ? 1 : -1;
+          if (depth == 0) {
+            return block.position() + token.position;
+          }
+        }
+      }
+    } else if (data) {
+      depth += data->bracketSummary.sum[type];
+    }
+    block = block.next();
+    ++number;
+  }
+  return -1;
+}
+
+int BracketIndex::scanBackward(const QTextBlock &start, int type, int depth) {
+  if (!start.isValid()) {
+    return -1;
+  }
+  ensureTree();
+
+  QTextBlock block = start;
+  int number = block.blockNumber();
+  int firstBlock = 0;
+  int previous = bucketAt(number, &firstBlock);
+  int boundary = firstBlock + m_bucketBlocks[previous] - 1;
+  if (boundary != number) {
+    boundary = firstBlock - 1;
+    --previous;
+  }
+  bool searchedTree = false;
+  while (block.isValid()) {
+    if (number == boundary && !searchedTree) {
+      const int bucket =
+          findBackward(1, 0, m_bucketCount - 1, previous, type, depth);
+      if (bucket < 0) {
+        return -1;
+      }
+      number = bucketStart(bucket) + m_bucketBlocks[bucket] - 1;
+      block = m_document->findBlockByNumber(number);
+      searchedTree = true;
+      continue;
+    }
+
+    const BlockMetadata *data = dataFor(block);
+    if (data && depth - data->bracketSummary.maxSuffix[type] <= 0) {
+      for (auto it = data->bracketTokens.crbegin();
+           it != data->bracketTokens.crend(); ++it) {
+        if (it->type == type) {
+          depth += it->opening ? -1 : 1;
+          if (depth == 0) {
+            return block.position() + it->position;
+          }
+        }
+      }
+    } else if (data) {
+      depth -= data->bracketSummary.sum[type];
+    }
+    block = block.previous();
+    --number;
+  }
+  return -1;
+}
@@ -0,0 +1,76 @@
+#ifndef BRACKETINDEX_H
+#define BRACKETINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "blockmetadata.h"
+
+class QTextBlock;
+class QTextDocument;
+
+constexpr int BRACKET_INDEX_BUCKET_BLOCKS = 32;
+constexpr int BRACKET_INDEX_MAX_BUCKET_BLOCKS = 128;
+
+struct BracketSyntax {
+  QString lineComment;
+  QString blockCommentStart;
+  QString blockCommentEnd;
+  QString quotes;
+};
+
+class BracketIndex : public QObject {
+  Q_OBJECT
+
+public:
+  explicit BracketIndex(QTextDocument *document);
+
+  static BracketIndex *forDocument(QTextDocument *document);
+
+  static BracketSyntax syntaxForLanguage(const QString &languageId);
+
+  static int bracketType(QChar ch, bool *opening = nullptr);
+
+  void setLanguage(const QString &languageId);
+
+  QString language() const { return m_languageId; }
+
+  int findMatchingBracket(int position);
+
+private:
+  void onContentsChange(int position, int charsRemoved, int charsAdded);
+  void reindexAll();
+  bool reindexBlock(QTextBlock &block, int entryState);
+  int entryStateFor(const QTextBlock &block) const;
+  BlockMetadata *dataFor(const QTextBlock &block) const;
+  void markBucketDirty(int blockNumber);
+  void spliceBlocks(int blockNumber, int delta);
+  void ensureTree();
+  void rebalanceBuckets();
+  BracketSummary bucketSummary(int firstBlock, int blocks) const;
+  int bucketAt(int blockNumber, int *firstBlock) const;
+  int bucketStart(int bucket) const;
+  void buildTree(int node, int lo, int hi);
+  void updateTree(int node, int lo, int hi, int leaf);
+  int findForward(int node, int lo, int hi, int from, int type,
+                  int &depth) const;
+  int findBackward(int node, int lo, int hi, int to, int type,
+                   int &depth) const;
+  int scanForward(const QTextBlock &start, int type, int depth);
+  int scanBackward(const QTextBlock &start, int type, int depth);
+
+  QTextDocument *m_document;
+  QString m_languageId;
+  BracketSyntax m_syntax;
+  QVector<BracketSummary> m_buckets;
+  QVector<int> m_bucketBlocks;
+  QVector<BracketSummary> m_tree;
+  QVector<int> m_treeBlocks;
+  QVector<int> m_dirtyBuckets;
+  int m_blockCount;
+  int m_bucketCount;
+  bool m_treeValid;
+};
+
+#endif
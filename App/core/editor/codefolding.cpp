@@ -1,80 +1,65 @@
 #include "codefolding.h"
+#include "blockmetadata.h"
 #include <QJsonArray>
-#include <QStringList>
 #include <QTextBlock>
 #include <QTextDocument>
+#include <algorithm>
+
+namespace {
+class FoldEndRecords {
+public:
+  void push(int position, int value) {
+    while (!m_values.isEmpty() && m_values.last() >= value) {
+      m_values.removeLast();
+      m_positions.removeLast();
+    }
+    m_values.append(value);
+    m_positions.append(position);
+  }
+
+  int firstAtMost(int value) const {
+    auto it = std::upper_bound(m_values.cbegin(), m_values.cend(), value);
+    if (it == m_values.cbegin())
+      return -1;
+    return m_positions.at(int(it - m_values.cbegin()) - 1);
+  }
+
+private:
+  QVector<int> m_values;
+  QVector<int> m_positions;
+};
+} // namespace
 
 CodeFoldingManager::CodeFoldingManager(QTextDocument *document)
-    : m_document(document) {}
+    : m_document(document),
+      m_metadata(BlockMetadataCache::forDocument(document)) {}
 
 bool CodeFoldingManager::isFolded(int blockNumber) const {
   return m_foldedBlocks.contains(blockNumber);
 }
 
-bool CodeFoldingManager::isSingleLineComment(const QString &trimmedText) {
-  if (trimmedText.startsWith("//")) {
-    return true;
-  }
-  if (trimmedText.startsWith("#") && !trimmedText.startsWith("#include") &&
-      !trimmedText.startsWith("#define") &&
-      !trimmedText.startsWith("#pragma") && !trimmedText.startsWith("#if") &&
-      !trimmedText.startsWith("#else") && !trimmedText.startsWith("#endif") &&
-      !trimmedText.startsWith("#region") &&
-      !trimmedText.startsWith("#endregion")) {
-    return true;
-  }
-  return false;
+const BlockMetadata *CodeFoldingManager::factsFor(int blockNumber) const {
+  if (!m_document)
+    return nullptr;
+  return m_metadata->facts(m_document->findBlockByNumber(blockNumber));
 }
 
 bool CodeFoldingManager::isFoldable(int blockNumber) const {
-  if (!m_document)
-    return false;
-
-  QTextBlock block = m_document->findBlockByNumber(blockNumber);
-  if (!block.isValid())
+  const BlockMetadata *facts = factsFor(blockNumber);
+  if (!facts)
     return false;
 
-  QString text = block.text();
-  QString trimmed = text.trimmed();
-
-  if (isRegionStart(blockNumber))
+  if (facts->regionStart)
     return true;
 
   if (isCommentBlockStart(blockNumber))
     return true;
 
-  if (trimmed.endsWith('{') || trimmed.endsWith(':'))
+  if (facts->foldMarker)
     return true;
 
-  QTextBlock nextBlock = block.next();
-  if (nextBlock.isValid()) {
-    QString nextText = nextBlock.text();
-
-    int currentIndent = 0;
-    for (QChar c : text) {
-      if (c == ' ')
-        currentIndent++;
-      else if (c == '\t')
-        currentIndent += 4;
-      else
-        break;
-    }
-
-    int nextIndent = 0;
-    for (QChar c : nextText) {
-      if (c == ' ')
-        nextIndent++;
-      else if (c == '\t')
-        nextIndent += 4;
-      else
-        break;
-    }
-
-    if (nextIndent > currentIndent && !nextText.trimmed().isEmpty())
-      return true;
-  }
-
-  return false;
+  const BlockMetadata *next = factsFor(blockNumber + 1);
+  return next && next->indentWidth > facts->indentWidth && !next->blank;
 }
 
 int CodeFoldingManager::getFoldingLevel(int blockNumber) const {
@@ -85,33 +70,9 @@ int CodeFoldingManager::getFoldingLevel(int blockNumber) const {
   if (!block.isValid())
     return 0;
 
-  QString text = block.text();
-  int indent = 0;
-
-  for (QChar c : text) {
-    if (c == ' ')
-      indent++;
-    else if (c == '\t')
-      indent += 4;
-    else
-      break;
-  }
-
-  int braceLevel = 0;
-  QTextBlock prevBlock = m_document->begin();
-  while (prevBlock.isValid() && prevBlock.blockNumber() < blockNumber) {
-    QString prevText = prevBlock.text();
-    for (QChar c : prevText) {
-      if (c == '{')
-        braceLevel++;
-      else if (c == '}')
-        braceLevel--;
-    }
-    prevBlock = prevBlock.next();
-  }
-
-  int indentLevel = indent / 4;
-  return qMax(indentLevel, braceLevel);
+  int indentLevel =
+      m_metadata->facts(block)->indentWidth / BLOCK_METADATA_TAB_WIDTH;
+  return qMax(indentLevel, m_metadata->braceLevel(block));
 }
 
 int CodeFoldingManager::findFoldEndBlock(int startBlock) const {
@@ -122,8 +83,6 @@ int CodeFoldingManager::findFoldEndBlock(int startBlock) const {
   if (!block.isValid())
     return startBlock;
 
-  QString text = block.text();
-
   if (isRegionStart(startBlock)) {
     return findRegionEndBlock(startBlock);
   }
@@ -132,63 +91,26 @@ int CodeFoldingManager::findFoldEndBlock(int startBlock) const {
     return findCommentBlockEnd(startBlock);
   }
 
-  int startIndent = 0;
-  for (QChar c : text) {
-    if (c == ' ')
-      startIndent++;
-    else if (c == '\t')
-      startIndent += 4;
-    else
-      break;
-  }
-
-  bool braceStyle = text.contains('{');
-  int braceCount = 0;
-
-  if (braceStyle) {
-    for (QChar c : text) {
-      if (c == '{')
-        braceCount++;
-      else if (c == '}')
-        braceCount--;
-    }
-  }
+  const BlockMetadata *start = m_metadata->facts(block);
+  const bool braceStyle = start->hasBrace;
+  int braceCount = start->braceDelta;
 
   block = block.next();
   int lastNonEmpty = startBlock;
 
   while (block.isValid()) {
-    text = block.text().trimmed();
+    const BlockMetadata *facts = m_metadata->facts(block);
 
     if (braceStyle) {
-      for (QChar c : block.text()) {
-        if (c == '{')
-          braceCount++;
-        else if (c == '}')
-          braceCount--;
-      }
-
+      braceCount += facts->braceDelta;
       if (braceCount <= 0) {
         return block.blockNumber();
       }
-    } else {
-
-      if (!text.isEmpty()) {
-        int indent = 0;
-        for (QChar c : block.text()) {
-          if (c == ' ')
-            indent++;
-          else if (c == '\t')
-            indent += 4;
-          else
-            break;
-        }
-
-        if (indent <= startIndent) {
-          return lastNonEmpty;
-        }
-        lastNonEmpty = block.blockNumber();
+    } else if (!facts->blank) {
+      if (facts->indentWidth <= start->indentWidth) {
+        return lastNonEmpty;
       }
+      lastNonEmpty = block.blockNumber();
     }
 
     block = block.next();
@@ -197,6 +119,148 @@ int CodeFoldingManager::findFoldEndBlock(int startBlock) const {
   return lastNonEmpty;
 }
 
+QVector<const BlockMetadata *> CodeFoldingManager::collectFacts() const {
+  QVector<const BlockMetadata *> facts;
+  facts.reserve(m_document->blockCount());
+  for (QTextBlock block = m_document->begin(); block.isValid();
+       block = block.next()) {
+    facts.append(m_metadata->facts(block));
+  }
+  return facts;
+}
+
+QVector<int> CodeFoldingManager::collectFoldEnds(
+    const QVector<const BlockMetadata *> &facts, bool commentsOnly) const {
+  const int count = facts.size();
+  QVector<int> ends(count, -1);
+
+  QVector<int> commentEnds(count, -1);
+  int nextBlockCommentEnd = count - 1;
+  for (int i = count - 1; i >= 0; --i) {
+    if (facts[i]->blockCommentEnd)
+      nextBlockCommentEnd = i;
+    if (facts[i]->blockCommentStart) {
+      commentEnds[i] = nextBlockCommentEnd;
+    } else if (facts[i]->lineComment) {
+      const bool runContinues = i + 1 < count && facts[i + 1]->lineComment;
+      commentEnds[i] = runContinues ? commentEnds[i + 1] : i;
+    }
+  }
+
+  auto isCommentStart = [&](int i) {
+    if (facts[i]->blockCommentStart)
+      return true;
+    if (!facts[i]->lineComment || (i > 0 && facts[i - 1]->lineComment))
+      return false;
+    return commentEnds[i] - i + 1 >= 3;
+  };
+
+  if (commentsOnly) {
+    for (int i = 0; i < count; ++i) {
+      if (isCommentStart(i))
+        ends[i] = commentEnds[i];
+    }
+    return ends;
+  }
+
+  QVector<int> regionEnds(count, count - 1);
+  QVector<int> openRegions;
+  for (int i = 0; i < count; ++i) {
+    if (facts[i]->regionStart) {
+      openRegions.append(i);
+    } else if (facts[i]->regionEnd && !openRegions.isEmpty()) {
+      regionEnds[openRegions.takeLast()] = i;
+    }
+  }
+
+  QVector<int> braceDepth(count + 1, 0);
+  QVector<int> lastNonBlankBefore(count + 1, -1);
+  for (int i = 0; i < count; ++i) {
+    braceDepth[i + 1] = braceDepth[i] + facts[i]->braceDelta;
+    lastNonBlankBefore[i + 1] = facts[i]->blank ? lastNonBlankBefore[i] : i;
+  }
+
+  FoldEndRecords braceRecords;
+  FoldEndRecords indentRecords;
+  for (int i = count - 1; i >= 0; --i) {
+    if (i + 2 <= count)
+      braceRecords.push(i + 2, braceDepth[i + 2]);
+    if (i + 1 < count && !facts[i + 1]->blank)
+      indentRecords.push(i + 1, facts[i + 1]->indentWidth);
+
+    const BlockMetadata *block = facts[i];
+    if (block->regionStart) {
+      ends[i] = regionEnds[i];
+      continue;
+    }
+    if (isCommentStart(i)) {
+      ends[i] = commentEnds[i];
+      continue;
+    }
+
+    const bool nextIndented = i + 1 < count && !facts[i + 1]->blank &&
+                              facts[i + 1]->indentWidth > block->indentWidth;
+    if (!block->foldMarker && !nextIndented)
+      continue;
+
+    if (block->hasBrace) {
+      const int close = braceRecords.firstAtMost(braceDepth[i]);
+      ends[i] = close >= 0 ? close - 1 : i;
+    } else {
+      const int dedent = indentRecords.firstAtMost(block->indentWidth);
+      const int lastInside = lastNonBlankBefore[dedent >= 0 ? dedent : count];
+      ends[i] = qMax(i, lastInside);
+    }
+  }
+  return ends;
+}
+
+void CodeFoldingManager::setBlockVisible(QTextBlock &block, int blockNumber,
+                                         bool visible) {
+  if (block.isVisible() == visible)
+    return;
+
+  block.setVisible(visible);
+  block.setLineCount(visible ? 1 : 0);
+  if (m_changedFirst < 0 || blockNumber < m_changedFirst)
+    m_changedFirst = blockNumber;
+  m_changedLast = qMax(m_changedLast, blockNumber);
+}
+
+void CodeFoldingManager::setBlocksVisible(int firstBlock, int lastBlock,
+                                          bool visible) {
+  QTextBlock block = m_document->findBlockByNumber(firstBlock);
+  for (int number = firstBlock; block.isValid() && number <= lastBlock;
+       ++number, block = block.next()) {
+    setBlockVisible(block, number, visible);
+  }
+}
+
+bool CodeFoldingManager::takeChangedRange(int *firstBlock, int *lastBlock) {
+  if (m_changedFirst < 0)
+    return false;
+
+  *firstBlock = m_changedFirst;
+  *lastBlock = m_changedLast;
+  m_changedFirst = -1;
+  m_changedLast = -1;
+  return true;
+}
+
+void CodeFoldingManager::hideFoldRanges(const QVector<int> &ends) {
+  int hideThrough = -1;
+  QTextBlock block = m_document->begin();
+  for (int i = 0; block.isValid() && i < ends.size();
+       ++i, block = block.next()) {
+    if (i <= hideThrough)
+      setBlockVisible(block, i, false);
+    if (ends[i] >= 0) {
+      m_foldedBlocks.insert(i);
+      hideThrough = qMax(hideThrough, ends[i]);
+    }
+  }
+}
+
 bool CodeFoldingManager::foldBlock(int blockNumber) {
   if (!m_document)
     return false;
@@ -205,13 +269,7 @@ bool CodeFoldingManager::foldBlock(int blockNumber) {
     m_foldedBlocks.insert(blockNumber);
 
     int endBlock = findFoldEndBlock(blockNumber);
-    QTextBlock block = m_document->findBlockByNumber(blockNumber + 1);
-
-    while (block.isValid() && block.blockNumber() <= endBlock) {
-      block.setVisible(false);
-      block.setLineCount(0);
-      block = block.next();
-    }
+    setBlocksVisible(blockNumber + 1, endBlock, false);
 
     return true;
   }
@@ -234,13 +292,7 @@ bool CodeFoldingManager::unfoldBlock(int blockNumber) {
     m_foldedBlocks.remove(blockNumber);
 
     int endBlock = findFoldEndBlock(blockNumber);
-    QTextBlock block = m_document->findBlockByNumber(blockNumber + 1);
-
-    while (block.isValid() && block.blockNumber() <= endBlock) {
-      block.setVisible(true);
-      block.setLineCount(1);
-      block = block.next();
-    }
+    setBlocksVisible(blockNumber + 1, endBlock, true);
 
     return true;
   }
@@ -255,24 +307,12 @@ void CodeFoldingManager::toggleFoldAtLine(int line) {
     m_foldedBlocks.remove(line);
 
     int endBlock = findFoldEndBlock(line);
-    QTextBlock block = m_document->findBlockByNumber(line + 1);
-
-    while (block.isValid() && block.blockNumber() <= endBlock) {
-      block.setVisible(true);
-      block.setLineCount(1);
-      block = block.next();
-    }
+    setBlocksVisible(line + 1, endBlock, true);
   } else if (isFoldable(line)) {
     m_foldedBlocks.insert(line);
 
     int endBlock = findFoldEndBlock(line);
-    QTextBlock block = m_document->findBlockByNumber(line + 1);
-
-    while (block.isValid() && block.blockNumber() <= endBlock) {
-      block.setVisible(false);
-      block.setLineCount(0);
-      block = block.next();
-    }
+    setBlocksVisible(line + 1, endBlock, false);
   }
 }
 
@@ -280,25 +320,7 @@ void CodeFoldingManager::foldAll() {
   if (!m_document)
     return;
 
-  QTextBlock block = m_document->begin();
-  while (block.isValid()) {
-    if (isFoldable(block.blockNumber())) {
-      int blockNum = block.blockNumber();
-      if (!m_foldedBlocks.contains(blockNum)) {
-        m_foldedBlocks.insert(blockNum);
-
-        int endBlock = findFoldEndBlock(blockNum);
-        QTextBlock innerBlock = block.next();
-
-        while (innerBlock.isValid() && innerBlock.blockNumber() <= endBlock) {
-          innerBlock.setVisible(false);
-          innerBlock.setLineCount(0);
-          innerBlock = innerBlock.next();
-        }
-      }
-    }
-    block = block.next();
-  }
+  hideFoldRanges(collectFoldEnds(collectFacts(), false));
 }
 
 void CodeFoldingManager::unfoldAll() {
@@ -307,11 +329,10 @@ void CodeFoldingManager::unfoldAll() {
 
   m_foldedBlocks.clear();
 
-  QTextBlock block = m_document->begin();
-  while (block.isValid()) {
-    block.setVisible(true);
-    block.setLineCount(1);
-    block = block.next();
+  int number = 0;
+  for (QTextBlock block = m_document->begin(); block.isValid();
+       block = block.next(), ++number) {
+    setBlockVisible(block, number, true);
   }
 }
 
@@ -321,77 +342,28 @@ void CodeFoldingManager::foldToLevel(int level) {
 
   unfoldAll();
 
+  const QVector<const BlockMetadata *> facts = collectFacts();
+  QVector<int> ends = collectFoldEnds(facts, false);
   QTextBlock block = m_document->begin();
-  while (block.isValid()) {
-    int blockNum = block.blockNumber();
-    if (isFoldable(blockNum)) {
-      int blockLevel = getFoldingLevel(blockNum);
-
-      if (blockLevel >= level) {
-        m_foldedBlocks.insert(blockNum);
-
-        int endBlock = findFoldEndBlock(blockNum);
-        QTextBlock innerBlock = block.next();
-
-        while (innerBlock.isValid() && innerBlock.blockNumber() <= endBlock) {
-          innerBlock.setVisible(false);
-          innerBlock.setLineCount(0);
-          innerBlock = innerBlock.next();
-        }
-      }
-    }
-    block = block.next();
+  for (int i = 0; block.isValid() && i < ends.size();
+       ++i, block = block.next()) {
+    if (ends[i] < 0)
+      continue;
+    int indentLevel = facts[i]->indentWidth / BLOCK_METADATA_TAB_WIDTH;
+    if (qMax(indentLevel, m_metadata->braceLevel(block)) < level)
+      ends[i] = -1;
   }
+  hideFoldRanges(ends);
 }
 
 bool CodeFoldingManager::isRegionStart(int blockNumber) const {
-  if (!m_document)
-    return false;
-
-  QTextBlock block = m_document->findBlockByNumber(blockNumber);
-  if (!block.isValid())
-    return false;
-
-  QString text = block.text().trimmed();
-
-  static const QStringList regionPatterns = {
-      "#region",    "// region", "//region",      "//#region",
-      "// #region", "/* region", "/*region",      "/* #region",
-      "/*#region",  "# region",  "#pragma region"};
-
-  QString lowerText = text.toLower();
-  for (const QString &pattern : regionPatterns) {
-    if (lowerText.startsWith(pattern.toLower())) {
-      return true;
-    }
-  }
-
-  return false;
+  const BlockMetadata *facts = factsFor(blockNumber);
+  return facts && facts->regionStart;
 }
 
 bool CodeFoldingManager::isRegionEnd(int blockNumber) const {
-  if (!m_document)
-    return false;
-
-  QTextBlock block = m_document->findBlockByNumber(blockNumber);
-  if (!block.isValid())
-    return false;
-
-  QString text = block.text().trimmed();
-
-  static const QStringList endregionPatterns = {
-      "#endregion",    "// endregion", "//endregion",      "//#endregion",
-      "// #endregion", "/* endregion", "/*endregion",      "/* #endregion",
-      "/*#endregion",  "# endregion",  "#pragma endregion"};
-
-  QString lowerText = text.toLower();
-  for (const QString &pattern : endregionPatterns) {
-    if (lowerText.startsWith(pattern.toLower())) {
-      return true;
-    }
-  }
-
-  return false;
+  const BlockMetadata *facts = factsFor(blockNumber);
+  return facts && facts->regionEnd;
 }
 
 int CodeFoldingManager::findRegionEndBlock(int startBlock) const {
@@ -402,14 +374,14 @@ int CodeFoldingManager::findRegionEndBlock(int startBlock) const {
   QTextBlock block = m_document->findBlockByNumber(startBlock + 1);
 
   while (block.isValid()) {
-    int blockNum = block.blockNumber();
+    const BlockMetadata *facts = m_metadata->facts(block);
 
-    if (isRegionStart(blockNum)) {
+    if (facts->regionStart) {
       depth++;
-    } else if (isRegionEnd(blockNum)) {
+    } else if (facts->regionEnd) {
       depth--;
       if (depth == 0) {
-        return blockNum;
+        return block.blockNumber();
       }
     }
 
@@ -420,38 +392,26 @@ int CodeFoldingManager::findRegionEndBlock(int startBlock) const {
 }
 
 bool CodeFoldingManager::isCommentBlockStart(int blockNumber) const {
-  if (!m_document)
-    return false;
-
-  QTextBlock block = m_document->findBlockByNumber(blockNumber);
-  if (!block.isValid())
+  const BlockMetadata *facts = factsFor(blockNumber);
+  if (!facts)
     return false;
 
-  QString text = block.text().trimmed();
-
-  if (text.startsWith("/*") && !text.contains("*/")) {
+  if (facts->blockCommentStart) {
     return true;
   }
 
-  if (isSingleLineComment(text)) {
-    QTextBlock prevBlock = block.previous();
-    if (prevBlock.isValid()) {
-      QString prevText = prevBlock.text().trimmed();
-      if (isSingleLineComment(prevText)) {
-        return false;
-      }
+  if (facts->lineComment) {
+    const BlockMetadata *prev = factsFor(blockNumber - 1);
+    if (prev && prev->lineComment) {
+      return false;
     }
 
     int consecutiveComments = 1;
-    QTextBlock nextBlock = block.next();
-    while (nextBlock.isValid() && consecutiveComments < 3) {
-      QString nextText = nextBlock.text().trimmed();
-      if (isSingleLineComment(nextText)) {
-        consecutiveComments++;
-        nextBlock = nextBlock.next();
-      } else {
+    while (consecutiveComments < 3) {
+      const BlockMetadata *next = factsFor(blockNumber + consecutiveComments);
+      if (!next || !next->lineComment)
         break;
-      }
+      consecutiveComments++;
     }
 
     return consecutiveComments >= 3;
@@ -468,15 +428,11 @@ int CodeFoldingManager::findCommentBlockEnd(int startBlock) const {
   if (!block.isValid())
     return startBlock;
 
-  QString text = block.text().trimmed();
-
-  if (text.startsWith("/*")) {
-    QTextBlock searchBlock = block;
-    while (searchBlock.isValid()) {
-      if (searchBlock.text().contains("*/")) {
-        return searchBlock.blockNumber();
+  if (m_metadata->facts(block)->blockCommentStart) {
+    for (QTextBlock search = block; search.isValid(); search = search.next()) {
+      if (m_metadata->facts(search)->blockCommentEnd) {
+        return search.blockNumber();
       }
-      searchBlock = searchBlock.next();
     }
     return m_document->blockCount() - 1;
   }
@@ -484,15 +440,9 @@ int CodeFoldingManager::findCommentBlockEnd(int startBlock) const {
   int lastCommentBlock = startBlock;
   QTextBlock nextBlock = block.next();
 
-  while (nextBlock.isValid()) {
-    QString nextText = nextBlock.text().trimmed();
-
-    if (isSingleLineComment(nextText)) {
-      lastCommentBlock = nextBlock.blockNumber();
-      nextBlock = nextBlock.next();
-    } else {
-      break;
-    }
+  while (nextBlock.isValid() && m_metadata->facts(nextBlock)->lineComment) {
+    lastCommentBlock = nextBlock.blockNumber();
+    nextBlock = nextBlock.next();
   }
 
   return lastCommentBlock;
@@ -502,23 +452,7 @@ void CodeFoldingManager::foldComments() {
   if (!m_document)
     return;
 
-  QTextBlock block = m_document->begin();
-  while (block.isValid()) {
-    int blockNum = block.blockNumber();
-    if (isCommentBlockStart(blockNum) && !m_foldedBlocks.contains(blockNum)) {
-      m_foldedBlocks.insert(blockNum);
-
-      int endBlock = findCommentBlockEnd(blockNum);
-      QTextBlock innerBlock = block.next();
-
-      while (innerBlock.isValid() && innerBlock.blockNumber() <= endBlock) {
-        innerBlock.setVisible(false);
-        innerBlock.setLineCount(0);
-        innerBlock = innerBlock.next();
-      }
-    }
-    block = block.next();
-  }
+  hideFoldRanges(collectFoldEnds(collectFacts(), true));
 }
 
 void CodeFoldingManager::unfoldComments() {
@@ -536,13 +470,7 @@ void CodeFoldingManager::unfoldComments() {
     m_foldedBlocks.remove(blockNum);
 
     int endBlock = findCommentBlockEnd(blockNum);
-    QTextBlock block = m_document->findBlockByNumber(blockNum + 1);
-
-    while (block.isValid() && block.blockNumber() <= endBlock) {
-      block.setVisible(true);
-      block.setLineCount(1);
-      block = block.next();
-    }
+    setBlocksVisible(blockNum + 1, endBlock, true);
   }
 }
 
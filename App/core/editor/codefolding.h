@@ -5,7 +5,10 @@
 #include <QJsonObject>
 #include <QSet>
 #include <QString>
+#include <QVector>
 
+class BlockMetadata;
+class BlockMetadataCache;
 class QTextDocument;
 class QTextBlock;
 
@@ -46,15 +49,26 @@ public:
   bool isCommentBlockStart(int blockNumber) const;
   int findCommentBlockEnd(int startBlock) const;
 
+  bool takeChangedRange(int *firstBlock, int *lastBlock);
+
   QJsonObject saveFoldState() const;
 
   void restoreFoldState(const QJsonObject &state);
 
 private:
-  static bool isSingleLineComment(const QString &trimmedText);
+  const BlockMetadata *factsFor(int blockNumber) const;
+  QVector<const BlockMetadata *> collectFacts() const;
+  QVector<int> collectFoldEnds(const QVector<const BlockMetadata *> &facts,
+                               bool commentsOnly) const;
+  void hideFoldRanges(const QVector<int> &ends);
+  void setBlockVisible(QTextBlock &block, int blockNumber, bool visible);
+  void setBlocksVisible(int firstBlock, int lastBlock, bool visible);
 
   QTextDocument *m_document;
+  BlockMetadataCache *m_metadata;
   QSet<int> m_foldedBlocks;
+  int m_changedFirst = -1;
+  int m_changedLast = -1;
 };
 
 #endif
@@ -0,0 +1,374 @@
+#include "decorationstore.h"
+#include <QTextBlock>
+#include <QTextDocument>
+#include <algorithm>
+#include <limits>
+
+DecorationStore::DecorationStore(QTextDocument *document)
+    : QObject(document), m_document(document) {
+  connect(m_document, &QTextDocument::contentsChange, this,
+          &DecorationStore::onContentsChange);
+}
+
+DecorationStore *DecorationStore::forDocument(QTextDocument *document) {
+  if (!document) {
+    return nullptr;
+  }
+  auto *store = document->findChild<DecorationStore *>(
+      QString(), Qt::FindDirectChildrenOnly);
+  return store ? store : new DecorationStore(document);
+}
+
+void DecorationStore::setDiagnostics(const QList<LspDiagnostic> &diagnostics) {
+  Layer &layer = m_layers[static_cast<int>(DecorationKind::Diagnostic)];
+  layer.entries.clear();
+  m_diagnostics.clear();
+  m_diagnostics.reserve(diagnostics.size());
+  layer.entries.reserve(diagnostics.size());
+
+  for (const LspDiagnostic &diag : diagnostics) {
+    const int start = positionFor(diag.range.start);
+    if (start < 0) {
+      continue;
+    }
+    int end = positionFor(diag.range.end);
+    if (end < 0) {
+      const QTextBlock startBlock = m_document->findBlock(start);
+      end = startBlock.position() + startBlock.length() - 1;
+    }
+    layer.entries.append(
+        {start, qMax(start, end), static_cast<int>(m_diagnostics.size())});
+    m_diagnostics.append(diag);
+  }
+  sortAndIndex(layer);
+}
+
+void DecorationStore::setLineTexts(DecorationKind kind,
+                                   const QMap<int, QString> &texts) {
+  Layer &layer = m_layers[static_cast<int>(kind)];
+  layer.entries.clear();
+  layer.texts.clear();
+  layer.entries.reserve(texts.size());
+  layer.texts.reserve(texts.size());
+
+  for (auto it = texts.cbegin(); it != texts.cend(); ++it) {
+    const QTextBlock block = m_document->findBlockByNumber(it.key());
+    if (!block.isValid()) {
+      continue;
+    }
+    layer.entries.append({block.position(), block.position(),
+                          static_cast<int>(layer.texts.size())});
+    layer.texts.append(it.value());
+  }
+  sortAndIndex(layer);
+}
+
+void DecorationStore::clear(DecorationKind kind) {
+  Layer &layer = m_layers[static_cast<int>(kind)];
+  layer.entries.clear();
+  layer.minStart.clear();
+  layer.maxEnd.clear();
+  layer.pending.clear();
+  layer.texts.clear();
+  layer.removed = 0;
+  if (kind == DecorationKind::Diagnostic) {
+    m_diagnostics.clear();
+  }
+}
+
+int DecorationStore::count(DecorationKind kind) const {
+  const Layer &layer = m_layers[static_cast<int>(kind)];
+  return layer.entries.size() - layer.removed;
+}
+
+QVector<Decoration> DecorationStore::overlapping(DecorationKind kind, int from,
+                                                 int to) const {
+  const Layer &layer = m_layers[static_cast<int>(kind)];
+  QVector<Decoration> result;
+  const int limit = lowerBound(layer, to + 1);
+  if (limit > 0) {
+    collectOverlapping(layer, 1, 0, layer.entries.size() - 1, 0, limit, from,
+                       result);
+  }
+  return result;
+}
+
+QVector<Decoration> DecorationStore::startingIn(DecorationKind kind, int from,
+                                                int to) const {
+  const Layer &layer = m_layers[static_cast<int>(kind)];
+  QVector<Decoration> result;
+  if (!layer.entries.isEmpty()) {
+    collectStarting(layer, 1, 0, layer.entries.size() - 1, 0,
+                    lowerBound(layer, from), to, result);
+  }
+  return result;
+}
+
+LspDiagnostic DecorationStore::diagnostic(const Decoration &decoration) const {
+  LspDiagnostic diag = m_diagnostics.value(decoration.payload);
+  diag.range.start = lspPositionFor(decoration.start);
+  diag.range.end = lspPositionFor(decoration.end);
+  return diag;
+}
+
+LspDiagnosticSeverity
+DecorationStore::severity(const Decoration &decoration) const {
+  return m_diagnostics.value(decoration.payload).severity;
+}
+
+QString DecorationStore::text(DecorationKind kind,
+                              const Decoration &decoration) const {
+  return m_layers[static_cast<int>(kind)].texts.value(decoration.payload);
+}
+
+QList<LspDiagnostic> DecorationStore::diagnostics() const {
+  QList<LspDiagnostic> result;
+  const QVector<Decoration> decorations =
+      startingIn(DecorationKind::Diagnostic, std::numeric_limits<int>::min(),
+                 std::numeric_limits<int>::max());
+  result.reserve(decorations.size());
+  for (const Decoration &decoration : decorations) {
+    result.append(diagnostic(decoration));
+  }
+  return result;
+}
+
+QList<LspDiagnostic> DecorationStore::diagnosticsOnLine(int line) const {
+  QList<LspDiagnostic> result;
+  const QTextBlock block = m_document->findBlockByNumber(line);
+  if (!block.isValid()) {
+    return result;
+  }
+  const QVector<Decoration> decorations =
+      startingIn(DecorationKind::Diagnostic, block.position(),
+                 block.position() + block.length() - 1);
+  for (const Decoration &decoration : decorations) {
+    result.append(diagnostic(decoration));
+  }
+  return result;
+}
+
+void DecorationStore::onContentsChange(int position, int charsRemoved,
+                                       int charsAdded) {
+  if (charsRemoved == charsAdded) {
+    return;
+  }
+
+  const int delta = charsAdded - charsRemoved;
+  const int removedEnd = position + charsRemoved;
+  const int affected = charsRemoved == 0 ? position : position + 1;
+
+  for (int kind = 0; kind < DECORATION_KIND_COUNT; ++kind) {
+    Layer &layer = m_layers[kind];
+    if (layer.entries.isEmpty() || layer.maxEnd.value(1) < position) {
+      continue;
+    }
+
+    const bool lineAnchored =
+        kind != static_cast<int>(DecorationKind::Diagnostic);
+    const int last = layer.entries.size() - 1;
+    const int shifted = lowerBound(layer, removedEnd);
+    remap(layer, 1, 0, last, shifted, affected, position, removedEnd, delta,
+          lineAnchored);
+    if (shifted <= last) {
+      shiftFrom(layer, 1, 0, last, shifted, delta);
+    }
+    if (2 * layer.removed > layer.entries.size()) {
+      compact(layer);
+    }
+  }
+}
+
+int DecorationStore::positionFor(const LspPosition &position) const {
+  const QTextBlock block = m_document->findBlockByNumber(position.line);
+  if (!block.isValid()) {
+    return -1;
+  }
+  return block.position() +
+         qBound(0, position.character, qMax(0, block.length() - 1));
+}
+
+LspPosition DecorationStore::lspPositionFor(int position) const {
+  const QTextBlock block = m_document->findBlock(position);
+  if (!block.isValid()) {
+    return {0, 0};
+  }
+  return {block.blockNumber(), position - block.position()};
+}
+
+void DecorationStore::sortAndIndex(Layer &layer) {
+  std::stable_sort(layer.entries.begin(), layer.entries.end(),
+                   [](const Decoration &a, const Decoration &b) {
+                     return a.start < b.start;
+                   });
+  layer.removed = 0;
+  layer.minStart.fill(0, 4 * layer.entries.size());
+  layer.maxEnd.fill(-1, 4 * layer.entries.size());
+  layer.pending.fill(0, 4 * layer.entries.size());
+  if (!layer.entries.isEmpty()) {
+    buildTree(layer, 1, 0, layer.entries.size() - 1);
+  }
+}
+
+void DecorationStore::compact(Layer &layer) {
+  QVector<Decoration> live;
+  live.reserve(layer.entries.size() - layer.removed);
+  collectStarting(layer, 1, 0, layer.entries.size() - 1, 0, 0,
+                  std::numeric_limits<int>::max(), live);
+  layer.entries = live;
+  sortAndIndex(layer);
+}
+
+void DecorationStore::buildTree(Layer &layer, int node, int lo, int hi) {
+  layer.pending[node] = 0;
+  if (lo == hi) {
+    const Decoration &decoration = layer.entries[lo];
+    layer.minStart[node] = decoration.start;
+    layer.maxEnd[node] = decoration.end;
+    return;
+  }
+  const int mid = (lo + hi) / 2;
+  buildTree(layer, node * 2, lo, mid);
+  buildTree(layer, node * 2 + 1, mid + 1, hi);
+  pullUp(layer, node);
+}
+
+void DecorationStore::pullUp(Layer &layer, int node) {
+  layer.minStart[node] = layer.minStart[node * 2];
+  layer.maxEnd[node] =
+      qMax(layer.maxEnd[node * 2], layer.maxEnd[node * 2 + 1]);
+}
+
+void DecorationStore::shift(Layer &layer, int node, int lo, int hi,
+                            int delta) {
+  layer.minStart[node] += delta;
+  layer.maxEnd[node] += delta;
+  if (lo == hi) {
+    layer.entries[lo].start += delta;
+    layer.entries[lo].end += delta;
+  } else {
+    layer.pending[node] += delta;
+  }
+}
+
+void DecorationStore::pushDown(Layer &layer, int node, int lo, int hi) {
+  const int delta = layer.pending[node];
+  if (delta == 0) {
+    return;
+  }
+  const int mid = (lo + hi) / 2;
+  shift(layer, node * 2, lo, mid, delta);
+  shift(layer, node * 2 + 1, mid + 1, hi, delta);
+  layer.pending[node] = 0;
+}
+
+void DecorationStore::shiftFrom(Layer &layer, int node, int lo, int hi,
+                                int first, int delta) {
+  if (hi < first) {
+    return;
+  }
+  if (lo >= first) {
+    shift(layer, node, lo, hi, delta);
+    return;
+  }
+  pushDown(layer, node, lo, hi);
+  const int mid = (lo + hi) / 2;
+  shiftFrom(layer, node * 2, lo, mid, first, delta);
+  shiftFrom(layer, node * 2 + 1, mid + 1, hi, first, delta);
+  pullUp(layer, node);
+}
+
+void DecorationStore::remap(Layer &layer, int node, int lo, int hi, int limit,
+                            int affected, int position, int removedEnd,
+                            int delta, bool lineAnchored) {
+  if (lo >= limit || layer.maxEnd[node] < affected) {
+    return;
+  }
+  if (lo == hi) {
+    Decoration &decoration = layer.entries[lo];
+    if (lineAnchored && decoration.payload >= 0 &&
+        decoration.start > position) {
+      decoration.payload = -1;
+      ++layer.removed;
+    }
+    decoration.start = qMin(decoration.start, position);
+    if (decoration.end >= removedEnd) {
+      decoration.end += delta;
+    } else if (decoration.end > position) {
+      decoration.end = position;
+    }
+    layer.minStart[node] = decoration.start;
+    layer.maxEnd[node] = decoration.end;
+    return;
+  }
+  pushDown(layer, node, lo, hi);
+  const int mid = (lo + hi) / 2;
+  remap(layer, node * 2, lo, mid, limit, affected, position, removedEnd, delta,
+        lineAnchored);
+  remap(layer, node * 2 + 1, mid + 1, hi, limit, affected, position,
+        removedEnd, delta, lineAnchored);
+  pullUp(layer, node);
+}
+
+void DecorationStore::collectOverlapping(const Layer &layer, int node, int lo,
+                                         int hi, int offset, int limit,
+                                         int from, QVector<Decoration> &out) {
+  if (lo >= limit || layer.maxEnd[node] + offset < from) {
+    return;
+  }
+  if (lo == hi) {
+    const Decoration &decoration = layer.entries[lo];
+    if (decoration.payload >= 0) {
+      out.append({decoration.start + offset, decoration.end + offset,
+                  decoration.payload});
+    }
+    return;
+  }
+  const int mid = (lo + hi) / 2;
+  offset += layer.pending[node];
+  collectOverlapping(layer, node * 2, lo, mid, offset, limit, from, out);
+  collectOverlapping(layer, node * 2 + 1, mid + 1, hi, offset, limit, from,
+                     out);
+}
+
+void DecorationStore::collectStarting(const Layer &layer, int node, int lo,
+                                      int hi, int offset, int first, int to,
+                                      QVector<Decoration> &out) {
+  if (hi < first || layer.minStart[node] + offset > to) {
+    return;
+  }
+  if (lo == hi) {
+    const Decoration &decoration = layer.entries[lo];
+    if (decoration.payload >= 0) {
+      out.append({decoration.start + offset, decoration.end + offset,
+                  decoration.payload});
+    }
+    return;
+  }
+  const int mid = (lo + hi) / 2;
+  offset += layer.pending[node];
+  collectStarting(layer, node * 2, lo, mid, offset, first, to, out);
+  collectStarting(layer, node * 2 + 1, mid + 1, hi, offset, first, to, out);
+}
+
+int DecorationStore::lowerBound(const Layer &layer, int position) {
+  if (layer.entries.isEmpty()) {
+    return 0;
+  }
+  int node = 1;
+  int lo = 0;
+  int hi = layer.entries.size() - 1;
+  int offset = 0;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    offset += layer.pending[node];
+    if (layer.minStart[node * 2 + 1] + offset < position) {
+      node = node * 2 + 1;
+      lo = mid + 1;
+    } else {
+      node = node * 2;
+      hi = mid;
+    }
+  }
+  return layer.minStart[node] + offset < position ? lo + 1 : lo;
+}
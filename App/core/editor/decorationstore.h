@@ -0,0 +1,93 @@
+#ifndef DECORATIONSTORE_H
+#define DECORATIONSTORE_H
+
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "../../lsp/lspclient.h"
+
+class QTextDocument;
+
+enum class DecorationKind { Diagnostic, CodeLens, InlineBlame };
+
+constexpr int DECORATION_KIND_COUNT = 3;
+
+struct Decoration {
+  int start;
+  int end;
+  int payload;
+};
+
+class DecorationStore : public QObject {
+  Q_OBJECT
+
+public:
+  explicit DecorationStore(QTextDocument *document);
+
+  static DecorationStore *forDocument(QTextDocument *document);
+
+  void setDiagnostics(const QList<LspDiagnostic> &diagnostics);
+
+  void setLineTexts(DecorationKind kind, const QMap<int, QString> &texts);
+
+  void clear(DecorationKind kind);
+
+  int count(DecorationKind kind) const;
+
+  bool isEmpty(DecorationKind kind) const { return count(kind) == 0; }
+
+  QVector<Decoration> overlapping(DecorationKind kind, int from, int to) const;
+
+  QVector<Decoration> startingIn(DecorationKind kind, int from, int to) const;
+
+  LspDiagnostic diagnostic(const Decoration &decoration) const;
+
+  LspDiagnosticSeverity severity(const Decoration &decoration) const;
+
+  QString text(DecorationKind kind, const Decoration &decoration) const;
+
+  QList<LspDiagnostic> diagnostics() const;
+
+  QList<LspDiagnostic> diagnosticsOnLine(int line) const;
+
+private:
+  struct Layer {
+    QVector<Decoration> entries;
+    QVector<int> minStart;
+    QVector<int> maxEnd;
+    QVector<int> pending;
+    QVector<QString> texts;
+    int removed = 0;
+  };
+
+  void onContentsChange(int position, int charsRemoved, int charsAdded);
+  int positionFor(const LspPosition &position) const;
+  LspPosition lspPositionFor(int position) const;
+  static void sortAndIndex(Layer &layer);
+  static void compact(Layer &layer);
+  static void buildTree(Layer &layer, int node, int lo, int hi);
+  static void pullUp(Layer &layer, int node);
+  static void shift(Layer &layer, int node, int lo, int hi, int delta);
+  static void pushDown(Layer &layer, int node, int lo, int hi);
+  static void shiftFrom(Layer &layer, int node, int lo, int hi, int first,
+                        int delta);
+  static void remap(Layer &layer, int node, int lo, int hi, int limit,
+                    int affected, int position, int removedEnd, int delta,
+                    bool lineAnchored);
+  static void collectOverlapping(const Layer &layer, int node, int lo, int hi,
+                                 int offset, int limit, int from,
+                                 QVector<Decoration> &out);
+  static void collectStarting(const Layer &layer, int node, int lo, int hi,
+                              int offset, int first, int to,
+                              QVector<Decoration> &out);
+  static int lowerBound(const Layer &layer, int position);
+
+  QTextDocument *m_document;
+  Layer m_layers[DECORATION_KIND_COUNT];
+  QVector<LspDiagnostic> m_diagnostics;
+};
+
+#endif
@@ -13,9 +13,12 @@
 
 #include "../../core/lightpadpage.h"
 #include "../../core/lightpadtabwidget.h"
+#include "../../core/profiling/paintprofiler.h"
 #include "../../dap/breakpointmanager.h"
+#include "../../git/gitdifftracker.h"
 #include "../../ui/mainwindow.h"
 #include "codefolding.h"
+#include "decorationstore.h"
 
 namespace {
 Theme currentThemeFor(const TextArea *editor) {
@@ -140,17 +143,6 @@ void LineNumberArea::setFoldingEnabled(bool enabled) {
   update();
 }
 
-void LineNumberArea::setDiagnosticLines(
-    const QMap<int, LspDiagnosticSeverity> &diagnosticLines) {
-  m_diagnosticLines = diagnosticLines;
-  update();
-}
-
-void LineNumberArea::clearDiagnosticLines() {
-  m_diagnosticLines.clear();
-  update();
-}
-
 void LineNumberArea::setRichBlameData(
     const QMap<int, GitBlameLineInfo> &blameData) {
   m_richBlameData = blameData;
@@ -364,8 +356,12 @@ bool LineNumberArea::event(QEvent *event) {
             if (diffLine.first == lineNum) {
               QString filePath = resolveFilePath();
               if (!filePath.isEmpty()) {
+                GitDiffTracker *tracker = m_editor->gitDiffTracker();
                 GitDiffHunk hunk =
-                    m_gitIntegration->getDiffHunkAtLine(filePath, lineNum);
+                    tracker && tracker->hasBase()
+                        ? tracker->hunkAtLine(lineNum)
+                        : m_gitIntegration->getDiffHunkAtLine(filePath,
+                                                              lineNum);
                 QString tooltip = buildDiffHunkTooltip(hunk);
                 if (!tooltip.isEmpty()) {
                   QToolTip::showText(helpEvent->globalPos(), tooltip, this);
@@ -378,37 +374,35 @@ bool LineNumberArea::event(QEvent *event) {
         }
 
         if (hoverX >= DIFF_INDICATOR_WIDTH &&
-            hoverX < DIFF_INDICATOR_WIDTH + BREAKPOINT_AREA_WIDTH &&
-            m_diagnosticLines.contains(lineNum)) {
+            hoverX < DIFF_INDICATOR_WIDTH + BREAKPOINT_AREA_WIDTH) {
           QStringList messages;
-          if (m_editor) {
-            for (const LspDiagnostic &diag : m_editor->diagnostics()) {
-              if (diag.range.start.line + 1 == lineNum) {
-                QString prefix;
-                switch (diag.severity) {
-                case LspDiagnosticSeverity::Error:
-                  prefix = "⛔ ";
-                  break;
-                case LspDiagnosticSeverity::Warning:
-                  prefix = "⚠️ ";
-                  break;
-                case LspDiagnosticSeverity::Information:
-                  prefix = "ℹ️ ";
-                  break;
-                case LspDiagnosticSeverity::Hint:
-                  prefix = "💡 ";
-                  break;
-                }
-                QString msg = prefix + diag.message;
-                if (!diag.source.isEmpty()) {
-                  msg += QString(" [%1]").arg(diag.source);
-                }
-                if (!diag.code.isEmpty()) {
-                  msg += QString(" (%1)").arg(diag.code);
-                }
-                messages.append(msg);
-              }
+          const QList<LspDiagnostic> lineDiagnostics =
+              DecorationStore::forDocument(m_editor->document())
+                  ->diagnosticsOnLine(lineNum - 1);
+          for (const LspDiagnostic &diag : lineDiagnostics) {
+            QString prefix;
+            switch (diag.severity) {
+            case LspDiagnosticSeverity::Error:
+              prefix = "⛔ ";
+              break;
+            case LspDiagnosticSeverity::Warning:
+              prefix = "⚠️ ";
+              break;
+            case LspDiagnosticSeverity::Information:
+              prefix = "ℹ️ ";
+              break;
+            case LspDiagnosticSeverity::Hint:
+              prefix = "💡 ";
+              break;
+            }
+            QString msg = prefix + diag.message;
+            if (!diag.source.isEmpty()) {
+              msg += QString(" [%1]").arg(diag.source);
             }
+            if (!diag.code.isEmpty()) {
+              msg += QString(" (%1)").arg(diag.code);
+            }
+            messages.append(msg);
           }
           if (!messages.isEmpty()) {
             QToolTip::showText(helpEvent->globalPos(), messages.join("\n"),
@@ -557,7 +551,7 @@ void LineNumberArea::mousePressEvent(QMouseEvent *event) {
     int foldX = numberAreaWidth() - FOLD_INDICATOR_WIDTH;
     if (event->pos().x() >= foldX && event->pos().x() < numberAreaWidth()) {
       int blockNumber = clickedLine - 1;
-      CodeFoldingManager *folding = m_editor->m_codeFolding;
+      CodeFoldingManager *folding = m_editor->m_codeFolding.get();
       if (folding->isFoldable(blockNumber) || folding->isFolded(blockNumber)) {
         m_editor->toggleFoldAtLine(blockNumber);
         event->accept();
@@ -586,6 +580,8 @@ void LineNumberArea::paintEvent(QPaintEvent *event) {
     return;
   }
 
+  PAINT_PROFILE_SCOPE("LineNumberArea::paintEvent");
+
   QPainter painter(this);
   painter.setFont(m_font);
   painter.fillRect(event->rect(), m_backgroundColor);
@@ -627,6 +623,9 @@ void LineNumberArea::paintEvent(QPaintEvent *event) {
     }
   }
 
+  const DecorationStore *decorations =
+      DecorationStore::forDocument(m_editor->document());
+
   while (block.isValid() && top <= event->rect().bottom()) {
     if (block.isVisible() && bottom >= event->rect().top()) {
       QString number = QString::number(blockNumber + 1);
@@ -677,9 +676,17 @@ void LineNumberArea::paintEvent(QPaintEvent *event) {
         painter.restore();
       }
 
-      if (m_diagnosticLines.contains(lineNum) &&
-          !breakpointLines.contains(lineNum)) {
-        LspDiagnosticSeverity severity = m_diagnosticLines[lineNum];
+      const QVector<Decoration> blockDiagnostics =
+          breakpointLines.contains(lineNum)
+              ? QVector<Decoration>()
+              : decorations->startingIn(DecorationKind::Diagnostic,
+                                        block.position(),
+                                        block.position() + block.length() - 1);
+      if (!blockDiagnostics.isEmpty()) {
+        LspDiagnosticSeverity severity = LspDiagnosticSeverity::Hint;
+        for (const Decoration &diagnostic : blockDiagnostics) {
+          severity = qMin(severity, decorations->severity(diagnostic));
+        }
         const QColor markerColor =
             diagnosticColorFor(currentThemeFor(m_editor), severity);
 
@@ -710,7 +717,7 @@ void LineNumberArea::paintEvent(QPaintEvent *event) {
       }
 
       if (m_foldingEnabled && m_editor->m_codeFolding) {
-        CodeFoldingManager *folding = m_editor->m_codeFolding;
+        CodeFoldingManager *folding = m_editor->m_codeFolding.get();
         bool foldable = folding->isFoldable(blockNumber);
         bool folded = folding->isFolded(blockNumber);
 
@@ -49,10 +49,6 @@ public:
 
   void setFoldingEnabled(bool enabled);
 
-  void
-  setDiagnosticLines(const QMap<int, LspDiagnosticSeverity> &diagnosticLines);
-  void clearDiagnosticLines();
-
 protected:
   void paintEvent(QPaintEvent *event) override;
   bool event(QEvent *event) override;
@@ -84,8 +80,6 @@ private:
   int m_blameTextWidth;
   bool m_foldingEnabled;
 
-  QMap<int, LspDiagnosticSeverity> m_diagnosticLines;
-
   static constexpr int DIFF_INDICATOR_WIDTH = 3;
   static constexpr int BREAKPOINT_AREA_WIDTH = 16;
   static constexpr int FOLD_INDICATOR_WIDTH = 14;
@@ -107,14 +107,17 @@ void MultiCursorHandler::addCursorsToAllOccurrences() {
   m_extraCursors.clear();
 
   QTextDocument *doc = m_editor->document();
-  QTextCursor searchCursor(doc);
+  const QString text = doc->toPlainText();
+  QString needle = word;
+  needle.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+
   QTextCursor firstCursor;
   bool first = true;
-
-  while (true) {
-    QTextCursor found = doc->find(word, searchCursor);
-    if (found.isNull())
-      break;
+  for (int pos = text.indexOf(needle, 0, Qt::CaseInsensitive); pos >= 0;
+       pos = text.indexOf(needle, pos + needle.length(), Qt::CaseInsensitive)) {
+    QTextCursor found(doc);
+    found.setPosition(pos);
+    found.setPosition(pos + needle.length(), QTextCursor::KeepAnchor);
 
     if (first) {
       firstCursor = found;
@@ -122,9 +125,6 @@ void MultiCursorHandler::addCursorsToAllOccurrences() {
     } else {
       m_extraCursors.append(found);
     }
-
-    searchCursor = found;
-    searchCursor.movePosition(QTextCursor::Right);
   }
 
   if (!first) {
@@ -164,6 +164,119 @@ void MultiCursorHandler::applyToAllCursors(
   mergeOverlappingCursors();
 }
 
+void MultiCursorHandler::applyEditToAllCursors(
+    const std::function<MultiCursorEdit(const QTextCursor &)> &buildEdit) {
+  if (!m_editor)
+    return;
+
+  QTextDocument *doc = m_editor->document();
+  const int maxPosition = qMax(0, doc->characterCount() - 1);
+
+  QList<MultiCursorEdit> edits;
+  edits.reserve(m_extraCursors.size() + 1);
+  edits.append(buildEdit(m_editor->textCursor()));
+  for (const QTextCursor &cursor : std::as_const(m_extraCursors)) {
+    edits.append(buildEdit(cursor));
+  }
+  m_extraCursors.clear();
+
+  for (MultiCursorEdit &edit : edits) {
+    edit.from = qBound(0, edit.from, maxPosition);
+    edit.to = qBound(edit.from, edit.to, maxPosition);
+  }
+  std::stable_sort(edits.begin(), edits.end(),
+                   [](const MultiCursorEdit &a, const MultiCursorEdit &b) {
+                     return a.from < b.from;
+                   });
+
+  int kept = 0;
+  for (int i = 0; i < edits.size(); ++i) {
+    MultiCursorEdit edit = edits[i];
+    if (kept > 0) {
+      const MultiCursorEdit &previous = edits[kept - 1];
+      if (edit.from == previous.from && edit.to == previous.to) {
+        continue;
+      }
+      edit.from = qMax(edit.from, previous.to);
+      edit.to = qMax(edit.to, edit.from);
+    }
+    edits[kept++] = edit;
+  }
+  edits.resize(kept);
+
+  QTextCursor editCursor(doc);
+  editCursor.beginEditBlock();
+  for (int i = edits.size() - 1; i >= 0; --i) {
+    const MultiCursorEdit &edit = edits[i];
+    if (edit.from == edit.to && edit.text.isEmpty())
+      continue;
+    editCursor.setPosition(edit.from);
+    editCursor.setPosition(edit.to, QTextCursor::KeepAnchor);
+    editCursor.insertText(edit.text);
+  }
+  editCursor.endEditBlock();
+
+  QTextCursor mainCursor(doc);
+  int shift = 0;
+  for (int i = 0; i < edits.size(); ++i) {
+    const MultiCursorEdit &edit = edits[i];
+    QTextCursor cursor(doc);
+    cursor.setPosition(edit.from + shift + edit.text.length());
+    shift += edit.text.length() - (edit.to - edit.from);
+    if (i == 0) {
+      mainCursor = cursor;
+    } else {
+      m_extraCursors.append(cursor);
+    }
+  }
+  m_editor->setTextCursor(mainCursor);
+}
+
+void MultiCursorHandler::insertText(const QString &text) {
+  applyEditToAllCursors([&text](const QTextCursor &cursor) {
+    return MultiCursorEdit{cursor.selectionStart(), cursor.selectionEnd(),
+                           text};
+  });
+}
+
+void MultiCursorHandler::deletePreviousChar() {
+  if (!m_editor)
+    return;
+
+  QTextDocument *doc = m_editor->document();
+  applyEditToAllCursors([doc](const QTextCursor &cursor) {
+    if (cursor.hasSelection()) {
+      return MultiCursorEdit{cursor.selectionStart(), cursor.selectionEnd(),
+                             QString()};
+    }
+    int from = cursor.position() - 1;
+    if (from > 0 && doc->characterAt(from).isLowSurrogate() &&
+        doc->characterAt(from - 1).isHighSurrogate()) {
+      --from;
+    }
+    return MultiCursorEdit{qMax(0, from), cursor.position(), QString()};
+  });
+}
+
+void MultiCursorHandler::deleteChar() {
+  if (!m_editor)
+    return;
+
+  QTextDocument *doc = m_editor->document();
+  applyEditToAllCursors([doc](const QTextCursor &cursor) {
+    if (cursor.hasSelection()) {
+      return MultiCursorEdit{cursor.selectionStart(), cursor.selectionEnd(),
+                             QString()};
+    }
+    int to = cursor.position() + 1;
+    if (doc->characterAt(cursor.position()).isHighSurrogate() &&
+        doc->characterAt(to).isLowSurrogate()) {
+      ++to;
+    }
+    return MultiCursorEdit{cursor.position(), to, QString()};
+  });
+}
+
 void MultiCursorHandler::updateExtraSelections(const QColor &highlightColor) {
   if (!m_editor)
     return;
@@ -204,15 +317,9 @@ void MultiCursorHandler::mergeOverlappingCursors() {
             });
 
   QList<QTextCursor> unique;
-  for (const QTextCursor &cursor : allCursors) {
-    bool duplicate = false;
-    for (const QTextCursor &existing : unique) {
-      if (cursor.position() == existing.position()) {
-        duplicate = true;
-        break;
-      }
-    }
-    if (!duplicate) {
+  unique.reserve(allCursors.size());
+  for (const QTextCursor &cursor : std::as_const(allCursors)) {
+    if (unique.isEmpty() || unique.last().position() != cursor.position()) {
       unique.append(cursor);
     }
   }
@@ -9,6 +9,12 @@
 class QPlainTextEdit;
 class QTextDocument;
 
+struct MultiCursorEdit {
+  int from;
+  int to;
+  QString text;
+};
+
 class MultiCursorHandler {
 public:
   explicit MultiCursorHandler(QPlainTextEdit *editor);
@@ -33,6 +39,15 @@ public:
 
   void applyToAllCursors(const std::function<void(QTextCursor &)> &operation);
 
+  void applyEditToAllCursors(
+      const std::function<MultiCursorEdit(const QTextCursor &)> &buildEdit);
+
+  void insertText(const QString &text);
+
+  void deletePreviousChar();
+
+  void deleteChar();
+
   void updateExtraSelections(const QColor &highlightColor);
 
   QString lastSelectedWord() const { return m_lastSelectedWord; }
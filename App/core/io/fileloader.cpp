@@ -0,0 +1,255 @@
+#include "fileloader.h"
+#include "../logging/logger.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QStringDecoder>
+#include <QThread>
+#include <QWaitCondition>
+
+class FileLoaderWorker : public QThread {
+public:
+  FileLoaderWorker(const QString &filePath, qint64 chunkBytes,
+                   FileLoader *receiver)
+      : m_filePath(filePath), m_chunkBytes(chunkBytes), m_receiver(receiver),
+        m_chunksInFlight(0) {}
+
+  ~FileLoaderWorker() override { stopLoading(); }
+
+  void stopLoading() {
+    requestInterruption();
+    {
+      QMutexLocker locker(&m_mutex);
+      m_acknowledged.wakeAll();
+    }
+    wait();
+  }
+
+  void acknowledgeChunk() {
+    QMutexLocker locker(&m_mutex);
+    m_chunksInFlight = qMax(0, m_chunksInFlight - 1);
+    m_acknowledged.wakeAll();
+  }
+
+protected:
+  void run() override {
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+      fail(QString("Cannot open file for reading: %1").arg(m_filePath));
+      return;
+    }
+
+    const qint64 totalBytes = file.size();
+    QByteArray data =
+        file.read(qMin(m_chunkBytes, FILE_LOADER_FIRST_CHUNK_BYTES));
+    const FileFormat format = FileLoader::detectFormat(data);
+    QStringDecoder decoder(format.encoding);
+    bool pendingCarriageReturn = false;
+    qint64 bytesRead = 0;
+
+    while (!isInterruptionRequested()) {
+      if (file.error() != QFileDevice::NoError) {
+        fail(file.errorString());
+        return;
+      }
+
+      const bool last = data.isEmpty();
+      bytesRead += data.size();
+      const QString text = FileLoader::normalizeLineEndings(
+          decoder.decode(data), &pendingCarriageReturn, last);
+      if (!text.isEmpty()) {
+        {
+          QMutexLocker locker(&m_mutex);
+          ++m_chunksInFlight;
+        }
+        FileLoader *receiver = m_receiver;
+        QMetaObject::invokeMethod(
+            receiver,
+            [receiver, text, bytesRead, totalBytes]() {
+              receiver->onChunkLoaded(text, bytesRead, totalBytes);
+            },
+            Qt::QueuedConnection);
+      }
+      if (last) {
+        if (!waitForAcknowledgement(0)) {
+          return;
+        }
+        FileLoader *receiver = m_receiver;
+        QMetaObject::invokeMethod(
+            receiver, [receiver, format]() { receiver->onFinished(format); },
+            Qt::QueuedConnection);
+        return;
+      }
+      if (!waitForAcknowledgement(FILE_LOADER_MAX_CHUNKS_IN_FLIGHT - 1)) {
+        return;
+      }
+      data = file.read(m_chunkBytes);
+    }
+  }
+
+private:
+  bool waitForAcknowledgement(int limit) {
+    QMutexLocker locker(&m_mutex);
+    while (m_chunksInFlight > limit && !isInterruptionRequested()) {
+      m_acknowledged.wait(&m_mutex);
+    }
+    return !isInterruptionRequested();
+  }
+
+  void fail(const QString &errorMessage) {
+    FileLoader *receiver = m_receiver;
+    QMetaObject::invokeMethod(
+        receiver,
+        [receiver, errorMessage]() { receiver->onFailed(errorMessage); },
+        Qt::QueuedConnection);
+  }
+
+  QString m_filePath;
+  qint64 m_chunkBytes;
+  FileLoader *m_receiver;
+  QMutex m_mutex;
+  QWaitCondition m_acknowledged;
+  int m_chunksInFlight;
+};
+
+FileLoader::FileLoader(const QString &filePath, QObject *parent)
+    : QObject(parent), m_filePath(filePath), m_worker(nullptr),
+      m_chunkBytes(FILE_LOADER_CHUNK_BYTES), m_finished(false),
+      m_cancelled(false), m_bytesRead(0), m_totalBytes(0) {}
+
+FileLoader::~FileLoader() { delete m_worker; }
+
+FileFormat FileLoader::detectFormat(const QByteArray &head) {
+  FileFormat format;
+  if (head.startsWith("\xEF\xBB\xBF")) {
+    format.encoding = QStringConverter::Utf8;
+    format.hasBom = true;
+  } else if (head.startsWith("\xFF\xFE")) {
+    format.encoding = QStringConverter::Utf16LE;
+    format.hasBom = true;
+  } else if (head.startsWith("\xFE\xFF")) {
+    format.encoding = QStringConverter::Utf16BE;
+    format.hasBom = true;
+  } else {
+    QStringDecoder probe(QStringConverter::Utf8);
+    probe.decode(head);
+    if (probe.hasError()) {
+      format.encoding = QStringConverter::Latin1;
+    }
+  }
+
+  QStringDecoder decoder(format.encoding);
+  const QString text = decoder.decode(head);
+  for (int i = 0; i < text.size(); ++i) {
+    if (text.at(i) == QLatin1Char('\n')) {
+      break;
+    }
+    if (text.at(i) == QLatin1Char('\r')) {
+      format.lineEnding =
+          i + 1 < text.size() && text.at(i + 1) == QLatin1Char('\n')
+              ? FileLineEnding::CRLF
+              : FileLineEnding::CR;
+      break;
+    }
+  }
+  return format;
+}
+
+QString FileLoader::normalizeLineEndings(const QString &chunk,
+                                         bool *pendingCarriageReturn,
+                                         bool last) {
+  QString text =
+      *pendingCarriageReturn ? QStringLiteral("\r") + chunk : chunk;
+  *pendingCarriageReturn = !last && text.endsWith(QLatin1Char('\r'));
+  if (*pendingCarriageReturn) {
+    text.chop(1);
+  }
+  text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+  return text;
+}
+
+bool FileLoader::readAll(const QString &filePath, QString *text,
+                         FileFormat *format, QString *errorMessage) {
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    if (errorMessage) {
+      *errorMessage = QString("Cannot open file for reading: %1").arg(filePath);
+    }
+    return false;
+  }
+
+  const QByteArray data = file.readAll();
+  if (file.error() != QFileDevice::NoError) {
+    if (errorMessage) {
+      *errorMessage = file.errorString();
+    }
+    return false;
+  }
+
+  const FileFormat detected =
+      detectFormat(data.left(FILE_LOADER_FIRST_CHUNK_BYTES));
+  QStringDecoder decoder(detected.encoding);
+  bool pendingCarriageReturn = false;
+  *text = normalizeLineEndings(decoder.decode(data), &pendingCarriageReturn,
+                               true);
+  if (format) {
+    *format = detected;
+  }
+  return true;
+}
+
+void FileLoader::setChunkSize(qint64 bytes) {
+  m_chunkBytes = qMax<qint64>(1, bytes);
+}
+
+void FileLoader::start() {
+  if (m_worker) {
+    return;
+  }
+  m_worker = new FileLoaderWorker(m_filePath, m_chunkBytes, this);
+  m_worker->start();
+}
+
+void FileLoader::cancel() {
+  m_cancelled = true;
+  if (m_worker) {
+    m_worker->stopLoading();
+  }
+}
+
+void FileLoader::acknowledgeChunk() {
+  if (m_worker) {
+    m_worker->acknowledgeChunk();
+  }
+}
+
+void FileLoader::onChunkLoaded(const QString &text, qint64 bytesRead,
+                               qint64 totalBytes) {
+  if (m_cancelled) {
+    return;
+  }
+  m_bytesRead = bytesRead;
+  m_totalBytes = totalBytes;
+  emit chunkLoaded(text);
+  emit progress(bytesRead, totalBytes);
+}
+
+void FileLoader::onFinished(const FileFormat &format) {
+  if (m_cancelled) {
+    return;
+  }
+  m_format = format;
+  m_finished = true;
+  LOG_INFO(QString("Finished loading file: %1 (%2 bytes)")
+               .arg(m_filePath)
+               .arg(m_bytesRead));
+  emit finished();
+}
+
+void FileLoader::onFailed(const QString &errorMessage) {
+  if (m_cancelled) {
+    return;
+  }
+  LOG_ERROR(errorMessage);
+  emit failed(errorMessage);
+}
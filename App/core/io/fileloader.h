@@ -0,0 +1,80 @@
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringConverter>
+
+constexpr qint64 FILE_LOADER_FIRST_CHUNK_BYTES = 64 * 1024;
+constexpr qint64 FILE_LOADER_CHUNK_BYTES = 1024 * 1024;
+constexpr qint64 FILE_LOADER_SYNC_LIMIT = 1024 * 1024;
+constexpr int FILE_LOADER_MAX_CHUNKS_IN_FLIGHT = 4;
+
+enum class FileLineEnding { LF, CRLF, CR };
+
+struct FileFormat {
+  QStringConverter::Encoding encoding = QStringConverter::Utf8;
+  FileLineEnding lineEnding = FileLineEnding::LF;
+  bool hasBom = false;
+};
+
+class FileLoader : public QObject {
+  Q_OBJECT
+
+public:
+  explicit FileLoader(const QString &filePath, QObject *parent = nullptr);
+  ~FileLoader() override;
+
+  static FileFormat detectFormat(const QByteArray &head);
+
+  static QString normalizeLineEndings(const QString &chunk,
+                                      bool *pendingCarriageReturn, bool last);
+
+  static bool readAll(const QString &filePath, QString *text,
+                      FileFormat *format, QString *errorMessage);
+
+  void setChunkSize(qint64 bytes);
+
+  void start();
+
+  void cancel();
+
+  void acknowledgeChunk();
+
+  QString filePath() const { return m_filePath; }
+
+  FileFormat format() const { return m_format; }
+
+  bool isFinished() const { return m_finished; }
+
+  qint64 bytesRead() const { return m_bytesRead; }
+
+  qint64 totalBytes() const { return m_totalBytes; }
+
+signals:
+  void chunkLoaded(const QString &text);
+
+  void progress(qint64 bytesRead, qint64 totalBytes);
+
+  void finished();
+
+  void failed(const QString &errorMessage);
+
+private:
+  friend class FileLoaderWorker;
+
+  void onChunkLoaded(const QString &text, qint64 bytesRead, qint64 totalBytes);
+  void onFinished(const FileFormat &format);
+  void onFailed(const QString &errorMessage);
+
+  QString m_filePath;
+  class FileLoaderWorker *m_worker;
+  qint64 m_chunkBytes;
+  FileFormat m_format;
+  bool m_finished;
+  bool m_cancelled;
+  qint64 m_bytesRead;
+  qint64 m_totalBytes;
+};
+
+#endif
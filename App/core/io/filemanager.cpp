@@ -1,5 +1,6 @@
 #include "filemanager.h"
 #include "../logging/logger.h"
+#include "filesaver.h"
 
 #include <QFile>
 #include <QFileInfo>
@@ -62,19 +63,13 @@ FileManager::FileResult FileManager::writeFile(const QString &filePath,
     return result;
   }
 
-  QFile file(filePath);
-  if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) {
-    result.errorMessage =
-        QString("Cannot open file for writing: %1").arg(filePath);
+  if (!FileSaver::writeAtomically(filePath, content.toUtf8(), true,
+                                  &result.errorMessage)) {
     LOG_ERROR(result.errorMessage);
     emit fileError(filePath, result.errorMessage);
     return result;
   }
 
-  QTextStream stream(&file);
-  stream << content;
-  file.close();
-
   result.success = true;
   LOG_INFO(QString("Successfully saved file: %1").arg(filePath));
   emit fileSaved(filePath);
@@ -0,0 +1,326 @@
+#include "filesaver.h"
+#include "../logging/logger.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringEncoder>
+#include <QThread>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void syncParentDirectory(const QString &filePath) {
+#ifdef Q_OS_UNIX
+  const QByteArray directory =
+      QFile::encodeName(QFileInfo(filePath).absolutePath());
+  const int fd = ::open(directory.constData(), O_RDONLY);
+  if (fd >= 0) {
+    ::fsync(fd);
+    ::close(fd);
+  }
+#else
+  Q_UNUSED(filePath);
+#endif
+}
+
+} // namespace
+
+class FileSaverWorker : public QThread {
+public:
+  explicit FileSaverWorker(FileSaver *saver) : m_saver(saver) {}
+
+protected:
+  void run() override {
+    FileSaver::Job job;
+    bool syncDirectory = false;
+    while (m_saver->takeJob(&job, &syncDirectory)) {
+      const qint64 startedNs = m_saver->m_clock.nsecsElapsed();
+      FileSaveResult result = FileSaver::write(job.request, syncDirectory);
+      result.queuedMs = (startedNs - job.queuedAtNs) / 1000000.0;
+
+      FileSaver *saver = m_saver;
+      const FileSaver::CallbackList callbacks = job.callbacks;
+      QMetaObject::invokeMethod(
+          saver,
+          [saver, result, callbacks]() {
+            saver->onSaveFinished(result, callbacks);
+          },
+          Qt::QueuedConnection);
+      m_saver->finishJob(result);
+    }
+  }
+
+private:
+  FileSaver *m_saver;
+};
+
+FileSaver &FileSaver::instance() {
+  static FileSaver instance;
+  return instance;
+}
+
+FileSaver::FileSaver()
+    : QObject(nullptr), m_worker(nullptr), m_busy(0), m_stopping(false),
+      m_syncPolicy(SaveSyncPolicy::ExplicitSaves), m_lastLatencyMs(0.0),
+      m_totalLatencyMs(0.0), m_completedCount(0) {
+  m_clock.start();
+}
+
+FileSaver::~FileSaver() {
+  {
+    QMutexLocker locker(&m_mutex);
+    m_stopping = true;
+    m_jobAvailable.wakeAll();
+  }
+  if (m_worker) {
+    m_worker->wait();
+    delete m_worker;
+  }
+}
+
+QByteArray FileSaver::encode(const QString &text, const FileFormat &format) {
+  QString converted = text;
+  if (format.lineEnding == FileLineEnding::CRLF) {
+    converted.replace(QLatin1Char('\n'), QLatin1String("\r\n"));
+  } else if (format.lineEnding == FileLineEnding::CR) {
+    converted.replace(QLatin1Char('\n'), QLatin1Char('\r'));
+  }
+
+  const QStringConverter::Flags flags =
+      format.hasBom ? QStringConverter::Flag::WriteBom
+                    : QStringConverter::Flag::Default;
+  QStringEncoder encoder(format.encoding, flags);
+  QByteArray data = encoder.encode(converted);
+  if (encoder.hasError()) {
+    LOG_WARNING("Text cannot be represented in the file's encoding, "
+                "saving as UTF-8");
+    QStringEncoder utf8(QStringConverter::Utf8, flags);
+    data = utf8.encode(converted);
+  }
+  return data;
+}
+
+bool FileSaver::writeAtomically(const QString &filePath,
+                                const QByteArray &data, bool syncDirectory,
+                                QString *errorMessage) {
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    if (errorMessage) {
+      *errorMessage = QString("Cannot open file for writing: %1").arg(filePath);
+    }
+    return false;
+  }
+
+  if (file.write(data) != data.size()) {
+    if (errorMessage) {
+      *errorMessage = file.errorString();
+    }
+    file.cancelWriting();
+    return false;
+  }
+
+  if (!file.commit()) {
+    if (errorMessage) {
+      *errorMessage = file.errorString();
+    }
+    return false;
+  }
+
+  if (syncDirectory) {
+    syncParentDirectory(filePath);
+  }
+  return true;
+}
+
+SaveSyncPolicy FileSaver::syncPolicyFromString(const QString &value) {
+  if (value == "never") {
+    return SaveSyncPolicy::Never;
+  }
+  if (value == "always") {
+    return SaveSyncPolicy::Always;
+  }
+  return SaveSyncPolicy::ExplicitSaves;
+}
+
+QString FileSaver::syncPolicyToString(SaveSyncPolicy policy) {
+  switch (policy) {
+  case SaveSyncPolicy::Never:
+    return "never";
+  case SaveSyncPolicy::Always:
+    return "always";
+  case SaveSyncPolicy::ExplicitSaves:
+    break;
+  }
+  return "explicit";
+}
+
+void FileSaver::save(const FileSaveRequest &request, QObject *context,
+                     Callback callback) {
+  if (!m_worker) {
+    m_worker = new FileSaverWorker(this);
+    m_worker->start();
+  }
+
+  QMutexLocker locker(&m_mutex);
+  for (Job &job : m_queue) {
+    if (job.request.filePath != request.filePath) {
+      continue;
+    }
+    const bool isAutoSave = job.request.isAutoSave && request.isAutoSave;
+    job.request = request;
+    job.request.isAutoSave = isAutoSave;
+    if (callback) {
+      job.callbacks.append({context, callback});
+    }
+    return;
+  }
+
+  Job job;
+  job.request = request;
+  job.queuedAtNs = m_clock.nsecsElapsed();
+  if (callback) {
+    job.callbacks.append({context, callback});
+  }
+  m_queue.append(job);
+  m_jobAvailable.wakeOne();
+}
+
+void FileSaver::waitForIdle() {
+  {
+    QMutexLocker locker(&m_mutex);
+    while (!m_queue.isEmpty() || m_busy > 0) {
+      m_idle.wait(&m_mutex);
+    }
+  }
+  QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+bool FileSaver::waitForIdle(const QString &filePath) {
+  bool succeeded = false;
+  {
+    QMutexLocker locker(&m_mutex);
+    while (isPending(filePath)) {
+      m_idle.wait(&m_mutex);
+    }
+    succeeded = m_lastSucceeded.take(filePath);
+  }
+  QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+  return succeeded;
+}
+
+int FileSaver::pendingCount() const {
+  QMutexLocker locker(&m_mutex);
+  return m_queue.size() + m_busy;
+}
+
+void FileSaver::setSyncPolicy(SaveSyncPolicy policy) {
+  QMutexLocker locker(&m_mutex);
+  m_syncPolicy = policy;
+}
+
+SaveSyncPolicy FileSaver::syncPolicy() const {
+  QMutexLocker locker(&m_mutex);
+  return m_syncPolicy;
+}
+
+double FileSaver::averageLatencyMs() const {
+  return m_completedCount > 0 ? m_totalLatencyMs / m_completedCount : 0.0;
+}
+
+bool FileSaver::isPending(const QString &filePath) const {
+  if (m_busy > 0 && m_busyPath == filePath) {
+    return true;
+  }
+  for (const Job &job : m_queue) {
+    if (job.request.filePath == filePath) {
+      return true;
+    }
+  }
+  return false;
+}
+
+FileSaveResult FileSaver::write(const FileSaveRequest &request,
+                                bool syncDirectory) {
+  QElapsedTimer timer;
+  timer.start();
+
+  FileSaveResult result;
+  result.filePath = request.filePath;
+  result.isAutoSave = request.isAutoSave;
+
+  if (request.filePath.isEmpty()) {
+    result.errorMessage = "File path is empty";
+  } else {
+    const QByteArray data = encode(request.text, request.format);
+    result.success = writeAtomically(request.filePath, data, syncDirectory,
+                                     &result.errorMessage);
+    if (result.success) {
+      result.bytesWritten = data.size();
+    }
+  }
+
+  result.writeMs = timer.nsecsElapsed() / 1000000.0;
+  return result;
+}
+
+bool FileSaver::takeJob(Job *job, bool *syncDirectory) {
+  QMutexLocker locker(&m_mutex);
+  while (m_queue.isEmpty() && !m_stopping) {
+    m_jobAvailable.wait(&m_mutex);
+  }
+  if (m_queue.isEmpty()) {
+    return false;
+  }
+
+  *job = m_queue.takeFirst();
+  m_busyPath = job->request.filePath;
+  *syncDirectory = m_syncPolicy == SaveSyncPolicy::Always ||
+                   (m_syncPolicy == SaveSyncPolicy::ExplicitSaves &&
+                    !job->request.isAutoSave);
+  ++m_busy;
+  return true;
+}
+
+void FileSaver::finishJob(const FileSaveResult &result) {
+  QMutexLocker locker(&m_mutex);
+  --m_busy;
+  m_busyPath.clear();
+  m_lastSucceeded.insert(result.filePath, result.success);
+  m_idle.wakeAll();
+}
+
+void FileSaver::onSaveFinished(const FileSaveResult &result,
+                               const CallbackList &callbacks) {
+  {
+    QMutexLocker locker(&m_mutex);
+    if (!isPending(result.filePath)) {
+      m_lastSucceeded.remove(result.filePath);
+    }
+  }
+
+  m_lastLatencyMs = result.queuedMs + result.writeMs;
+  m_totalLatencyMs += m_lastLatencyMs;
+  ++m_completedCount;
+
+  if (result.success) {
+    LOG_INFO(QString("Saved file: %1 (%2 bytes, %3 ms)")
+                 .arg(result.filePath)
+                 .arg(result.bytesWritten)
+                 .arg(m_lastLatencyMs, 0, 'f', 1));
+  } else {
+    LOG_ERROR(QString("Failed to save %1: %2")
+                  .arg(result.filePath, result.errorMessage));
+  }
+
+  emit saveFinished(result);
+  for (const auto &entry : callbacks) {
+    if (entry.first) {
+      entry.second(result);
+    }
+  }
+}
@@ -0,0 +1,118 @@
+#ifndef FILESAVER_H
+#define FILESAVER_H
+
+#include "fileloader.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QString>
+#include <QWaitCondition>
+#include <functional>
+
+// QSaveFile always flushes the temporary file before renaming it over the
+// target; the policy decides whether the parent directory is synced as well,
+// which is what makes the rename itself survive a power loss.
+enum class SaveSyncPolicy { Never, ExplicitSaves, Always };
+
+struct FileSaveRequest {
+  QString filePath;
+  QString text;
+  FileFormat format;
+  bool isAutoSave = false;
+};
+
+struct FileSaveResult {
+  QString filePath;
+  bool success = false;
+  bool isAutoSave = false;
+  QString errorMessage;
+  qint64 bytesWritten = 0;
+  double queuedMs = 0.0;
+  double writeMs = 0.0;
+};
+
+class FileSaver : public QObject {
+  Q_OBJECT
+
+public:
+  using Callback = std::function<void(const FileSaveResult &)>;
+
+  static FileSaver &instance();
+
+  static QByteArray encode(const QString &text, const FileFormat &format);
+
+  static bool writeAtomically(const QString &filePath, const QByteArray &data,
+                              bool syncDirectory, QString *errorMessage);
+
+  static SaveSyncPolicy syncPolicyFromString(const QString &value);
+
+  static QString syncPolicyToString(SaveSyncPolicy policy);
+
+  void save(const FileSaveRequest &request, QObject *context = nullptr,
+            Callback callback = Callback());
+
+  void waitForIdle();
+
+  bool waitForIdle(const QString &filePath);
+
+  int pendingCount() const;
+
+  void setSyncPolicy(SaveSyncPolicy policy);
+
+  SaveSyncPolicy syncPolicy() const;
+
+  double lastLatencyMs() const { return m_lastLatencyMs; }
+
+  double averageLatencyMs() const;
+
+  int completedCount() const { return m_completedCount; }
+
+signals:
+  void saveFinished(const FileSaveResult &result);
+
+private:
+  friend class FileSaverWorker;
+
+  using CallbackList = QList<QPair<QPointer<QObject>, Callback>>;
+
+  struct Job {
+    FileSaveRequest request;
+    qint64 queuedAtNs = 0;
+    CallbackList callbacks;
+  };
+
+  FileSaver();
+  ~FileSaver();
+  FileSaver(const FileSaver &) = delete;
+  FileSaver &operator=(const FileSaver &) = delete;
+
+  static FileSaveResult write(const FileSaveRequest &request,
+                              bool syncDirectory);
+  bool isPending(const QString &filePath) const;
+  bool takeJob(Job *job, bool *syncDirectory);
+  void finishJob(const FileSaveResult &result);
+  void onSaveFinished(const FileSaveResult &result,
+                      const CallbackList &callbacks);
+
+  class FileSaverWorker *m_worker;
+  QElapsedTimer m_clock;
+  mutable QMutex m_mutex;
+  QWaitCondition m_jobAvailable;
+  QWaitCondition m_idle;
+  QList<Job> m_queue;
+  int m_busy;
+  QString m_busyPath;
+  QHash<QString, bool> m_lastSucceeded;
+  bool m_stopping;
+  SaveSyncPolicy m_syncPolicy;
+  double m_lastLatencyMs;
+  double m_totalLatencyMs;
+  int m_completedCount;
+};
+
+#endif
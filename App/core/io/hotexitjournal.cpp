@@ -0,0 +1,608 @@
+#include "hotexitjournal.h"
+#include "../logging/logger.h"
+#include "fileloader.h"
+#include "filesaver.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QMutex>
+#include <QPointer>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QThread>
+#include <QTimer>
+#include <QUuid>
+#include <QWaitCondition>
+
+namespace {
+
+constexpr quint32 JOURNAL_MAGIC = 0x4C504A4E;
+constexpr quint16 JOURNAL_VERSION = 1;
+const QString JOURNAL_SUFFIX = ".journal";
+const QString LOCK_SUFFIX = ".lock";
+
+enum RecordKind : quint8 {
+  SnapshotRecord = 1,
+  EditRecord = 2,
+  FilePathRecord = 3,
+  BaseRecord = 4,
+};
+
+QString plainText(QString rawText) {
+  rawText.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+  return rawText;
+}
+
+QByteArray hashFile(const QString &filePath) {
+  QFile file(filePath);
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  if (!file.open(QIODevice::ReadOnly) || !hash.addData(&file)) {
+    return QByteArray();
+  }
+  return hash.result();
+}
+
+bool readBase(const QString &filePath, qint64 modified, qint64 size,
+              const QByteArray &hash, QString *text) {
+  const QFileInfo info(filePath);
+  if (!info.isFile() || info.size() != size ||
+      info.lastModified().toMSecsSinceEpoch() != modified ||
+      hashFile(filePath) != hash) {
+    LOG_WARNING(QString("Hot-exit base changed on disk: %1").arg(filePath));
+    return false;
+  }
+  FileFormat format;
+  QString errorMessage;
+  return FileLoader::readAll(filePath, text, &format, &errorMessage);
+}
+
+std::unique_ptr<QLockFile> lockJournal(const QString &journalPath) {
+  auto lock = std::make_unique<QLockFile>(journalPath + LOCK_SUFFIX);
+  lock->setStaleLockTime(0);
+  if (!lock->tryLock(0)) {
+    return nullptr;
+  }
+  return lock;
+}
+
+} // namespace
+
+class HotExitWriter : public QThread {
+public:
+  enum class Kind { HashBase, WriteSnapshot };
+
+  struct Job {
+    Kind kind = Kind::HashBase;
+    QPointer<HotExitJournal> journal;
+    quint64 token = 0;
+    QString journalPath;
+    QString filePath;
+    QString text;
+  };
+
+  static HotExitWriter &instance() {
+    static HotExitWriter writer;
+    return writer;
+  }
+
+  ~HotExitWriter() override {
+    {
+      QMutexLocker locker(&m_mutex);
+      m_stopping = true;
+      m_jobAvailable.wakeAll();
+    }
+    wait();
+  }
+
+  void submit(const Job &job) {
+    if (!isRunning()) {
+      start();
+    }
+    QMutexLocker locker(&m_mutex);
+    m_queue.append(job);
+    m_jobAvailable.wakeOne();
+  }
+
+  void waitForIdle() {
+    {
+      QMutexLocker locker(&m_mutex);
+      while (!m_queue.isEmpty() || m_busy) {
+        m_idle.wait(&m_mutex);
+      }
+    }
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+  }
+
+protected:
+  void run() override {
+    Job job;
+    while (takeJob(&job)) {
+      if (job.kind == Kind::HashBase) {
+        hashBase(job);
+      } else {
+        writeSnapshot(job);
+      }
+      QMutexLocker locker(&m_mutex);
+      m_busy = false;
+      m_idle.wakeAll();
+    }
+  }
+
+private:
+  HotExitWriter() : m_busy(false), m_stopping(false) {}
+
+  bool takeJob(Job *job) {
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.isEmpty() && !m_stopping) {
+      m_jobAvailable.wait(&m_mutex);
+    }
+    if (m_queue.isEmpty()) {
+      return false;
+    }
+    *job = m_queue.takeFirst();
+    m_busy = true;
+    return true;
+  }
+
+  void hashBase(const Job &job) {
+    const QFileInfo before(job.filePath);
+    QByteArray hash;
+    if (before.isFile()) {
+      hash = hashFile(job.filePath);
+    }
+    const QFileInfo after(job.filePath);
+    if (after.size() != before.size() ||
+        after.lastModified() != before.lastModified()) {
+      hash.clear();
+    }
+
+    const QPointer<HotExitJournal> journal = job.journal;
+    const quint64 token = job.token;
+    const qint64 modified = before.lastModified().toMSecsSinceEpoch();
+    const qint64 size = before.size();
+    QMetaObject::invokeMethod(
+        this,
+        [journal, token, modified, size, hash]() {
+          if (journal) {
+            journal->onBaseHashed(token, modified, size, hash);
+          }
+        },
+        Qt::QueuedConnection);
+  }
+
+  void writeSnapshot(const Job &job) {
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << JOURNAL_MAGIC << JOURNAL_VERSION << quint8(SnapshotRecord)
+           << job.filePath << plainText(job.text);
+
+    QString errorMessage;
+    qint64 bytes = data.size();
+    if (!FileSaver::writeAtomically(job.journalPath, data, false,
+                                    &errorMessage)) {
+      LOG_WARNING(
+          QString("Cannot write hot-exit snapshot: %1").arg(errorMessage));
+      bytes = -1;
+    }
+
+    const QPointer<HotExitJournal> journal = job.journal;
+    const quint64 token = job.token;
+    QMetaObject::invokeMethod(
+        this,
+        [journal, token, bytes]() {
+          if (journal) {
+            journal->onSnapshotWritten(token, bytes);
+          }
+        },
+        Qt::QueuedConnection);
+  }
+
+  QMutex m_mutex;
+  QWaitCondition m_jobAvailable;
+  QWaitCondition m_idle;
+  QList<Job> m_queue;
+  bool m_busy;
+  bool m_stopping;
+};
+
+HotExitJournal::HotExitJournal(QTextDocument *document,
+                               const QString &directory)
+    : QObject(document), m_document(document), m_directory(directory),
+      m_compactTimer(new QTimer(this)), m_baseModified(0), m_baseSize(-1),
+      m_snapshotBytes(0), m_editBytes(0), m_lastToken(0), m_baseRequest(0),
+      m_pendingSnapshot(0), m_revision(document->revision()),
+      m_startPending(false), m_baseValid(false) {
+  m_compactTimer->setSingleShot(true);
+  m_compactTimer->setInterval(HOT_EXIT_IDLE_COMPACT_MS);
+  connect(m_compactTimer, &QTimer::timeout, this, [this]() {
+    if (m_editBytes >= qMax(HOT_EXIT_MIN_COMPACT_BYTES, m_snapshotBytes)) {
+      compact();
+    }
+  });
+  connect(document, &QTextDocument::contentsChange, this,
+          &HotExitJournal::onContentsChange);
+  connect(document, &QTextDocument::modificationChanged, this,
+          &HotExitJournal::onModificationChanged);
+
+  if (document->isModified()) {
+    m_startPending = true;
+    QTimer::singleShot(0, this, &HotExitJournal::start);
+  } else {
+    captureBase();
+  }
+}
+
+HotExitJournal::~HotExitJournal() {
+  m_baseRequest = 0;
+  stop(false);
+}
+
+HotExitJournal *HotExitJournal::forDocument(QTextDocument *document,
+                                            const QString &directory) {
+  if (!document) {
+    return nullptr;
+  }
+  HotExitJournal *journal = find(document);
+  return journal ? journal : new HotExitJournal(document, directory);
+}
+
+HotExitJournal *HotExitJournal::find(QTextDocument *document) {
+  if (!document) {
+    return nullptr;
+  }
+  return document->findChild<HotExitJournal *>(QString(),
+                                               Qt::FindDirectChildrenOnly);
+}
+
+bool HotExitJournal::readJournal(const QString &journalPath,
+                                 RecoveredBuffer *buffer) {
+  QFile file(journalPath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_6_0);
+  quint32 magic = 0;
+  quint16 version = 0;
+  stream >> magic >> version;
+  if (stream.status() != QDataStream::Ok || magic != JOURNAL_MAGIC ||
+      version != JOURNAL_VERSION) {
+    return false;
+  }
+
+  bool hasSnapshot = false;
+  QString filePath;
+  QString text;
+  while (!stream.atEnd()) {
+    quint8 kind = 0;
+    stream >> kind;
+    if (kind == SnapshotRecord) {
+      QString snapshotPath;
+      QString snapshotText;
+      stream >> snapshotPath >> snapshotText;
+      if (stream.status() != QDataStream::Ok) {
+        break;
+      }
+      filePath = snapshotPath;
+      text = snapshotText;
+      hasSnapshot = true;
+    } else if (kind == BaseRecord) {
+      QString basePath;
+      qint64 modified = 0;
+      qint64 size = 0;
+      QByteArray hash;
+      stream >> basePath >> modified >> size >> hash;
+      if (stream.status() != QDataStream::Ok ||
+          !readBase(basePath, modified, size, hash, &text)) {
+        return false;
+      }
+      filePath = basePath;
+      hasSnapshot = true;
+    } else if (kind == EditRecord) {
+      qint32 position = 0;
+      qint32 removed = 0;
+      QString added;
+      stream >> position >> removed >> added;
+      if (stream.status() != QDataStream::Ok || !hasSnapshot ||
+          position < 0 || position > text.size()) {
+        break;
+      }
+      removed = qBound(0, removed, static_cast<int>(text.size()) - position);
+      text.replace(position, removed, added);
+    } else if (kind == FilePathRecord) {
+      QString newPath;
+      stream >> newPath;
+      if (stream.status() != QDataStream::Ok) {
+        break;
+      }
+      filePath = newPath;
+    } else {
+      break;
+    }
+  }
+
+  if (!hasSnapshot) {
+    return false;
+  }
+  buffer->journalPath = journalPath;
+  buffer->filePath = filePath;
+  buffer->text = text;
+  return true;
+}
+
+QList<RecoveredBuffer> HotExitJournal::recover(const QString &directory) {
+  QList<RecoveredBuffer> buffers;
+  const QFileInfoList entries =
+      QDir(directory).entryInfoList({"*" + JOURNAL_SUFFIX}, QDir::Files,
+                                    QDir::Time | QDir::Reversed);
+  for (const QFileInfo &entry : entries) {
+    const QString journalPath = entry.absoluteFilePath();
+    std::unique_ptr<QLockFile> lock = lockJournal(journalPath);
+    if (!lock) {
+      continue;
+    }
+
+    RecoveredBuffer buffer;
+    if (readJournal(journalPath, &buffer)) {
+      buffers.append(buffer);
+    } else {
+      LOG_WARNING(QString("Discarding unreadable hot-exit journal: %1")
+                      .arg(journalPath));
+      QFile::remove(journalPath);
+    }
+  }
+  return buffers;
+}
+
+void HotExitJournal::removeJournal(const QString &journalPath) {
+  std::unique_ptr<QLockFile> lock = lockJournal(journalPath);
+  if (lock) {
+    QFile::remove(journalPath);
+  }
+}
+
+void HotExitJournal::setFilePath(const QString &filePath) {
+  if (filePath == m_filePath) {
+    return;
+  }
+  m_filePath = filePath;
+  if (!isRecording()) {
+    captureBase();
+    return;
+  }
+
+  QByteArray record;
+  QDataStream stream(&record, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_6_0);
+  stream << quint8(FilePathRecord) << m_filePath;
+  append(record);
+}
+
+void HotExitJournal::compact() {
+  if (m_file.isOpen()) {
+    writeSnapshot();
+  }
+}
+
+void HotExitJournal::discard() { stop(true); }
+
+void HotExitJournal::flush() {
+  if (m_baseRequest != 0 || m_pendingSnapshot != 0) {
+    HotExitWriter::instance().waitForIdle();
+  }
+}
+
+void HotExitJournal::onContentsChange(int position, int removed, int added) {
+  if (!m_document->isUndoRedoEnabled()) {
+    return;
+  }
+
+  const int revision = m_document->revision();
+  if (removed == added && revision == m_revision) {
+    return;
+  }
+  m_revision = revision;
+
+  if (!isRecording()) {
+    if (m_baseValid && !m_startPending && startFromBase()) {
+      recordEdit(position, removed, added);
+    } else if (!m_startPending) {
+      m_startPending = true;
+      QTimer::singleShot(0, this, &HotExitJournal::start);
+    }
+    return;
+  }
+  recordEdit(position, removed, added);
+}
+
+void HotExitJournal::onModificationChanged(bool modified) {
+  if (!modified) {
+    stop(true);
+    captureBase();
+  }
+}
+
+void HotExitJournal::captureBase() {
+  m_baseValid = false;
+  m_baseRequest = 0;
+  if (m_document->isModified() || m_filePath.isEmpty()) {
+    return;
+  }
+
+  HotExitWriter::Job job;
+  job.kind = HotExitWriter::Kind::HashBase;
+  job.journal = this;
+  job.token = m_baseRequest = ++m_lastToken;
+  job.filePath = m_filePath;
+  HotExitWriter::instance().submit(job);
+}
+
+void HotExitJournal::onBaseHashed(quint64 token, qint64 modified, qint64 size,
+                                  const QByteArray &hash) {
+  if (token != m_baseRequest) {
+    return;
+  }
+  m_baseRequest = 0;
+  if (hash.isEmpty() || m_document->isModified() || isRecording()) {
+    return;
+  }
+  m_baseModified = modified;
+  m_baseSize = size;
+  m_baseHash = hash;
+  m_baseValid = true;
+}
+
+void HotExitJournal::start() {
+  m_startPending = false;
+  if (isRecording() || !m_document->isModified() ||
+      !m_document->isUndoRedoEnabled()) {
+    return;
+  }
+
+  if (!QDir().mkpath(m_directory)) {
+    LOG_WARNING(
+        QString("Cannot create hot-exit directory: %1").arg(m_directory));
+    return;
+  }
+
+  m_journalPath = QDir(m_directory).filePath(
+      QUuid::createUuid().toString(QUuid::WithoutBraces) + JOURNAL_SUFFIX);
+  m_lock = lockJournal(m_journalPath);
+  if (!m_lock) {
+    stop(true);
+    return;
+  }
+  writeSnapshot();
+}
+
+bool HotExitJournal::startFromBase() {
+  m_baseValid = false;
+  const QFileInfo info(m_filePath);
+  if (!info.isFile() || info.size() != m_baseSize ||
+      info.lastModified().toMSecsSinceEpoch() != m_baseModified ||
+      !QDir().mkpath(m_directory)) {
+    return false;
+  }
+
+  m_journalPath = QDir(m_directory).filePath(
+      QUuid::createUuid().toString(QUuid::WithoutBraces) + JOURNAL_SUFFIX);
+  m_lock = lockJournal(m_journalPath);
+  m_file.setFileName(m_journalPath);
+  if (!m_lock || !m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    stop(true);
+    return false;
+  }
+
+  QByteArray header;
+  QDataStream stream(&header, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_6_0);
+  stream << JOURNAL_MAGIC << JOURNAL_VERSION << quint8(BaseRecord)
+         << m_filePath << m_baseModified << m_baseSize << m_baseHash;
+  append(header);
+  if (!m_file.isOpen()) {
+    return false;
+  }
+  m_snapshotBytes = m_baseSize;
+  m_editBytes = 0;
+  return true;
+}
+
+void HotExitJournal::stop(bool removeJournalFile) {
+  if (m_pendingSnapshot != 0) {
+    if (removeJournalFile) {
+      m_pendingSnapshot = 0;
+    }
+    HotExitWriter::instance().waitForIdle();
+    m_pendingSnapshot = 0;
+  }
+  m_compactTimer->stop();
+  m_file.close();
+  if (removeJournalFile && m_lock && !m_journalPath.isEmpty()) {
+    QFile::remove(m_journalPath);
+  }
+  m_lock.reset();
+  m_journalPath.clear();
+  m_pendingRecords.clear();
+  m_snapshotBytes = 0;
+  m_editBytes = 0;
+}
+
+void HotExitJournal::writeSnapshot() {
+  m_file.close();
+  m_pendingRecords.clear();
+  m_editBytes = 0;
+
+  HotExitWriter::Job job;
+  job.kind = HotExitWriter::Kind::WriteSnapshot;
+  job.journal = this;
+  job.token = m_pendingSnapshot = ++m_lastToken;
+  job.journalPath = m_journalPath;
+  job.filePath = m_filePath;
+  job.text = m_document->toRawText();
+  HotExitWriter::instance().submit(job);
+}
+
+void HotExitJournal::onSnapshotWritten(quint64 token, qint64 bytes) {
+  if (token != m_pendingSnapshot) {
+    return;
+  }
+  m_pendingSnapshot = 0;
+  if (bytes < 0) {
+    stop(true);
+    return;
+  }
+
+  m_file.setFileName(m_journalPath);
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    LOG_WARNING(QString("Cannot append to hot-exit journal: %1")
+                    .arg(m_file.errorString()));
+    stop(true);
+    return;
+  }
+  m_snapshotBytes = bytes;
+  m_editBytes = 0;
+  const QByteArray records = m_pendingRecords;
+  m_pendingRecords.clear();
+  if (!records.isEmpty()) {
+    append(records);
+  }
+}
+
+void HotExitJournal::append(const QByteArray &record) {
+  if (m_pendingSnapshot != 0) {
+    m_pendingRecords += record;
+    m_editBytes += record.size();
+    return;
+  }
+  if (m_file.write(record) != record.size() || !m_file.flush()) {
+    LOG_WARNING(QString("Cannot append to hot-exit journal: %1")
+                    .arg(m_file.errorString()));
+    stop(true);
+    return;
+  }
+  m_editBytes += record.size();
+}
+
+void HotExitJournal::recordEdit(int position, int removed, int added) {
+  QString text;
+  const int end = qMin(position + added, m_document->characterCount() - 1);
+  if (end > position) {
+    QTextCursor cursor(m_document);
+    cursor.setPosition(position);
+    cursor.setPosition(end, QTextCursor::KeepAnchor);
+    text = plainText(cursor.selectedText());
+  }
+
+  QByteArray record;
+  QDataStream stream(&record, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_6_0);
+  stream << quint8(EditRecord) << qint32(position) << qint32(removed) << text;
+  append(record);
+  m_compactTimer->start();
+}
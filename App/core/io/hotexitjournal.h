@@ -0,0 +1,95 @@
+#ifndef HOTEXITJOURNAL_H
+#define HOTEXITJOURNAL_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class QLockFile;
+class QTextDocument;
+class QTimer;
+
+constexpr int HOT_EXIT_IDLE_COMPACT_MS = 2000;
+constexpr qint64 HOT_EXIT_MIN_COMPACT_BYTES = 64 * 1024;
+
+struct RecoveredBuffer {
+  QString journalPath;
+  QString filePath;
+  QString text;
+};
+
+class HotExitJournal : public QObject {
+  Q_OBJECT
+
+public:
+  HotExitJournal(QTextDocument *document, const QString &directory);
+  ~HotExitJournal() override;
+
+  static HotExitJournal *forDocument(QTextDocument *document,
+                                     const QString &directory);
+
+  static HotExitJournal *find(QTextDocument *document);
+
+  static bool readJournal(const QString &journalPath, RecoveredBuffer *buffer);
+
+  static QList<RecoveredBuffer> recover(const QString &directory);
+
+  static void removeJournal(const QString &journalPath);
+
+  void setFilePath(const QString &filePath);
+
+  QString filePath() const { return m_filePath; }
+
+  QString journalPath() const { return m_journalPath; }
+
+  bool isRecording() const { return m_file.isOpen() || m_pendingSnapshot != 0; }
+
+  qint64 pendingEditBytes() const { return m_editBytes; }
+
+  void compact();
+
+  void discard();
+
+  void flush();
+
+private:
+  friend class HotExitWriter;
+
+  void onContentsChange(int position, int removed, int added);
+  void onModificationChanged(bool modified);
+  void captureBase();
+  void start();
+  bool startFromBase();
+  void stop(bool removeJournalFile);
+  void writeSnapshot();
+  void onBaseHashed(quint64 token, qint64 modified, qint64 size,
+                    const QByteArray &hash);
+  void onSnapshotWritten(quint64 token, qint64 bytes);
+  void recordEdit(int position, int removed, int added);
+  void append(const QByteArray &record);
+
+  QTextDocument *m_document;
+  QString m_directory;
+  QString m_filePath;
+  QString m_journalPath;
+  QFile m_file;
+  std::unique_ptr<QLockFile> m_lock;
+  QTimer *m_compactTimer;
+  QByteArray m_baseHash;
+  QByteArray m_pendingRecords;
+  qint64 m_baseModified;
+  qint64 m_baseSize;
+  qint64 m_snapshotBytes;
+  qint64 m_editBytes;
+  quint64 m_lastToken;
+  quint64 m_baseRequest;
+  quint64 m_pendingSnapshot;
+  int m_revision;
+  bool m_startPending;
+  bool m_baseValid;
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include "../ui/mainwindow.h"
 #include "../ui/panels/minimap.h"
 #include "../ui/uistylehelper.h"
+#include "io/hotexitjournal.h"
 #include <QDir>
 #include <QDragEnterEvent>
 #include <QDragMoveEvent>
@@ -730,6 +731,12 @@ void LightpadPage::setSharedFileSystemModel(GitFileSystemModel *sharedModel) {
 void LightpadPage::setFilePath(QString path) {
   filePath = path;
 
+  if (textArea) {
+    if (HotExitJournal *journal = HotExitJournal::find(textArea->document())) {
+      journal->setFilePath(path);
+    }
+  }
+
   if (!path.isEmpty() && !projectRootPath.isEmpty()) {
     setTreeViewVisible(true);
   }
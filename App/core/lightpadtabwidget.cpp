@@ -13,6 +13,7 @@
 #include <QFontMetrics>
 #include <QMenu>
 #include <QProcess>
+#include <QSignalBlocker>
 #include <QSizePolicy>
 #include <QStyle>
 #include <QTabBar>
@@ -126,7 +127,16 @@ void LightpadTabWidget::resizeEvent(QResizeEvent *event) {
 }
 
 void LightpadTabWidget::tabRemoved(int index) {
-  Q_UNUSED(index);
+  QWidget *removed = nullptr;
+  if (index >= 0 && index < m_tabPages.size()) {
+    removed = m_tabPages.takeAt(index);
+  }
+
+  if (removed && m_deferredTabs.remove(removed) > 0) {
+    removed->deleteLater();
+  } else if (LightpadPage *page = qobject_cast<LightpadPage *>(removed)) {
+    emit pageRemoved(page);
+  }
 
   if (count() <= 1)
     addNewTab();
@@ -136,6 +146,7 @@ void LightpadTabWidget::tabRemoved(int index) {
 
 void LightpadTabWidget::tabInserted(int index) {
   QTabWidget::tabInserted(index);
+  m_tabPages.insert(index, widget(index));
   updateCloseButtons();
 }
 
@@ -215,26 +226,68 @@ void LightpadTabWidget::updateCloseButtons() {
   }
 }
 
-void LightpadTabWidget::addNewTab() {
-  if (mainWindow) {
-    LightpadPage *newPage = new LightpadPage(this);
-    newPage->setMainWindow(mainWindow);
-    if (mainWindow->getGitIntegration()) {
-      newPage->setGitIntegration(mainWindow->getGitIntegration());
-    }
+LightpadPage *LightpadTabWidget::createPage() {
+  if (!mainWindow) {
+    return nullptr;
+  }
 
-    QString projectRoot = mainWindow->getProjectRootPath();
-    if (!projectRoot.isEmpty()) {
-      newPage->setProjectRootPath(projectRoot);
-      newPage->setTreeViewVisible(true);
-      newPage->setModelRootIndex(projectRoot);
-    }
+  LightpadPage *newPage = new LightpadPage(this);
+  newPage->setMainWindow(mainWindow);
+  if (mainWindow->getGitIntegration()) {
+    newPage->setGitIntegration(mainWindow->getGitIntegration());
+  }
 
+  QString projectRoot = mainWindow->getProjectRootPath();
+  if (!projectRoot.isEmpty()) {
+    newPage->setProjectRootPath(projectRoot);
+    newPage->setTreeViewVisible(true);
+    newPage->setModelRootIndex(projectRoot);
+  }
+  return newPage;
+}
+
+void LightpadTabWidget::addNewTab() {
+  if (LightpadPage *newPage = createPage()) {
     insertTab(count() - 1, newPage, unsavedDocumentLabel);
     setCurrentIndex(count() - 2);
   }
 }
 
+void LightpadTabWidget::addDeferredTab(const QString &filePath,
+                                       const QJsonObject &sessionState) {
+  int index = count() - 1;
+  if (index > 0 && currentIndex() == index - 1 && isBlankPage(index - 1)) {
+    --index;
+  }
+
+  QWidget *placeholder = new QWidget(this);
+  m_deferredTabs.insert(placeholder, {filePath, sessionState});
+  insertTab(index, placeholder, QFileInfo(filePath).fileName());
+}
+
+LightpadPage *LightpadTabWidget::materializeTab(int index) {
+  if (!isDeferredTab(index)) {
+    return getPage(index);
+  }
+
+  LightpadPage *page = createPage();
+  if (!page) {
+    return nullptr;
+  }
+
+  QWidget *placeholder = widget(index);
+  QWidget *current = currentWidget();
+  m_deferredTabs.remove(placeholder);
+  {
+    const QSignalBlocker blocker(this);
+    insertTab(index, page, unsavedDocumentLabel);
+    QTabWidget::removeTab(index + 1);
+    setCurrentWidget(current == placeholder ? page : current);
+  }
+  placeholder->deleteLater();
+  return page;
+}
+
 void LightpadTabWidget::setMainWindow(MainWindow *window) {
   mainWindow = window;
   QList<LightpadPage *> pages = findChildren<LightpadPage *>();
@@ -484,6 +537,8 @@ QString LightpadTabWidget::getFilePath(int index) {
     QWidget *w = widget(index);
     if (m_viewerFilePaths.contains(w))
       return m_viewerFilePaths[w];
+    if (m_deferredTabs.contains(w))
+      return m_deferredTabs[w].filePath;
   }
 
   return "";
@@ -524,6 +579,30 @@ bool LightpadTabWidget::isViewerTab(int index) const {
   return m_viewerFilePaths.contains(w);
 }
 
+bool LightpadTabWidget::isDeferredTab(int index) const {
+  if (index < 0 || index >= count())
+    return false;
+
+  return m_deferredTabs.contains(widget(index));
+}
+
+QJsonObject LightpadTabWidget::deferredTabState(int index) const {
+  if (index < 0 || index >= count())
+    return QJsonObject();
+
+  return m_deferredTabs.value(widget(index)).sessionState;
+}
+
+bool LightpadTabWidget::isBlankPage(int index) {
+  LightpadPage *page = getPage(index);
+  if (!page || isViewerTab(index) || !page->getFilePath().isEmpty())
+    return false;
+
+  TextArea *textArea = page->getTextArea();
+  return textArea && textArea->document()->isEmpty() &&
+         !textArea->document()->isModified();
+}
+
 void LightpadTabWidget::setupTabBar() {
 
   LightpadTabBar *customTabBar = new LightpadTabBar(this);
@@ -1,7 +1,10 @@
 #ifndef LIGHTPADTABWIDGET_H
 #define LIGHTPADTABWIDGET_H
 
+#include <QJsonObject>
+#include <QList>
 #include <QMap>
+#include <QPointer>
 #include <QTabBar>
 #include <QTabWidget>
 #include <QToolButton>
@@ -12,6 +15,11 @@ const int buttonSize = 25;
 class MainWindow;
 class LightpadPage;
 
+struct DeferredTab {
+  QString filePath;
+  QJsonObject sessionState;
+};
+
 class LightpadTabBar : public QTabBar {
   Q_OBJECT
 
@@ -41,6 +49,8 @@ public:
   void addViewerTab(QWidget *viewer, const QString &filePath);
   void addViewerTab(QWidget *viewer, const QString &filePath,
                     const QString &projectRootPath);
+  void addDeferredTab(const QString &filePath, const QJsonObject &sessionState);
+  LightpadPage *materializeTab(int index);
   void setMainWindow(MainWindow *window);
   void setTheme(const QString &backgroundColor, const QString &foregroundColor,
                 const QString &surfaceColor, const QString &hoverColor,
@@ -52,6 +62,12 @@ public:
   LightpadPage *getCurrentPage();
   QString getFilePath(int index);
   bool isViewerTab(int index) const;
+  bool isDeferredTab(int index) const;
+  QJsonObject deferredTabState(int index) const;
+  bool isBlankPage(int index);
+
+signals:
+  void pageRemoved(LightpadPage *page);
 
 protected:
   void resizeEvent(QResizeEvent *event) override;
@@ -69,11 +85,14 @@ private slots:
   void onRevealInFileExplorer(int index);
 
 private:
+  LightpadPage *createPage();
   void updateCloseButtons();
   void setupTabBar();
   MainWindow *mainWindow;
   QToolButton *newTabButton;
   QMap<QWidget *, QString> m_viewerFilePaths;
+  QMap<QWidget *, DeferredTab> m_deferredTabs;
+  QList<QPointer<QWidget>> m_tabPages;
   QString m_foregroundColor;
   QString m_hoverColor;
   QString m_accentColor;
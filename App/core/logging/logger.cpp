@@ -1,29 +1,144 @@
 #include "logger.h"
 #include <QDebug>
+#include <QThread>
 #include <iostream>
 
+namespace {
+
+qint64 utf8Size(QStringView text) {
+  qint64 size = text.size();
+  for (const QChar c : text) {
+    const char16_t unit = c.unicode();
+    if (unit >= 0x80) {
+      size += unit >= 0x800 && !c.isSurrogate() ? 2 : 1;
+    }
+  }
+  return size;
+}
+
+} // namespace
+
+LogQueue::LogQueue(int capacity)
+    : m_mask(qNextPowerOfTwo(quint32(qMax(capacity, 2) - 1)) - 1),
+      m_enqueuePos(0), m_dequeuePos(0) {
+  m_cells.reset(new Cell[m_mask + 1]);
+  for (quint64 i = 0; i <= m_mask; ++i) {
+    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool LogQueue::tryPush(LogRecord &&record) {
+  quint64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell &cell = m_cells[pos & m_mask];
+    const quint64 sequence = cell.sequence.load(std::memory_order_acquire);
+    const qint64 difference = qint64(sequence) - qint64(pos);
+    if (difference == 0) {
+      if (m_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        cell.record = std::move(record);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (difference < 0) {
+      return false;
+    } else {
+      pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool LogQueue::tryPop(LogRecord *record) {
+  Cell &cell = m_cells[m_dequeuePos & m_mask];
+  const quint64 sequence = cell.sequence.load(std::memory_order_acquire);
+  if (sequence != m_dequeuePos + 1) {
+    return false;
+  }
+  *record = std::move(cell.record);
+  cell.record = LogRecord();
+  cell.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+  ++m_dequeuePos;
+  return true;
+}
+
+bool LogQueue::isEmpty() const {
+  const Cell &cell = m_cells[m_dequeuePos & m_mask];
+  return cell.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1;
+}
+
+class LogWriter : public QThread {
+public:
+  explicit LogWriter(Logger *logger) : m_logger(logger) {}
+
+protected:
+  void run() override {
+    QList<LogRecord> batch;
+    batch.reserve(LOG_WRITER_BATCH);
+    for (;;) {
+      LogRecord record;
+      while (batch.size() < LOG_WRITER_BATCH &&
+             m_logger->m_queue.tryPop(&record)) {
+        batch.append(std::move(record));
+      }
+      if (!batch.isEmpty()) {
+        m_logger->writeRecords(batch);
+        batch.clear();
+        continue;
+      }
+      if (m_logger->m_stopping.load()) {
+        return;
+      }
+
+      m_logger->m_writerWaiting.store(true);
+      if (m_logger->m_queue.isEmpty()) {
+        m_logger->m_wakeup.tryAcquire(1, LOG_WRITER_IDLE_MS);
+      }
+      m_logger->m_writerWaiting.store(false);
+    }
+  }
+
+private:
+  Logger *m_logger;
+};
+
 Logger &Logger::instance() {
   static Logger instance;
   return instance;
 }
 
 Logger::Logger()
-    : m_logLevel(LogLevel::Info), m_fileLoggingEnabled(false),
-      m_consoleLoggingEnabled(true) {}
+    : m_logLevel(static_cast<int>(LogLevel::Info)),
+      m_consoleLoggingEnabled(true), m_fileLoggingEnabled(false),
+      m_logFileBytes(0), m_rotateBytes(LOG_ROTATE_BYTES),
+      m_rotatedFiles(LOG_ROTATED_FILES), m_queue(LOG_QUEUE_CAPACITY),
+      m_enqueued(0), m_reportedDropped(0), m_writerWaiting(false),
+      m_stopping(false), m_written(0), m_writer(nullptr) {
+  for (auto &dropped : m_dropped) {
+    dropped.store(0);
+  }
+  m_writer = new LogWriter(this);
+  m_writer->start(QThread::LowPriority);
+}
 
-Logger::~Logger() { shutdown(); }
+Logger::~Logger() {
+  m_stopping.store(true);
+  m_wakeup.release();
+  m_writer->wait();
+  delete m_writer;
+  m_writer = nullptr;
+  shutdown();
+}
 
 void Logger::setLogLevel(LogLevel level) {
-  QMutexLocker locker(&m_mutex);
-  m_logLevel = level;
+  m_logLevel.store(static_cast<int>(level));
 }
 
 LogLevel Logger::logLevel() const {
-  QMutexLocker locker(&m_mutex);
-  return m_logLevel;
+  return static_cast<LogLevel>(m_logLevel.load());
 }
 
 void Logger::setFileLoggingEnabled(bool enabled, const QString &filePath) {
+  flush();
   QMutexLocker locker(&m_mutex);
 
   if (enabled && !m_fileLoggingEnabled) {
@@ -39,6 +154,7 @@ void Logger::setFileLoggingEnabled(bool enabled, const QString &filePath) {
     if (m_logFile.open(QIODevice::WriteOnly | QIODevice::Append |
                        QIODevice::Text)) {
       m_logStream.setDevice(&m_logFile);
+      m_logFileBytes = m_logFile.size();
       m_fileLoggingEnabled = true;
     }
   } else if (!enabled && m_fileLoggingEnabled) {
@@ -54,13 +170,17 @@ bool Logger::isFileLoggingEnabled() const {
 }
 
 void Logger::setConsoleLoggingEnabled(bool enabled) {
-  QMutexLocker locker(&m_mutex);
-  m_consoleLoggingEnabled = enabled;
+  m_consoleLoggingEnabled.store(enabled);
 }
 
 bool Logger::isConsoleLoggingEnabled() const {
+  return m_consoleLoggingEnabled.load();
+}
+
+void Logger::setRotation(qint64 maxBytes, int maxFiles) {
   QMutexLocker locker(&m_mutex);
-  return m_consoleLoggingEnabled;
+  m_rotateBytes = maxBytes;
+  m_rotatedFiles = qMax(0, maxFiles);
 }
 
 void Logger::debug(const QString &message, const char *file, int line) {
@@ -79,7 +199,33 @@ void Logger::error(const QString &message, const char *file, int line) {
   log(LogLevel::Error, message, file, line);
 }
 
+void Logger::flush() {
+  if (!m_writer || QThread::currentThread() == m_writer) {
+    return;
+  }
+
+  const quint64 target = m_enqueued.load();
+  m_wakeup.release();
+  QMutexLocker locker(&m_progressMutex);
+  while (m_written < target && m_writer->isRunning()) {
+    m_progress.wait(&m_progressMutex, LOG_WRITER_IDLE_MS);
+  }
+}
+
+quint64 Logger::droppedCount() const {
+  quint64 total = 0;
+  for (const auto &dropped : m_dropped) {
+    total += dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+quint64 Logger::droppedCount(LogLevel level) const {
+  return m_dropped[static_cast<int>(level)].load(std::memory_order_relaxed);
+}
+
 void Logger::shutdown() {
+  flush();
   QMutexLocker locker(&m_mutex);
   if (m_fileLoggingEnabled) {
     m_logStream.flush();
@@ -90,32 +236,64 @@ void Logger::shutdown() {
 
 void Logger::log(LogLevel level, const QString &message, const char *file,
                  int line) {
-  if (level < m_logLevel) {
+  if (!isEnabled(level)) {
     return;
   }
 
-  QMutexLocker locker(&m_mutex);
+  LogRecord record;
+  record.level = level;
+  record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+  record.file = file;
+  record.line = line;
+  record.message = message;
 
-  QString timestamp =
-      QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-  QString levelStr = levelToString(level);
-
-  QString logMessage;
-  if (file && line > 0) {
-    QString fileName = QFileInfo(file).fileName();
-    logMessage = QString("[%1] [%2] [%3:%4] %5")
-                     .arg(timestamp)
-                     .arg(levelStr)
-                     .arg(fileName)
-                     .arg(line)
-                     .arg(message);
-  } else {
-    logMessage =
-        QString("[%1] [%2] %3").arg(timestamp).arg(levelStr).arg(message);
+  if (!m_writer) {
+    writeRecords({record});
+    return;
+  }
+
+  if (!m_queue.tryPush(std::move(record))) {
+    m_dropped[static_cast<int>(level)].fetch_add(1, std::memory_order_relaxed);
+    return;
   }
+  m_enqueued.fetch_add(1, std::memory_order_release);
+  if (m_writerWaiting.exchange(false)) {
+    m_wakeup.release();
+  }
+}
+
+void Logger::writeRecords(const QList<LogRecord> &records) {
+  {
+    QMutexLocker locker(&m_mutex);
+    const quint64 dropped = droppedCount();
+    if (dropped != m_reportedDropped) {
+      LogRecord notice;
+      notice.level = LogLevel::Warning;
+      notice.timestampMs = QDateTime::currentMSecsSinceEpoch();
+      notice.message = QString("%1 log messages dropped (queue full)")
+                           .arg(dropped - m_reportedDropped);
+      m_reportedDropped = dropped;
+      writeRecord(notice);
+    }
+
+    for (const LogRecord &record : records) {
+      writeRecord(record);
+    }
+    if (m_fileLoggingEnabled) {
+      m_logStream.flush();
+    }
+  }
+
+  QMutexLocker locker(&m_progressMutex);
+  m_written += records.size();
+  m_progress.wakeAll();
+}
+
+void Logger::writeRecord(const LogRecord &record) {
+  const QString logMessage = formatRecord(record);
 
-  if (m_consoleLoggingEnabled) {
-    switch (level) {
+  if (m_consoleLoggingEnabled.load(std::memory_order_relaxed)) {
+    switch (record.level) {
     case LogLevel::Debug:
       qDebug().noquote() << logMessage;
       break;
@@ -132,12 +310,64 @@ void Logger::log(LogLevel level, const QString &message, const char *file,
   }
 
   if (m_fileLoggingEnabled && m_logFile.isOpen()) {
+    rotateIfNeeded();
     m_logStream << logMessage << "\n";
-    m_logStream.flush();
+    m_logFileBytes += utf8Size(logMessage) + 1;
+  }
+}
+
+void Logger::rotateIfNeeded() {
+  if (m_rotateBytes <= 0 || m_logFileBytes < m_rotateBytes) {
+    return;
+  }
+
+  const QString path = m_logFile.fileName();
+  m_logStream.flush();
+  m_logFile.close();
+
+  for (int i = m_rotatedFiles - 1; i >= 1; --i) {
+    const QString from = QString("%1.%2").arg(path).arg(i);
+    const QString to = QString("%1.%2").arg(path).arg(i + 1);
+    QFile::remove(to);
+    QFile::rename(from, to);
+  }
+  if (m_rotatedFiles > 0) {
+    const QString first = path + ".1";
+    QFile::remove(first);
+    QFile::rename(path, first);
+  }
+
+  m_logFile.setFileName(path);
+  if (m_logFile.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                     QIODevice::Text)) {
+    m_logStream.setDevice(&m_logFile);
+  } else {
+    m_fileLoggingEnabled = false;
+  }
+  m_logFileBytes = 0;
+}
+
+QString Logger::formatRecord(const LogRecord &record) {
+  const QString timestamp = QDateTime::fromMSecsSinceEpoch(record.timestampMs)
+                                .toString("yyyy-MM-dd hh:mm:ss.zzz");
+  const QString levelStr = levelToString(record.level);
+
+  if (record.file && record.line > 0) {
+    QString fileName = QFileInfo(record.file).fileName();
+    return QString("[%1] [%2] [%3:%4] %5")
+        .arg(timestamp)
+        .arg(levelStr)
+        .arg(fileName)
+        .arg(record.line)
+        .arg(record.message);
   }
+  return QString("[%1] [%2] %3")
+      .arg(timestamp)
+      .arg(levelStr)
+      .arg(record.message);
 }
 
-QString Logger::levelToString(LogLevel level) const {
+QString Logger::levelToString(LogLevel level) {
   switch (level) {
   case LogLevel::Debug:
     return "DEBUG";
@@ -4,13 +4,60 @@
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QList>
 #include <QMutex>
+#include <QSemaphore>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
 
 enum class LogLevel { Debug, Info, Warning, Error };
 
+constexpr int LOG_LEVEL_COUNT = 4;
+constexpr int LOG_QUEUE_CAPACITY = 8192;
+constexpr int LOG_WRITER_BATCH = 256;
+constexpr int LOG_WRITER_IDLE_MS = 250;
+constexpr qint64 LOG_ROTATE_BYTES = 5 * 1024 * 1024;
+constexpr int LOG_ROTATED_FILES = 3;
+
+struct LogRecord {
+  LogLevel level = LogLevel::Info;
+  qint64 timestampMs = 0;
+  const char *file = nullptr;
+  int line = 0;
+  QString message;
+};
+
+class LogQueue {
+public:
+  explicit LogQueue(int capacity);
+
+  int capacity() const { return static_cast<int>(m_mask + 1); }
+
+  bool tryPush(LogRecord &&record);
+
+  bool tryPop(LogRecord *record);
+
+  bool isEmpty() const;
+
+private:
+  LogQueue(const LogQueue &) = delete;
+  LogQueue &operator=(const LogQueue &) = delete;
+
+  struct Cell {
+    std::atomic<quint64> sequence;
+    LogRecord record;
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  quint64 m_mask;
+  alignas(64) std::atomic<quint64> m_enqueuePos;
+  alignas(64) quint64 m_dequeuePos;
+};
+
 class Logger {
 public:
   static Logger &instance();
@@ -19,6 +66,11 @@ public:
 
   LogLevel logLevel() const;
 
+  bool isEnabled(LogLevel level) const {
+    return static_cast<int>(level) >=
+           m_logLevel.load(std::memory_order_relaxed);
+  }
+
   void setFileLoggingEnabled(bool enabled, const QString &filePath = QString());
 
   bool isFileLoggingEnabled() const;
@@ -27,6 +79,8 @@ public:
 
   bool isConsoleLoggingEnabled() const;
 
+  void setRotation(qint64 maxBytes, int maxFiles);
+
   void debug(const QString &message, const char *file = nullptr, int line = 0);
 
   void info(const QString &message, const char *file = nullptr, int line = 0);
@@ -36,29 +90,64 @@ public:
 
   void error(const QString &message, const char *file = nullptr, int line = 0);
 
+  void flush();
+
+  quint64 droppedCount() const;
+
+  quint64 droppedCount(LogLevel level) const;
+
+  static QString formatRecord(const LogRecord &record);
+
   void shutdown();
 
 private:
+  friend class LogWriter;
+
   Logger();
   ~Logger();
   Logger(const Logger &) = delete;
   Logger &operator=(const Logger &) = delete;
 
   void log(LogLevel level, const QString &message, const char *file, int line);
-  QString levelToString(LogLevel level) const;
+  void writeRecords(const QList<LogRecord> &records);
+  void writeRecord(const LogRecord &record);
+  void rotateIfNeeded();
+  static QString levelToString(LogLevel level);
   QString getDefaultLogPath() const;
 
-  LogLevel m_logLevel;
+  std::atomic<int> m_logLevel;
+  std::atomic<bool> m_consoleLoggingEnabled;
   bool m_fileLoggingEnabled;
-  bool m_consoleLoggingEnabled;
   QFile m_logFile;
   QTextStream m_logStream;
+  qint64 m_logFileBytes;
+  qint64 m_rotateBytes;
+  int m_rotatedFiles;
   mutable QMutex m_mutex;
+
+  LogQueue m_queue;
+  std::atomic<quint64> m_enqueued;
+  std::atomic<quint64> m_dropped[LOG_LEVEL_COUNT];
+  quint64 m_reportedDropped;
+  std::atomic<bool> m_writerWaiting;
+  std::atomic<bool> m_stopping;
+  QSemaphore m_wakeup;
+  QMutex m_progressMutex;
+  QWaitCondition m_progress;
+  quint64 m_written;
+  class LogWriter *m_writer;
 };
 
-#define LOG_DEBUG(msg) Logger::instance().debug(msg, __FILE__, __LINE__)
-#define LOG_INFO(msg) Logger::instance().info(msg, __FILE__, __LINE__)
-#define LOG_WARNING(msg) Logger::instance().warning(msg, __FILE__, __LINE__)
-#define LOG_ERROR(msg) Logger::instance().error(msg, __FILE__, __LINE__)
+#define LOG_AT_LEVEL(level, method, msg)                                       \
+  do {                                                                         \
+    if (Logger::instance().isEnabled(level)) {                                 \
+      Logger::instance().method(msg, __FILE__, __LINE__);                      \
+    }                                                                          \
+  } while (0)
+
+#define LOG_DEBUG(msg) LOG_AT_LEVEL(LogLevel::Debug, debug, msg)
+#define LOG_INFO(msg) LOG_AT_LEVEL(LogLevel::Info, info, msg)
+#define LOG_WARNING(msg) LOG_AT_LEVEL(LogLevel::Warning, warning, msg)
+#define LOG_ERROR(msg) LOG_AT_LEVEL(LogLevel::Error, error, msg)
 
 #endif
@@ -0,0 +1,159 @@
+#include "paintprofiler.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+QHash<QString, qint64> mergeByName(const QHash<const char *, qint64> &values) {
+  QHash<QString, qint64> merged;
+  for (auto it = values.cbegin(); it != values.cend(); ++it) {
+    merged[QString::fromLatin1(it.key())] += it.value();
+  }
+  return merged;
+}
+} // namespace
+
+PaintProfiler &PaintProfiler::instance() {
+  static PaintProfiler instance;
+  return instance;
+}
+
+PaintProfiler::PaintProfiler()
+    : QObject(nullptr), m_enabled(false), m_tracing(false), m_frameCount(0) {
+  m_clock.start();
+}
+
+void PaintProfiler::setEnabled(bool enabled) {
+  m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void PaintProfiler::setTracing(bool tracing) {
+  QMutexLocker locker(&m_mutex);
+  m_tracing = tracing;
+}
+
+bool PaintProfiler::isTracing() const {
+  QMutexLocker locker(&m_mutex);
+  return m_tracing;
+}
+
+qint64 PaintProfiler::nowNanoseconds() const { return m_clock.nsecsElapsed(); }
+
+void PaintProfiler::recordScope(const char *name, qint64 startNs,
+                                qint64 durationNs) {
+  QMutexLocker locker(&m_mutex);
+  m_currentFrame[name] += durationNs;
+  if (m_tracing && m_traceEvents.size() < PAINT_PROFILER_MAX_TRACE_EVENTS) {
+    m_traceEvents.append({name, startNs, durationNs,
+                          reinterpret_cast<quintptr>(
+                              QThread::currentThreadId())});
+  }
+}
+
+void PaintProfiler::addCount(const char *name, qint64 delta) {
+  QMutexLocker locker(&m_mutex);
+  m_counters[name] += delta;
+}
+
+void PaintProfiler::finishFrame() {
+  {
+    QMutexLocker locker(&m_mutex);
+    const QHash<QString, qint64> frame = mergeByName(m_currentFrame);
+    m_currentFrame.clear();
+
+    m_lastFrame.clear();
+    for (auto it = frame.cbegin(); it != frame.cend(); ++it) {
+      m_lastFrame.append({it.key(), it.value()});
+    }
+    std::sort(m_lastFrame.begin(), m_lastFrame.end(),
+              [](const QPair<QString, qint64> &a,
+                 const QPair<QString, qint64> &b) {
+                return a.second > b.second;
+              });
+
+    if (m_tracing &&
+        m_counterSamples.size() < PAINT_PROFILER_MAX_TRACE_EVENTS) {
+      m_counterSamples.append({m_clock.nsecsElapsed(), m_counters});
+    }
+    ++m_frameCount;
+  }
+  emit frameFinished();
+}
+
+PaintProfiler::Breakdown PaintProfiler::lastFrame() const {
+  QMutexLocker locker(&m_mutex);
+  return m_lastFrame;
+}
+
+QHash<QString, qint64> PaintProfiler::counters() const {
+  QMutexLocker locker(&m_mutex);
+  return mergeByName(m_counters);
+}
+
+int PaintProfiler::frameCount() const {
+  QMutexLocker locker(&m_mutex);
+  return m_frameCount;
+}
+
+QJsonObject PaintProfiler::chromeTrace() const {
+  QMutexLocker locker(&m_mutex);
+
+  const qint64 pid = QCoreApplication::applicationPid();
+  QJsonArray events;
+  for (const PaintTraceEvent &event : m_traceEvents) {
+    QJsonObject json;
+    json["name"] = QString::fromLatin1(event.name);
+    json["cat"] = "paint";
+    json["ph"] = "X";
+    json["ts"] = event.timestamp / 1000.0;
+    json["dur"] = event.duration / 1000.0;
+    json["pid"] = pid;
+    json["tid"] = static_cast<qint64>(event.thread);
+    events.append(json);
+  }
+
+  for (const auto &sample : m_counterSamples) {
+    QJsonObject args;
+    const QHash<QString, qint64> counters = mergeByName(sample.second);
+    for (auto it = counters.cbegin(); it != counters.cend(); ++it) {
+      args[it.key()] = it.value();
+    }
+    QJsonObject json;
+    json["name"] = "counters";
+    json["ph"] = "C";
+    json["ts"] = sample.first / 1000.0;
+    json["pid"] = pid;
+    json["args"] = args;
+    events.append(json);
+  }
+
+  QJsonObject trace;
+  trace["traceEvents"] = events;
+  trace["displayTimeUnit"] = "ms";
+  return trace;
+}
+
+bool PaintProfiler::writeChromeTrace(const QString &filePath) const {
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+  const QByteArray json =
+      QJsonDocument(chromeTrace()).toJson(QJsonDocument::Compact);
+  return file.write(json) == json.size();
+}
+
+void PaintProfiler::reset() {
+  QMutexLocker locker(&m_mutex);
+  m_currentFrame.clear();
+  m_lastFrame.clear();
+  m_counters.clear();
+  m_traceEvents.clear();
+  m_counterSamples.clear();
+  m_frameCount = 0;
+}
@@ -0,0 +1,122 @@
+#ifndef PAINTPROFILER_H
+#define PAINTPROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+constexpr int PAINT_PROFILER_MAX_TRACE_EVENTS = 200000;
+
+struct PaintTraceEvent {
+  const char *name;
+  qint64 timestamp;
+  qint64 duration;
+  quintptr thread;
+};
+
+class PaintProfiler : public QObject {
+  Q_OBJECT
+
+public:
+  using Breakdown = QVector<QPair<QString, qint64>>;
+
+  static PaintProfiler &instance();
+
+  void setEnabled(bool enabled);
+
+  bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  void setTracing(bool tracing);
+
+  bool isTracing() const;
+
+  qint64 nowNanoseconds() const;
+
+  void recordScope(const char *name, qint64 startNs, qint64 durationNs);
+
+  void addCount(const char *name, qint64 delta = 1);
+
+  void finishFrame();
+
+  Breakdown lastFrame() const;
+
+  QHash<QString, qint64> counters() const;
+
+  int frameCount() const;
+
+  QJsonObject chromeTrace() const;
+
+  bool writeChromeTrace(const QString &filePath) const;
+
+  void reset();
+
+signals:
+  void frameFinished();
+
+private:
+  PaintProfiler();
+  PaintProfiler(const PaintProfiler &) = delete;
+  PaintProfiler &operator=(const PaintProfiler &) = delete;
+
+  std::atomic<bool> m_enabled;
+  bool m_tracing;
+  QElapsedTimer m_clock;
+  mutable QMutex m_mutex;
+  QHash<const char *, qint64> m_currentFrame;
+  Breakdown m_lastFrame;
+  QHash<const char *, qint64> m_counters;
+  QVector<PaintTraceEvent> m_traceEvents;
+  QVector<QPair<qint64, QHash<const char *, qint64>>> m_counterSamples;
+  int m_frameCount;
+};
+
+class PaintProfileScope {
+public:
+  explicit PaintProfileScope(const char *name, bool endsFrame = false)
+      : m_name(name), m_endsFrame(endsFrame),
+        m_start(PaintProfiler::instance().isEnabled()
+                    ? PaintProfiler::instance().nowNanoseconds()
+                    : -1) {}
+
+  ~PaintProfileScope() {
+    if (m_start < 0) {
+      return;
+    }
+    PaintProfiler &profiler = PaintProfiler::instance();
+    profiler.recordScope(m_name, m_start,
+                         profiler.nowNanoseconds() - m_start);
+    if (m_endsFrame) {
+      profiler.finishFrame();
+    }
+  }
+
+private:
+  PaintProfileScope(const PaintProfileScope &) = delete;
+  PaintProfileScope &operator=(const PaintProfileScope &) = delete;
+
+  const char *m_name;
+  bool m_endsFrame;
+  qint64 m_start;
+};
+
+#define PAINT_PROFILE_CONCAT_INNER(a, b) a##b
+#define PAINT_PROFILE_CONCAT(a, b) PAINT_PROFILE_CONCAT_INNER(a, b)
+#define PAINT_PROFILE_SCOPE(name)                                              \
+  PaintProfileScope PAINT_PROFILE_CONCAT(paintProfileScope, __LINE__)(name)
+#define PAINT_PROFILE_FRAME(name)                                              \
+  PaintProfileScope PAINT_PROFILE_CONCAT(paintProfileScope, __LINE__)(name,    \
+                                                                      true)
+#define PAINT_PROFILE_COUNT(name)                                              \
+  do {                                                                         \
+    if (PaintProfiler::instance().isEnabled())                                 \
+      PaintProfiler::instance().addCount(name);                                \
+  } while (false)
+
+#endif
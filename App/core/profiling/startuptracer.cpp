@@ -0,0 +1,218 @@
+#include "startuptracer.h"
+#include "../logging/logger.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QEvent>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QWidget>
+
+#include <algorithm>
+
+namespace {
+QString milliseconds(qint64 nanoseconds) {
+  return QString::number(nanoseconds / 1000000.0, 'f', 1);
+}
+} // namespace
+
+StartupTracer &StartupTracer::instance() {
+  static StartupTracer instance;
+  return instance;
+}
+
+StartupTracer::StartupTracer()
+    : QObject(nullptr), m_enabled(false), m_quitAfterStartup(false) {
+  m_clock.start();
+}
+
+QString StartupTracer::defaultTracePath() {
+  return QDir::temp().filePath("lightpad-startup-trace.json");
+}
+
+void StartupTracer::configure(const QStringList &arguments) {
+  const QString traceFlag = QString::fromLatin1(STARTUP_TRACE_FLAG);
+  m_enabled = false;
+  m_quitAfterStartup = false;
+  m_tracePath.clear();
+  for (const QString &argument : arguments) {
+    if (argument == traceFlag) {
+      m_enabled = true;
+      m_tracePath = defaultTracePath();
+    } else if (argument.startsWith(traceFlag + "=")) {
+      m_enabled = true;
+      m_tracePath = argument.mid(traceFlag.size() + 1);
+    } else if (argument == QLatin1String(STARTUP_QUIT_FLAG)) {
+      m_enabled = true;
+      m_quitAfterStartup = true;
+    }
+  }
+}
+
+QStringList StartupTracer::stripArguments(const QStringList &arguments) {
+  const QString traceFlag = QString::fromLatin1(STARTUP_TRACE_FLAG);
+  QStringList remaining;
+  for (const QString &argument : arguments) {
+    if (argument != traceFlag && !argument.startsWith(traceFlag + "=") &&
+        argument != QLatin1String(STARTUP_QUIT_FLAG)) {
+      remaining.append(argument);
+    }
+  }
+  return remaining;
+}
+
+void StartupTracer::recordPhase(const char *name, qint64 startNs,
+                                qint64 durationNs) {
+  if (m_enabled) {
+    m_phases.append({name, startNs, durationNs});
+  }
+}
+
+void StartupTracer::mark(const char *name) {
+  if (m_enabled) {
+    m_marks.append({name, nowNanoseconds()});
+  }
+}
+
+qint64 StartupTracer::markNanoseconds(const char *name) const {
+  for (const auto &mark : m_marks) {
+    if (qstrcmp(mark.first, name) == 0) {
+      return mark.second;
+    }
+  }
+  return -1;
+}
+
+void StartupTracer::watchWindow(QWidget *window) {
+  if (!m_enabled || !window || m_window) {
+    return;
+  }
+  m_window = window;
+  QCoreApplication::instance()->installEventFilter(this);
+}
+
+bool StartupTracer::eventFilter(QObject *watched, QEvent *event) {
+  if (event->type() == QEvent::Paint && m_window) {
+    auto *widget = qobject_cast<QWidget *>(watched);
+    if (widget && widget->window() == m_window) {
+      QCoreApplication::instance()->removeEventFilter(this);
+      mark(STARTUP_FIRST_PAINT_MARK);
+      QTimer::singleShot(0, this, &StartupTracer::finish);
+    }
+  }
+  return QObject::eventFilter(watched, event);
+}
+
+void StartupTracer::finish() {
+  mark(STARTUP_INTERACTIVE_MARK);
+  LOG_INFO("Startup timeline:\n" + timeline());
+  if (!m_tracePath.isEmpty()) {
+    if (writeChromeTrace(m_tracePath)) {
+      LOG_INFO(QString("Startup trace written to %1").arg(m_tracePath));
+    } else {
+      LOG_WARNING(
+          QString("Cannot write startup trace to %1").arg(m_tracePath));
+    }
+  }
+  m_enabled = false;
+  emit interactive();
+
+  if (m_quitAfterStartup) {
+    QTimer::singleShot(0, QCoreApplication::instance(),
+                       &QCoreApplication::quit);
+  }
+}
+
+QString StartupTracer::timeline() const {
+  QList<StartupPhase> sorted = m_phases;
+  std::sort(sorted.begin(), sorted.end(),
+            [](const StartupPhase &a, const StartupPhase &b) {
+              if (a.startNs != b.startNs) {
+                return a.startNs < b.startNs;
+              }
+              return a.durationNs > b.durationNs;
+            });
+
+  QStringList lines;
+  QList<qint64> openEnds;
+  for (const StartupPhase &phase : sorted) {
+    while (!openEnds.isEmpty() && phase.startNs >= openEnds.last()) {
+      openEnds.removeLast();
+    }
+    lines.append(QString("%1%2  %3 ms  (at %4 ms)")
+                     .arg(QString(openEnds.size() * 2, QLatin1Char(' ')),
+                          QString::fromLatin1(phase.name),
+                          milliseconds(phase.durationNs),
+                          milliseconds(phase.startNs)));
+    openEnds.append(phase.startNs + phase.durationNs);
+  }
+  for (const auto &mark : m_marks) {
+    lines.append(QString("%1 at %2 ms")
+                     .arg(QString::fromLatin1(mark.first),
+                          milliseconds(mark.second)));
+  }
+  return lines.join('\n');
+}
+
+QJsonObject StartupTracer::chromeTrace() const {
+  const qint64 pid = QCoreApplication::applicationPid();
+  QJsonArray events;
+  for (const StartupPhase &phase : m_phases) {
+    QJsonObject json;
+    json["name"] = QString::fromLatin1(phase.name);
+    json["cat"] = "startup";
+    json["ph"] = "X";
+    json["ts"] = phase.startNs / 1000.0;
+    json["dur"] = phase.durationNs / 1000.0;
+    json["pid"] = pid;
+    json["tid"] = 0;
+    events.append(json);
+  }
+
+  for (const auto &mark : m_marks) {
+    QJsonObject json;
+    json["name"] = QString::fromLatin1(mark.first);
+    json["cat"] = "startup";
+    json["ph"] = "i";
+    json["s"] = "g";
+    json["ts"] = mark.second / 1000.0;
+    json["pid"] = pid;
+    json["tid"] = 0;
+    events.append(json);
+  }
+
+  QJsonObject otherData;
+  const qint64 firstPaintNs = markNanoseconds(STARTUP_FIRST_PAINT_MARK);
+  if (firstPaintNs >= 0) {
+    otherData["firstPaintMs"] = firstPaintNs / 1000000.0;
+  }
+  const qint64 interactiveNs = markNanoseconds(STARTUP_INTERACTIVE_MARK);
+  if (interactiveNs >= 0) {
+    otherData["interactiveMs"] = interactiveNs / 1000000.0;
+  }
+
+  QJsonObject trace;
+  trace["traceEvents"] = events;
+  trace["displayTimeUnit"] = "ms";
+  trace["otherData"] = otherData;
+  return trace;
+}
+
+bool StartupTracer::writeChromeTrace(const QString &filePath) const {
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+  const QByteArray json =
+      QJsonDocument(chromeTrace()).toJson(QJsonDocument::Compact);
+  return file.write(json) == json.size();
+}
+
+void StartupTracer::reset() {
+  m_phases.clear();
+  m_marks.clear();
+  m_window.clear();
+  m_clock.restart();
+}
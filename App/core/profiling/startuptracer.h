@@ -0,0 +1,116 @@
+#ifndef STARTUPTRACER_H
+#define STARTUPTRACER_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+
+class QWidget;
+
+constexpr auto STARTUP_TRACE_FLAG = "--trace-startup";
+constexpr auto STARTUP_QUIT_FLAG = "--quit-after-startup";
+constexpr auto STARTUP_FIRST_PAINT_MARK = "first-paint";
+constexpr auto STARTUP_INTERACTIVE_MARK = "interactive";
+
+struct StartupPhase {
+  const char *name;
+  qint64 startNs;
+  qint64 durationNs;
+};
+
+class StartupTracer : public QObject {
+  Q_OBJECT
+
+public:
+  static StartupTracer &instance();
+
+  static QString defaultTracePath();
+
+  void configure(const QStringList &arguments);
+
+  static QStringList stripArguments(const QStringList &arguments);
+
+  void setEnabled(bool enabled) { m_enabled = enabled; }
+
+  bool isEnabled() const { return m_enabled; }
+
+  QString tracePath() const { return m_tracePath; }
+
+  bool quitAfterStartup() const { return m_quitAfterStartup; }
+
+  qint64 nowNanoseconds() const { return m_clock.nsecsElapsed(); }
+
+  void recordPhase(const char *name, qint64 startNs, qint64 durationNs);
+
+  void mark(const char *name);
+
+  qint64 markNanoseconds(const char *name) const;
+
+  void watchWindow(QWidget *window);
+
+  QList<StartupPhase> phases() const { return m_phases; }
+
+  QString timeline() const;
+
+  QJsonObject chromeTrace() const;
+
+  bool writeChromeTrace(const QString &filePath) const;
+
+  void reset();
+
+signals:
+  void interactive();
+
+protected:
+  bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+  StartupTracer();
+  StartupTracer(const StartupTracer &) = delete;
+  StartupTracer &operator=(const StartupTracer &) = delete;
+
+  void finish();
+
+  bool m_enabled;
+  bool m_quitAfterStartup;
+  QString m_tracePath;
+  QElapsedTimer m_clock;
+  QList<StartupPhase> m_phases;
+  QList<QPair<const char *, qint64>> m_marks;
+  QPointer<QWidget> m_window;
+};
+
+class StartupTraceScope {
+public:
+  explicit StartupTraceScope(const char *name)
+      : m_name(name), m_start(StartupTracer::instance().isEnabled()
+                                  ? StartupTracer::instance().nowNanoseconds()
+                                  : -1) {}
+
+  ~StartupTraceScope() {
+    if (m_start < 0) {
+      return;
+    }
+    StartupTracer &tracer = StartupTracer::instance();
+    tracer.recordPhase(m_name, m_start, tracer.nowNanoseconds() - m_start);
+  }
+
+private:
+  StartupTraceScope(const StartupTraceScope &) = delete;
+  StartupTraceScope &operator=(const StartupTraceScope &) = delete;
+
+  const char *m_name;
+  qint64 m_start;
+};
+
+#define STARTUP_TRACE_CONCAT_INNER(a, b) a##b
+#define STARTUP_TRACE_CONCAT(a, b) STARTUP_TRACE_CONCAT_INNER(a, b)
+#define STARTUP_TRACE_SCOPE(name)                                              \
+  StartupTraceScope STARTUP_TRACE_CONCAT(startupTraceScope, __LINE__)(name)
+
+#endif
@@ -3,6 +3,7 @@
 #include <QBoxLayout>
 #include <QCompleter>
 #include <QDialog>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QInputDialog>
 #include <QMenu>
@@ -18,6 +19,7 @@
 #include <QTextCursor>
 #include <QTextEdit>
 #include <QTimer>
+#include <QUrl>
 #include <QtGlobal>
 #include <algorithm>
 #include <functional>
@@ -27,6 +29,7 @@
 #include "../completion/completionitem.h"
 #include "../completion/completionwidget.h"
 #include "../dap/breakpointmanager.h"
+#include "../git/gitdifftracker.h"
 #include "../git/gitintegration.h"
 #include "../language/languagecatalog.h"
 #include "../settings/textareasettings.h"
@@ -35,13 +38,17 @@
 #include "../test_templates/testfileclassifier.h"
 #include "../theme/themeengine.h"
 #include "../ui/mainwindow.h"
+#include "editor/blockmetadata.h"
+#include "editor/bracketindex.h"
 #include "editor/codefolding.h"
+#include "editor/decorationstore.h"
 #include "editor/linenumberarea.h"
 #include "editor/multicursor.h"
 #include "editor/texttransforms.h"
 #include "lightpadpage.h"
 #include "lightpadtabwidget.h"
 #include "logging/logger.h"
+#include "profiling/paintprofiler.h"
 #include "textarea.h"
 
 QMap<QChar, QChar> brackets = {{'{', '}'}, {'(', ')'}, {'[', ']'}};
@@ -96,47 +103,6 @@ private:
 QIcon TextArea::s_unsavedIcon;
 bool TextArea::s_iconsInitialized = false;
 
-static int findClosingParentheses(const QString &text, int pos, QChar startStr,
-                                  QChar endStr) {
-
-  int counter = 1;
-
-  while (counter > 0 && pos < text.size() - 1) {
-    auto chr = text[++pos];
-    if (chr == startStr)
-      counter++;
-
-    else if (chr == endStr)
-      counter--;
-  }
-
-  if (counter != 0)
-    return -1;
-
-  return pos;
-}
-
-static int findOpeningParentheses(const QString &text, int pos, QChar startStr,
-                                  QChar endStr) {
-
-  int counter = 1;
-  pos--;
-
-  while (counter > 0 && pos > 0) {
-    auto chr = text[--pos];
-    if (chr == startStr)
-      counter--;
-
-    else if (chr == endStr)
-      counter++;
-  }
-
-  if (counter != 0)
-    return -1;
-
-  return ++pos;
-}
-
 static int leadingSpaces(const QString &str, int tabWidth) {
 
   int n = 0;
@@ -246,7 +212,7 @@ TextArea::TextArea(QWidget *parent)
       m_codeLensEnabled(false), m_debugExecutionLine(0) {
   initializeIconCache();
   m_multiCursor = new MultiCursorHandler(this);
-  m_codeFolding = new CodeFoldingManager(document());
+  m_codeFolding = std::make_shared<CodeFoldingManager>(document());
   m_vimMode = new VimMode(this, this);
   mainFont = QApplication::font();
   QPlainTextEdit::setFont(mainFont);
@@ -288,7 +254,7 @@ TextArea::TextArea(const TextAreaSettings &settings, QWidget *parent)
       m_codeLensEnabled(false), m_debugExecutionLine(0) {
   initializeIconCache();
   m_multiCursor = new MultiCursorHandler(this);
-  m_codeFolding = new CodeFoldingManager(document());
+  m_codeFolding = std::make_shared<CodeFoldingManager>(document());
   m_vimMode = new VimMode(this, this);
   mainFont = settings.mainFont;
   QPlainTextEdit::setFont(mainFont);
@@ -325,13 +291,7 @@ void TextArea::setupTextArea() {
     }
   });
 
-  connect(document(), &QTextDocument::undoCommandAdded, this, [&] {
-    if (!areChangesUnsaved) {
-
-      setTabWidgetIcon(s_unsavedIcon);
-      areChangesUnsaved = true;
-    }
-  });
+  connectDocumentSignals();
 
   connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int) {
     static bool updateScheduled = false;
@@ -340,6 +300,10 @@ void TextArea::setupTextArea() {
       QTimer::singleShot(16, this, [this]() {
         updateScheduled = false;
         updateHighlighterViewport();
+        if (!DecorationStore::forDocument(document())->isEmpty(
+                DecorationKind::Diagnostic)) {
+          scheduleExtraSelectionsRefresh();
+        }
       });
     }
   });
@@ -375,6 +339,58 @@ void TextArea::setupTextArea() {
   clearLineHighlight();
 }
 
+void TextArea::connectDocumentSignals() {
+  connect(document(), &QTextDocument::undoCommandAdded, this, [this] {
+    if (!areChangesUnsaved) {
+
+      setTabWidgetIcon(s_unsavedIcon);
+      areChangesUnsaved = true;
+    }
+  });
+
+  connect(document(), &QTextDocument::modificationChanged, this,
+          [this](bool modified) {
+            if (!modified && areChangesUnsaved) {
+              removeIconUnsaved();
+            }
+          });
+
+  connect(document()->documentLayout(), &QAbstractTextDocumentLayout::update,
+          this, [] { PAINT_PROFILE_COUNT("layoutPasses"); });
+}
+
+void TextArea::shareDocumentWith(TextArea *source) {
+  if (!source || source == this || source->document() == document()) {
+    return;
+  }
+
+  document()->disconnect(this);
+  setDocument(source->document());
+  connectDocumentSignals();
+
+  m_codeFolding = source->m_codeFolding;
+  syntaxHighlighter = source->documentHighlighter();
+  highlightLang = source->highlightLang;
+  searchWord = source->searchWord;
+  m_languageId = source->m_languageId;
+  if (m_completionEngine) {
+    m_completionEngine->setLanguage(m_languageId);
+  }
+  areChangesUnsaved = source->areChangesUnsaved;
+
+  updateLineNumberAreaLayout();
+  updateHighlighterViewport();
+  updateExtraSelections();
+}
+
+QSyntaxHighlighter *TextArea::documentHighlighter() const {
+  if (syntaxHighlighter) {
+    return syntaxHighlighter;
+  }
+  return document()->findChild<QSyntaxHighlighter *>(
+      QString(), Qt::FindDirectChildrenOnly);
+}
+
 void TextArea::applyLineSpacing(int percent) {
   if (auto *layout =
           dynamic_cast<LineSpacingLayout *>(document()->documentLayout())) {
@@ -528,9 +544,75 @@ QString TextArea::getSearchWord() { return searchWord; }
 
 bool TextArea::changesUnsaved() { return areChangesUnsaved; }
 
+void TextArea::beginLoading() {
+  m_loading = true;
+  setReadOnly(true);
+  document()->setUndoRedoEnabled(false);
+  m_loadQueue.clear();
+  m_loadOffset = 0;
+  clear();
+}
+
+void TextArea::appendLoadedText(const QString &text) {
+  m_loadQueue.append(text);
+  scheduleLoadedTextInsert();
+}
+
+void TextArea::scheduleLoadedTextInsert() {
+  if (m_loadInsertPending) {
+    return;
+  }
+  m_loadInsertPending = true;
+  QTimer::singleShot(0, this, [this]() {
+    m_loadInsertPending = false;
+    insertLoadedText();
+  });
+}
+
+void TextArea::insertLoadedText() {
+  QElapsedTimer elapsed;
+  elapsed.start();
+  QTextCursor cursor(document());
+  cursor.movePosition(QTextCursor::End);
+  while (!m_loadQueue.isEmpty() &&
+         !elapsed.hasExpired(TEXTAREA_LOAD_SLICE_MS)) {
+    const QString &chunk = m_loadQueue.first();
+    int length = qMin(TEXTAREA_LOAD_SLICE_CHARS,
+                      static_cast<int>(chunk.size()) - m_loadOffset);
+    if (m_loadOffset + length < chunk.size() &&
+        chunk.at(m_loadOffset + length - 1).isHighSurrogate()) {
+      --length;
+    }
+    cursor.insertText(chunk.mid(m_loadOffset, length));
+    m_loadOffset += length;
+    if (m_loadOffset >= chunk.size()) {
+      m_loadQueue.removeFirst();
+      m_loadOffset = 0;
+      emit loadedTextInserted();
+    }
+  }
+  if (!m_loadQueue.isEmpty()) {
+    scheduleLoadedTextInsert();
+  }
+}
+
+void TextArea::finishLoading() {
+  m_loadQueue.clear();
+  m_loadOffset = 0;
+  document()->setUndoRedoEnabled(true);
+  document()->setModified(false);
+  setReadOnly(false);
+  m_loading = false;
+  emit loadingFinished();
+}
+
 void TextArea::resizeEvent(QResizeEvent *e) {
   QPlainTextEdit::resizeEvent(e);
   updateLineNumberAreaLayout();
+  if (!DecorationStore::forDocument(document())->isEmpty(
+          DecorationKind::Diagnostic)) {
+    scheduleExtraSelectionsRefresh();
+  }
 }
 
 void TextArea::focusOutEvent(QFocusEvent *event) {
@@ -546,6 +628,11 @@ void TextArea::keyPressEvent(QKeyEvent *keyEvent) {
     return;
   }
 
+  if (m_loading) {
+    QPlainTextEdit::keyPressEvent(keyEvent);
+    return;
+  }
+
   if (m_vimMode && m_vimMode->isEnabled() &&
       m_vimMode->processKeyEvent(keyEvent)) {
     return;
@@ -741,31 +828,20 @@ void TextArea::keyPressEvent(QKeyEvent *keyEvent) {
   if (hasMultipleCursors() && !keyEvent->text().isEmpty() &&
       keyEvent->modifiers() == Qt::NoModifier) {
 
-    QString text = keyEvent->text();
-    applyToAllCursors(
-        [&text](QTextCursor &cursor) { cursor.insertText(text); });
+    m_multiCursor->insertText(keyEvent->text());
+    drawExtraCursors();
     return;
   }
 
   if (hasMultipleCursors() && keyEvent->key() == Qt::Key_Backspace) {
-    applyToAllCursors([](QTextCursor &cursor) {
-      if (!cursor.hasSelection()) {
-        cursor.deletePreviousChar();
-      } else {
-        cursor.removeSelectedText();
-      }
-    });
+    m_multiCursor->deletePreviousChar();
+    drawExtraCursors();
     return;
   }
 
   if (hasMultipleCursors() && keyEvent->key() == Qt::Key_Delete) {
-    applyToAllCursors([](QTextCursor &cursor) {
-      if (!cursor.hasSelection()) {
-        cursor.deleteChar();
-      } else {
-        cursor.removeSelectedText();
-      }
-    });
+    m_multiCursor->deleteChar();
+    drawExtraCursors();
     return;
   }
 
@@ -827,6 +903,7 @@ void TextArea::keyPressEvent(QKeyEvent *keyEvent) {
     m_lastCompletionRequestPosition = cursor.position();
     CompletionContext ctx;
     ctx.documentUri = getDocumentUri();
+    ctx.document = document();
     ctx.languageId = m_languageId;
     ctx.prefix = completionPrefix;
     ctx.line = cursor.blockNumber();
@@ -1137,38 +1214,36 @@ void TextArea::updateRowColDisplay() {
 }
 
 void TextArea::drawMatchingBrackets() {
-  auto _drawMatchingBrackets =
-      [&](QTextCursor::MoveOperation op, const QChar &startStr,
-          const QChar &endStr,
-          std::function<int(const QString &, int, QChar, QChar)> function) {
-        QList<QTextEdit::ExtraSelection> extraSelections;
-
-        if (lineHighlighted) {
-          extraSelections = this->extraSelections();
-          while (extraSelections.size() > 1)
-            extraSelections.pop_back();
-        }
+  auto _drawMatchingBrackets = [&](QTextCursor::MoveOperation op,
+                                   int bracketPosition) {
+    QList<QTextEdit::ExtraSelection> extraSelections;
+
+    if (lineHighlighted) {
+      extraSelections = this->extraSelections();
+      while (extraSelections.size() > 1)
+        extraSelections.pop_back();
+    }
 
-        QTextEdit::ExtraSelection selection;
+    QTextEdit::ExtraSelection selection;
 
-        selection.format.setForeground(QColor("yellow"));
+    selection.format.setForeground(QColor("yellow"));
 
-        selection.cursor = textCursor();
-        selection.cursor.clearSelection();
-        selection.cursor.movePosition(op, QTextCursor::KeepAnchor);
-        extraSelections.append(selection);
+    selection.cursor = textCursor();
+    selection.cursor.clearSelection();
+    selection.cursor.movePosition(op, QTextCursor::KeepAnchor);
+    extraSelections.append(selection);
 
-        auto plainText = toPlainText();
-        auto pos =
-            function(plainText, textCursor().position(), startStr, endStr);
+    auto pos = BracketIndex::forDocument(document())
+                   ->findMatchingBracket(bracketPosition);
 
-        if (pos != -1) {
-          selection.cursor.setPosition(pos);
-          selection.cursor.movePosition(op, QTextCursor::KeepAnchor);
-          extraSelections.append(selection);
-          setExtraSelections(extraSelections);
-        }
-      };
+    if (pos != -1) {
+      selection.cursor.setPosition(
+          op == QTextCursor::NextCharacter ? pos : pos + 1);
+      selection.cursor.movePosition(op, QTextCursor::KeepAnchor);
+      extraSelections.append(selection);
+      setExtraSelections(extraSelections);
+    }
+  };
 
   auto cursor = textCursor();
   auto result =
@@ -1181,12 +1256,11 @@ void TextArea::drawMatchingBrackets() {
   auto endStr = result ? cursor.selectedText().front() : QChar(' ');
 
   if (brackets.contains(startStr))
-    _drawMatchingBrackets(QTextCursor::NextCharacter, startStr,
-                          brackets[startStr], &findClosingParentheses);
+    _drawMatchingBrackets(QTextCursor::NextCharacter, textCursor().position());
 
   else if (brackets.values().contains(endStr))
-    _drawMatchingBrackets(QTextCursor::PreviousCharacter, brackets.key(endStr),
-                          endStr, &findOpeningParentheses);
+    _drawMatchingBrackets(QTextCursor::PreviousCharacter,
+                          textCursor().position() - 1);
 }
 
 void TextArea::updateExtraSelections() {
@@ -1257,23 +1331,22 @@ void TextArea::updateExtraSelections() {
     }
   }
 
-  for (const LspDiagnostic &diag : m_diagnostics) {
-    int startLine = diag.range.start.line;
-    int startCol = diag.range.start.character;
-    int endLine = diag.range.end.line;
-    int endCol = diag.range.end.character;
-
-    QTextBlock startBlock = document()->findBlockByNumber(startLine);
-    QTextBlock endBlock = document()->findBlockByNumber(endLine);
+  const DecorationStore *decorations = DecorationStore::forDocument(document());
+  int visibleFrom = 0;
+  int visibleTo = 0;
+  visiblePositionRange(&visibleFrom, &visibleTo);
+  const QVector<Decoration> visibleDiagnostics = decorations->overlapping(
+      DecorationKind::Diagnostic, visibleFrom, visibleTo);
+  for (const Decoration &decoration : visibleDiagnostics) {
+    const LspDiagnosticSeverity severity = decorations->severity(decoration);
+    QTextBlock startBlock = document()->findBlock(decoration.start);
     if (!startBlock.isValid())
       continue;
-    if (!endBlock.isValid())
-      endBlock = startBlock;
 
     QTextEdit::ExtraSelection selection;
 
     QColor underlineColor;
-    switch (diag.severity) {
+    switch (severity) {
     case LspDiagnosticSeverity::Error:
       underlineColor = mainWindow ? mainWindow->getTheme().diagnosticErrorColor
                                   : QColor(231, 76, 60);
@@ -1294,7 +1367,7 @@ void TextArea::updateExtraSelections() {
     }
 
     QTextCharFormat fmt;
-    if (diag.severity == LspDiagnosticSeverity::Hint) {
+    if (severity == LspDiagnosticSeverity::Hint) {
       fmt.setUnderlineStyle(QTextCharFormat::DotLine);
     } else {
       fmt.setUnderlineStyle(QTextCharFormat::WaveUnderline);
@@ -1302,19 +1375,14 @@ void TextArea::updateExtraSelections() {
     fmt.setUnderlineColor(underlineColor);
     selection.format = fmt;
 
-    QTextCursor diagCursor(startBlock);
-    int maxStartCol = qMax(0, startBlock.length() - 1);
-    diagCursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor,
-                            qMin(startCol, maxStartCol));
-    if (startLine == endLine && endCol > startCol) {
-      diagCursor.movePosition(
-          QTextCursor::Right, QTextCursor::KeepAnchor,
-          qMin(endCol - startCol, qMax(0, startBlock.length() - 1 - startCol)));
-    } else if (endLine > startLine) {
-      diagCursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-    } else {
-      diagCursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-    }
+    const int blockEnd = startBlock.position() + startBlock.length() - 1;
+    QTextCursor diagCursor(document());
+    diagCursor.setPosition(decoration.start);
+    diagCursor.setPosition(decoration.end > decoration.start &&
+                                   decoration.end <= blockEnd
+                               ? decoration.end
+                               : blockEnd,
+                           QTextCursor::KeepAnchor);
 
     selection.cursor = diagCursor;
     extraSelections.append(selection);
@@ -1340,37 +1408,31 @@ void TextArea::updateExtraSelections() {
     extraSelections.append(selection);
   }
 
-  constexpr int kBracketScanCharacterLimit = 200000;
-  const bool canScanBrackets =
-      document() && document()->characterCount() <= kBracketScanCharacterLimit;
-  if (matchingBracketsHighlighted && canScanBrackets) {
-    auto addBracketSelection =
-        [&](QTextCursor::MoveOperation op, const QChar &startStr,
-            const QChar &endStr,
-            std::function<int(const QString &, int, QChar, QChar)> function) {
-          QTextEdit::ExtraSelection selection;
-          selection.format.setForeground(QColor("yellow"));
-
-          QTextCursor current = textCursor();
-          current.clearSelection();
-          current.movePosition(op, QTextCursor::KeepAnchor);
-          if (current.selectedText().isEmpty())
-            return;
-
-          selection.cursor = current;
-          extraSelections.append(selection);
-
-          auto plainText = toPlainText();
-          auto pos =
-              function(plainText, textCursor().position(), startStr, endStr);
-          if (pos != -1) {
-            QTextCursor match = textCursor();
-            match.setPosition(pos);
-            match.movePosition(op, QTextCursor::KeepAnchor);
-            selection.cursor = match;
-            extraSelections.append(selection);
-          }
-        };
+  if (matchingBracketsHighlighted && document()) {
+    auto addBracketSelection = [&](QTextCursor::MoveOperation op,
+                                   int bracketPosition) {
+      QTextEdit::ExtraSelection selection;
+      selection.format.setForeground(QColor("yellow"));
+
+      QTextCursor current = textCursor();
+      current.clearSelection();
+      current.movePosition(op, QTextCursor::KeepAnchor);
+      if (current.selectedText().isEmpty())
+        return;
+
+      selection.cursor = current;
+      extraSelections.append(selection);
+
+      auto pos = BracketIndex::forDocument(document())
+                     ->findMatchingBracket(bracketPosition);
+      if (pos != -1) {
+        QTextCursor match = textCursor();
+        match.setPosition(op == QTextCursor::NextCharacter ? pos : pos + 1);
+        match.movePosition(op, QTextCursor::KeepAnchor);
+        selection.cursor = match;
+        extraSelections.append(selection);
+      }
+    };
 
     auto nextCursor = textCursor();
     auto nextResult = nextCursor.movePosition(QTextCursor::NextCharacter,
@@ -1383,11 +1445,10 @@ void TextArea::updateExtraSelections() {
     auto endStr = prevResult ? prevCursor.selectedText().front() : QChar(' ');
 
     if (brackets.contains(startStr))
-      addBracketSelection(QTextCursor::NextCharacter, startStr,
-                          brackets[startStr], &findClosingParentheses);
+      addBracketSelection(QTextCursor::NextCharacter, textCursor().position());
     else if (brackets.values().contains(endStr))
-      addBracketSelection(QTextCursor::PreviousCharacter, brackets.key(endStr),
-                          endStr, &findOpeningParentheses);
+      addBracketSelection(QTextCursor::PreviousCharacter,
+                          textCursor().position() - 1);
   }
 
   setExtraSelections(extraSelections);
@@ -1445,6 +1506,7 @@ void TextArea::updateSyntaxHighlightTags(QString searchKey,
 
   auto colors = mainWindow->getTheme();
 
+  syntaxHighlighter = documentHighlighter();
   if (!languageChanged && syntaxHighlighter) {
     if (auto *pluginHighlighter =
             qobject_cast<PluginBasedSyntaxHighlighter *>(syntaxHighlighter)) {
@@ -1456,24 +1518,27 @@ void TextArea::updateSyntaxHighlightTags(QString searchKey,
     }
 
     if (searchChanged) {
+      PAINT_PROFILE_COUNT("rehighlights");
       syntaxHighlighter->rehighlight();
     }
     updateHighlighterViewport();
     return;
   }
 
-  if (syntaxHighlighter) {
-    delete syntaxHighlighter;
-    syntaxHighlighter = nullptr;
+  const auto highlighters = document()->findChildren<QSyntaxHighlighter *>(
+      QString(), Qt::FindDirectChildrenOnly);
+  for (QSyntaxHighlighter *highlighter : highlighters) {
+    delete highlighter;
   }
 
   auto &registry = SyntaxPluginRegistry::instance();
-  ISyntaxPlugin *plugin = registry.getPluginByLanguageId(highlightLang);
+  std::shared_ptr<const CompiledSyntaxRules> rules =
+      registry.compiledRules(highlightLang);
 
-  if (plugin && document()) {
+  if (rules && document()) {
 
-    auto *pluginHighlighter =
-        new PluginBasedSyntaxHighlighter(plugin, colors, searchKey, document());
+    auto *pluginHighlighter = new PluginBasedSyntaxHighlighter(
+        std::move(rules), colors, searchKey, document());
     syntaxHighlighter = pluginHighlighter;
     updateHighlighterViewport();
     return;
@@ -1482,7 +1547,16 @@ void TextArea::updateSyntaxHighlightTags(QString searchKey,
   updateHighlighterViewport();
 }
 
+void TextArea::visiblePositionRange(int *from, int *to) const {
+  *from = firstVisibleBlock().position();
+  const QTextBlock last = document()->findBlock(
+      cursorForPosition(QPoint(viewport()->width(), viewport()->height()))
+          .position());
+  *to = last.isValid() ? last.position() + last.length() : *from;
+}
+
 void TextArea::updateHighlighterViewport() {
+  syntaxHighlighter = documentHighlighter();
   if (!syntaxHighlighter) {
     return;
   }
@@ -1575,12 +1649,18 @@ void TextArea::setLanguage(const QString &languageId) {
   if (m_completionEngine) {
     m_completionEngine->setLanguage(m_languageId);
   }
+  BracketIndex::forDocument(document())->setLanguage(m_languageId);
 }
 
 QString TextArea::language() const { return m_languageId; }
 
 QString TextArea::getDocumentUri() const {
-  return QString("file://%1").arg(objectName());
+  const QString filePath = resolveFilePath();
+  if (!filePath.isEmpty()) {
+    return QUrl::fromLocalFile(filePath).toString();
+  }
+  return QString("untitled:%1")
+      .arg(reinterpret_cast<quintptr>(document()), 0, 16);
 }
 
 QString TextArea::resolveFilePath() const {
@@ -1614,6 +1694,7 @@ void TextArea::triggerCompletion() {
   CompletionContext ctx;
   m_lastCompletionRequestPosition = cursor.position();
   ctx.documentUri = getDocumentUri();
+  ctx.document = document();
   ctx.languageId = m_languageId;
   ctx.prefix = prefix;
   ctx.line = cursor.blockNumber();
@@ -1627,7 +1708,9 @@ void TextArea::triggerCompletion() {
 
 void TextArea::onCompletionsReady(const QList<CompletionItem> &items) {
   if (m_lastCompletionRequestPosition != textCursor().position()) {
-    hideCompletionPopup();
+    if (m_completionWidget) {
+      m_completionWidget->hide();
+    }
     return;
   }
 
@@ -1697,10 +1780,16 @@ void TextArea::hideCompletionPopup() {
   if (m_completionWidget) {
     m_completionWidget->hide();
   }
+  if (m_completionEngine) {
+    m_completionEngine->clearCandidates(document());
+  }
 }
 
 void TextArea::invalidateCompletionRequest() {
   m_lastCompletionRequestPosition = -1;
+  if (m_completionEngine) {
+    m_completionEngine->clearCandidates(document());
+  }
 }
 
 void TextArea::addCursorAbove() {
@@ -1767,9 +1856,14 @@ void TextArea::applyToAllCursors(
 }
 
 void TextArea::paintEvent(QPaintEvent *event) {
-  QPlainTextEdit::paintEvent(event);
+  PAINT_PROFILE_FRAME("TextArea::paintEvent");
+  {
+    PAINT_PROFILE_SCOPE("QPlainTextEdit::paintEvent");
+    QPlainTextEdit::paintEvent(event);
+  }
 
   if (m_showIndentGuides) {
+    PAINT_PROFILE_SCOPE("TextArea::indentGuides");
     QPainter painter(viewport());
     painter.setPen(QPen(QColor(128, 128, 128, 60), 1, Qt::DotLine));
 
@@ -1777,6 +1871,8 @@ void TextArea::paintEvent(QPaintEvent *event) {
     int spaceWidth = fm.horizontalAdvance(' ');
     int indentWidth = spaceWidth * 4;
 
+    BlockMetadataCache *metadata =
+        BlockMetadataCache::forDocument(document());
     QTextBlock block = firstVisibleBlock();
     int top =
         qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
@@ -1784,24 +1880,14 @@ void TextArea::paintEvent(QPaintEvent *event) {
 
     while (block.isValid() && top <= event->rect().bottom()) {
       if (block.isVisible() && bottom >= event->rect().top()) {
-        QString text = block.text();
-
-        int indent = 0;
-        for (QChar c : text) {
-          if (c == ' ')
-            indent++;
-          else if (c == '\t')
-            indent += 4;
-          else
-            break;
-        }
+        int indent = metadata->facts(block)->indentWidth;
 
         QTextCursor blockStart(block);
         blockStart.setPosition(block.position());
         QRect startRect = cursorRect(blockStart);
         int xOffset = startRect.left();
 
-        int numGuides = indent / 4;
+        int numGuides = indent / BLOCK_METADATA_TAB_WIDTH;
         for (int i = 1; i <= numGuides; ++i) {
           int x = xOffset + (i * indentWidth) - indentWidth;
           painter.drawLine(x, top, x, bottom);
@@ -1815,6 +1901,7 @@ void TextArea::paintEvent(QPaintEvent *event) {
   }
 
   if (m_showWhitespace) {
+    PAINT_PROFILE_SCOPE("TextArea::whitespace");
     QPainter painter(viewport());
     painter.setPen(QPen(QColor(128, 128, 128, 80), 1));
 
@@ -1862,7 +1949,9 @@ void TextArea::paintEvent(QPaintEvent *event) {
     }
   }
 
-  if (m_codeLensEnabled && !m_codeLensEntries.isEmpty()) {
+  DecorationStore *decorations = DecorationStore::forDocument(document());
+  if (m_codeLensEnabled && !decorations->isEmpty(DecorationKind::CodeLens)) {
+    PAINT_PROFILE_SCOPE("TextArea::codeLens");
     QPainter painter(viewport());
     QFont codeLensFont = mainFont;
     codeLensFont.setPointSizeF(mainFont.pointSizeF() * 0.85);
@@ -1871,8 +1960,13 @@ void TextArea::paintEvent(QPaintEvent *event) {
     QColor codeLensColor(160, 160, 160, 180);
     painter.setPen(codeLensColor);
 
-    for (const CodeLensEntry &entry : m_codeLensEntries) {
-      QTextBlock block = document()->findBlockByNumber(entry.line);
+    int visibleFrom = 0;
+    int visibleTo = 0;
+    visiblePositionRange(&visibleFrom, &visibleTo);
+    const QVector<Decoration> lenses = decorations->startingIn(
+        DecorationKind::CodeLens, visibleFrom, visibleTo);
+    for (const Decoration &lens : lenses) {
+      QTextBlock block = document()->findBlock(lens.start);
       if (!block.isValid() || !block.isVisible())
         continue;
 
@@ -1891,17 +1985,21 @@ void TextArea::paintEvent(QPaintEvent *event) {
       int xPos = cursorRect(blockStart).left();
 
       painter.drawText(xPos, yPos, viewport()->width() - xPos, cfm.height(),
-                       Qt::AlignVCenter | Qt::AlignLeft, entry.text);
+                       Qt::AlignVCenter | Qt::AlignLeft,
+                       decorations->text(DecorationKind::CodeLens, lens));
     }
   }
 
-  if (m_inlineBlameEnabled && !m_inlineBlameData.isEmpty()) {
-    int currentLine = textCursor().blockNumber() + 1;
-    auto it = m_inlineBlameData.find(currentLine);
-    if (it != m_inlineBlameData.end()) {
+  if (m_inlineBlameEnabled &&
+      !decorations->isEmpty(DecorationKind::InlineBlame)) {
+    PAINT_PROFILE_SCOPE("TextArea::inlineBlame");
+    QTextBlock block = textCursor().block();
+    const QVector<Decoration> blame =
+        decorations->startingIn(DecorationKind::InlineBlame, block.position(),
+                                block.position() + block.length() - 1);
+    if (!blame.isEmpty()) {
       QPainter painter(viewport());
-      QTextBlock block = document()->findBlockByNumber(currentLine - 1);
-      if (block.isValid() && block.isVisible()) {
+      if (block.isVisible()) {
         QRectF blockGeom =
             blockBoundingGeometry(block).translated(contentOffset());
         QString lineText = block.text();
@@ -1920,12 +2018,15 @@ void TextArea::paintEvent(QPaintEvent *event) {
         ghostFont.setItalic(true);
         painter.setFont(ghostFont);
         painter.drawText(xPos, yPos, viewport()->width() - xPos, fm.height(),
-                         Qt::AlignVCenter | Qt::AlignLeft, it.value());
+                         Qt::AlignVCenter | Qt::AlignLeft,
+                         decorations->text(DecorationKind::InlineBlame,
+                                           blame.first()));
       }
     }
   }
 
   if (m_multiCursor && m_multiCursor->hasMultipleCursors()) {
+    PAINT_PROFILE_SCOPE("TextArea::multiCursor");
     QPainter painter(viewport());
     painter.setPen(QPen(defaultPenColor, 2));
 
@@ -1938,6 +2039,7 @@ void TextArea::paintEvent(QPaintEvent *event) {
   }
 
   if (hasFocus()) {
+    PAINT_PROFILE_SCOPE("TextArea::cursorGlow");
     QPainter glowPainter(viewport());
     glowPainter.setRenderHint(QPainter::Antialiasing, true);
     QRect cr = cursorRect();
@@ -2014,41 +2116,53 @@ void TextArea::mouseReleaseEvent(QMouseEvent *event) {
 void TextArea::foldCurrentBlock() {
   int blockNum = textCursor().blockNumber();
   if (m_codeFolding->foldBlock(blockNum)) {
-    viewport()->update();
-    document()->markContentsDirty(0, document()->characterCount());
+    relayoutFoldChanges();
   }
 }
 
 void TextArea::unfoldCurrentBlock() {
   int blockNum = textCursor().blockNumber();
   if (m_codeFolding->unfoldBlock(blockNum)) {
-    viewport()->update();
-    document()->markContentsDirty(0, document()->characterCount());
+    relayoutFoldChanges();
   }
 }
 
 void TextArea::foldAll() {
   m_codeFolding->foldAll();
-  viewport()->update();
-  document()->markContentsDirty(0, document()->characterCount());
+  relayoutFoldChanges();
 }
 
 void TextArea::unfoldAll() {
   m_codeFolding->unfoldAll();
-  viewport()->update();
-  document()->markContentsDirty(0, document()->characterCount());
+  relayoutFoldChanges();
 }
 
 void TextArea::toggleFoldAtLine(int line) {
   m_codeFolding->toggleFoldAtLine(line);
-  viewport()->update();
-  document()->markContentsDirty(0, document()->characterCount());
+  relayoutFoldChanges();
 }
 
 void TextArea::foldToLevel(int level) {
   m_codeFolding->foldToLevel(level);
+  relayoutFoldChanges();
+}
+
+void TextArea::relayoutFoldChanges() {
   viewport()->update();
-  document()->markContentsDirty(0, document()->characterCount());
+
+  int firstBlock = 0;
+  int lastBlock = 0;
+  if (!m_codeFolding->takeChangedRange(&firstBlock, &lastBlock))
+    return;
+
+  QTextBlock first = document()->findBlockByNumber(firstBlock);
+  QTextBlock last = document()->findBlockByNumber(lastBlock);
+  if (!first.isValid() || !last.isValid())
+    return;
+
+  const int start = first.position();
+  document()->markContentsDirty(start,
+                                last.position() + last.length() - start);
 }
 
 void TextArea::setShowWhitespace(bool show) {
@@ -2123,13 +2237,44 @@ void TextArea::setGutterGitIntegration(GitIntegration *git) {
   }
 }
 
+void TextArea::setGitDiffTracking(GitIntegration *git,
+                                  const QString &filePath) {
+  if (!git || filePath.isEmpty()) {
+    if (m_gitDiffTracker) {
+      m_gitDiffTracker->setGitIntegration(nullptr);
+      m_gitDiffTracker->clearBase();
+    } else {
+      clearGitDiffLines();
+    }
+    return;
+  }
+
+  if (!m_gitDiffTracker) {
+    m_gitDiffTracker = new GitDiffTracker(document(), this);
+    connect(m_gitDiffTracker, &GitDiffTracker::diffChanged, this,
+            [this](const QList<QPair<int, int>> &gutterLines) {
+              setGitDiffLines(gutterLines);
+            });
+  }
+
+  setGutterGitIntegration(git);
+  m_gitDiffTracker->setGitIntegration(git);
+  m_gitDiffTracker->setFilePath(filePath);
+  m_gitDiffTracker->reloadBase();
+}
+
 void TextArea::setInlineBlameData(const QMap<int, QString> &blameData) {
-  m_inlineBlameData = blameData;
+  QMap<int, QString> blameByBlock;
+  for (auto it = blameData.cbegin(); it != blameData.cend(); ++it) {
+    blameByBlock.insert(it.key() - 1, it.value());
+  }
+  DecorationStore::forDocument(document())->setLineTexts(
+      DecorationKind::InlineBlame, blameByBlock);
   viewport()->update();
 }
 
 void TextArea::clearInlineBlameData() {
-  m_inlineBlameData.clear();
+  DecorationStore::forDocument(document())->clear(DecorationKind::InlineBlame);
   viewport()->update();
 }
 
@@ -2158,12 +2303,17 @@ bool TextArea::isHeatmapEnabled() const {
 }
 
 void TextArea::setCodeLensEntries(const QList<CodeLensEntry> &entries) {
-  m_codeLensEntries = entries;
+  QMap<int, QString> lensByBlock;
+  for (const CodeLensEntry &entry : entries) {
+    lensByBlock.insert(entry.line, entry.text);
+  }
+  DecorationStore::forDocument(document())->setLineTexts(
+      DecorationKind::CodeLens, lensByBlock);
   viewport()->update();
 }
 
 void TextArea::clearCodeLensEntries() {
-  m_codeLensEntries.clear();
+  DecorationStore::forDocument(document())->clear(DecorationKind::CodeLens);
   viewport()->update();
 }
 
@@ -2331,14 +2481,12 @@ void TextArea::splitSelectionIntoLines() {
 
 void TextArea::foldComments() {
   m_codeFolding->foldComments();
-  viewport()->update();
-  document()->markContentsDirty(0, document()->characterCount());
+  relayoutFoldChanges();
 }
 
 void TextArea::unfoldComments() {
   m_codeFolding->unfoldComments();
-  viewport()->update();
-  document()->markContentsDirty(0, document()->characterCount());
+  relayoutFoldChanges();
 }
 
 void TextArea::sortLinesAscending() {
@@ -2404,33 +2552,26 @@ void TextArea::setWordWrapEnabled(bool enabled) {
   }
 }
 
+QList<LspDiagnostic> TextArea::diagnostics() const {
+  return DecorationStore::forDocument(document())->diagnostics();
+}
+
 bool TextArea::wordWrapEnabled() const {
   return lineWrapMode() == QPlainTextEdit::WidgetWidth;
 }
 
 void TextArea::setDiagnostics(const QList<LspDiagnostic> &diagnostics) {
-  m_diagnostics = diagnostics;
-
-  QMap<int, LspDiagnosticSeverity> diagnosticLines;
-  for (const LspDiagnostic &diag : diagnostics) {
-    int line = diag.range.start.line + 1;
-    if (!diagnosticLines.contains(line) ||
-        static_cast<int>(diag.severity) <
-            static_cast<int>(diagnosticLines[line])) {
-      diagnosticLines[line] = diag.severity;
-    }
-  }
+  DecorationStore::forDocument(document())->setDiagnostics(diagnostics);
   if (lineNumberArea) {
-    lineNumberArea->setDiagnosticLines(diagnosticLines);
+    lineNumberArea->update();
   }
-
   scheduleExtraSelectionsRefresh();
 }
 
 void TextArea::clearDiagnostics() {
-  m_diagnostics.clear();
+  DecorationStore::forDocument(document())->clear(DecorationKind::Diagnostic);
   if (lineNumberArea) {
-    lineNumberArea->clearDiagnosticLines();
+    lineNumberArea->update();
   }
   scheduleExtraSelectionsRefresh();
 }
@@ -4,13 +4,18 @@
 #include <QList>
 #include <QMap>
 #include <QPlainTextEdit>
+#include <QPointer>
 #include <QSet>
 #include <QTextCursor>
 #include <functional>
+#include <memory>
 
 #include "../editor/vimmode.h"
 #include "../lsp/lspclient.h"
 
+constexpr int TEXTAREA_LOAD_SLICE_CHARS = 64 * 1024;
+constexpr int TEXTAREA_LOAD_SLICE_MS = 8;
+
 class MainWindow;
 class QSyntaxHighlighter;
 class QCompleter;
@@ -20,6 +25,7 @@ class LineNumberArea;
 class MultiCursorHandler;
 class CodeFoldingManager;
 class GitIntegration;
+class GitDiffTracker;
 struct GitBlameLineInfo;
 struct CompletionItem;
 struct TextAreaSettings;
@@ -42,6 +48,7 @@ public:
   void setFontSize(int size);
   void setFont(QFont font);
   void setPlainText(const QString &text);
+  void shareDocumentWith(TextArea *source);
   void setMainWindow(MainWindow *window);
   void setTabWidth(int width);
   void removeIconUnsaved();
@@ -66,6 +73,11 @@ public:
   QString getSearchWord();
   bool changesUnsaved();
 
+  void beginLoading();
+  void appendLoadedText(const QString &text);
+  void finishLoading();
+  bool isLoading() const { return m_loading; }
+
   void addCursorAbove();
   void addCursorBelow();
   void addCursorAtNextOccurrence();
@@ -114,6 +126,8 @@ public:
 
   void setRichBlameData(const QMap<int, GitBlameLineInfo> &blameData);
   void setGutterGitIntegration(GitIntegration *git);
+  void setGitDiffTracking(GitIntegration *git, const QString &filePath);
+  GitDiffTracker *gitDiffTracker() const { return m_gitDiffTracker; }
 
   void setHeatmapData(const QMap<int, qint64> &timestamps);
   void setHeatmapEnabled(bool enabled);
@@ -139,7 +153,11 @@ public:
 
   void setDiagnostics(const QList<LspDiagnostic> &diagnostics);
   void clearDiagnostics();
-  const QList<LspDiagnostic> &diagnostics() const { return m_diagnostics; }
+  QList<LspDiagnostic> diagnostics() const;
+
+signals:
+  void loadingFinished();
+  void loadedTextInserted();
 
 protected:
   void resizeEvent(QResizeEvent *event) override;
@@ -161,7 +179,7 @@ private:
   QString bufferText;
   QString highlightLang;
   QFont mainFont;
-  QSyntaxHighlighter *syntaxHighlighter;
+  QPointer<QSyntaxHighlighter> syntaxHighlighter;
   QCompleter *m_completer;
   CompletionEngine *m_completionEngine;
   CompletionWidget *m_completionWidget;
@@ -180,7 +198,7 @@ private:
 
   MultiCursorHandler *m_multiCursor;
 
-  CodeFoldingManager *m_codeFolding;
+  std::shared_ptr<CodeFoldingManager> m_codeFolding;
 
   bool m_columnSelectionActive;
   QPoint m_columnSelectionStart;
@@ -194,19 +212,25 @@ private:
 
   QList<QPair<int, int>> m_gitDiffLines;
   QMap<int, QString> m_gitBlameLines;
+  GitDiffTracker *m_gitDiffTracker = nullptr;
 
-  QMap<int, QString> m_inlineBlameData;
   bool m_inlineBlameEnabled;
   int m_lastInlineBlameLine;
 
-  QList<CodeLensEntry> m_codeLensEntries;
   bool m_codeLensEnabled;
 
   int m_debugExecutionLine;
 
-  QList<LspDiagnostic> m_diagnostics;
+  bool m_loading = false;
+  QList<QString> m_loadQueue;
+  int m_loadOffset = 0;
+  bool m_loadInsertPending = false;
 
   void setupTextArea();
+  void connectDocumentSignals();
+  QSyntaxHighlighter *documentHighlighter() const;
+  void relayoutFoldChanges();
+  void visiblePositionRange(int *from, int *to) const;
   void setTabWidgetIcon(QIcon icon);
   void closeParentheses(QString startSr, QString closeStr);
   void handleKeyEnterPressed();
@@ -217,6 +241,8 @@ private:
   void updateExtraSelections();
   void updateCursorPositionChangedCallbacks();
   void scheduleExtraSelectionsRefresh();
+  void scheduleLoadedTextInsert();
+  void insertLoadedText();
   void insertCompletion(const QString &completion);
   void insertCompletionItem(const CompletionItem &item);
   QString textUnderCursor() const;
@@ -48,7 +48,8 @@ void GitFileSystemModel::initializeIcons() {
 
 GitFileSystemModel::GitFileSystemModel(QObject *parent)
     : QFileSystemModel(parent), m_gitIntegration(nullptr),
-      m_gitStatusEnabled(true), m_refreshTimer(new QTimer(this)) {
+      m_gitStatusEnabled(true), m_refreshTimer(new QTimer(this)),
+      m_fullRefreshPending(false) {
   initializeIcons();
   setFilter(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden |
             QDir::System);
@@ -56,7 +57,7 @@ GitFileSystemModel::GitFileSystemModel(QObject *parent)
   m_refreshTimer->setSingleShot(true);
   m_refreshTimer->setInterval(GIT_STATUS_REFRESH_DEBOUNCE_MS);
   connect(m_refreshTimer, &QTimer::timeout, this,
-          &GitFileSystemModel::updateStatusCache);
+          &GitFileSystemModel::applyPendingRefresh);
 }
 
 GitFileSystemModel::~GitFileSystemModel() {}
@@ -80,6 +81,8 @@ void GitFileSystemModel::setGitIntegration(GitIntegration *git) {
   if (m_gitIntegration) {
     connect(m_gitIntegration, &GitIntegration::statusChanged, this,
             &GitFileSystemModel::onGitStatusChanged);
+    connect(m_gitIntegration, &GitIntegration::workingTreeChanged, this,
+            &GitFileSystemModel::onWorkingTreeChanged);
     updateStatusCache();
   } else if (!m_statusCache.isEmpty()) {
     m_statusCache.clear();
@@ -204,7 +207,68 @@ void GitFileSystemModel::refreshGitStatus() {
   }
 }
 
-void GitFileSystemModel::onGitStatusChanged() { m_refreshTimer->start(); }
+void GitFileSystemModel::onGitStatusChanged() {
+  m_fullRefreshPending = true;
+  m_refreshTimer->start();
+}
+
+void GitFileSystemModel::onWorkingTreeChanged(const QStringList &directories) {
+  for (const QString &dir : directories) {
+    m_pendingDirectories.insert(dir);
+  }
+  if (!m_refreshTimer->isActive()) {
+    m_refreshTimer->start();
+  }
+}
+
+void GitFileSystemModel::applyPendingRefresh() {
+  const bool fullRefresh = m_fullRefreshPending;
+  QStringList directories(m_pendingDirectories.begin(),
+                          m_pendingDirectories.end());
+  m_fullRefreshPending = false;
+  m_pendingDirectories.clear();
+
+  if (fullRefresh) {
+    updateStatusCache();
+  } else if (!directories.isEmpty()) {
+    updateStatusCacheForDirectories(directories);
+  }
+}
+
+void GitFileSystemModel::updateStatusCacheForDirectories(
+    const QStringList &directories) {
+  if (!m_gitStatusEnabled || !m_gitIntegration ||
+      !m_gitIntegration->isValidRepository()) {
+    return;
+  }
+
+  const QString repoPath = m_gitIntegration->repositoryPath();
+  QList<GitFileInfo> statusList =
+      m_gitIntegration->getStatusForPaths(directories);
+
+  for (auto it = m_statusCache.begin(); it != m_statusCache.end();) {
+    bool inScope = false;
+    for (const QString &dir : directories) {
+      if (dir == repoPath || it.key().startsWith(dir + "/")) {
+        inScope = true;
+        break;
+      }
+    }
+    if (inScope) {
+      it = m_statusCache.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (const GitFileInfo &info : statusList) {
+    m_statusCache[repoPath + "/" + info.filePath] = info;
+  }
+
+  rebuildDirtyDirectories();
+
+  emit layoutChanged();
+}
 
 void GitFileSystemModel::updateStatusCache() {
   if (!m_gitIntegration || !m_gitIntegration->isValidRepository()) {
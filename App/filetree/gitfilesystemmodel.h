@@ -45,11 +45,14 @@ public:
 
 private slots:
   void onGitStatusChanged();
+  void onWorkingTreeChanged(const QStringList &directories);
 
 private:
   GitIntegration *m_gitIntegration;
   bool m_gitStatusEnabled;
   QTimer *m_refreshTimer;
+  bool m_fullRefreshPending;
+  QSet<QString> m_pendingDirectories;
   mutable QMap<QString, GitFileInfo> m_statusCache;
   mutable QSet<QString> m_dirtyDirectories;
   QString m_rootHeaderLabel;
@@ -64,7 +67,9 @@ private:
   QColor getStatusColor(const QString &filePath) const;
   static QColor colorForFileExtension(const QString &extension);
 
+  void applyPendingRefresh();
   void updateStatusCache();
+  void updateStatusCacheForDirectories(const QStringList &directories);
   void rebuildDirtyDirectories();
 
   static void initializeIcons();
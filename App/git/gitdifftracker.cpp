@@ -0,0 +1,253 @@
+#include "gitdifftracker.h"
+
+#include <QEvent>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QWidget>
+
+constexpr int DEFAULT_RECOMPUTE_DELAY_MS = 50;
+
+GitDiffTracker::GitDiffTracker(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_hasBase(false),
+      m_dirty(false), m_baseStale(false) {
+  m_recomputeTimer.setSingleShot(true);
+  m_recomputeTimer.setInterval(DEFAULT_RECOMPUTE_DELAY_MS);
+  connect(&m_recomputeTimer, &QTimer::timeout, this,
+          &GitDiffTracker::recompute);
+
+  if (m_document) {
+    connect(m_document, &QTextDocument::contentsChange, this,
+            &GitDiffTracker::onContentsChange);
+  }
+
+  if (parent && parent->isWidgetType()) {
+    parent->installEventFilter(this);
+  }
+}
+
+void GitDiffTracker::setGitIntegration(GitIntegration *git) {
+  if (m_git == git) {
+    return;
+  }
+
+  if (m_git) {
+    disconnect(m_git, nullptr, this, nullptr);
+  }
+
+  m_git = git;
+  m_baseBlobId.clear();
+
+  if (m_git) {
+    connect(m_git, &GitIntegration::headChanged, this,
+            &GitDiffTracker::onHeadChanged);
+    connect(m_git, &GitIntegration::headBlobLoaded, this,
+            &GitDiffTracker::onHeadBlobLoaded);
+  }
+}
+
+void GitDiffTracker::setFilePath(const QString &filePath) {
+  if (m_filePath == filePath) {
+    return;
+  }
+  m_filePath = filePath;
+  m_baseBlobId.clear();
+}
+
+void GitDiffTracker::reloadBase() {
+  if (!m_git || !m_git->isValidRepository() || m_filePath.isEmpty()) {
+    clearBase();
+    return;
+  }
+
+  if (isHidden()) {
+    m_baseStale = true;
+    return;
+  }
+
+  m_baseStale = false;
+  m_git->requestHeadBlob(m_filePath);
+}
+
+bool GitDiffTracker::eventFilter(QObject *watched, QEvent *event) {
+  if (watched == parent() && event->type() == QEvent::Show && m_baseStale) {
+    reloadBase();
+  }
+  return QObject::eventFilter(watched, event);
+}
+
+bool GitDiffTracker::isHidden() const {
+  const QWidget *widget = qobject_cast<const QWidget *>(parent());
+  return widget && !widget->isVisible();
+}
+
+void GitDiffTracker::onHeadChanged(const QStringList &changedFiles) {
+  if (!m_git || m_filePath.isEmpty()) {
+    return;
+  }
+  if (!changedFiles.isEmpty() &&
+      !changedFiles.contains(m_git->relativeToRepository(m_filePath))) {
+    return;
+  }
+  reloadBase();
+}
+
+void GitDiffTracker::onHeadBlobLoaded(const QString &relativePath,
+                                      const QString &blobId,
+                                      const QString &content) {
+  if (!m_git || m_filePath.isEmpty() ||
+      relativePath != m_git->relativeToRepository(m_filePath)) {
+    return;
+  }
+
+  if (blobId.isEmpty()) {
+    clearBase();
+    return;
+  }
+
+  if (m_hasBase && blobId == m_baseBlobId) {
+    return;
+  }
+
+  setBaseText(content);
+  m_baseBlobId = blobId;
+}
+
+void GitDiffTracker::setBaseText(const QString &text) {
+  m_baseLines = GitLineDiff::splitLines(text);
+  m_baseBlobId.clear();
+  m_hasBase = true;
+  m_dirty = true;
+  rebuildCurrentLines();
+  m_recomputeTimer.stop();
+  recompute();
+}
+
+void GitDiffTracker::clearBase() {
+  m_recomputeTimer.stop();
+  m_hasBase = false;
+  m_baseBlobId.clear();
+  m_baseLines.clear();
+  m_currentLines.clear();
+  m_hunks.clear();
+  m_dirty = false;
+  emit diffChanged({});
+}
+
+void GitDiffTracker::setDebounceInterval(int msec) {
+  m_recomputeTimer.setInterval(qMax(0, msec));
+}
+
+void GitDiffTracker::flush() {
+  if (m_recomputeTimer.isActive()) {
+    m_recomputeTimer.stop();
+    recompute();
+  }
+}
+
+QList<GitDiffLineInfo> GitDiffTracker::diffLines() const {
+  return GitLineDiff::toDiffLineInfo(m_hunks);
+}
+
+QList<QPair<int, int>> GitDiffTracker::gutterLines() const {
+  return GitLineDiff::toGutterLines(diffLines());
+}
+
+GitDiffHunk GitDiffTracker::hunkAtLine(int lineNumber) const {
+  return GitLineDiff::hunkAtLine(m_baseLines, m_currentLines, m_hunks,
+                                 lineNumber);
+}
+
+void GitDiffTracker::onContentsChange(int position, int charsRemoved,
+                                      int charsAdded) {
+  Q_UNUSED(charsRemoved);
+
+  if (!m_hasBase || !m_document) {
+    return;
+  }
+
+  QTextBlock first = m_document->findBlock(position);
+  if (!first.isValid()) {
+    rebuildCurrentLines();
+    scheduleRecompute();
+    return;
+  }
+
+  QTextBlock last = m_document->findBlock(position + charsAdded);
+  if (!last.isValid()) {
+    last = m_document->lastBlock();
+  }
+
+  const int firstNumber = first.blockNumber();
+  const int newCount = last.blockNumber() - firstNumber + 1;
+  const int blockDelta = m_document->blockCount() - m_currentLines.size();
+  const int oldCount = newCount - blockDelta;
+
+  if (newCount <= 0 || oldCount < 0 ||
+      firstNumber + oldCount > m_currentLines.size()) {
+    rebuildCurrentLines();
+    scheduleRecompute();
+    return;
+  }
+
+  QStringList replacement;
+  replacement.reserve(newCount);
+  bool changed = oldCount != newCount;
+  QTextBlock block = first;
+  for (int i = 0; i < newCount && block.isValid(); ++i) {
+    QString text = block.text();
+    if (!changed && m_currentLines[firstNumber + i] != text) {
+      changed = true;
+    }
+    replacement.append(text);
+    block = block.next();
+  }
+
+  if (!changed) {
+    return;
+  }
+
+  if (oldCount == replacement.size()) {
+    for (int i = 0; i < replacement.size(); ++i) {
+      m_currentLines[firstNumber + i] = replacement[i];
+    }
+  } else {
+    QStringList updated;
+    updated.reserve(m_currentLines.size() + replacement.size() - oldCount);
+    updated << m_currentLines.mid(0, firstNumber) << replacement
+            << m_currentLines.mid(firstNumber + oldCount);
+    m_currentLines = updated;
+  }
+
+  scheduleRecompute();
+}
+
+void GitDiffTracker::rebuildCurrentLines() {
+  m_currentLines.clear();
+  if (!m_document) {
+    return;
+  }
+
+  m_currentLines.reserve(m_document->blockCount());
+  for (QTextBlock block = m_document->begin(); block.isValid();
+       block = block.next()) {
+    m_currentLines.append(block.text());
+  }
+}
+
+void GitDiffTracker::scheduleRecompute() { m_recomputeTimer.start(); }
+
+void GitDiffTracker::recompute() {
+  if (!m_hasBase) {
+    return;
+  }
+
+  QList<GitLineDiffHunk> hunks =
+      GitLineDiff::computeHunks(m_baseLines, m_currentLines);
+  if (!m_dirty && hunks == m_hunks) {
+    return;
+  }
+
+  m_hunks = hunks;
+  m_dirty = false;
+  emit diffChanged(gutterLines());
+}
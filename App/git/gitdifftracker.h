@@ -0,0 +1,69 @@
+#ifndef GITDIFFTRACKER_H
+#define GITDIFFTRACKER_H
+
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+
+#include "gitintegration.h"
+#include "gitlinediff.h"
+
+class QTextDocument;
+
+class GitDiffTracker : public QObject {
+  Q_OBJECT
+
+public:
+  explicit GitDiffTracker(QTextDocument *document, QObject *parent = nullptr);
+
+  void setGitIntegration(GitIntegration *git);
+  void setFilePath(const QString &filePath);
+  QString filePath() const { return m_filePath; }
+
+  void reloadBase();
+  void setBaseText(const QString &text);
+  void clearBase();
+  bool hasBase() const { return m_hasBase; }
+  QString baseBlobId() const { return m_baseBlobId; }
+
+  void setDebounceInterval(int msec);
+  void flush();
+
+  QList<GitLineDiffHunk> hunks() const { return m_hunks; }
+  QList<GitDiffLineInfo> diffLines() const;
+  QList<QPair<int, int>> gutterLines() const;
+  GitDiffHunk hunkAtLine(int lineNumber) const;
+
+signals:
+  void diffChanged(const QList<QPair<int, int>> &gutterLines);
+
+protected:
+  bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+  bool isHidden() const;
+  void onHeadChanged(const QStringList &changedFiles);
+  void onHeadBlobLoaded(const QString &relativePath, const QString &blobId,
+                        const QString &content);
+  void onContentsChange(int position, int charsRemoved, int charsAdded);
+  void rebuildCurrentLines();
+  void scheduleRecompute();
+  void recompute();
+
+  QTextDocument *m_document;
+  QPointer<GitIntegration> m_git;
+  QString m_filePath;
+  QString m_baseBlobId;
+  QStringList m_baseLines;
+  QStringList m_currentLines;
+  QList<GitLineDiffHunk> m_hunks;
+  QTimer m_recomputeTimer;
+  bool m_hasBase;
+  bool m_dirty;
+  bool m_baseStale;
+};
+
+#endif
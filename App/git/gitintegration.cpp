@@ -1,17 +1,179 @@
 #include "gitintegration.h"
 #include "../core/logging/logger.h"
+#include "gitrepositorywatcher.h"
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QList>
+#include <QMutex>
 #include <QRegularExpression>
 #include <QTemporaryFile>
 #include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
+
+constexpr int MAX_CACHED_BLOBS = 64;
+
+class GitBaseLoader : public QThread {
+public:
+  explicit GitBaseLoader(GitIntegration *receiver) : m_receiver(receiver) {}
+
+  ~GitBaseLoader() override {
+    {
+      QMutexLocker locker(&m_mutex);
+      m_stopping = true;
+      m_wake.wakeAll();
+    }
+    wait();
+  }
+
+  void requestBlob(const QString &repositoryPath, const QString &relativePath,
+                   int generation) {
+    enqueue({repositoryPath, relativePath, QString(), generation, false});
+  }
+
+  void requestHead(const QString &repositoryPath,
+                   const QString &previousHead) {
+    enqueue({repositoryPath, QString(), previousHead, 0, true});
+  }
+
+protected:
+  void run() override {
+    while (true) {
+      Job job;
+      {
+        QMutexLocker locker(&m_mutex);
+        while (!m_stopping && m_jobs.isEmpty()) {
+          m_wake.wait(&m_mutex);
+        }
+        if (m_stopping) {
+          return;
+        }
+        job = m_jobs.takeFirst();
+      }
+
+      if (job.head) {
+        resolveHead(job);
+      } else {
+        loadBlob(job);
+      }
+    }
+  }
+
+private:
+  struct Job {
+    QString repositoryPath;
+    QString relativePath;
+    QString previousHead;
+    int generation = 0;
+    bool head = false;
+  };
+
+  void enqueue(const Job &job) {
+    QMutexLocker locker(&m_mutex);
+    m_jobs.append(job);
+    m_wake.wakeOne();
+    if (!isRunning()) {
+      start(QThread::LowPriority);
+    }
+  }
+
+  static QByteArray runGit(const QString &repositoryPath,
+                           const QStringList &args, bool *success) {
+    QProcess process;
+    process.setWorkingDirectory(repositoryPath);
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("GIT_OPTIONAL_LOCKS", "0");
+    process.setProcessEnvironment(env);
+    process.start("git", args);
+    *success = process.waitForFinished(GIT_COMMAND_TIMEOUT_MS) &&
+               process.exitStatus() == QProcess::NormalExit &&
+               process.exitCode() == 0;
+    return *success ? process.readAllStandardOutput() : QByteArray();
+  }
+
+  void loadBlob(const Job &job) {
+    bool success = false;
+    const QString blobId = QString::fromUtf8(
+        runGit(job.repositoryPath,
+               {"rev-parse", "--verify", "--quiet",
+                "HEAD:" + job.relativePath},
+               &success)
+            .trimmed());
+    QString content;
+    if (success && !blobId.isEmpty()) {
+      content = QString::fromUtf8(
+          runGit(job.repositoryPath, {"cat-file", "blob", blobId}, &success));
+    }
+    const QString loadedBlobId = success ? blobId : QString();
+
+    GitIntegration *receiver = m_receiver;
+    QMetaObject::invokeMethod(
+        receiver,
+        [receiver, job, loadedBlobId, content]() {
+          receiver->onHeadBlobLoaded(job.repositoryPath, job.relativePath,
+                                     job.generation, loadedBlobId, content);
+        },
+        Qt::QueuedConnection);
+  }
+
+  void resolveHead(const Job &job) {
+    bool success = false;
+    QString head = QString::fromUtf8(
+        runGit(job.repositoryPath, {"rev-parse", "--verify", "--quiet", "HEAD"},
+               &success)
+            .trimmed());
+    if (!success) {
+      head.clear();
+    }
+
+    QStringList changedFiles;
+    bool allFiles = job.previousHead.isEmpty() || head.isEmpty();
+    if (!allFiles && head != job.previousHead) {
+      const QByteArray output =
+          runGit(job.repositoryPath,
+                 {"diff", "--name-only", "-z", job.previousHead, head},
+                 &success);
+      if (success) {
+        for (const QByteArray &path : output.split('\0')) {
+          if (!path.isEmpty()) {
+            changedFiles.append(QString::fromUtf8(path));
+          }
+        }
+      } else {
+        allFiles = true;
+      }
+    }
+
+    GitIntegration *receiver = m_receiver;
+    QMetaObject::invokeMethod(
+        receiver,
+        [receiver, repositoryPath = job.repositoryPath, head, changedFiles,
+         allFiles]() {
+          receiver->onHeadResolved(repositoryPath, head, changedFiles,
+                                   allFiles);
+        },
+        Qt::QueuedConnection);
+  }
+
+  GitIntegration *m_receiver;
+  QMutex m_mutex;
+  QWaitCondition m_wake;
+  QList<Job> m_jobs;
+  bool m_stopping = false;
+};
 
 GitIntegration::GitIntegration(QObject *parent)
-    : QObject(parent), m_isValid(false) {}
+    : QObject(parent), m_isValid(false), m_headGeneration(0),
+      m_headKnown(false), m_resolvingHead(false), m_headDirty(false),
+      m_baseLoader(nullptr),
+      m_watcher(nullptr) {
+  connect(this, &GitIntegration::statusChanged, this,
+          &GitIntegration::resolveHead);
+}
 
-GitIntegration::~GitIntegration() {}
+GitIntegration::~GitIntegration() { delete m_baseLoader; }
 
 bool GitIntegration::setRepositoryPath(const QString &path) {
   QString repoRoot = findRepositoryRoot(path);
@@ -20,13 +182,26 @@ bool GitIntegration::setRepositoryPath(const QString &path) {
     m_isValid = false;
     m_repositoryPath.clear();
     m_currentBranch.clear();
+    resetHeadState();
+    if (m_watcher) {
+      m_watcher->clear();
+    }
     LOG_DEBUG("No git repository found at: " + path);
     return false;
   }
 
+  const bool repositoryChanged = m_repositoryPath != repoRoot;
   m_repositoryPath = repoRoot;
   m_isValid = true;
+  if (repositoryChanged) {
+    resetHeadState();
+    resolveHead();
+  }
   updateCurrentBranch();
+  if (m_watcher &&
+      (repositoryChanged || m_watcher->repositoryPath().isEmpty())) {
+    restartRepositoryWatcher();
+  }
 
   LOG_INFO("Git repository found at: " + m_repositoryPath);
   return true;
@@ -70,6 +245,9 @@ QString GitIntegration::executeGitCommand(const QStringList &args,
   QProcess process;
   process.setWorkingDirectory(m_repositoryPath.isEmpty() ? QDir::currentPath()
                                                          : m_repositoryPath);
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("GIT_OPTIONAL_LOCKS", "0");
+  process.setProcessEnvironment(env);
   process.start("git", args);
 
   if (!process.waitForFinished(GIT_COMMAND_TIMEOUT_MS)) {
@@ -102,6 +280,41 @@ QString GitIntegration::executeGitCommand(const QStringList &args,
   return output;
 }
 
+QByteArray GitIntegration::executeGitCommandRaw(const QStringList &args,
+                                               bool *success) const {
+  if (!m_isValid) {
+    if (success)
+      *success = false;
+    return QByteArray();
+  }
+
+  QProcess process;
+  process.setWorkingDirectory(m_repositoryPath);
+  process.start("git", args);
+
+  if (!process.waitForFinished(GIT_COMMAND_TIMEOUT_MS)) {
+    LOG_WARNING("Git command timed out: git " + args.join(" "));
+    if (success)
+      *success = false;
+    return QByteArray();
+  }
+
+  if (success) {
+    *success = (process.exitCode() == 0);
+  }
+
+  return process.readAllStandardOutput();
+}
+
+QString GitIntegration::relativeToRepository(const QString &filePath) const {
+  const int length = m_repositoryPath.length();
+  if (length > 0 && filePath.startsWith(m_repositoryPath) &&
+      (filePath.length() == length || filePath.at(length) == '/')) {
+    return filePath.mid(length + 1);
+  }
+  return filePath;
+}
+
 QString GitIntegration::executeWordDiff(const QStringList &args) const {
   if (!m_isValid) {
     return QString();
@@ -140,6 +353,135 @@ QList<GitFileInfo> GitIntegration::getStatus() const {
   return parseStatusOutput(output);
 }
 
+QList<GitFileInfo>
+GitIntegration::getStatusForPaths(const QStringList &paths) const {
+  if (!m_isValid || paths.isEmpty()) {
+    return QList<GitFileInfo>();
+  }
+
+  QStringList args = {"status", "--porcelain", "-uall", "--"};
+  for (const QString &path : paths) {
+    const QString relativePath = relativeToRepository(path);
+    args.append(relativePath.isEmpty() || relativePath == m_repositoryPath
+                    ? QStringLiteral(".")
+                    : relativePath);
+  }
+
+  bool success;
+  QString output = executeGitCommand(args, &success);
+  if (!success) {
+    return QList<GitFileInfo>();
+  }
+
+  return parseStatusOutput(output);
+}
+
+QStringList GitIntegration::trackedDirectories() const {
+  if (!m_isValid) {
+    return QStringList();
+  }
+
+  bool success;
+  QString output = executeGitCommand(
+      {"ls-tree", "-d", "-r", "--name-only", "HEAD"}, &success);
+  if (!success) {
+    return QStringList();
+  }
+
+  return output.split('\n', Qt::SkipEmptyParts);
+}
+
+QStringList GitIntegration::untrackedDirectories() const {
+  if (!m_isValid) {
+    return QStringList();
+  }
+
+  bool success;
+  const QByteArray output = executeGitCommandRaw(
+      {"ls-files", "-z", "--others", "--exclude-standard", "--directory"},
+      &success);
+  if (!success) {
+    return QStringList();
+  }
+
+  QStringList directories;
+  for (const QByteArray &entry : output.split('\0')) {
+    if (entry.endsWith('/')) {
+      directories.append(QString::fromUtf8(entry.chopped(1)));
+    }
+  }
+  return directories;
+}
+
+QStringList GitIntegration::trackedFiles() const {
+  if (!m_isValid) {
+    return QStringList();
+  }
+
+  bool success;
+  const QByteArray output = executeGitCommandRaw({"ls-files", "-z"}, &success);
+  if (!success) {
+    return QStringList();
+  }
+
+  QStringList files;
+  for (const QByteArray &entry : output.split('\0')) {
+    if (!entry.isEmpty()) {
+      files.append(QString::fromUtf8(entry));
+    }
+  }
+  return files;
+}
+
+void GitIntegration::setFileSystemWatchingEnabled(bool enabled) {
+  if (enabled == (m_watcher != nullptr)) {
+    return;
+  }
+
+  if (!enabled) {
+    delete m_watcher;
+    m_watcher = nullptr;
+    return;
+  }
+
+  m_watcher = new GitRepositoryWatcher(this);
+  connect(m_watcher, &GitRepositoryWatcher::metadataChanged, this,
+          &GitIntegration::onRepositoryMetadataChanged);
+  connect(m_watcher, &GitRepositoryWatcher::workingTreeChanged, this,
+          &GitIntegration::workingTreeChanged);
+  restartRepositoryWatcher();
+}
+
+bool GitIntegration::isFileSystemWatchingEnabled() const {
+  return m_watcher != nullptr;
+}
+
+void GitIntegration::restartRepositoryWatcher() {
+  if (!m_watcher) {
+    return;
+  }
+
+  if (!m_isValid) {
+    m_watcher->clear();
+    return;
+  }
+
+  m_watcher->setRepository(m_repositoryPath,
+                           trackedDirectories() + untrackedDirectories(),
+                           trackedFiles());
+}
+
+void GitIntegration::onRepositoryMetadataChanged(bool headChanged) {
+  if (!m_isValid) {
+    return;
+  }
+
+  if (headChanged) {
+    restartRepositoryWatcher();
+  }
+  refresh();
+}
+
 GitFileInfo GitIntegration::getFileStatus(const QString &filePath) const {
   GitFileInfo info;
   info.filePath = filePath;
@@ -150,10 +492,7 @@ GitFileInfo GitIntegration::getFileStatus(const QString &filePath) const {
     return info;
   }
 
-  QString relativePath = filePath;
-  if (filePath.startsWith(m_repositoryPath)) {
-    relativePath = filePath.mid(m_repositoryPath.length() + 1);
-  }
+  const QString relativePath = relativeToRepository(filePath);
 
   bool success;
   QString output = executeGitCommand(
@@ -324,6 +663,109 @@ GitIntegration::getDiffLines(const QString &filePath) const {
   return result;
 }
 
+void GitIntegration::requestHeadBlob(const QString &filePath) {
+  if (!m_isValid || filePath.isEmpty()) {
+    return;
+  }
+
+  const QString relativePath = relativeToRepository(filePath);
+  auto cached = m_headBlobIds.constFind(relativePath);
+  if (cached != m_headBlobIds.constEnd() &&
+      (cached->isEmpty() || m_blobContents.contains(*cached))) {
+    emit headBlobLoaded(relativePath, *cached, m_blobContents.value(*cached));
+    return;
+  }
+
+  if (m_pendingHeadBlobs.value(relativePath, -1) == m_headGeneration) {
+    return;
+  }
+  m_pendingHeadBlobs.insert(relativePath, m_headGeneration);
+  baseLoader()->requestBlob(m_repositoryPath, relativePath, m_headGeneration);
+}
+
+GitBaseLoader *GitIntegration::baseLoader() {
+  if (!m_baseLoader) {
+    m_baseLoader = new GitBaseLoader(this);
+  }
+  return m_baseLoader;
+}
+
+void GitIntegration::resetHeadState() {
+  ++m_headGeneration;
+  m_headKnown = false;
+  m_headCommit.clear();
+  m_headBlobIds.clear();
+  m_pendingHeadBlobs.clear();
+  m_headDirty = false;
+}
+
+void GitIntegration::resolveHead() {
+  if (!m_isValid) {
+    return;
+  }
+  if (m_resolvingHead) {
+    m_headDirty = true;
+    return;
+  }
+  m_resolvingHead = true;
+  m_headDirty = false;
+  baseLoader()->requestHead(m_repositoryPath, m_headCommit);
+}
+
+void GitIntegration::onHeadResolved(const QString &repositoryPath,
+                                    const QString &head,
+                                    const QStringList &changedFiles,
+                                    bool allFiles) {
+  m_resolvingHead = false;
+  if (!m_isValid || repositoryPath != m_repositoryPath) {
+    resolveHead();
+    return;
+  }
+
+  const bool known = m_headKnown;
+  const QString previousHead = m_headCommit;
+  m_headKnown = true;
+  m_headCommit = head;
+  if (known && head != previousHead &&
+      (allFiles || !changedFiles.isEmpty())) {
+    ++m_headGeneration;
+    if (allFiles) {
+      m_headBlobIds.clear();
+      m_pendingHeadBlobs.clear();
+    } else {
+      for (const QString &path : changedFiles) {
+        m_headBlobIds.remove(path);
+        m_pendingHeadBlobs.remove(path);
+      }
+    }
+    emit headChanged(allFiles ? QStringList() : changedFiles);
+  }
+
+  if (m_headDirty) {
+    resolveHead();
+  }
+}
+
+void GitIntegration::onHeadBlobLoaded(const QString &repositoryPath,
+                                      const QString &relativePath,
+                                      int generation, const QString &blobId,
+                                      const QString &content) {
+  if (repositoryPath != m_repositoryPath ||
+      m_pendingHeadBlobs.value(relativePath, -1) != generation) {
+    return;
+  }
+  m_pendingHeadBlobs.remove(relativePath);
+
+  m_headBlobIds.insert(relativePath, blobId);
+  if (!blobId.isEmpty()) {
+    if (m_blobContents.size() >= MAX_CACHED_BLOBS) {
+      m_blobContents.clear();
+    }
+    m_blobContents.insert(blobId, content);
+  }
+  emit headBlobLoaded(relativePath, blobId, content);
+}
+
 QList<GitBranchInfo> GitIntegration::getBranches() const {
   QList<GitBranchInfo> result;
 
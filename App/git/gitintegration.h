@@ -1,12 +1,16 @@
 #ifndef GITINTEGRATION_H
 #define GITINTEGRATION_H
 
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QProcess>
 #include <QString>
 #include <QStringList>
 
+class GitBaseLoader;
+class GitRepositoryWatcher;
+
 constexpr int GIT_COMMAND_TIMEOUT_MS = 5000;
 
 enum class GitFileStatus {
@@ -133,10 +137,28 @@ public:
 
   QList<GitFileInfo> getStatus() const;
 
+  QList<GitFileInfo> getStatusForPaths(const QStringList &paths) const;
+
+  QStringList trackedDirectories() const;
+
+  QStringList untrackedDirectories() const;
+
+  QStringList trackedFiles() const;
+
+  void setFileSystemWatchingEnabled(bool enabled);
+
+  bool isFileSystemWatchingEnabled() const;
+
+  GitRepositoryWatcher *repositoryWatcher() const { return m_watcher; }
+
   GitFileInfo getFileStatus(const QString &filePath) const;
 
   QList<GitDiffLineInfo> getDiffLines(const QString &filePath) const;
 
+  void requestHeadBlob(const QString &filePath);
+
+  QString relativeToRepository(const QString &filePath) const;
+
   QList<GitBranchInfo> getBranches() const;
 
   bool stageFile(const QString &filePath);
@@ -299,8 +321,15 @@ signals:
 
   void statusChanged();
 
+  void workingTreeChanged(const QStringList &directories);
+
   void branchChanged(const QString &branchName);
 
+  void headChanged(const QStringList &changedFiles);
+
+  void headBlobLoaded(const QString &relativePath, const QString &blobId,
+                      const QString &content);
+
   void errorOccurred(const QString &error);
 
   void operationCompleted(const QString &operation);
@@ -319,10 +348,23 @@ private:
   bool m_isValid;
   QString m_currentBranch;
   QList<GitFileInfo> m_statusCache;
+  QHash<QString, QString> m_headBlobIds;
+  QHash<QString, QString> m_blobContents;
+  QHash<QString, int> m_pendingHeadBlobs;
+  QString m_headCommit;
+  int m_headGeneration;
+  bool m_headKnown;
+  bool m_resolvingHead;
+  bool m_headDirty;
+  GitBaseLoader *m_baseLoader;
+  GitRepositoryWatcher *m_watcher;
 
   QString executeGitCommand(const QStringList &args,
                             bool *success = nullptr) const;
 
+  QByteArray executeGitCommandRaw(const QStringList &args,
+                                 bool *success = nullptr) const;
+
   QString executeGitCommandAtPath(const QString &path, const QStringList &args,
                                   bool *success = nullptr) const;
 
@@ -334,6 +376,25 @@ private:
 
   void updateCurrentBranch();
 
+  void restartRepositoryWatcher();
+
+  void onRepositoryMetadataChanged(bool headChanged);
+
+  GitBaseLoader *baseLoader();
+
+  void resetHeadState();
+
+  void resolveHead();
+
+  void onHeadResolved(const QString &repositoryPath, const QString &head,
+                      const QStringList &changedFiles, bool allFiles);
+
+  void onHeadBlobLoaded(const QString &repositoryPath,
+                        const QString &relativePath, int generation,
+                        const QString &blobId, const QString &content);
+
+  friend class GitBaseLoader;
+
   QList<GitStashEntry> parseStashListOutput(const QString &output) const;
 };
 
@@ -0,0 +1,266 @@
+#include "gitlinediff.h"
+
+#include <QHash>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+QList<GitLineDiffHunk> groupHunks(const std::vector<char> &deleted,
+                                  const std::vector<char> &inserted,
+                                  int oldOffset, int newOffset) {
+  QList<GitLineDiffHunk> hunks;
+  const int n = static_cast<int>(deleted.size());
+  const int m = static_cast<int>(inserted.size());
+  int i = 0;
+  int j = 0;
+
+  while (i < n || j < m) {
+    bool del = i < n && deleted[i];
+    bool ins = j < m && inserted[j];
+    if (!del && !ins) {
+      ++i;
+      ++j;
+      continue;
+    }
+
+    GitLineDiffHunk hunk{oldOffset + i, 0, newOffset + j, 0};
+    while ((i < n && deleted[i]) || (j < m && inserted[j])) {
+      if (i < n && deleted[i]) {
+        ++i;
+        ++hunk.oldCount;
+      } else {
+        ++j;
+        ++hunk.newCount;
+      }
+    }
+    hunks.append(hunk);
+  }
+
+  return hunks;
+}
+
+QList<GitLineDiffHunk> myersHunks(const std::vector<int> &a,
+                                  const std::vector<int> &b, int oldOffset,
+                                  int newOffset) {
+  const int n = static_cast<int>(a.size());
+  const int m = static_cast<int>(b.size());
+
+  if (n == 0 && m == 0) {
+    return {};
+  }
+  if (n == 0 || m == 0) {
+    return {GitLineDiffHunk{oldOffset, n, newOffset, m}};
+  }
+
+  const int maxD = n + m;
+  const int limit = std::min(maxD, GitLineDiff::MAX_EDIT_DISTANCE);
+  const int offset = maxD + 1;
+  std::vector<int> v(2 * maxD + 3, 0);
+  std::vector<std::vector<int>> trace;
+  int finalD = -1;
+
+  for (int d = 0; d <= limit && finalD < 0; ++d) {
+    for (int k = -d; k <= d; k += 2) {
+      int x;
+      if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+        x = v[offset + k + 1];
+      } else {
+        x = v[offset + k - 1] + 1;
+      }
+      int y = x - k;
+      while (x < n && y < m && a[x] == b[y]) {
+        ++x;
+        ++y;
+      }
+      v[offset + k] = x;
+      if (x >= n && y >= m) {
+        finalD = d;
+      }
+    }
+    trace.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+  }
+
+  if (finalD < 0) {
+    return {GitLineDiffHunk{oldOffset, n, newOffset, m}};
+  }
+
+  std::vector<char> deleted(n, 0);
+  std::vector<char> inserted(m, 0);
+  int x = n;
+  int y = m;
+
+  for (int d = finalD; d > 0; --d) {
+    const std::vector<int> &prev = trace[d - 1];
+    auto prevV = [&prev, d](int k) { return prev[k + d - 1]; };
+    int k = x - y;
+    int prevK;
+    if (k == -d || (k != d && prevV(k - 1) < prevV(k + 1))) {
+      prevK = k + 1;
+    } else {
+      prevK = k - 1;
+    }
+    int prevX = prevV(prevK);
+    int prevY = prevX - prevK;
+
+    if (prevK == k + 1) {
+      inserted[prevY] = 1;
+    } else {
+      deleted[prevX] = 1;
+    }
+    x = prevX;
+    y = prevY;
+  }
+
+  return groupHunks(deleted, inserted, oldOffset, newOffset);
+}
+
+} // namespace
+
+namespace GitLineDiff {
+
+QStringList splitLines(const QString &text) {
+  QStringList lines = text.split('\n');
+  for (QString &line : lines) {
+    if (line.endsWith('\r')) {
+      line.chop(1);
+    }
+  }
+  return lines;
+}
+
+QList<GitLineDiffHunk> computeHunks(const QStringList &oldLines,
+                                    const QStringList &newLines) {
+  int oldEnd = oldLines.size();
+  int newEnd = newLines.size();
+  int prefix = 0;
+  while (prefix < oldEnd && prefix < newEnd &&
+         oldLines[prefix] == newLines[prefix]) {
+    ++prefix;
+  }
+  while (oldEnd > prefix && newEnd > prefix &&
+         oldLines[oldEnd - 1] == newLines[newEnd - 1]) {
+    --oldEnd;
+    --newEnd;
+  }
+
+  QHash<QString, int> ids;
+  auto intern = [&ids](const QString &line) {
+    auto it = ids.constFind(line);
+    if (it != ids.constEnd()) {
+      return it.value();
+    }
+    int id = ids.size();
+    ids.insert(line, id);
+    return id;
+  };
+
+  std::vector<int> a;
+  a.reserve(oldEnd - prefix);
+  for (int i = prefix; i < oldEnd; ++i) {
+    a.push_back(intern(oldLines[i]));
+  }
+  std::vector<int> b;
+  b.reserve(newEnd - prefix);
+  for (int i = prefix; i < newEnd; ++i) {
+    b.push_back(intern(newLines[i]));
+  }
+
+  return myersHunks(a, b, prefix, prefix);
+}
+
+QList<GitDiffLineInfo> toDiffLineInfo(const QList<GitLineDiffHunk> &hunks) {
+  QList<GitDiffLineInfo> result;
+
+  for (const GitLineDiffHunk &hunk : hunks) {
+    if (hunk.newCount == 0) {
+      GitDiffLineInfo info;
+      info.lineNumber = std::max(hunk.newStart, 1);
+      info.type = GitDiffLineInfo::Type::Deleted;
+      result.append(info);
+      continue;
+    }
+
+    GitDiffLineInfo::Type type = hunk.oldCount == 0
+                                     ? GitDiffLineInfo::Type::Added
+                                     : GitDiffLineInfo::Type::Modified;
+    for (int i = 0; i < hunk.newCount; ++i) {
+      GitDiffLineInfo info;
+      info.lineNumber = hunk.newStart + i + 1;
+      info.type = type;
+      result.append(info);
+    }
+  }
+
+  return result;
+}
+
+QList<QPair<int, int>> toGutterLines(const QList<GitDiffLineInfo> &diffLines) {
+  QList<QPair<int, int>> gutterLines;
+  gutterLines.reserve(diffLines.size());
+  for (const auto &info : diffLines) {
+    int type = 1;
+    if (info.type == GitDiffLineInfo::Type::Added) {
+      type = 0;
+    } else if (info.type == GitDiffLineInfo::Type::Deleted) {
+      type = 2;
+    }
+    gutterLines.append(qMakePair(info.lineNumber, type));
+  }
+  return gutterLines;
+}
+
+GitDiffHunk hunkAtLine(const QStringList &oldLines,
+                       const QStringList &newLines,
+                       const QList<GitLineDiffHunk> &hunks, int lineNumber,
+                       int contextLines) {
+  GitDiffHunk result;
+  result.startLine = 0;
+  result.lineCount = 0;
+
+  for (const GitLineDiffHunk &hunk : hunks) {
+    bool matches = hunk.newCount == 0
+                       ? lineNumber == std::max(hunk.newStart, 1)
+                       : lineNumber > hunk.newStart &&
+                             lineNumber <= hunk.newStart + hunk.newCount;
+    if (!matches) {
+      continue;
+    }
+
+    int before = std::min(contextLines, hunk.newStart);
+    int afterAvailable = newLines.size() - (hunk.newStart + hunk.newCount);
+    int after = std::max(0, std::min(contextLines, afterAvailable));
+
+    int newStart = hunk.newStart - before;
+    int newCount = before + hunk.newCount + after;
+    int oldStart = hunk.oldStart - before;
+    int oldCount = before + hunk.oldCount + after;
+
+    for (int i = newStart; i < hunk.newStart; ++i) {
+      result.lines.append(" " + newLines[i]);
+    }
+    for (int i = hunk.oldStart; i < hunk.oldStart + hunk.oldCount; ++i) {
+      result.lines.append("-" + oldLines.value(i));
+    }
+    for (int i = hunk.newStart; i < hunk.newStart + hunk.newCount; ++i) {
+      result.lines.append("+" + newLines[i]);
+    }
+    for (int i = hunk.newStart + hunk.newCount;
+         i < hunk.newStart + hunk.newCount + after; ++i) {
+      result.lines.append(" " + newLines[i]);
+    }
+
+    result.startLine = newStart + 1;
+    result.lineCount = newCount;
+    result.header = QString("@@ -%1,%2 +%3,%4 @@")
+                        .arg(oldCount > 0 ? oldStart + 1 : oldStart)
+                        .arg(oldCount)
+                        .arg(newCount > 0 ? newStart + 1 : newStart)
+                        .arg(newCount);
+    return result;
+  }
+
+  return result;
+}
+
+} // namespace GitLineDiff
@@ -0,0 +1,43 @@
+#ifndef GITLINEDIFF_H
+#define GITLINEDIFF_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+#include "gitintegration.h"
+
+struct GitLineDiffHunk {
+  int oldStart;
+  int oldCount;
+  int newStart;
+  int newCount;
+
+  bool operator==(const GitLineDiffHunk &other) const {
+    return oldStart == other.oldStart && oldCount == other.oldCount &&
+           newStart == other.newStart && newCount == other.newCount;
+  }
+};
+
+namespace GitLineDiff {
+
+constexpr int MAX_EDIT_DISTANCE = 1024;
+
+QStringList splitLines(const QString &text);
+
+QList<GitLineDiffHunk> computeHunks(const QStringList &oldLines,
+                                    const QStringList &newLines);
+
+QList<GitDiffLineInfo> toDiffLineInfo(const QList<GitLineDiffHunk> &hunks);
+
+QList<QPair<int, int>> toGutterLines(const QList<GitDiffLineInfo> &diffLines);
+
+GitDiffHunk hunkAtLine(const QStringList &oldLines,
+                       const QStringList &newLines,
+                       const QList<GitLineDiffHunk> &hunks, int lineNumber,
+                       int contextLines = 3);
+
+} // namespace GitLineDiff
+
+#endif
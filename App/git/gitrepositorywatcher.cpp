@@ -0,0 +1,340 @@
+#include "gitrepositorywatcher.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <algorithm>
+
+static QByteArray readHeadFile(const QString &gitDir) {
+  QFile file(gitDir + "/HEAD");
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+  return file.readAll().trimmed();
+}
+
+GitRepositoryWatcher::GitRepositoryWatcher(QObject *parent)
+    : QObject(parent), m_watcher(new QFileSystemWatcher(this)),
+      m_pendingIndex(false), m_pendingHead(false) {
+  m_flushTimer.setSingleShot(true);
+  m_flushTimer.setInterval(GIT_WATCHER_DEBOUNCE_MS);
+  connect(&m_flushTimer, &QTimer::timeout, this,
+          &GitRepositoryWatcher::emitPendingChanges);
+  connect(m_watcher, &QFileSystemWatcher::directoryChanged, this,
+          &GitRepositoryWatcher::onDirectoryChanged);
+  connect(m_watcher, &QFileSystemWatcher::fileChanged, this,
+          &GitRepositoryWatcher::onFileChanged);
+}
+
+QString GitRepositoryWatcher::resolveGitDirectory(
+    const QString &repositoryPath) {
+  QFileInfo dotGit(repositoryPath + "/.git");
+  if (dotGit.isDir()) {
+    return dotGit.absoluteFilePath();
+  }
+
+  if (!dotGit.isFile()) {
+    return QString();
+  }
+
+  QFile file(dotGit.absoluteFilePath());
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QString();
+  }
+
+  const QString content = QString::fromUtf8(file.readAll()).trimmed();
+  if (!content.startsWith("gitdir:")) {
+    return QString();
+  }
+
+  QString gitDir = content.mid(7).trimmed();
+  if (QFileInfo(gitDir).isRelative()) {
+    gitDir = QDir(repositoryPath).absoluteFilePath(gitDir);
+  }
+  return QDir::cleanPath(gitDir);
+}
+
+void GitRepositoryWatcher::setRepository(
+    const QString &repositoryPath, const QStringList &workingTreeDirectories,
+    const QStringList &workingTreeFiles) {
+  clear();
+
+  m_repositoryPath = QDir::cleanPath(repositoryPath);
+  m_gitDir = resolveGitDirectory(m_repositoryPath);
+  if (m_repositoryPath.isEmpty() || m_gitDir.isEmpty()) {
+    return;
+  }
+
+  m_headContent = readHeadFile(m_gitDir);
+  watchMetadata();
+
+  QStringList directories;
+  directories.append(m_repositoryPath);
+  for (const QString &relative : workingTreeDirectories) {
+    if (directories.size() >= GIT_WATCHER_MAX_DIRECTORIES) {
+      break;
+    }
+    if (relative.isEmpty() || relative == ".") {
+      continue;
+    }
+    const QString absolute =
+        QDir::cleanPath(m_repositoryPath + "/" + relative);
+    if (!isWorkingTreePath(absolute)) {
+      continue;
+    }
+    directories.append(absolute);
+  }
+
+  QStringList files;
+  for (const QString &relative : workingTreeFiles) {
+    if (files.size() >= GIT_WATCHER_MAX_FILES) {
+      break;
+    }
+    const QString absolute =
+        QDir::cleanPath(m_repositoryPath + "/" + relative);
+    if (!relative.isEmpty() && isWorkingTreePath(absolute)) {
+      files.append(absolute);
+    }
+  }
+
+  for (const QString &dir : directories) {
+    m_workingTreeDirectories.insert(dir);
+  }
+  for (const QString &file : files) {
+    m_workingTreeFiles.insert(file);
+  }
+  m_watcher->addPaths(directories);
+  if (!files.isEmpty()) {
+    m_watcher->addPaths(files);
+  }
+}
+
+void GitRepositoryWatcher::clear() {
+  const QStringList files = m_watcher->files();
+  if (!files.isEmpty()) {
+    m_watcher->removePaths(files);
+  }
+  const QStringList directories = m_watcher->directories();
+  if (!directories.isEmpty()) {
+    m_watcher->removePaths(directories);
+  }
+
+  m_flushTimer.stop();
+  m_burstTimer.invalidate();
+  m_repositoryPath.clear();
+  m_gitDir.clear();
+  m_headContent.clear();
+  m_workingTreeDirectories.clear();
+  m_workingTreeFiles.clear();
+  m_pendingDirectories.clear();
+  m_pendingIndex = false;
+  m_pendingHead = false;
+}
+
+QStringList GitRepositoryWatcher::watchedDirectories() const {
+  return m_watcher->directories();
+}
+
+QStringList GitRepositoryWatcher::watchedFiles() const {
+  return m_watcher->files();
+}
+
+bool GitRepositoryWatcher::hasPendingChanges() const {
+  return m_pendingHead || m_pendingIndex || !m_pendingDirectories.isEmpty();
+}
+
+void GitRepositoryWatcher::setDebounceInterval(int msec) {
+  m_flushTimer.setInterval(qMax(0, msec));
+}
+
+void GitRepositoryWatcher::flush() {
+  if (m_flushTimer.isActive()) {
+    m_flushTimer.stop();
+    emitPendingChanges();
+  }
+}
+
+void GitRepositoryWatcher::onDirectoryChanged(const QString &path) {
+  if (m_gitDir.isEmpty()) {
+    return;
+  }
+
+  if (path == m_gitDir) {
+    m_pendingIndex = true;
+    watchMetadata();
+  } else if (path.startsWith(m_gitDir + "/refs")) {
+    m_pendingHead = true;
+    watchRefDirectories(m_gitDir + "/refs");
+  } else if (m_workingTreeDirectories.contains(path)) {
+    m_pendingDirectories.insert(path);
+    if (QFileInfo(path).isDir()) {
+      watchNewEntries(path);
+    } else {
+      m_workingTreeDirectories.remove(path);
+    }
+  } else {
+    return;
+  }
+
+  scheduleFlush();
+}
+
+void GitRepositoryWatcher::onFileChanged(const QString &path) {
+  if (m_gitDir.isEmpty()) {
+    return;
+  }
+
+  if (m_workingTreeFiles.contains(path)) {
+    m_pendingDirectories.insert(QFileInfo(path).absolutePath());
+    if (!QFileInfo::exists(path)) {
+      m_workingTreeFiles.remove(path);
+    } else if (!m_watcher->files().contains(path)) {
+      m_watcher->addPath(path);
+    }
+    scheduleFlush();
+    return;
+  }
+
+  if (path == m_gitDir + "/HEAD" || path == m_gitDir + "/packed-refs") {
+    m_pendingHead = true;
+  } else {
+    m_pendingIndex = true;
+  }
+
+  watchMetadata();
+  scheduleFlush();
+}
+
+void GitRepositoryWatcher::scheduleFlush() {
+  if (!m_burstTimer.isValid()) {
+    m_burstTimer.start();
+  }
+
+  if (m_burstTimer.elapsed() < GIT_WATCHER_MAX_LATENCY_MS ||
+      !m_flushTimer.isActive()) {
+    m_flushTimer.start();
+  }
+}
+
+void GitRepositoryWatcher::emitPendingChanges() {
+  m_burstTimer.invalidate();
+
+  bool headChanged = m_pendingHead;
+  const bool indexChanged = m_pendingIndex;
+  QStringList directories(m_pendingDirectories.begin(),
+                          m_pendingDirectories.end());
+  m_pendingHead = false;
+  m_pendingIndex = false;
+  m_pendingDirectories.clear();
+
+  if (indexChanged || headChanged) {
+    const QByteArray head = readHeadFile(m_gitDir);
+    if (head != m_headContent) {
+      m_headContent = head;
+      headChanged = true;
+    }
+    emit metadataChanged(headChanged);
+    return;
+  }
+
+  if (!directories.isEmpty()) {
+    std::sort(directories.begin(), directories.end());
+    emit workingTreeChanged(directories);
+  }
+}
+
+void GitRepositoryWatcher::watchMetadata() {
+  const QStringList watchedFiles = m_watcher->files();
+  const QStringList watchedDirs = m_watcher->directories();
+
+  if (!watchedDirs.contains(m_gitDir)) {
+    m_watcher->addPath(m_gitDir);
+  }
+
+  for (const QString &name : {QStringLiteral("index"), QStringLiteral("HEAD"),
+                              QStringLiteral("packed-refs")}) {
+    const QString path = m_gitDir + "/" + name;
+    if (!watchedFiles.contains(path) && QFileInfo::exists(path)) {
+      m_watcher->addPath(path);
+    }
+  }
+
+  watchRefDirectories(m_gitDir + "/refs");
+}
+
+void GitRepositoryWatcher::watchRefDirectories(const QString &refsPath) {
+  if (!QFileInfo(refsPath).isDir()) {
+    return;
+  }
+
+  const QStringList watchedDirs = m_watcher->directories();
+  QStringList toAdd;
+  if (!watchedDirs.contains(refsPath)) {
+    toAdd.append(refsPath);
+  }
+
+  QDirIterator it(refsPath, QDir::Dirs | QDir::NoDotAndDotDot,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    const QString dir = it.next();
+    if (!watchedDirs.contains(dir)) {
+      toAdd.append(dir);
+    }
+  }
+
+  if (!toAdd.isEmpty()) {
+    m_watcher->addPaths(toAdd);
+  }
+}
+
+void GitRepositoryWatcher::watchNewEntries(const QString &directory) {
+  QStringList newDirectories;
+  QStringList newFiles;
+  QDirIterator it(directory,
+                  QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot |
+                      QDir::Hidden | QDir::NoSymLinks);
+  while (it.hasNext()) {
+    const QString path = QDir::cleanPath(it.next());
+    if (!isWorkingTreePath(path)) {
+      continue;
+    }
+
+    if (it.fileInfo().isDir()) {
+      if (m_workingTreeDirectories.contains(path) ||
+          m_workingTreeDirectories.size() + newDirectories.size() >=
+              GIT_WATCHER_MAX_DIRECTORIES) {
+        continue;
+      }
+      newDirectories.append(path);
+    } else if (!m_workingTreeFiles.contains(path) &&
+               m_workingTreeFiles.size() + newFiles.size() <
+                   GIT_WATCHER_MAX_FILES) {
+      newFiles.append(path);
+    }
+  }
+
+  for (const QString &path : newFiles) {
+    m_workingTreeFiles.insert(path);
+  }
+  if (!newFiles.isEmpty()) {
+    m_watcher->addPaths(newFiles);
+  }
+
+  for (const QString &path : newDirectories) {
+    m_workingTreeDirectories.insert(path);
+    m_pendingDirectories.insert(path);
+  }
+  if (!newDirectories.isEmpty()) {
+    m_watcher->addPaths(newDirectories);
+  }
+  for (const QString &path : newDirectories) {
+    watchNewEntries(path);
+  }
+}
+
+bool GitRepositoryWatcher::isWorkingTreePath(const QString &path) const {
+  return path != m_gitDir && !path.startsWith(m_gitDir + "/") &&
+         QFileInfo(path).fileName() != QLatin1String(".git");
+}
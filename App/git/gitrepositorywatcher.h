@@ -0,0 +1,66 @@
+#ifndef GITREPOSITORYWATCHER_H
+#define GITREPOSITORYWATCHER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+class QFileSystemWatcher;
+
+constexpr int GIT_WATCHER_DEBOUNCE_MS = 150;
+constexpr int GIT_WATCHER_MAX_LATENCY_MS = 1000;
+constexpr int GIT_WATCHER_MAX_DIRECTORIES = 4096;
+constexpr int GIT_WATCHER_MAX_FILES = 8192;
+
+class GitRepositoryWatcher : public QObject {
+  Q_OBJECT
+
+public:
+  explicit GitRepositoryWatcher(QObject *parent = nullptr);
+
+  void setRepository(const QString &repositoryPath,
+                     const QStringList &workingTreeDirectories,
+                     const QStringList &workingTreeFiles = QStringList());
+  void clear();
+
+  QString repositoryPath() const { return m_repositoryPath; }
+  QString gitDirectory() const { return m_gitDir; }
+  QStringList watchedDirectories() const;
+  QStringList watchedFiles() const;
+  bool hasPendingChanges() const;
+
+  void setDebounceInterval(int msec);
+  void flush();
+
+  static QString resolveGitDirectory(const QString &repositoryPath);
+
+signals:
+  void metadataChanged(bool headChanged);
+  void workingTreeChanged(const QStringList &directories);
+
+private:
+  void onDirectoryChanged(const QString &path);
+  void onFileChanged(const QString &path);
+  void scheduleFlush();
+  void emitPendingChanges();
+  void watchMetadata();
+  void watchRefDirectories(const QString &refsPath);
+  void watchNewEntries(const QString &directory);
+  bool isWorkingTreePath(const QString &path) const;
+
+  QFileSystemWatcher *m_watcher;
+  QString m_repositoryPath;
+  QString m_gitDir;
+  QByteArray m_headContent;
+  QSet<QString> m_workingTreeDirectories;
+  QSet<QString> m_workingTreeFiles;
+  QSet<QString> m_pendingDirectories;
+  bool m_pendingIndex;
+  bool m_pendingHead;
+  QTimer m_flushTimer;
+  QElapsedTimer m_burstTimer;
+};
+
+#endif
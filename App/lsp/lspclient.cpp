@@ -577,6 +577,8 @@ void LspClient::handleResponse(int id, const QJsonValue &result,
     QJsonArray itemsArray = result.isArray()
                                 ? result.toArray()
                                 : result.toObject()["items"].toArray();
+    const bool isIncomplete =
+        !result.isArray() && result.toObject()["isIncomplete"].toBool();
     for (const QJsonValue &val : itemsArray) {
       QJsonObject obj = val.toObject();
       LspCompletionItem item;
@@ -586,7 +588,7 @@ void LspClient::handleResponse(int id, const QJsonValue &result,
       item.insertText = obj["insertText"].toString(item.label);
       items.append(item);
     }
-    emit completionReceived(id, items);
+    emit completionReceived(id, items, isIncomplete);
   } else if (method == "textDocument/hover") {
     QString contents;
     QJsonObject obj = result.toObject();
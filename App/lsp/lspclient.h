@@ -235,7 +235,8 @@ signals:
   void diagnosticsReceived(const QString &uri,
                            const QList<LspDiagnostic> &diagnostics);
 
-  void completionReceived(int requestId, const QList<LspCompletionItem> &items);
+  void completionReceived(int requestId, const QList<LspCompletionItem> &items,
+                          bool isIncomplete);
   void hoverReceived(int requestId, const QString &contents);
   void definitionReceived(int requestId, const QList<LspLocation> &locations);
   void referencesReceived(int requestId, const QList<LspLocation> &locations);
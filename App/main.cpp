@@ -1,5 +1,7 @@
 #include <QApplication>
 
+#include "core/profiling/startuptracer.h"
+
 #include "syntax/bazelsyntaxplugin.h"
 #include "syntax/cmakesyntaxplugin.h"
 #include "syntax/cppsyntaxplugin.h"
@@ -26,6 +28,7 @@
 #include <memory>
 
 void registerBuiltInSyntaxPlugins() {
+  STARTUP_TRACE_SCOPE("registerBuiltInSyntaxPlugins");
   auto &registry = SyntaxPluginRegistry::instance();
 
   registry.registerPlugin(std::make_unique<BazelSyntaxPlugin>());
@@ -51,19 +54,35 @@ void registerBuiltInSyntaxPlugins() {
 }
 
 int main(int argv, char **args) {
+  StartupTracer &tracer = StartupTracer::instance();
+  QStringList rawArguments;
+  for (int i = 1; i < argv; ++i) {
+    rawArguments.append(QString::fromLocal8Bit(args[i]));
+  }
+  tracer.configure(rawArguments);
+
+  qint64 phaseStart = tracer.nowNanoseconds();
   QApplication app(argv, args);
   app.setApplicationName("Lightpad");
   app.setOrganizationName("Lightpad");
   app.setWindowIcon(QIcon(":/resources/icons/app.png"));
   app.setStyle(new HackerStyle());
+  tracer.recordPhase("QApplication", phaseStart,
+                     tracer.nowNanoseconds() - phaseStart);
 
   registerBuiltInSyntaxPlugins();
 
+  phaseStart = tracer.nowNanoseconds();
   MainWindow w;
+  tracer.recordPhase("MainWindow", phaseStart,
+                     tracer.nowNanoseconds() - phaseStart);
+  tracer.watchWindow(&w);
 
-  QStringList arguments = app.arguments();
-  if (arguments.size() > 1) {
-    w.openPathsFromCommandLine(arguments.mid(1));
+  QStringList arguments =
+      StartupTracer::stripArguments(app.arguments().mid(1));
+  if (!arguments.isEmpty()) {
+    STARTUP_TRACE_SCOPE("openPathsFromCommandLine");
+    w.openPathsFromCommandLine(arguments);
   }
 
   return app.exec();
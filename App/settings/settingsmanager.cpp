@@ -8,18 +8,105 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonValue>
+#include <QSaveFile>
 #include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
 #include <functional>
 
+namespace {
+
+bool writeSettingsFile(const QString &filePath, const QJsonObject &settings,
+                       QString *errorMessage) {
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    *errorMessage = file.errorString();
+    return false;
+  }
+
+  const QByteArray data = QJsonDocument(settings).toJson();
+  if (file.write(data) != data.size()) {
+    *errorMessage = file.errorString();
+    file.cancelWriting();
+    return false;
+  }
+
+  if (!file.commit()) {
+    *errorMessage = file.errorString();
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+class SettingsWriter : public QThread {
+public:
+  SettingsWriter(SettingsManager *manager, const QString &filePath,
+                 const QJsonObject &settings)
+      : m_manager(manager), m_filePath(filePath), m_settings(settings) {}
+
+protected:
+  void run() override {
+    QString errorMessage;
+    const bool success =
+        writeSettingsFile(m_filePath, m_settings, &errorMessage);
+
+    SettingsManager *manager = m_manager;
+    const QString filePath = m_filePath;
+    QMetaObject::invokeMethod(
+        manager,
+        [manager, success, filePath, errorMessage]() {
+          manager->onBackgroundSaveFinished(success, filePath, errorMessage);
+        },
+        Qt::QueuedConnection);
+  }
+
+private:
+  SettingsManager *m_manager;
+  QString m_filePath;
+  QJsonObject m_settings;
+};
+
+SettingKey::SettingKey(const QString &path)
+    : m_path(path), m_segments(path.split('.')) {
+  m_prefixes.reserve(m_segments.size());
+  for (int dot = path.indexOf('.'); dot > 0; dot = path.indexOf('.', dot + 1)) {
+    m_prefixes.append(path.left(dot));
+  }
+  m_prefixes.append(path);
+}
+
+bool SettingKey::isAffectedBy(const QString &changedKey) const {
+  if (changedKey.isEmpty() || changedKey == m_path) {
+    return true;
+  }
+  if (changedKey.size() < m_path.size()) {
+    return m_path.startsWith(changedKey) &&
+           m_path.at(changedKey.size()) == QLatin1Char('.');
+  }
+  return changedKey.startsWith(m_path) &&
+         changedKey.at(m_path.size()) == QLatin1Char('.');
+}
+
 SettingsManager &SettingsManager::instance() {
   static SettingsManager instance;
   return instance;
 }
 
-SettingsManager::SettingsManager() : QObject(nullptr), m_dirty(false) {
+SettingsManager::SettingsManager()
+    : QObject(nullptr), m_dirty(false), m_generation(1), m_resetVersion(1),
+      m_saveTimer(nullptr), m_writer(nullptr), m_saveQueued(false) {
   initializeDefaults();
 }
 
+SettingsManager::~SettingsManager() {
+  if (m_writer) {
+    m_writer->wait();
+    delete m_writer;
+  }
+}
+
 void SettingsManager::initializeDefaults() {
 
   m_defaults["fontFamily"] = "Ubuntu Mono";
@@ -35,6 +122,9 @@ void SettingsManager::initializeDefaults() {
   m_defaults["trimTrailingWhitespace"] = false;
   m_defaults["insertFinalNewline"] = false;
   m_defaults["autoSaveFiles"] = true;
+  m_defaults["saveSyncPolicy"] = "explicit";
+  m_defaults["prewarmRestoredTabs"] = false;
+  m_defaults["terminalScrollbackMegabytes"] = 32;
 
   QJsonObject themeDefaults;
   themeDefaults["backgroundColor"] = "#0e1116";
@@ -171,6 +261,7 @@ bool SettingsManager::loadSettings() {
   if (!file.exists()) {
     LOG_INFO("Settings file does not exist, using defaults");
     m_settings = m_defaults;
+    invalidate(QString());
     emit settingsLoaded();
     return true;
   }
@@ -190,6 +281,7 @@ bool SettingsManager::loadSettings() {
     LOG_ERROR(
         QString("Failed to parse settings: %1").arg(parseError.errorString()));
     m_settings = m_defaults;
+    invalidate(QString());
     emit settingsLoaded();
     return false;
   }
@@ -208,43 +300,121 @@ bool SettingsManager::loadSettings() {
   }
 
   LOG_INFO(QString("Settings loaded from: %1").arg(filePath));
+  invalidate(QString());
   emit settingsLoaded();
   return true;
 }
 
 bool SettingsManager::saveSettings() {
+  if (m_saveTimer) {
+    m_saveTimer->stop();
+  }
+  m_saveQueued = false;
+  if (m_writer) {
+    m_writer->wait();
+  }
+
   if (!ensureSettingsDirectoryExists()) {
     return false;
   }
 
   QString filePath = getSettingsFilePath();
-  QFile file(filePath);
+  m_settings["settingsVersion"] = SETTINGS_VERSION;
 
-  if (!file.open(QIODevice::WriteOnly)) {
-    LOG_ERROR(
-        QString("Cannot open settings file for writing: %1").arg(filePath));
+  QString errorMessage;
+  if (!writeSettingsFile(filePath, m_settings, &errorMessage)) {
+    LOG_ERROR(QString("Cannot write settings file %1: %2")
+                  .arg(filePath, errorMessage));
     return false;
   }
 
-  m_settings["settingsVersion"] = SETTINGS_VERSION;
-
-  QJsonDocument doc(m_settings);
-  file.write(doc.toJson(QJsonDocument::Indented));
-  file.close();
-
   m_dirty = false;
   LOG_INFO(QString("Settings saved to: %1").arg(filePath));
   emit settingsSaved();
   return true;
 }
 
+void SettingsManager::requestSave() {
+  if (!m_saveTimer) {
+    m_saveTimer = new QTimer(this);
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(SETTINGS_SAVE_DEBOUNCE_MS);
+    connect(m_saveTimer, &QTimer::timeout, this,
+            &SettingsManager::writeInBackground);
+    if (QCoreApplication::instance()) {
+      connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+              this, &SettingsManager::flushPendingSave);
+    }
+  }
+  m_saveTimer->start();
+}
+
+void SettingsManager::flushPendingSave() {
+  if ((m_saveTimer && m_saveTimer->isActive()) || m_saveQueued) {
+    saveSettings();
+  } else if (m_writer) {
+    m_writer->wait();
+  }
+}
+
+bool SettingsManager::hasPendingSave() const {
+  return (m_saveTimer && m_saveTimer->isActive()) || m_writer ||
+         m_saveQueued;
+}
+
+void SettingsManager::writeInBackground() {
+  if (m_writer) {
+    m_saveQueued = true;
+    return;
+  }
+  if (!ensureSettingsDirectoryExists()) {
+    return;
+  }
+
+  m_settings["settingsVersion"] = SETTINGS_VERSION;
+  m_writer = new SettingsWriter(this, getSettingsFilePath(), m_settings);
+  m_writer->start();
+}
+
+void SettingsManager::onBackgroundSaveFinished(bool success,
+                                               const QString &filePath,
+                                               const QString &errorMessage) {
+  if (m_writer) {
+    m_writer->wait();
+    delete m_writer;
+    m_writer = nullptr;
+  }
+
+  if (!success) {
+    LOG_ERROR(QString("Cannot write settings file %1: %2")
+                  .arg(filePath, errorMessage));
+  } else {
+    if (!m_saveQueued && !(m_saveTimer && m_saveTimer->isActive())) {
+      m_dirty = false;
+    }
+    emit settingsSaved();
+  }
+
+  if (m_saveQueued) {
+    m_saveQueued = false;
+    writeInBackground();
+  }
+}
+
 QVariant SettingsManager::getValue(const QString &key,
                                    const QVariant &defaultValue) const {
+  if (!key.contains('.')) {
+    const QJsonValue value = m_settings.value(key);
+    return value.isUndefined() ? defaultValue : value.toVariant();
+  }
+  return getValue(SettingKey(key), defaultValue);
+}
 
-  QStringList keys = key.split('.');
+QVariant SettingsManager::getValue(const SettingKey &key,
+                                   const QVariant &defaultValue) const {
   QJsonValue value = m_settings;
 
-  for (const QString &k : keys) {
+  for (const QString &k : key.segments()) {
     if (!value.isObject()) {
       return defaultValue;
     }
@@ -269,6 +439,7 @@ void SettingsManager::setValue(const QString &key, const QVariant &value) {
   if (keys.size() == 1) {
     m_settings[key] = QJsonValue::fromVariant(value);
     m_dirty = true;
+    invalidate(key);
     emit settingChanged(key, value);
     return;
   }
@@ -294,6 +465,7 @@ void SettingsManager::setValue(const QString &key, const QVariant &value) {
   setNested(m_settings, 0);
 
   m_dirty = true;
+  invalidate(key);
   emit settingChanged(key, value);
 }
 
@@ -317,9 +489,46 @@ bool SettingsManager::hasKey(const QString &key) const {
 void SettingsManager::resetToDefaults() {
   m_settings = m_defaults;
   m_dirty = true;
+  invalidate(QString());
   LOG_INFO("Settings reset to defaults");
 }
 
+void SettingsManager::invalidate(const QString &key) {
+  const quint64 version = ++m_generation;
+  if (key.isEmpty()) {
+    m_resetVersion = version;
+    m_keyVersions.clear();
+    m_subtreeVersions.clear();
+  } else {
+    m_keyVersions.insert(key, version);
+    for (int dot = key.lastIndexOf('.'); dot > 0;
+         dot = key.lastIndexOf('.', dot - 1)) {
+      m_subtreeVersions.insert(key.left(dot), version);
+    }
+  }
+  emit settingsInvalidated(key);
+}
+
+quint64 SettingsManager::version(const SettingKey &key) const {
+  quint64 result =
+      qMax(m_resetVersion, m_subtreeVersions.value(key.path(), 0));
+  for (const QString &prefix : key.prefixes()) {
+    result = qMax(result, m_keyVersions.value(prefix, 0));
+  }
+  return result;
+}
+
+QMetaObject::Connection
+SettingsManager::subscribe(const SettingKey &key, QObject *context,
+                           std::function<void()> callback) {
+  return connect(this, &SettingsManager::settingsInvalidated, context,
+                 [key, callback](const QString &changedKey) {
+                   if (key.isAffectedBy(changedKey)) {
+                     callback();
+                   }
+                 });
+}
+
 const QJsonObject &SettingsManager::getSettingsObject() const {
   return m_settings;
 }
@@ -348,6 +557,7 @@ bool SettingsManager::migrateFromOldPath(const QString &oldPath) {
   }
 
   m_settings = doc.object();
+  invalidate(QString());
 
   if (saveSettings()) {
     LOG_INFO(QString("Successfully migrated settings from %1 to %2")
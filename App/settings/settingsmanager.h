@@ -1,10 +1,35 @@
 #ifndef SETTINGSMANAGER_H
 #define SETTINGSMANAGER_H
 
+#include <QHash>
 #include <QJsonObject>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QVariant>
+#include <functional>
+
+class QTimer;
+
+constexpr int SETTINGS_SAVE_DEBOUNCE_MS = 500;
+
+class SettingKey {
+public:
+  explicit SettingKey(const QString &path);
+
+  const QString &path() const { return m_path; }
+
+  const QStringList &segments() const { return m_segments; }
+
+  const QStringList &prefixes() const { return m_prefixes; }
+
+  bool isAffectedBy(const QString &changedKey) const;
+
+private:
+  QString m_path;
+  QStringList m_segments;
+  QStringList m_prefixes;
+};
 
 class SettingsManager : public QObject {
   Q_OBJECT
@@ -22,9 +47,18 @@ public:
 
   bool saveSettings();
 
+  void requestSave();
+
+  void flushPendingSave();
+
+  bool hasPendingSave() const;
+
   QVariant getValue(const QString &key,
                     const QVariant &defaultValue = QVariant()) const;
 
+  QVariant getValue(const SettingKey &key,
+                    const QVariant &defaultValue = QVariant()) const;
+
   void setValue(const QString &key, const QVariant &value);
 
   bool hasKey(const QString &key) const;
@@ -35,27 +69,80 @@ public:
 
   bool migrateFromOldPath(const QString &oldPath);
 
+  quint64 generation() const { return m_generation; }
+
+  quint64 version(const SettingKey &key) const;
+
+  QMetaObject::Connection subscribe(const SettingKey &key, QObject *context,
+                                    std::function<void()> callback);
+
 signals:
 
   void settingChanged(const QString &key, const QVariant &value);
 
+  void settingsInvalidated(const QString &key);
+
   void settingsLoaded();
 
   void settingsSaved();
 
 private:
+  friend class SettingsWriter;
+
   SettingsManager();
-  ~SettingsManager() = default;
+  ~SettingsManager();
   SettingsManager(const SettingsManager &) = delete;
   SettingsManager &operator=(const SettingsManager &) = delete;
 
   void initializeDefaults();
   void migrateSettings(int fromVersion);
   bool ensureSettingsDirectoryExists();
+  void invalidate(const QString &key);
+  void writeInBackground();
+  void onBackgroundSaveFinished(bool success, const QString &filePath,
+                                const QString &errorMessage);
 
   QJsonObject m_settings;
   QJsonObject m_defaults;
   bool m_dirty;
+  quint64 m_generation;
+  quint64 m_resetVersion;
+  QHash<QString, quint64> m_keyVersions;
+  QHash<QString, quint64> m_subtreeVersions;
+  QTimer *m_saveTimer;
+  class SettingsWriter *m_writer;
+  bool m_saveQueued;
+};
+
+template <typename T> class Setting {
+public:
+  Setting(const QString &key, const T &defaultValue)
+      : m_key(key), m_defaultValue(defaultValue), m_value(defaultValue),
+        m_version(0) {}
+
+  const SettingKey &key() const { return m_key; }
+
+  const T &value() const {
+    const SettingsManager &manager = SettingsManager::instance();
+    const quint64 version = manager.version(m_key);
+    if (m_version != version) {
+      m_value = manager.getValue(m_key, QVariant::fromValue(m_defaultValue))
+                    .template value<T>();
+      m_version = version;
+    }
+    return m_value;
+  }
+
+  void setValue(const T &value) {
+    SettingsManager::instance().setValue(m_key.path(),
+                                         QVariant::fromValue(value));
+  }
+
+private:
+  SettingKey m_key;
+  T m_defaultValue;
+  mutable T m_value;
+  mutable quint64 m_version;
 };
 
 #endif
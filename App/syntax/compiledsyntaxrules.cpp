@@ -0,0 +1,108 @@
+#include "compiledsyntaxrules.h"
+#include "../core/logging/logger.h"
+
+namespace {
+
+bool isStringLikeRule(const QString &ruleName) {
+  return ruleName.contains("string") || ruleName.contains("quotation");
+}
+
+bool isCommentLikeRule(const QString &ruleName) {
+  return ruleName.contains("comment");
+}
+
+int paletteIndexFor(CompiledSyntaxRules *rules, SyntaxStyle style,
+                    const QTextCharFormat &baseFormat) {
+  if (baseFormat.properties().isEmpty()) {
+    return static_cast<int>(style);
+  }
+  for (int i = 0; i < rules->customFormats.size(); ++i) {
+    if (rules->customStyles.at(i) == style &&
+        rules->customFormats.at(i) == baseFormat) {
+      return SYNTAX_STYLE_COUNT + i;
+    }
+  }
+  rules->customStyles.append(style);
+  rules->customFormats.append(baseFormat);
+  return SYNTAX_STYLE_COUNT + static_cast<int>(rules->customFormats.size()) - 1;
+}
+
+} // namespace
+
+SyntaxStyle CompiledSyntaxRules::classify(const QString &ruleName) {
+  const QString name = ruleName.toLower();
+
+  if (name.contains("keyword") || name.contains("preprocessor") ||
+      name.contains("directive")) {
+    if (name.contains("0") || name.contains("primary")) {
+      return SyntaxStyle::Keyword0;
+    }
+    if (name.contains("1") || name.contains("secondary")) {
+      return SyntaxStyle::Keyword1;
+    }
+    if (name.contains("2") || name.contains("tertiary")) {
+      return SyntaxStyle::Keyword2;
+    }
+    return SyntaxStyle::Keyword0;
+  }
+  if (name.contains("number")) {
+    return SyntaxStyle::Number;
+  }
+  if (isStringLikeRule(name)) {
+    return SyntaxStyle::String;
+  }
+  if (isCommentLikeRule(name)) {
+    return SyntaxStyle::Comment;
+  }
+  if (name.contains("function")) {
+    return SyntaxStyle::Function;
+  }
+  if (name.contains("class") || name.contains("type") ||
+      name.contains("scope") || name.contains("scoped")) {
+    return SyntaxStyle::Class;
+  }
+  return SyntaxStyle::Plain;
+}
+
+std::shared_ptr<const CompiledSyntaxRules>
+CompiledSyntaxRules::compile(const ISyntaxPlugin &plugin) {
+  auto rules = std::make_shared<CompiledSyntaxRules>();
+  rules->languageId = plugin.languageId();
+  rules->languageName = plugin.languageName();
+
+  for (const SyntaxRule &rule : plugin.syntaxRules()) {
+    const QString name = rule.name.toLower();
+    CompiledSyntaxRule compiled{
+        rule.pattern,
+        paletteIndexFor(rules.get(), classify(name), rule.format)};
+    compiled.pattern.optimize();
+
+    const bool stringLike = isStringLikeRule(name);
+    const bool commentLike = isCommentLikeRule(name);
+    if (stringLike) {
+      rules->stringRules.append(compiled);
+    }
+    if (commentLike) {
+      rules->commentRules.append(compiled);
+    }
+    if (!stringLike && !commentLike) {
+      rules->otherRules.append(compiled);
+    }
+  }
+
+  for (const MultiLineBlock &block : plugin.multiLineBlocks()) {
+    CompiledMultiLineBlock compiled{
+        block.startPattern, block.endPattern,
+        paletteIndexFor(rules.get(), SyntaxStyle::Comment, block.format)};
+    compiled.startPattern.optimize();
+    compiled.endPattern.optimize();
+    rules->multiLineBlocks.append(compiled);
+  }
+
+  Logger::instance().info(
+      QString("Compiled %1 rules and %2 multi-line blocks for plugin '%3'")
+          .arg(rules->ruleCount())
+          .arg(rules->multiLineBlocks.size())
+          .arg(rules->languageName));
+  return rules;
+}
@@ -0,0 +1,64 @@
+#ifndef COMPILEDSYNTAXRULES_H
+#define COMPILEDSYNTAXRULES_H
+
+#include "../plugins/isyntaxplugin.h"
+#include <QRegularExpression>
+#include <QString>
+#include <QTextCharFormat>
+#include <QVector>
+#include <memory>
+
+enum class SyntaxStyle : int {
+  Plain = 0,
+  Keyword0,
+  Keyword1,
+  Keyword2,
+  Number,
+  String,
+  Comment,
+  Function,
+  Class,
+  Count
+};
+
+constexpr int SYNTAX_STYLE_COUNT = static_cast<int>(SyntaxStyle::Count);
+
+struct CompiledSyntaxRule {
+  QRegularExpression pattern;
+  int paletteIndex;
+};
+
+struct CompiledMultiLineBlock {
+  QRegularExpression startPattern;
+  QRegularExpression endPattern;
+  int paletteIndex;
+};
+
+struct CompiledSyntaxRules {
+  QString languageId;
+  QString languageName;
+
+  QVector<CompiledSyntaxRule> stringRules;
+  QVector<CompiledSyntaxRule> commentRules;
+  QVector<CompiledSyntaxRule> otherRules;
+  QVector<CompiledMultiLineBlock> multiLineBlocks;
+
+  QVector<SyntaxStyle> customStyles;
+  QVector<QTextCharFormat> customFormats;
+
+  int paletteSize() const {
+    return SYNTAX_STYLE_COUNT + static_cast<int>(customFormats.size());
+  }
+
+  int ruleCount() const {
+    return static_cast<int>(stringRules.size() + commentRules.size() +
+                            otherRules.size());
+  }
+
+  static SyntaxStyle classify(const QString &ruleName);
+
+  static std::shared_ptr<const CompiledSyntaxRules>
+  compile(const ISyntaxPlugin &plugin);
+};
+
+#endif
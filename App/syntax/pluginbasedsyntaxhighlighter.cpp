@@ -1,27 +1,90 @@
 #include "pluginbasedsyntaxhighlighter.h"
 #include "../core/logging/logger.h"
+#include "../core/profiling/paintprofiler.h"
 #include <QBitArray>
-#include <functional>
+
+namespace {
+QTextCharFormat applyStyle(QTextCharFormat format, SyntaxStyle style,
+                           const Theme &theme) {
+  switch (style) {
+  case SyntaxStyle::Keyword0:
+    format.setForeground(theme.keywordFormat_0);
+    format.setFontWeight(QFont::Bold);
+    break;
+  case SyntaxStyle::Keyword1:
+    format.setForeground(theme.keywordFormat_1);
+    format.setFontWeight(QFont::Bold);
+    break;
+  case SyntaxStyle::Keyword2:
+    format.setForeground(theme.keywordFormat_2);
+    break;
+  case SyntaxStyle::Number:
+    format.setForeground(theme.numberFormat);
+    break;
+  case SyntaxStyle::String:
+    format.setForeground(theme.quotationFormat);
+    break;
+  case SyntaxStyle::Comment:
+    format.setForeground(theme.singleLineCommentFormat);
+    break;
+  case SyntaxStyle::Function:
+    format.setForeground(theme.functionFormat);
+    format.setFontItalic(true);
+    break;
+  case SyntaxStyle::Class:
+    format.setForeground(theme.classFormat);
+    format.setFontWeight(QFont::Bold);
+    break;
+  case SyntaxStyle::Plain:
+  case SyntaxStyle::Count:
+    break;
+  }
+  return format;
+}
+} // namespace
 
 PluginBasedSyntaxHighlighter::PluginBasedSyntaxHighlighter(
     ISyntaxPlugin *plugin, const Theme &theme, const QString &searchKeyword,
     QTextDocument *parent)
+    : PluginBasedSyntaxHighlighter(
+          plugin ? CompiledSyntaxRules::compile(*plugin) : nullptr, theme,
+          searchKeyword, parent) {}
+
+PluginBasedSyntaxHighlighter::PluginBasedSyntaxHighlighter(
+    std::shared_ptr<const CompiledSyntaxRules> rules, const Theme &theme,
+    const QString &searchKeyword, QTextDocument *parent)
     : QSyntaxHighlighter(parent), m_theme(theme),
-      m_searchKeyword(searchKeyword), m_firstVisibleBlock(-1),
-      m_lastVisibleBlock(-1) {
-  if (!plugin) {
+      m_searchKeyword(searchKeyword), m_rules(std::move(rules)),
+      m_firstVisibleBlock(-1), m_lastVisibleBlock(-1) {
+  m_searchFormat.setBackground(QColor("#646464"));
+  if (!m_rules) {
     Logger::instance().warning(
-        "PluginBasedSyntaxHighlighter created with null plugin");
+        "PluginBasedSyntaxHighlighter created without syntax rules");
     return;
   }
 
-  loadRulesFromPlugin(plugin, theme);
+  m_palette = buildPalette(*m_rules, theme);
+}
 
-  m_searchFormat.setBackground(QColor("#646464"));
+QVector<QTextCharFormat>
+PluginBasedSyntaxHighlighter::buildPalette(const CompiledSyntaxRules &rules,
+                                           const Theme &theme) {
+  QVector<QTextCharFormat> palette;
+  palette.reserve(rules.paletteSize());
+  for (int style = 0; style < SYNTAX_STYLE_COUNT; ++style) {
+    palette.append(
+        applyStyle(QTextCharFormat(), static_cast<SyntaxStyle>(style), theme));
+  }
+  for (int i = 0; i < rules.customFormats.size(); ++i) {
+    palette.append(applyStyle(rules.customFormats.at(i),
+                              rules.customStyles.at(i), theme));
+  }
+  return palette;
 }
 
 void PluginBasedSyntaxHighlighter::setSearchKeyword(const QString &keyword) {
   m_searchKeyword = keyword;
+  PAINT_PROFILE_COUNT("rehighlights");
   rehighlight();
 }
 
@@ -62,71 +125,9 @@ void PluginBasedSyntaxHighlighter::setVisibleBlockRange(int first, int last) {
   }
 }
 
-void PluginBasedSyntaxHighlighter::loadRulesFromPlugin(ISyntaxPlugin *plugin,
-                                                       const Theme &theme) {
-  if (!plugin) {
-    return;
-  }
-
-  m_rules = plugin->syntaxRules();
-
-  for (SyntaxRule &rule : m_rules) {
-    rule.format = applyThemeToFormat(rule, theme);
-  }
-
-  m_multiLineBlocks = plugin->multiLineBlocks();
-
-  for (MultiLineBlock &block : m_multiLineBlocks) {
-
-    block.format.setForeground(theme.singleLineCommentFormat);
-  }
-
-  Logger::instance().info(
-      QString("Loaded %1 rules and %2 multi-line blocks from plugin '%3'")
-          .arg(m_rules.size())
-          .arg(m_multiLineBlocks.size())
-          .arg(plugin->languageName()));
-}
-
-QTextCharFormat
-PluginBasedSyntaxHighlighter::applyThemeToFormat(const SyntaxRule &rule,
-                                                 const Theme &theme) {
-  QTextCharFormat format = rule.format;
-  QString ruleName = rule.name.toLower();
-
-  if (ruleName.contains("keyword") || ruleName.contains("preprocessor") ||
-      ruleName.contains("directive")) {
-    if (ruleName.contains("0") || ruleName.contains("primary")) {
-      format.setForeground(theme.keywordFormat_0);
-      format.setFontWeight(QFont::Bold);
-    } else if (ruleName.contains("1") || ruleName.contains("secondary")) {
-      format.setForeground(theme.keywordFormat_1);
-      format.setFontWeight(QFont::Bold);
-    } else if (ruleName.contains("2") || ruleName.contains("tertiary")) {
-      format.setForeground(theme.keywordFormat_2);
-    } else {
-      format.setForeground(theme.keywordFormat_0);
-      format.setFontWeight(QFont::Bold);
-    }
-  } else if (ruleName.contains("number")) {
-    format.setForeground(theme.numberFormat);
-  } else if (ruleName.contains("string") || ruleName.contains("quotation")) {
-    format.setForeground(theme.quotationFormat);
-  } else if (ruleName.contains("comment")) {
-    format.setForeground(theme.singleLineCommentFormat);
-  } else if (ruleName.contains("function")) {
-    format.setForeground(theme.functionFormat);
-    format.setFontItalic(true);
-  } else if (ruleName.contains("class") || ruleName.contains("type") ||
-             ruleName.contains("scope") || ruleName.contains("scoped")) {
-    format.setForeground(theme.classFormat);
-    format.setFontWeight(QFont::Bold);
-  }
-
-  return format;
-}
-
 void PluginBasedSyntaxHighlighter::highlightBlock(const QString &text) {
+  PAINT_PROFILE_SCOPE("highlightBlock");
+  PAINT_PROFILE_COUNT("blocksHighlighted");
 
   if (text.isEmpty()) {
     setCurrentBlockState(previousBlockState());
@@ -171,82 +172,67 @@ void PluginBasedSyntaxHighlighter::highlightBlock(const QString &text) {
     }
   };
 
-  auto isStringLikeRule = [](const QString &ruleName) {
-    QString normalized = ruleName.toLower();
-    return normalized.contains("string") || normalized.contains("quotation");
-  };
-
-  auto isCommentLikeRule = [](const QString &ruleName) {
-    QString normalized = ruleName.toLower();
-    return normalized.contains("comment");
-  };
-
-  auto applyRules = [&](const std::function<bool(const QString &)> &predicate,
+  auto applyRules = [&](const QVector<CompiledSyntaxRule> &rules,
                         bool protect) {
-    for (const SyntaxRule &rule : m_rules) {
-      if (!predicate(rule.name)) {
-        continue;
-      }
-
+    for (const CompiledSyntaxRule &rule : rules) {
       QRegularExpressionMatchIterator matchIterator =
           rule.pattern.globalMatch(text);
 
       while (matchIterator.hasNext()) {
         QRegularExpressionMatch match = matchIterator.next();
         applyFormatRange(match.capturedStart(), match.capturedLength(),
-                         rule.format, protect);
+                         m_palette.at(rule.paletteIndex), protect);
       }
     }
   };
 
   setCurrentBlockState(0);
-  for (int i = 0; i < m_multiLineBlocks.size(); ++i) {
-    const MultiLineBlock &block = m_multiLineBlocks[i];
-    int stateId = i + 1;
-
-    int startIndex = 0;
-    if (previousBlockState() != stateId) {
-      QRegularExpressionMatch startMatch = block.startPattern.match(text);
-      startIndex = startMatch.hasMatch() ? startMatch.capturedStart() : -1;
-    }
-
-    while (startIndex >= 0) {
-
-      QRegularExpressionMatch startMatch =
-          block.startPattern.match(text, startIndex);
-      int searchFrom =
-          (previousBlockState() == stateId)
-              ? startIndex
-              : startIndex +
-                    (startMatch.hasMatch() ? startMatch.capturedLength() : 1);
-
-      QRegularExpressionMatch endMatch =
-          block.endPattern.match(text, searchFrom);
-      int endIndex = endMatch.capturedStart();
-      int blockLength = 0;
-
-      if (endIndex == -1) {
-        setCurrentBlockState(stateId);
-        blockLength = text.length() - startIndex;
-      } else {
-        blockLength = endIndex - startIndex + endMatch.capturedLength();
+  if (m_rules) {
+    for (int i = 0; i < m_rules->multiLineBlocks.size(); ++i) {
+      const CompiledMultiLineBlock &block = m_rules->multiLineBlocks[i];
+      const QTextCharFormat &format = m_palette.at(block.paletteIndex);
+      int stateId = i + 1;
+
+      int startIndex = 0;
+      if (previousBlockState() != stateId) {
+        QRegularExpressionMatch startMatch = block.startPattern.match(text);
+        startIndex = startMatch.hasMatch() ? startMatch.capturedStart() : -1;
       }
 
-      applyFormatRange(startIndex, blockLength, block.format, true);
+      while (startIndex >= 0) {
+
+        QRegularExpressionMatch startMatch =
+            block.startPattern.match(text, startIndex);
+        int searchFrom =
+            (previousBlockState() == stateId)
+                ? startIndex
+                : startIndex +
+                      (startMatch.hasMatch() ? startMatch.capturedLength() : 1);
+
+        QRegularExpressionMatch endMatch =
+            block.endPattern.match(text, searchFrom);
+        int endIndex = endMatch.capturedStart();
+        int blockLength = 0;
+
+        if (endIndex == -1) {
+          setCurrentBlockState(stateId);
+          blockLength = text.length() - startIndex;
+        } else {
+          blockLength = endIndex - startIndex + endMatch.capturedLength();
+        }
+
+        applyFormatRange(startIndex, blockLength, format, true);
 
-      QRegularExpressionMatch nextStart =
-          block.startPattern.match(text, startIndex + blockLength);
-      startIndex = nextStart.hasMatch() ? nextStart.capturedStart() : -1;
+        QRegularExpressionMatch nextStart =
+            block.startPattern.match(text, startIndex + blockLength);
+        startIndex = nextStart.hasMatch() ? nextStart.capturedStart() : -1;
+      }
     }
-  }
 
-  applyRules(isStringLikeRule, true);
-  applyRules(isCommentLikeRule, true);
-  applyRules(
-      [&](const QString &ruleName) {
-        return !isStringLikeRule(ruleName) && !isCommentLikeRule(ruleName);
-      },
-      false);
+    applyRules(m_rules->stringRules, true);
+    applyRules(m_rules->commentRules, true);
+    applyRules(m_rules->otherRules, false);
+  }
 
   if (!m_searchKeyword.isEmpty()) {
     QRegularExpression searchPattern(m_searchKeyword,
@@ -289,6 +275,7 @@ void PluginBasedSyntaxHighlighter::rehighlightBlockRange(int firstBlock,
     return;
   }
 
+  PAINT_PROFILE_COUNT("rehighlightRanges");
   QTextBlock block = document()->findBlockByNumber(clampedFirst);
   for (int current = clampedFirst; block.isValid() && current <= clampedLast;
        ++current, block = block.next()) {
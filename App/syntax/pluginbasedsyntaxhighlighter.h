@@ -3,10 +3,12 @@
 
 #include "../plugins/isyntaxplugin.h"
 #include "../settings/theme.h"
+#include "compiledsyntaxrules.h"
 #include <QRegularExpression>
 #include <QSyntaxHighlighter>
 #include <QTextCharFormat>
 #include <QVector>
+#include <memory>
 
 class PluginBasedSyntaxHighlighter : public QSyntaxHighlighter {
   Q_OBJECT
@@ -16,6 +18,18 @@ public:
                                const QString &searchKeyword = "",
                                QTextDocument *parent = nullptr);
 
+  PluginBasedSyntaxHighlighter(std::shared_ptr<const CompiledSyntaxRules> rules,
+                               const Theme &theme,
+                               const QString &searchKeyword = "",
+                               QTextDocument *parent = nullptr);
+
+  std::shared_ptr<const CompiledSyntaxRules> compiledRules() const {
+    return m_rules;
+  }
+
+  static QVector<QTextCharFormat> buildPalette(const CompiledSyntaxRules &rules,
+                                               const Theme &theme);
+
   void setSearchKeyword(const QString &keyword);
 
   QString searchKeyword() const { return m_searchKeyword; }
@@ -29,17 +43,12 @@ private:
   bool isBlockVisible(int blockNumber) const;
   void rehighlightBlockRange(int firstBlock, int lastBlock);
 
-  void loadRulesFromPlugin(ISyntaxPlugin *plugin, const Theme &theme);
-
-  QTextCharFormat applyThemeToFormat(const SyntaxRule &rule,
-                                     const Theme &theme);
-
   Theme m_theme;
   QString m_searchKeyword;
 
-  QVector<SyntaxRule> m_rules;
+  std::shared_ptr<const CompiledSyntaxRules> m_rules;
 
-  QVector<MultiLineBlock> m_multiLineBlocks;
+  QVector<QTextCharFormat> m_palette;
 
   QTextCharFormat m_searchFormat;
 
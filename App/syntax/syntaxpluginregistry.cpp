@@ -34,6 +34,7 @@ void SyntaxPluginRegistry::registerPlugin(
   }
 
   languagePlugins[langId] = std::move(plugin);
+  compiledRuleSets.erase(langId);
 
   Logger::instance().info(
       QString("Registered syntax plugin for language '%1' with %2 extension(s)")
@@ -65,6 +66,23 @@ SyntaxPluginRegistry::getPluginByExtension(const QString &extension) const {
   return nullptr;
 }
 
+std::shared_ptr<const CompiledSyntaxRules>
+SyntaxPluginRegistry::compiledRules(const QString &languageId) const {
+  auto cached = compiledRuleSets.find(languageId);
+  if (cached != compiledRuleSets.end()) {
+    return cached->second;
+  }
+
+  ISyntaxPlugin *plugin = getPluginByLanguageId(languageId);
+  if (!plugin) {
+    return nullptr;
+  }
+  std::shared_ptr<const CompiledSyntaxRules> rules =
+      CompiledSyntaxRules::compile(*plugin);
+  compiledRuleSets[languageId] = rules;
+  return rules;
+}
+
 QStringList SyntaxPluginRegistry::getAllLanguageIds() const {
   QStringList ids;
   for (const auto &pair : languagePlugins) {
@@ -94,5 +112,6 @@ bool SyntaxPluginRegistry::isExtensionSupported(
 void SyntaxPluginRegistry::clear() {
   languagePlugins.clear();
   extensionToLanguage.clear();
+  compiledRuleSets.clear();
   Logger::instance().info("Cleared all syntax plugins from registry");
 }
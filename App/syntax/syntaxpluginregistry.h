@@ -2,6 +2,7 @@
 #define SYNTAXPLUGINREGISTRY_H
 
 #include "../plugins/isyntaxplugin.h"
+#include "compiledsyntaxrules.h"
 #include <QMap>
 #include <QString>
 #include <QStringList>
@@ -18,6 +19,9 @@ public:
 
   ISyntaxPlugin *getPluginByExtension(const QString &extension) const;
 
+  std::shared_ptr<const CompiledSyntaxRules>
+  compiledRules(const QString &languageId) const;
+
   QStringList getAllLanguageIds() const;
 
   QStringList getAllExtensions() const;
@@ -37,6 +41,9 @@ private:
   std::map<QString, std::unique_ptr<ISyntaxPlugin>> languagePlugins;
 
   QMap<QString, QString> extensionToLanguage;
+
+  mutable std::map<QString, std::shared_ptr<const CompiledSyntaxRules>>
+      compiledRuleSets;
 };
 
 #endif
@@ -30,6 +30,7 @@
 #include <QStatusBar>
 #include <QStringListModel>
 #include <QTextDocument>
+#include <QThread>
 #include <QToolButton>
 #include <QVBoxLayout>
 #include <cstdio>
@@ -38,6 +39,8 @@
 
 #include "../completion/completionengine.h"
 #include "../completion/completionproviderregistry.h"
+#include "../completion/identifierindex.h"
+#include "../completion/providers/bufferwordcompletionprovider.h"
 #include "../completion/providers/keywordcompletionprovider.h"
 #include "../completion/providers/lspcompletionprovider.h"
 #include "../completion/providers/plugincompletionprovider.h"
@@ -45,7 +48,12 @@
 #include "../core/autosavemanager.h"
 #include "../core/lightpadpage.h"
 #include "../core/logging/logger.h"
+#include "../core/documentregistry.h"
+#include "../core/io/fileloader.h"
+#include "../core/io/hotexitjournal.h"
 #include "../core/navigationhistory.h"
+#include "../core/profiling/paintprofiler.h"
+#include "../core/profiling/startuptracer.h"
 #include "../core/recentfilesmanager.h"
 #include "../core/textarea.h"
 #include "../dap/debugsettings.h"
@@ -96,13 +104,16 @@
 #include "panels/sourcecontrolpanel.h"
 #include "panels/spliteditorcontainer.h"
 #include "panels/terminal.h"
+#include "panels/terminalscreen.h"
 #include "panels/terminaltabwidget.h"
 #include "panels/testpanel.h"
 #include "popup.h"
 #include "ui_mainwindow.h"
 #include "viewers/imageviewer.h"
 #include "widgets/hacker/hackerscanlineoverlay.h"
+#include "widgets/lazydockwidget.h"
 #include "widgets/notificationwidget.h"
+#include "widgets/paintprofileroverlay.h"
 #ifdef HAVE_PDF_SUPPORT
 #include "viewers/pdfviewer.h"
 #endif
@@ -124,6 +135,7 @@ constexpr auto kSessionTabPathKey = "path";
 constexpr auto kSessionTabCursorKey = "cursorPosition";
 constexpr auto kSessionTabVerticalScrollKey = "verticalScroll";
 constexpr auto kSessionTabHorizontalScrollKey = "horizontalScroll";
+constexpr int kMaxPrewarmedTabs = 8;
 
 template <typename T> bool hasVisibleChildWidget(const QObject *parent) {
   if (!parent) {
@@ -167,8 +179,75 @@ QColor glowShift(const QColor &base, const QColor &glow, qreal glowLevel,
                  qreal strength) {
   return blendColor(base, glow, qBound(0.0, glowLevel * strength, 1.0));
 }
+
+void applyRecoveredBuffer(TextArea *textArea, const RecoveredBuffer &buffer) {
+  if (textArea->toPlainText() != buffer.text) {
+    QTextCursor cursor(textArea->document());
+    cursor.select(QTextCursor::Document);
+    cursor.insertText(buffer.text);
+  }
+  HotExitJournal::removeJournal(buffer.journalPath);
+}
+
+void applySessionTabState(TextArea *textArea, const QJsonObject &tabState) {
+  if (textArea->isLoading()) {
+    QObject::connect(
+        textArea, &TextArea::loadingFinished, textArea,
+        [textArea, tabState]() { applySessionTabState(textArea, tabState); },
+        Qt::SingleShotConnection);
+    return;
+  }
+
+  QTextCursor cursor = textArea->textCursor();
+  cursor.setPosition(qBound(0, tabState.value(kSessionTabCursorKey).toInt(),
+                            textArea->document()->characterCount() - 1));
+  textArea->setTextCursor(cursor);
+  if (QScrollBar *scrollBar = textArea->verticalScrollBar()) {
+    scrollBar->setValue(tabState.value(kSessionTabVerticalScrollKey).toInt());
+  }
+  if (QScrollBar *scrollBar = textArea->horizontalScrollBar()) {
+    scrollBar->setValue(tabState.value(kSessionTabHorizontalScrollKey).toInt());
+  }
+}
 } // namespace
 
+class TabPrewarmWorker : public QThread {
+public:
+  TabPrewarmWorker(const QStringList &filePaths, MainWindow *window)
+      : QThread(window), m_filePaths(filePaths), m_window(window) {}
+
+protected:
+  void run() override {
+    for (const QString &filePath : m_filePaths) {
+      if (isInterruptionRequested()) {
+        return;
+      }
+      const QFileInfo fileInfo(filePath);
+      if (!fileInfo.isFile() || fileInfo.size() > FILE_LOADER_SYNC_LIMIT) {
+        continue;
+      }
+
+      MainWindow::PrewarmedFile file;
+      file.lastModified = fileInfo.lastModified();
+      file.size = fileInfo.size();
+      if (!FileLoader::readAll(filePath, &file.text, &file.format, nullptr)) {
+        continue;
+      }
+
+      MainWindow *window = m_window;
+      const QString key = QDir::cleanPath(filePath);
+      QMetaObject::invokeMethod(
+          window,
+          [window, key, file]() { window->m_prewarmedFiles.insert(key, file); },
+          Qt::QueuedConnection);
+    }
+  }
+
+private:
+  QStringList m_filePaths;
+  MainWindow *m_window;
+};
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow), popupTabWidth(nullptr),
       preferences(nullptr), findReplacePanel(nullptr), terminalWidget(nullptr),
@@ -207,7 +286,10 @@ MainWindow::MainWindow(QWidget *parent)
       m_treeScrollSyncing(false), m_treeFilterText(""), m_treeCurrentPath(""),
       m_treeSelectionSyncing(false) {
   QApplication::instance()->installEventFilter(this);
-  ui->setupUi(this);
+  {
+    STARTUP_TRACE_SCOPE("MainWindow::setupUi");
+    ui->setupUi(this);
+  }
   setDockOptions(DockUtils::mainWindowDockOptions());
   setCorner(Qt::BottomLeftCorner, Qt::BottomDockWidgetArea);
   setCorner(Qt::BottomRightCorner, Qt::BottomDockWidgetArea);
@@ -273,6 +355,7 @@ MainWindow::MainWindow(QWidget *parent)
   ui->debugButton->setIconSize(0.8 * ui->debugButton->size());
 
   recentFilesManager = new RecentFilesManager(this);
+  m_documentRegistry = new DocumentRegistry(this);
 
   setupNavigationHistory();
 
@@ -306,7 +389,7 @@ MainWindow::MainWindow(QWidget *parent)
   setupRecentFilesDialog();
   setupBreadcrumb();
   setupGitIntegration();
-  ensureDebugPanel();
+  ensureDebugDock();
   TestConfigurationManager::instance().loadTemplates();
 
   if (ui->testButton) {
@@ -584,6 +667,12 @@ MainWindow::~MainWindow() { delete ui; }
 void MainWindow::closeEvent(QCloseEvent *event) {
   LOG_INFO("closeEvent: saving settings before close");
   saveSettings();
+  SettingsManager::instance().flushPendingSave();
+  FileSaver::instance().waitForIdle();
+  if (m_tabPrewarmer) {
+    m_tabPrewarmer->requestInterruption();
+    m_tabPrewarmer->wait();
+  }
 
   if (preferences) {
     preferences->close();
@@ -606,7 +695,16 @@ QString MainWindow::textAreaSettingsPath() const {
   return QDir(fallbackDir).filePath("editor_settings.json");
 }
 
+QString MainWindow::hotExitDirectory() const {
+  QString settingsDir = SettingsManager::instance().getSettingsDirectory();
+  if (settingsDir.isEmpty()) {
+    settingsDir = QDir::home().filePath(".lightpad");
+  }
+  return QDir(settingsDir).filePath("hotexit");
+}
+
 void MainWindow::loadSettings() {
+  STARTUP_TRACE_SCOPE("MainWindow::loadSettings");
   QString editorSettingsPath = textAreaSettingsPath();
   if (QFileInfo(editorSettingsPath).exists()) {
     settings.loadSettings(editorSettingsPath);
@@ -627,6 +725,8 @@ void MainWindow::loadSettings() {
     autoSaveManager->setEnabled(
         globalSettings.getValue("autoSaveFiles", true).toBool());
   }
+  FileSaver::instance().setSyncPolicy(FileSaver::syncPolicyFromString(
+      globalSettings.getValue("saveSyncPolicy", "explicit").toString()));
   QString fontFamily =
       globalSettings.getValue("fontFamily", "Ubuntu Mono").toString();
   int fontSize = globalSettings.getValue("fontSize", defaultFontSize).toInt();
@@ -693,28 +793,35 @@ void MainWindow::loadSettings() {
                  .arg(filePath)
                  .arg(QFileInfo(filePath).exists()));
     if (!filePath.isEmpty() && QFileInfo(filePath).exists()) {
-      openFileAndAddToNewTab(filePath);
-      if (TextArea *textArea = getCurrentTextArea()) {
-        QTextCursor cursor = textArea->textCursor();
-        cursor.setPosition(qBound(0,
-                                  tabState.value(kSessionTabCursorKey).toInt(),
-                                  textArea->document()->characterCount() - 1));
-        textArea->setTextCursor(cursor);
-        if (QScrollBar *scrollBar = textArea->verticalScrollBar()) {
-          scrollBar->setValue(
-              tabState.value(kSessionTabVerticalScrollKey).toInt());
-        }
-        if (QScrollBar *scrollBar = textArea->horizontalScrollBar()) {
-          scrollBar->setValue(
-              tabState.value(kSessionTabHorizontalScrollKey).toInt());
-        }
-      }
+      deferTab(filePath, tabState);
     }
   }
 
+  LightpadTabWidget *restoredTabWidget = currentTabWidget();
+  for (int i = restoredTabWidget->count() - 2;
+       i >= 0 && restoredTabWidget->count() > 2; --i) {
+    if (restoredTabWidget->isBlankPage(i)) {
+      restoredTabWidget->removeTab(i);
+    }
+  }
+
+  restoreHotExitBuffers();
+  const QString currentFilePath =
+      globalSettings.getValue("currentFilePath", "").toString();
+  if (!currentFilePath.isEmpty() && QFileInfo(currentFilePath).exists()) {
+    openFileAndAddToNewTab(currentFilePath);
+  }
+  restoredTabWidget = currentTabWidget();
+  if (restoredTabWidget->isDeferredTab(restoredTabWidget->currentIndex())) {
+    materializeDeferredTab(restoredTabWidget,
+                           restoredTabWidget->currentIndex());
+  }
   applyTreeExpandedStateToViews();
   restoreSessionUiState();
   m_restoringSession = false;
+  if (globalSettings.getValue("prewarmRestoredTabs", false).toBool()) {
+    prewarmDeferredTabs();
+  }
   m_globalSettingsLoaded = true;
 }
 
@@ -787,7 +894,9 @@ void MainWindow::saveSettings() {
       LOG_INFO(
           QString("saveSettings: tab %1 filePath='%2'").arg(i).arg(filePath));
       if (!filePath.isEmpty()) {
-        QJsonObject tabState;
+        QJsonObject tabState = tabWidget->isDeferredTab(i)
+                                   ? tabWidget->deferredTabState(i)
+                                   : QJsonObject();
         tabState[kSessionTabPathKey] = filePath;
         if (LightpadPage *page = tabWidget->getPage(i)) {
           if (TextArea *textArea = page->getTextArea()) {
@@ -828,10 +937,135 @@ void MainWindow::saveSettings() {
     testPanel->saveState();
   }
   persistTreeStateToSettings();
-  globalSettings.saveSettings();
+  globalSettings.requestSave();
+}
+
+void MainWindow::restoreHotExitBuffers() {
+  STARTUP_TRACE_SCOPE("MainWindow::restoreHotExitBuffers");
+  const QList<RecoveredBuffer> buffers =
+      HotExitJournal::recover(hotExitDirectory());
+  for (const RecoveredBuffer &buffer : buffers) {
+    LOG_INFO(QString("Restoring unsaved buffer from %1 (%2)")
+                 .arg(buffer.journalPath,
+                      buffer.filePath.isEmpty() ? QString("untitled")
+                                                : buffer.filePath));
+    LightpadTabWidget *tabWidget = currentTabWidget();
+    if (!buffer.filePath.isEmpty() && QFileInfo(buffer.filePath).isFile()) {
+      openFileAndAddToNewTab(buffer.filePath);
+      tabWidget = currentTabWidget();
+    } else {
+      tabWidget->addNewTab();
+      if (!buffer.filePath.isEmpty()) {
+        tabWidget->setFilePath(tabWidget->currentIndex(), buffer.filePath);
+        setFilePathAsTabText(buffer.filePath);
+      }
+    }
+
+    TextArea *textArea = getCurrentTextArea();
+    if (!textArea || tabWidget->getFilePath(tabWidget->currentIndex()) !=
+                         buffer.filePath) {
+      continue;
+    }
+    if (textArea->isLoading()) {
+      connect(
+          textArea, &TextArea::loadingFinished, this,
+          [textArea, buffer]() { applyRecoveredBuffer(textArea, buffer); },
+          Qt::SingleShotConnection);
+    } else {
+      applyRecoveredBuffer(textArea, buffer);
+    }
+  }
+}
+
+void MainWindow::discardHotExitJournal(LightpadPage *page) {
+  TextArea *textArea = page ? page->getTextArea() : nullptr;
+  if (!textArea) {
+    return;
+  }
+
+  QTextDocument *document = textArea->document();
+  for (LightpadTabWidget *tabWidget : allTabWidgets()) {
+    for (int i = 0; tabWidget && i < tabWidget->count(); ++i) {
+      LightpadPage *openPage = tabWidget->getPage(i);
+      if (openPage && openPage->getTextArea() &&
+          openPage->getTextArea()->document() == document) {
+        return;
+      }
+    }
+  }
+  if (HotExitJournal *journal = HotExitJournal::find(document)) {
+    journal->discard();
+  }
+}
+
+void MainWindow::deferTab(const QString &filePath,
+                          const QJsonObject &sessionState) {
+  const QString extension = QFileInfo(filePath).suffix().toLower();
+  bool isViewer = ImageViewer::isSupportedImageFormat(extension);
+#ifdef HAVE_PDF_SUPPORT
+  isViewer = isViewer || PdfViewer::isSupportedPdfFormat(extension);
+#endif
+  if (isViewer) {
+    openFileAndAddToNewTab(filePath);
+    return;
+  }
+
+  LightpadTabWidget *tabWidget = currentTabWidget();
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    if (tabWidget->getFilePath(i) == filePath) {
+      return;
+    }
+  }
+  tabWidget->addDeferredTab(filePath, sessionState);
+}
+
+void MainWindow::materializeDeferredTab(LightpadTabWidget *tabWidget,
+                                        int index) {
+  if (tabWidget != currentTabWidget() || tabWidget->currentIndex() != index) {
+    return;
+  }
+
+  const QString filePath = tabWidget->getFilePath(index);
+  const QJsonObject sessionState = tabWidget->deferredTabState(index);
+  if (!tabWidget->materializeTab(index)) {
+    return;
+  }
+
+  openFileAndAddToNewTab(filePath);
+  TextArea *textArea = getCurrentTextArea();
+  if (textArea && !sessionState.isEmpty() &&
+      tabWidget->getFilePath(tabWidget->currentIndex()) == filePath) {
+    applySessionTabState(textArea, sessionState);
+  }
+}
+
+void MainWindow::prewarmDeferredTabs() {
+  if (m_tabPrewarmer) {
+    return;
+  }
+
+  QStringList filePaths;
+  for (LightpadTabWidget *tabWidget : allTabWidgets()) {
+    for (int i = 0; i < tabWidget->count() &&
+                    filePaths.size() < kMaxPrewarmedTabs;
+         ++i) {
+      if (tabWidget->isDeferredTab(i)) {
+        filePaths.append(tabWidget->getFilePath(i));
+      }
+    }
+  }
+  if (filePaths.isEmpty()) {
+    return;
+  }
+
+  m_tabPrewarmer = new TabPrewarmWorker(filePaths, this);
+  connect(m_tabPrewarmer, &QThread::finished, m_tabPrewarmer,
+          &QObject::deleteLater);
+  m_tabPrewarmer->start(QThread::LowestPriority);
 }
 
 void MainWindow::restoreSessionUiState() {
+  STARTUP_TRACE_SCOPE("MainWindow::restoreSessionUiState");
   SettingsManager &globalSettings = SettingsManager::instance();
   const QString currentFilePath =
       globalSettings.getValue("currentFilePath", "").toString();
@@ -849,27 +1083,22 @@ void MainWindow::restoreSessionUiState() {
       globalSettings.getValue("mainWindowDockState", "").toString();
 
   if (!dockStateBase64.isEmpty()) {
-    ensureTerminalWidget();
-    if (!m_problemsDock) {
-      showProblemsPanel();
-      if (m_problemsDock) {
-        m_problemsDock->hide();
-      }
-    }
-    ensureSourceControlPanel();
-    ensureDebugPanel();
-    ensureTestPanel();
+    ensureTerminalDock();
+    ensureProblemsDock();
+    ensureSourceControlDock();
+    ensureDebugDock();
+    ensureTestDock();
   }
 
   if (showSourceControlDock) {
-    ensureSourceControlPanel();
+    ensureSourceControlDock();
     if (sourceControlDock) {
       sourceControlDock->show();
     }
   }
 
   if (showDebugDock) {
-    ensureDebugPanel();
+    ensureDebugDock();
     if (debugDock) {
       debugDock->show();
     }
@@ -884,7 +1113,7 @@ void MainWindow::restoreSessionUiState() {
   }
 
   if (showTestDock) {
-    ensureTestPanel();
+    ensureTestDock();
     if (testDock) {
       testDock->show();
       testDock->raise();
@@ -917,7 +1146,7 @@ void MainWindow::restoreSessionUiState() {
   setCorner(Qt::BottomRightCorner, Qt::BottomDockWidgetArea);
 
   if (showTerminalDock) {
-    ensureTerminalWidget();
+    ensureTerminalDock();
     if (m_terminalDock) {
       m_terminalDock->show();
       m_terminalDock->raise();
@@ -927,14 +1156,14 @@ void MainWindow::restoreSessionUiState() {
     showProblemsPanel();
   }
   if (showDebugDock) {
-    ensureDebugPanel();
+    ensureDebugDock();
     if (debugDock) {
       debugDock->show();
       debugDock->raise();
     }
   }
   if (showTestDock) {
-    ensureTestPanel();
+    ensureTestDock();
     if (testDock) {
       testDock->show();
       testDock->raise();
@@ -1110,23 +1339,7 @@ void MainWindow::applyHighlightForFile(const QString &filePath) {
   textArea->setLanguage(languageId);
   textArea->updateSyntaxHighlightTags("", languageId);
 
-  if (m_gitIntegration) {
-    QList<GitDiffLineInfo> diffLines = m_gitIntegration->getDiffLines(filePath);
-    QList<QPair<int, int>> gutterLines;
-    gutterLines.reserve(diffLines.size());
-    for (const auto &info : diffLines) {
-      int type = 1;
-      if (info.type == GitDiffLineInfo::Type::Added) {
-        type = 0;
-      } else if (info.type == GitDiffLineInfo::Type::Deleted) {
-        type = 2;
-      }
-      gutterLines.append(qMakePair(info.lineNumber, type));
-    }
-    textArea->setGitDiffLines(gutterLines);
-  } else {
-    textArea->clearGitDiffLines();
-  }
+  textArea->setGitDiffTracking(m_gitIntegration, filePath);
 
   showGitBlameForCurrentFile(isGitBlameEnabledForFile(filePath));
   updateInlineBlameForCurrentFile();
@@ -1755,6 +1968,9 @@ void MainWindow::openFileAndAddToNewTab(QString filePath) {
     QString tabFilePath = tabWidget->getFilePath(i);
     if (tabFilePath == filePath) {
       tabWidget->setCurrentIndex(i);
+      if (tabWidget->isDeferredTab(i)) {
+        materializeDeferredTab(tabWidget, i);
+      }
       return;
     }
   }
@@ -1791,7 +2007,17 @@ void MainWindow::openFileAndAddToNewTab(QString filePath) {
     tabWidget->addNewTab();
   }
 
-  open(filePath);
+  auto *sharedView =
+      qobject_cast<TextArea *>(m_documentRegistry->primaryView(filePath));
+  const bool sharesDocument = sharedView && getCurrentTextArea() &&
+                              sharedView != getCurrentTextArea();
+  if (sharesDocument) {
+    tabWidget->setFilePath(tabWidget->currentIndex(), filePath);
+    getCurrentTextArea()->shareDocumentWith(sharedView);
+    m_documentRegistry->registerView(filePath, getCurrentTextArea());
+  } else {
+    open(filePath);
+  }
   setFilePathAsTabText(filePath);
 
   auto page = tabWidget->getCurrentPage();
@@ -1806,10 +2032,14 @@ void MainWindow::openFileAndAddToNewTab(QString filePath) {
     page->setFilePath(filePath);
   }
 
-  if (getCurrentTextArea())
+  const bool loading =
+      getCurrentTextArea() && getCurrentTextArea()->isLoading();
+  if (getCurrentTextArea() && !loading)
     applyHighlightForFile(filePath);
 
-  notifyDiagnosticsFileOpened(filePath);
+  if (!sharesDocument && !loading) {
+    notifyDiagnosticsFileOpened(filePath);
+  }
 
   if (problemsPanel) {
     problemsPanel->setCurrentFilePath(filePath);
@@ -1842,6 +2072,14 @@ void MainWindow::closeTabPage(QString filePath) {
 }
 
 void MainWindow::openPathsFromCommandLine(const QStringList &paths) {
+  QString lastFilePath;
+  for (const QString &path : paths) {
+    QFileInfo info(path);
+    if (info.isFile()) {
+      lastFilePath = info.absoluteFilePath();
+    }
+  }
+
   for (const QString &path : paths) {
     QFileInfo info(path);
     if (!info.exists()) {
@@ -1855,8 +2093,10 @@ void MainWindow::openPathsFromCommandLine(const QStringList &paths) {
       if (fileQuickOpen) {
         fileQuickOpen->setRootDirectory(info.absoluteFilePath());
       }
-    } else {
+    } else if (info.absoluteFilePath() == lastFilePath) {
       openFileAndAddToNewTab(info.absoluteFilePath());
+    } else {
+      deferTab(info.absoluteFilePath(), QJsonObject());
     }
   }
 }
@@ -1918,7 +2158,7 @@ void MainWindow::on_actionIncrease_Font_Size_triggered() {
   settings.mainFont.setPointSize(getCurrentTextArea()->fontSize());
   SettingsManager::instance().setValue("fontSize",
                                        settings.mainFont.pointSize());
-  SettingsManager::instance().saveSettings();
+  SettingsManager::instance().requestSave();
   settings.saveSettings(textAreaSettingsPath());
 }
 
@@ -1930,7 +2170,7 @@ void MainWindow::on_actionDecrease_Font_Size_triggered() {
   settings.mainFont.setPointSize(getCurrentTextArea()->fontSize());
   SettingsManager::instance().setValue("fontSize",
                                        settings.mainFont.pointSize());
-  SettingsManager::instance().saveSettings();
+  SettingsManager::instance().requestSave();
   settings.saveSettings(textAreaSettingsPath());
 }
 
@@ -1942,7 +2182,7 @@ void MainWindow::on_actionReset_Font_Size_triggered() {
   settings.mainFont.setPointSize(getCurrentTextArea()->fontSize());
   SettingsManager::instance().setValue("fontSize",
                                        settings.mainFont.pointSize());
-  SettingsManager::instance().saveSettings();
+  SettingsManager::instance().requestSave();
   settings.saveSettings(textAreaSettingsPath());
 }
 
@@ -1971,7 +2211,9 @@ void MainWindow::on_actionClose_Tab_triggered() {
   int index = tabWidget->currentIndex();
   if (index > -1) {
     QString filePath = tabWidget->getFilePath(index);
-    notifyDiagnosticsFileClosed(filePath);
+    if (m_documentRegistry->viewCount(filePath) <= 1) {
+      notifyDiagnosticsFileClosed(filePath);
+    }
     tabWidget->removeTab(index);
     unwatchOpenFileIfUnused(filePath);
   }
@@ -2143,11 +2385,39 @@ void MainWindow::on_actionSave_as_triggered() {
   save(filePath);
 }
 
-void MainWindow::open(const QString &filePath) {
+bool MainWindow::saveCurrentAndWait() {
+  LightpadTabWidget *tabWidget = currentTabWidget();
+  TextArea *textArea = getCurrentTextArea();
+  if (!tabWidget || !textArea) {
+    return true;
+  }
 
-  QFile file(filePath);
+  on_actionSave_triggered();
+  const QString filePath = tabWidget->getFilePath(tabWidget->currentIndex());
+  if (!filePath.isEmpty()) {
+    FileSaver::instance().waitForIdle(filePath);
+  }
+  return !textArea->changesUnsaved();
+}
 
-  if (!file.open(QFile::ReadOnly | QFile::Text)) {
+void MainWindow::open(const QString &filePath) {
+
+  QFileInfo fileInfo(filePath);
+  QString text;
+  FileFormat format;
+  const bool streamed = fileInfo.size() > FILE_LOADER_SYNC_LIMIT;
+  const PrewarmedFile prewarmed =
+      m_prewarmedFiles.take(QDir::cleanPath(filePath));
+  const bool usePrewarmed = !streamed && prewarmed.lastModified.isValid() &&
+                            prewarmed.lastModified == fileInfo.lastModified() &&
+                            prewarmed.size == fileInfo.size();
+  if (usePrewarmed) {
+    text = prewarmed.text;
+    format = prewarmed.format;
+  }
+  if (!fileInfo.isReadable() ||
+      (!streamed && !usePrewarmed &&
+       !FileLoader::readAll(filePath, &text, &format, nullptr))) {
     ThemedMessageBox::critical(this, tr("Error"), tr("Can't open file."));
     return;
   }
@@ -2158,15 +2428,55 @@ void MainWindow::open(const QString &filePath) {
 
   if (getCurrentTextArea()) {
     auto *textArea = getCurrentTextArea();
-    textArea->setPlainText(QString::fromUtf8(file.readAll()));
-    textArea->moveCursor(QTextCursor::Start);
-    textArea->centerCursor();
+    if (streamed) {
+      textArea->beginLoading();
+      auto *loader = new FileLoader(filePath, textArea);
+      connect(loader, &FileLoader::chunkLoaded, textArea,
+              &TextArea::appendLoadedText);
+      connect(textArea, &TextArea::loadedTextInserted, loader,
+              &FileLoader::acknowledgeChunk);
+      connect(loader, &FileLoader::finished, this,
+              [this, textArea, loader, filePath]() {
+                textArea->finishLoading();
+                m_fileFormats[QDir::cleanPath(filePath)] = loader->format();
+                loader->deleteLater();
+                finishStreamedOpen(textArea, filePath);
+              });
+      connect(loader, &FileLoader::failed, this,
+              [this, textArea, loader](const QString &errorMessage) {
+                textArea->finishLoading();
+                loader->deleteLater();
+                ThemedMessageBox::critical(this, tr("Error"), errorMessage);
+              });
+      loader->start();
+    } else {
+      m_fileFormats[QDir::cleanPath(filePath)] = format;
+      textArea->setPlainText(text);
+      textArea->moveCursor(QTextCursor::Start);
+      textArea->centerCursor();
+    }
+    m_documentRegistry->registerView(filePath, textArea);
   }
 
   recordFileTimestamp(filePath);
   watchOpenFile(filePath);
 }
 
+void MainWindow::finishStreamedOpen(TextArea *textArea,
+                                    const QString &filePath) {
+  if (textArea == getCurrentTextArea()) {
+    applyHighlightForFile(filePath);
+  } else {
+    QString languageId = effectiveLanguageIdForFile(filePath);
+    if (languageId.isEmpty()) {
+      languageId = "plaintext";
+    }
+    textArea->setLanguage(languageId);
+    textArea->updateSyntaxHighlightTags("", languageId);
+  }
+  notifyDiagnosticsFileOpened(filePath, textArea);
+}
+
 bool MainWindow::save(const QString &filePath, bool isAutoSave) {
   if (filePath.isEmpty()) {
     return false;
@@ -2214,7 +2524,8 @@ bool MainWindow::save(const QString &filePath, bool isAutoSave) {
     }
   }
 
-  if (!textArea || !targetTabWidget || targetTabIndex < 0) {
+  if (!textArea || !targetTabWidget || targetTabIndex < 0 ||
+      textArea->isLoading()) {
     return false;
   }
 
@@ -2229,12 +2540,6 @@ bool MainWindow::save(const QString &filePath, bool isAutoSave) {
     }
   }
 
-  QFile file(filePath);
-
-  if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) {
-    return false;
-  }
-
   SettingsManager &sm = SettingsManager::instance();
   if (sm.getValue("trimTrailingWhitespace", false).toBool()) {
     trimTrailingWhitespace(textArea);
@@ -2244,29 +2549,69 @@ bool MainWindow::save(const QString &filePath, bool isAutoSave) {
   }
 
   targetTabWidget->setFilePath(targetTabIndex, filePath);
+  submitSave(textArea, filePath, isAutoSave);
+  return true;
+}
 
+void MainWindow::submitSave(TextArea *textArea, const QString &filePath,
+                            bool isAutoSave) {
   const QString normalizedSavePath = QDir::cleanPath(filePath);
   m_internalFileWrites.insert(normalizedSavePath);
-  QTimer::singleShot(1000, this, [this, normalizedSavePath]() {
-    m_internalFileWrites.remove(normalizedSavePath);
-  });
-  if (file.write(textArea->toPlainText().toUtf8()) == -1) {
+
+  FileSaveRequest request;
+  request.filePath = filePath;
+  request.text = textArea->toPlainText();
+  request.format = m_fileFormats.value(normalizedSavePath);
+  request.isAutoSave = isAutoSave;
+
+  QPointer<TextArea> savedArea(textArea);
+  const int revision = textArea->document()->revision();
+  FileSaver::instance().save(
+      request, this,
+      [this, savedArea, revision, filePath](const FileSaveResult &result) {
+        finishSave(savedArea.data(), revision, filePath, result);
+      });
+}
+
+void MainWindow::finishSave(TextArea *textArea, int revision,
+                            const QString &filePath,
+                            const FileSaveResult &result) {
+  const QString normalizedSavePath = QDir::cleanPath(filePath);
+  const QString fileName = QFileInfo(filePath).fileName();
+  if (!result.success) {
     m_internalFileWrites.remove(normalizedSavePath);
-    return false;
+    statusBar()->showMessage(
+        tr("Could not save %1: %2").arg(fileName, result.errorMessage), 5000);
+    return;
   }
-  file.close();
-
-  textArea->document()->setModified(false);
-  textArea->removeIconUnsaved();
 
+  QTimer::singleShot(1000, this, [this, normalizedSavePath]() {
+    m_internalFileWrites.remove(normalizedSavePath);
+  });
   recordFileTimestamp(filePath);
   watchOpenFile(filePath);
 
-  const QString fileName = QFileInfo(filePath).fileName();
-  targetTabWidget->setTabText(targetTabIndex, fileName);
-  if (targetTabWidget == currentTabWidget() &&
-      targetTabIndex == targetTabWidget->currentIndex()) {
-    setMainWindowTitle(fileName);
+  const bool unchanged =
+      textArea && textArea->document()->revision() == revision;
+  if (unchanged) {
+    textArea->document()->setModified(false);
+    textArea->removeIconUnsaved();
+  }
+
+  for (LightpadTabWidget *tabWidget : allTabWidgets()) {
+    if (!tabWidget || !textArea) {
+      continue;
+    }
+    for (int i = 0; i < tabWidget->count(); ++i) {
+      LightpadPage *page = tabWidget->getPage(i);
+      if (!page || page->getTextArea() != textArea) {
+        continue;
+      }
+      tabWidget->setTabText(i, fileName);
+      if (tabWidget == currentTabWidget() && i == tabWidget->currentIndex()) {
+        setMainWindowTitle(fileName);
+      }
+    }
   }
 
   if (problemsPanel) {
@@ -2275,7 +2620,7 @@ bool MainWindow::save(const QString &filePath, bool isAutoSave) {
 
   notifyDiagnosticsFileSaved(filePath);
 
-  if (autoSaveManager) {
+  if (autoSaveManager && unchanged) {
     autoSaveManager->markSaved(filePath);
   }
 
@@ -2283,7 +2628,13 @@ bool MainWindow::save(const QString &filePath, bool isAutoSave) {
     testPanel->notifyFileSaved(filePath);
   }
 
-  return true;
+  if (!result.isAutoSave) {
+    statusBar()->showMessage(
+        tr("Saved %1 (%2 ms)")
+            .arg(fileName)
+            .arg(result.queuedMs + result.writeMs, 0, 'f', 1),
+        2000);
+  }
 }
 
 void MainWindow::recordFileTimestamp(const QString &filePath) {
@@ -2366,6 +2717,7 @@ void MainWindow::unwatchOpenFileIfUnused(const QString &filePath) {
     m_openFileWatcher->removePath(normalizedPath);
   }
   m_fileTimestamps.remove(normalizedPath);
+  m_fileFormats.remove(normalizedPath);
   m_externalChangePrompts.remove(normalizedPath);
   m_internalFileWrites.remove(normalizedPath);
 }
@@ -2434,12 +2786,12 @@ bool MainWindow::handleExternalModification(const QString &filePath,
 }
 
 bool MainWindow::reloadOpenFileFromDisk(const QString &filePath) {
-  QFile reloadFile(filePath);
-  if (!reloadFile.open(QFile::ReadOnly | QFile::Text)) {
+  QString diskText;
+  FileFormat format;
+  if (!FileLoader::readAll(filePath, &diskText, &format, nullptr)) {
     return false;
   }
-  const QString diskText = QString::fromUtf8(reloadFile.readAll());
-  reloadFile.close();
+  m_fileFormats[QDir::cleanPath(filePath)] = format;
 
   for (LightpadTabWidget *tabWidget : allTabWidgets()) {
     if (!tabWidget) {
@@ -2475,8 +2827,6 @@ bool MainWindow::reloadOpenFileFromDisk(const QString &filePath) {
 
 bool MainWindow::writeOpenFileToDisk(const QString &filePath) {
   TextArea *textArea = nullptr;
-  LightpadTabWidget *targetTabWidget = nullptr;
-  int targetTabIndex = -1;
 
   for (LightpadTabWidget *tabWidget : allTabWidgets()) {
     if (!tabWidget) {
@@ -2489,8 +2839,6 @@ bool MainWindow::writeOpenFileToDisk(const QString &filePath) {
       LightpadPage *page = tabWidget->getPage(i);
       if (page && page->getTextArea()) {
         textArea = page->getTextArea();
-        targetTabWidget = tabWidget;
-        targetTabIndex = i;
         break;
       }
     }
@@ -2499,43 +2847,11 @@ bool MainWindow::writeOpenFileToDisk(const QString &filePath) {
     }
   }
 
-  if (!textArea) {
+  if (!textArea || textArea->isLoading()) {
     return false;
   }
 
-  QFile file(filePath);
-  if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) {
-    return false;
-  }
-
-  const QString normalizedPath = QDir::cleanPath(filePath);
-  m_internalFileWrites.insert(normalizedPath);
-  QTimer::singleShot(1000, this, [this, normalizedPath]() {
-    m_internalFileWrites.remove(normalizedPath);
-  });
-  const bool ok = file.write(textArea->toPlainText().toUtf8()) != -1;
-  file.close();
-  if (!ok) {
-    m_internalFileWrites.remove(normalizedPath);
-    return false;
-  }
-
-  textArea->document()->setModified(false);
-  textArea->removeIconUnsaved();
-  recordFileTimestamp(normalizedPath);
-  watchOpenFile(normalizedPath);
-
-  if (targetTabWidget && targetTabIndex >= 0) {
-    targetTabWidget->setTabText(targetTabIndex,
-                                QFileInfo(normalizedPath).fileName());
-  }
-  notifyDiagnosticsFileSaved(normalizedPath);
-  if (autoSaveManager) {
-    autoSaveManager->markSaved(normalizedPath);
-  }
-  if (testPanel) {
-    testPanel->notifyFileSaved(normalizedPath);
-  }
+  submitSave(textArea, QDir::cleanPath(filePath), false);
   return true;
 }
 
@@ -2758,33 +3074,47 @@ void MainWindow::openTestConfigurationDialog() {
 
 void MainWindow::openShortcutsDialog() { openDialog(Dialog::shortcuts); }
 
-TerminalTabWidget *MainWindow::ensureTerminalWidget() {
-  if (!terminalWidget) {
-    terminalWidget = new TerminalTabWidget();
-    terminalWidget->applyTheme(getTheme());
+void MainWindow::ensureTerminalDock() {
+  if (m_terminalDock) {
+    return;
+  }
 
-    connect(terminalWidget, &TerminalTabWidget::closeRequested, this, [this]() {
-      if (m_terminalDock) {
-        m_terminalDock->hide();
-      }
-    });
+  m_terminalDock = new LazyDockWidget(
+      QString(), [this]() { return createTerminalWidget(); }, this);
+  m_terminalDock->setObjectName("terminalDock");
+  DockUtils::configureToolPanelDock(m_terminalDock);
+  addDockWidget(Qt::BottomDockWidgetArea, m_terminalDock);
+  tabifyBottomDock(m_terminalDock);
+  trackDockLayoutChanges(m_terminalDock);
+  m_terminalDock->hide();
+  connect(m_terminalDock, &QDockWidget::visibilityChanged, this,
+          [this](bool visible) {
+            Q_UNUSED(visible)
+            syncViewToggleActionStates();
+          });
+}
 
-    m_terminalDock = new QDockWidget(QString(), this);
-    m_terminalDock->setObjectName("terminalDock");
-    DockUtils::configureToolPanelDock(m_terminalDock);
+TerminalTabWidget *MainWindow::createTerminalWidget() {
+  STARTUP_TRACE_SCOPE("MainWindow::createTerminalWidget");
+  terminalWidget = new TerminalTabWidget();
+  terminalWidget->applyTheme(getTheme());
+  terminalWidget->setScrollbackMemoryLimit(
+      SettingsManager::instance()
+          .getValue("terminalScrollbackMegabytes",
+                    TERMINAL_DEFAULT_SCROLLBACK_MEGABYTES)
+          .toInt());
 
-    m_terminalDock->setWidget(terminalWidget);
-    addDockWidget(Qt::BottomDockWidgetArea, m_terminalDock);
-    tabifyBottomDock(m_terminalDock);
-    trackDockLayoutChanges(m_terminalDock);
-    m_terminalDock->hide();
-    connect(m_terminalDock, &QDockWidget::visibilityChanged, this,
-            [this](bool visible) {
-              Q_UNUSED(visible)
-              syncViewToggleActionStates();
-            });
-  }
+  connect(terminalWidget, &TerminalTabWidget::closeRequested, this, [this]() {
+    if (m_terminalDock) {
+      m_terminalDock->hide();
+    }
+  });
+  return terminalWidget;
+}
 
+TerminalTabWidget *MainWindow::ensureTerminalWidget() {
+  ensureTerminalDock();
+  m_terminalDock->materialize();
   return terminalWidget;
 }
 
@@ -3005,85 +3335,91 @@ void MainWindow::showTerminal() {
   (*runCurrentStage)();
 }
 
-void MainWindow::showProblemsPanel() {
-  if (m_vimCommandPanelActive) {
-    ensureStatusLabels();
+void MainWindow::ensureProblemsDock() {
+  if (m_problemsDock) {
     return;
   }
-  if (!problemsPanel) {
-    problemsPanel = new ProblemsPanel(this);
 
-    connect(problemsPanel, &ProblemsPanel::problemClicked, this,
-            [this](const QString &filePath, int line, int column) {
-              openFileAndAddToNewTab(filePath);
-              TextArea *textArea = getCurrentTextArea();
-              if (textArea) {
-                QTextCursor cursor = textArea->textCursor();
-                cursor.movePosition(QTextCursor::Start);
-                cursor.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor,
-                                    line);
-                cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor,
-                                    column);
-                textArea->setTextCursor(cursor);
-                textArea->setFocus();
-              }
-            });
+  m_problemsDock = new LazyDockWidget(
+      tr("Problems"), [this]() { return createProblemsPanel(); }, this);
+  m_problemsDock->setObjectName("problemsDock");
+  DockUtils::configureToolPanelDock(m_problemsDock);
+  addDockWidget(Qt::BottomDockWidgetArea, m_problemsDock);
+  tabifyBottomDock(m_problemsDock);
+  trackDockLayoutChanges(m_problemsDock);
+  m_problemsDock->hide();
+  connect(m_problemsDock, &QDockWidget::visibilityChanged, this,
+          [this](bool visible) {
+            Q_UNUSED(visible)
+            syncViewToggleActionStates();
+          });
+}
 
-    connect(problemsPanel, &ProblemsPanel::countsChanged, this,
-            &MainWindow::updateProblemsStatusLabel);
+ProblemsPanel *MainWindow::createProblemsPanel() {
+  problemsPanel = new ProblemsPanel(this);
 
-    connect(problemsPanel, &ProblemsPanel::refreshRequested, this,
-            [this](const QString &filePath) {
-              notifyDiagnosticsFileSaved(filePath);
-            });
+  connect(problemsPanel, &ProblemsPanel::problemClicked, this,
+          [this](const QString &filePath, int line, int column) {
+            openFileAndAddToNewTab(filePath);
+            TextArea *textArea = getCurrentTextArea();
+            if (textArea) {
+              QTextCursor cursor = textArea->textCursor();
+              cursor.movePosition(QTextCursor::Start);
+              cursor.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor,
+                                  line);
+              cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor,
+                                  column);
+              textArea->setTextCursor(cursor);
+              textArea->setFocus();
+            }
+          });
 
-    connect(problemsPanel, &ProblemsPanel::closeRequested, this, [this]() {
-      if (m_problemsDock) {
-        m_problemsDock->hide();
-      }
-    });
+  connect(problemsPanel, &ProblemsPanel::countsChanged, this,
+          &MainWindow::updateProblemsStatusLabel);
 
-    if (m_diagnosticsManager) {
-      for (const QString &uri : m_diagnosticsManager->allUris()) {
-        QList<LspDiagnostic> diags =
-            m_diagnosticsManager->diagnosticsForUri(uri);
-        problemsPanel->setDiagnostics(uri, diags);
-      }
+  connect(problemsPanel, &ProblemsPanel::refreshRequested, this,
+          [this](const QString &filePath) {
+            notifyDiagnosticsFileSaved(filePath);
+          });
+
+  connect(problemsPanel, &ProblemsPanel::closeRequested, this, [this]() {
+    if (m_problemsDock) {
+      m_problemsDock->hide();
     }
+  });
 
-    LightpadTabWidget *tabWidget = currentTabWidget();
-    if (tabWidget) {
-      QString filePath = tabWidget->getFilePath(tabWidget->currentIndex());
-      if (!filePath.isEmpty()) {
-        problemsPanel->setCurrentFilePath(filePath);
-      }
+  if (m_diagnosticsManager) {
+    for (const QString &uri : m_diagnosticsManager->allUris()) {
+      QList<LspDiagnostic> diags = m_diagnosticsManager->diagnosticsForUri(uri);
+      problemsPanel->setDiagnostics(uri, diags);
     }
+  }
 
-    ensureStatusLabels();
+  LightpadTabWidget *tabWidget = currentTabWidget();
+  if (tabWidget) {
+    QString filePath = tabWidget->getFilePath(tabWidget->currentIndex());
+    if (!filePath.isEmpty()) {
+      problemsPanel->setCurrentFilePath(filePath);
+    }
+  }
 
-    m_problemsDock = new QDockWidget(tr("Problems"), this);
-    m_problemsDock->setObjectName("problemsDock");
-    DockUtils::configureToolPanelDock(m_problemsDock);
-    m_problemsDock->setWidget(problemsPanel);
-    addDockWidget(Qt::BottomDockWidgetArea, m_problemsDock);
-    tabifyBottomDock(m_problemsDock);
-    trackDockLayoutChanges(m_problemsDock);
-    m_problemsDock->hide();
-    connect(m_problemsDock, &QDockWidget::visibilityChanged, this,
-            [this](bool visible) {
-              Q_UNUSED(visible)
-              syncViewToggleActionStates();
-            });
+  ensureStatusLabels();
+  return problemsPanel;
+}
+
+void MainWindow::showProblemsPanel() {
+  if (m_vimCommandPanelActive) {
+    ensureStatusLabels();
+    return;
   }
+  ensureProblemsDock();
 
-  if (!m_vimCommandPanelActive && m_problemsDock) {
-    bool visible = m_problemsDock->isVisible();
-    if (!visible) {
-      m_problemsDock->show();
-      m_problemsDock->raise();
-    } else {
-      m_problemsDock->hide();
-    }
+  bool visible = m_problemsDock->isVisible();
+  if (!visible) {
+    m_problemsDock->show();
+    m_problemsDock->raise();
+  } else {
+    m_problemsDock->hide();
   }
 }
 
@@ -3251,11 +3587,38 @@ void MainWindow::updatePythonEnvironmentLabel() {
   m_pythonEnvLabel->setVisible(true);
 }
 
-void MainWindow::ensureSourceControlPanel() {
+void MainWindow::ensureSourceControlDock() {
   if (sourceControlDock) {
     return;
   }
 
+  sourceControlDock = new LazyDockWidget(
+      tr("Source Control"), [this]() { return createSourceControlPanel(); },
+      this);
+  sourceControlDock->setObjectName("sourceControlDock");
+  DockUtils::configureToolPanelDock(sourceControlDock);
+  addDockWidget(Qt::RightDockWidgetArea, sourceControlDock);
+  trackDockLayoutChanges(sourceControlDock);
+  sourceControlDock->hide();
+  updateSourceControlDockTitle(
+      m_gitIntegration ? m_gitIntegration->repositoryPath() : QString(),
+      m_gitIntegration ? m_gitIntegration->isValidRepository() : false);
+
+  connect(sourceControlDock, &QDockWidget::visibilityChanged, this,
+          [this](bool visible) {
+            Q_UNUSED(visible)
+            syncViewToggleActionStates();
+          });
+}
+
+void MainWindow::ensureSourceControlPanel() {
+  ensureSourceControlDock();
+  sourceControlDock->materialize();
+}
+
+SourceControlPanel *MainWindow::createSourceControlPanel() {
+  STARTUP_TRACE_SCOPE("MainWindow::createSourceControlPanel");
+
   sourceControlPanel = new SourceControlPanel(this);
   sourceControlPanel->setGitIntegration(m_gitIntegration);
   sourceControlPanel->setWorkingPath(
@@ -3328,29 +3691,47 @@ void MainWindow::ensureSourceControlPanel() {
                 tr("Compare: %1 ↔ %2").arg(branch1).arg(branch2));
             diffDialog.exec();
           });
+  return sourceControlPanel;
+}
 
-  sourceControlDock = new QDockWidget(tr("Source Control"), this);
-  sourceControlDock->setObjectName("sourceControlDock");
-  DockUtils::configureToolPanelDock(sourceControlDock);
-  sourceControlDock->setWidget(sourceControlPanel);
-  addDockWidget(Qt::RightDockWidgetArea, sourceControlDock);
-  trackDockLayoutChanges(sourceControlDock);
-  sourceControlDock->hide();
-  updateSourceControlDockTitle(
-      m_gitIntegration ? m_gitIntegration->repositoryPath() : QString(),
-      m_gitIntegration ? m_gitIntegration->isValidRepository() : false);
+void MainWindow::ensureDebugDock() {
+  if (debugDock) {
+    return;
+  }
 
-  connect(sourceControlDock, &QDockWidget::visibilityChanged, this,
+  debugDock = new LazyDockWidget(
+      tr("Debug"), [this]() { return createDebugPanel(); }, this);
+  debugDock->setObjectName("debugDock");
+  DockUtils::configureToolPanelDock(debugDock);
+  addDockWidget(Qt::BottomDockWidgetArea, debugDock);
+  tabifyBottomDock(debugDock);
+  trackDockLayoutChanges(debugDock);
+  debugDock->hide();
+
+  connect(debugDock, &QDockWidget::visibilityChanged, this,
           [this](bool visible) {
             Q_UNUSED(visible)
             syncViewToggleActionStates();
           });
+
+  connect(&DebugSessionManager::instance(),
+          &DebugSessionManager::focusedSessionChanged, this,
+          [this](const QString &sessionId) { attachDebugSession(sessionId); });
+  connect(&DebugSessionManager::instance(),
+          &DebugSessionManager::sessionStarted, this,
+          [this](const QString &sessionId) { attachDebugSession(sessionId); });
+  connect(&DebugSessionManager::instance(),
+          &DebugSessionManager::allSessionsEnded, this,
+          [this]() { clearDebugSession(); });
 }
 
 void MainWindow::ensureDebugPanel() {
-  if (debugDock) {
-    return;
-  }
+  ensureDebugDock();
+  debugDock->materialize();
+}
+
+DebugPanel *MainWindow::createDebugPanel() {
+  STARTUP_TRACE_SCOPE("MainWindow::createDebugPanel");
 
   debugPanel = new DebugPanel(this);
   debugPanel->setObjectName("debugPanel");
@@ -3426,37 +3807,36 @@ void MainWindow::ensureDebugPanel() {
     clearDebugSession();
     DebugSessionManager::instance().stopSession(sessionIdToStop, true);
   });
+  return debugPanel;
+}
 
-  debugDock = new QDockWidget(tr("Debug"), this);
-  debugDock->setObjectName("debugDock");
-  DockUtils::configureToolPanelDock(debugDock);
-  debugDock->setWidget(debugPanel);
-  addDockWidget(Qt::BottomDockWidgetArea, debugDock);
-  tabifyBottomDock(debugDock);
-  trackDockLayoutChanges(debugDock);
-  debugDock->hide();
+void MainWindow::ensureTestDock() {
+  if (testDock) {
+    return;
+  }
 
-  connect(debugDock, &QDockWidget::visibilityChanged, this,
+  testDock = new LazyDockWidget(
+      tr("Tests"), [this]() { return createTestPanel(); }, this);
+  testDock->setObjectName("testDock");
+  DockUtils::configureToolPanelDock(testDock);
+  addDockWidget(Qt::BottomDockWidgetArea, testDock);
+  tabifyBottomDock(testDock);
+  trackDockLayoutChanges(testDock);
+  testDock->hide();
+  connect(testDock, &QDockWidget::visibilityChanged, this,
           [this](bool visible) {
             Q_UNUSED(visible)
             syncViewToggleActionStates();
           });
-
-  connect(&DebugSessionManager::instance(),
-          &DebugSessionManager::focusedSessionChanged, this,
-          [this](const QString &sessionId) { attachDebugSession(sessionId); });
-  connect(&DebugSessionManager::instance(),
-          &DebugSessionManager::sessionStarted, this,
-          [this](const QString &sessionId) { attachDebugSession(sessionId); });
-  connect(&DebugSessionManager::instance(),
-          &DebugSessionManager::allSessionsEnded, this,
-          [this]() { clearDebugSession(); });
 }
 
 void MainWindow::ensureTestPanel() {
-  if (testDock) {
-    return;
-  }
+  ensureTestDock();
+  testDock->materialize();
+}
+
+TestPanel *MainWindow::createTestPanel() {
+  STARTUP_TRACE_SCOPE("MainWindow::createTestPanel");
 
   TestConfigurationManager::instance().loadTemplates();
   testPanel = new TestPanel(this);
@@ -3516,20 +3896,7 @@ void MainWindow::ensureTestPanel() {
                       .arg(t.successColor.name()));
             }
           });
-
-  testDock = new QDockWidget(tr("Tests"), this);
-  testDock->setObjectName("testDock");
-  DockUtils::configureToolPanelDock(testDock);
-  testDock->setWidget(testPanel);
-  addDockWidget(Qt::BottomDockWidgetArea, testDock);
-  tabifyBottomDock(testDock);
-  trackDockLayoutChanges(testDock);
-  testDock->hide();
-  connect(testDock, &QDockWidget::visibilityChanged, this,
-          [this](bool visible) {
-            Q_UNUSED(visible)
-            syncViewToggleActionStates();
-          });
+  return testPanel;
 }
 
 void MainWindow::trackDockLayoutChanges(QDockWidget *dock) {
@@ -3721,6 +4088,7 @@ void MainWindow::showCommandPalette() {
 }
 
 void MainWindow::setupCommandPalette() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupCommandPalette");
   commandPalette = new CommandPalette(this);
 
   QMenuBar *menuBar = this->menuBar();
@@ -3745,6 +4113,7 @@ void MainWindow::showGoToLineDialog() {
 }
 
 void MainWindow::setupGoToLineDialog() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupGoToLineDialog");
   goToLineDialog = new GoToLineDialog(this);
 
   connect(goToLineDialog, &GoToLineDialog::lineSelected, this,
@@ -3870,6 +4239,7 @@ void MainWindow::showGoToSymbolDialog() {
 }
 
 void MainWindow::setupGoToSymbolDialog() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupGoToSymbolDialog");
   goToSymbolDialog = new GoToSymbolDialog(this);
 
   connect(goToSymbolDialog, &GoToSymbolDialog::symbolSelected, this,
@@ -3921,6 +4291,7 @@ void MainWindow::showFileQuickOpen() {
 }
 
 void MainWindow::setupFileQuickOpen() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupFileQuickOpen");
   fileQuickOpen = new FileQuickOpen(this);
 
   connect(
@@ -3937,6 +4308,7 @@ void MainWindow::showRecentFilesDialog() {
 }
 
 void MainWindow::setupRecentFilesDialog() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupRecentFilesDialog");
   recentFilesDialog = new RecentFilesDialog(recentFilesManager, this);
 
   connect(
@@ -3945,6 +4317,7 @@ void MainWindow::setupRecentFilesDialog() {
 }
 
 void MainWindow::setupBreadcrumb() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupBreadcrumb");
   breadcrumbWidget = new BreadcrumbWidget(this);
 
   auto layout = qobject_cast<QVBoxLayout *>(ui->centralwidget->layout());
@@ -4062,10 +4435,12 @@ void MainWindow::recordNavigationLocation() {
 }
 
 void MainWindow::setupNavigationHistory() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupNavigationHistory");
   navigationHistory = new NavigationHistory(this);
 }
 
 void MainWindow::setupSymbolNavigation() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupSymbolNavigation");
   m_symbolNavService = new SymbolNavigationService(this);
 
   const auto configs = LanguageLspDefinitionProvider::defaultConfigs();
@@ -4198,12 +4573,14 @@ void MainWindow::jumpToTarget(const DefinitionTarget &target) {
 }
 
 void MainWindow::setupAutoSave() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupAutoSave");
   autoSaveManager = new AutoSaveManager(this, this);
   autoSaveManager->setEnabled(
       SettingsManager::instance().getValue("autoSaveFiles", true).toBool());
 }
 
 void MainWindow::setupDiagnostics() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupDiagnostics");
   SettingsManager &sm = SettingsManager::instance();
   QJsonObject diagSettings =
       sm.getValue("diagnostics", QJsonObject()).toJsonObject();
@@ -4512,13 +4889,16 @@ void MainWindow::retryLanguageServerForCurrentFile(
   }
 }
 
-void MainWindow::notifyDiagnosticsFileOpened(const QString &filePath) {
+void MainWindow::notifyDiagnosticsFileOpened(const QString &filePath,
+                                             TextArea *textArea) {
   if (!m_languageFeatureManager || filePath.isEmpty()) {
     return;
   }
 
-  TextArea *textArea = getCurrentTextArea();
   if (!textArea) {
+    textArea = getCurrentTextArea();
+  }
+  if (!textArea || textArea->isLoading()) {
     return;
   }
 
@@ -4534,11 +4914,7 @@ void MainWindow::notifyDiagnosticsFileChanged(const QString &filePath,
     return;
   }
 
-  SettingsManager &sm = SettingsManager::instance();
-  QJsonObject diagSettings =
-      sm.getValue("diagnostics", QJsonObject()).toJsonObject();
-  bool onType = diagSettings.value("onType").toBool(true);
-  if (!onType) {
+  if (!m_diagnosticsOnType.value()) {
     return;
   }
 
@@ -4549,7 +4925,7 @@ void MainWindow::notifyDiagnosticsFileChanged(const QString &filePath,
     m_diagnosticsManager->trackDocumentVersion(uri, version);
   }
 
-  const int debounceMs = qMax(0, diagSettings.value("debounceMs").toInt(200));
+  const int debounceMs = qMax(0, m_diagnosticsDebounceMs.value());
   if (debounceMs == 0) {
     m_languageFeatureManager->changeDocument(filePath, version, text);
     return;
@@ -4607,11 +4983,7 @@ void MainWindow::notifyDiagnosticsFileSaved(const QString &filePath) {
 
   flushPendingDiagnosticsChange(filePath);
 
-  SettingsManager &sm = SettingsManager::instance();
-  QJsonObject diagSettings =
-      sm.getValue("diagnostics", QJsonObject()).toJsonObject();
-  bool onSave = diagSettings.value("onSave").toBool(true);
-  if (!onSave) {
+  if (!m_diagnosticsOnSave.value()) {
     return;
   }
 
@@ -4693,6 +5065,7 @@ void MainWindow::setupGitIntegration() {
   if (m_gitIntegration) {
     return;
   }
+  STARTUP_TRACE_SCOPE("MainWindow::setupGitIntegration");
 
   m_gitIntegration = new GitIntegration(this);
   m_inlineBlameEnabled = true;
@@ -4723,6 +5096,10 @@ void MainWindow::setupGitIntegration() {
           [this]() { m_gitStatusBarTimer.start(); });
   connect(m_gitIntegration, &GitIntegration::branchChanged, this,
           [this](const QString &) { m_gitStatusBarTimer.start(); });
+  connect(m_gitIntegration, &GitIntegration::workingTreeChanged, this,
+          [this](const QStringList &) { m_gitStatusBarTimer.start(); });
+
+  m_gitIntegration->setFileSystemWatchingEnabled(true);
 
   updateGitIntegrationForPath(QDir::currentPath());
 }
@@ -4755,21 +5132,7 @@ void MainWindow::updateGitIntegrationForPath(const QString &path) {
   LightpadTabWidget *tabWidget = currentTabWidget();
   QString currentFilePath = tabWidget->getFilePath(tabWidget->currentIndex());
   if (textArea && !currentFilePath.isEmpty()) {
-    textArea->setGutterGitIntegration(m_gitIntegration);
-    QList<GitDiffLineInfo> diffLines =
-        m_gitIntegration->getDiffLines(currentFilePath);
-    QList<QPair<int, int>> gutterLines;
-    gutterLines.reserve(diffLines.size());
-    for (const auto &info : diffLines) {
-      int type = 1;
-      if (info.type == GitDiffLineInfo::Type::Added) {
-        type = 0;
-      } else if (info.type == GitDiffLineInfo::Type::Deleted) {
-        type = 2;
-      }
-      gutterLines.append(qMakePair(info.lineNumber, type));
-    }
-    textArea->setGitDiffLines(gutterLines);
+    textArea->setGitDiffTracking(m_gitIntegration, currentFilePath);
   }
 
   showGitBlameForCurrentFile(isGitBlameEnabledForFile(currentFilePath));
@@ -4914,7 +5277,7 @@ void MainWindow::setFont(QFont newFont) {
   sm.setValue("fontSize", newFont.pointSize());
   sm.setValue("fontWeight", newFont.weight());
   sm.setValue("fontItalic", newFont.italic());
-  sm.saveSettings();
+  sm.requestSave();
   settings.saveSettings(textAreaSettingsPath());
 }
 
@@ -4944,7 +5307,7 @@ void MainWindow::setAutoSaveEnabled(bool enabled) {
   SettingsManager &globalSettings = SettingsManager::instance();
   if (globalSettings.getValue("autoSaveFiles", true).toBool() != enabled) {
     globalSettings.setValue("autoSaveFiles", enabled);
-    globalSettings.saveSettings();
+    globalSettings.requestSave();
   }
 }
 
@@ -4956,10 +5319,7 @@ bool MainWindow::isAutoSaveEnabled() const {
 }
 
 void MainWindow::runCurrentScript() {
-  on_actionSave_triggered();
-  auto textArea = getCurrentTextArea();
-
-  if (textArea && !textArea->changesUnsaved())
+  if (getCurrentTextArea() && saveCurrentAndWait())
     showTerminal();
 }
 
@@ -5082,7 +5442,11 @@ void MainWindow::startDebuggingForCurrentFile() {
     }
   }
 
-  on_actionSave_triggered();
+  if (!saveCurrentAndWait()) {
+    statusBar()->showMessage(
+        tr("Could not save the file. Debugging cancelled."), 5000);
+    return;
+  }
   LightpadTabWidget *tabWidget = currentTabWidget();
   if (!tabWidget) {
     return;
@@ -5204,6 +5568,7 @@ void MainWindow::attachDebugSession(const QString &sessionId) {
     return;
   }
 
+  ensureDebugPanel();
   m_activeDebugSessionId = sessionId;
   DebugSessionManager::instance().setFocusedSession(sessionId);
   debugPanel->setDapClient(session->client());
@@ -5376,10 +5741,7 @@ void MainWindow::formatCurrentDocument() {
     return;
   }
 
-  auto textArea = getCurrentTextArea();
-  on_actionSave_triggered();
-
-  if (textArea && textArea->changesUnsaved()) {
+  if (!saveCurrentAndWait()) {
     ThemedMessageBox::warning(this, "Format Document",
                               "Could not save the file. Formatting cancelled.");
     return;
@@ -5612,15 +5974,17 @@ void MainWindow::setFilePathAsTabText(QString filePath) {
 void MainWindow::closeCurrentTab() {
   auto textArea = getCurrentTextArea();
 
-  if (textArea && textArea->changesUnsaved())
-    on_actionSave_triggered();
+  if (textArea && textArea->changesUnsaved() && !saveCurrentAndWait())
+    return;
 
   LightpadTabWidget *tabWidget = currentTabWidget();
   int index = tabWidget->currentIndex();
   QString filePath;
   if (index >= 0) {
     filePath = tabWidget->getFilePath(index);
-    notifyDiagnosticsFileClosed(filePath);
+    if (m_documentRegistry->viewCount(filePath) <= 1) {
+      notifyDiagnosticsFileClosed(filePath);
+    }
   }
 
   tabWidget->closeCurrentTab();
@@ -5640,6 +6004,8 @@ void MainWindow::setupTabWidgetConnections(LightpadTabWidget *tabWidget) {
                        saveSettings();
                      }
                    });
+  QObject::connect(tabWidget, &LightpadTabWidget::pageRemoved, this,
+                   [this](LightpadPage *page) { discardHotExitJournal(page); });
   QObject::connect(tabWidget, &QTabWidget::tabCloseRequested, this,
                    [this](int) {
                      QTimer::singleShot(0, this, [this]() {
@@ -5656,6 +6022,13 @@ void MainWindow::updateTabWidgetContext(LightpadTabWidget *tabWidget,
     return;
   }
 
+  if (tabWidget->isDeferredTab(index)) {
+    if (!m_restoringSession) {
+      materializeDeferredTab(tabWidget, index);
+    }
+    return;
+  }
+
   auto text = tabWidget->tabText(index);
   setMainWindowTitle(text);
 
@@ -5731,12 +6104,14 @@ void MainWindow::applyTabWidgetTheme(LightpadTabWidget *tabWidget) {
 }
 
 void MainWindow::setupTabWidget() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupTabWidget");
   applyTabWidgetTheme(ui->tabWidget);
   setupTabWidgetConnections(ui->tabWidget);
   updateTabWidgetContext(ui->tabWidget, 0);
 }
 
 void MainWindow::setupCompletionSystem() {
+  STARTUP_TRACE_SCOPE("MainWindow::setupCompletionSystem");
 
   auto &registry = CompletionProviderRegistry::instance();
 
@@ -5746,6 +6121,8 @@ void MainWindow::setupCompletionSystem() {
 
   registry.registerProvider(std::make_shared<PluginCompletionProvider>());
 
+  registry.registerProvider(std::make_shared<BufferWordCompletionProvider>());
+
   m_lspCompletionProvider = std::make_shared<LspCompletionProvider>(nullptr);
   registry.registerProvider(m_lspCompletionProvider);
 
@@ -5769,10 +6146,16 @@ void MainWindow::setupTextArea() {
     textArea->setTabWidth(settings.tabWidth);
     textArea->setVimModeEnabled(settings.vimModeEnabled);
 
+    HotExitJournal *journal =
+        HotExitJournal::forDocument(textArea->document(), hotExitDirectory());
+    if (LightpadPage *page = currentTabWidget()->getCurrentPage()) {
+      journal->setFilePath(page->getFilePath());
+    }
+
     if (autoSaveManager && !textArea->property("autoSaveHooked").toBool()) {
-      connect(textArea->document(), &QTextDocument::modificationChanged, this,
+      connect(textArea, &QPlainTextEdit::modificationChanged, this,
               [this, textArea](bool modified) {
-                if (!autoSaveManager || !textArea) {
+                if (!autoSaveManager || !textArea || textArea->isLoading()) {
                   return;
                 }
 
@@ -5801,7 +6184,7 @@ void MainWindow::setupTextArea() {
     if (m_languageFeatureManager &&
         !textArea->property("diagnosticsHooked").toBool()) {
       connect(textArea, &QPlainTextEdit::textChanged, this, [this, textArea]() {
-        if (!m_languageFeatureManager || !textArea) {
+        if (!m_languageFeatureManager || !textArea || textArea->isLoading()) {
           return;
         }
         QString filePath;
@@ -5812,7 +6195,11 @@ void MainWindow::setupTextArea() {
           }
           parentObject = parentObject->parent();
         }
-        if (!filePath.isEmpty()) {
+        if (filePath.isEmpty()) {
+          return;
+        }
+        QPlainTextEdit *primary = m_documentRegistry->primaryView(filePath);
+        if (!primary || primary == textArea) {
           notifyDiagnosticsFileChanged(filePath, textArea->toPlainText());
         }
       });
@@ -5824,6 +6211,7 @@ void MainWindow::setupTextArea() {
 
     if (m_completionEngine) {
       textArea->setCompletionEngine(m_completionEngine);
+      IdentifierIndex::instance().watchDocument(textArea->document());
       LightpadTabWidget *tabWidget = currentTabWidget();
       QString filePath = tabWidget->getFilePath(tabWidget->currentIndex());
       if (m_lspCompletionProvider) {
@@ -5939,7 +6327,7 @@ void MainWindow::rebuildTestTargetMenu() {
   connect(automaticAction, &QAction::triggered, this, [this]() {
     SettingsManager::instance().setValue("activeTestConfigurationId",
                                          QString());
-    SettingsManager::instance().saveSettings();
+    SettingsManager::instance().requestSave();
     refreshTestTargetButton();
   });
 
@@ -5963,7 +6351,7 @@ void MainWindow::rebuildTestTargetMenu() {
               [this, configId = config.id]() {
                 SettingsManager::instance().setValue(
                     "activeTestConfigurationId", configId);
-                SettingsManager::instance().saveSettings();
+                SettingsManager::instance().requestSave();
                 refreshTestTargetButton();
               });
     }
@@ -6081,7 +6469,7 @@ void MainWindow::rebuildDebugTargetMenu() {
                                selectedCompoundName.isEmpty());
   connect(quickDebugAction, &QAction::triggered, this, [this]() {
     SettingsManager::instance().setValue("activeDebugTarget", QString());
-    SettingsManager::instance().saveSettings();
+    SettingsManager::instance().requestSave();
     refreshDebugTargetButton();
   });
 
@@ -6103,7 +6491,7 @@ void MainWindow::rebuildDebugTargetMenu() {
                                                      configName);
                 SettingsManager::instance().setValue("lastDebugConfiguration",
                                                      configName);
-                SettingsManager::instance().saveSettings();
+                SettingsManager::instance().requestSave();
                 refreshDebugTargetButton();
               });
     }
@@ -6130,7 +6518,7 @@ void MainWindow::rebuildDebugTargetMenu() {
                         compoundName);
                 SettingsManager::instance().setValue("lastDebugConfiguration",
                                                      compoundName);
-                SettingsManager::instance().saveSettings();
+                SettingsManager::instance().requestSave();
                 refreshDebugTargetButton();
               });
     }
@@ -6239,7 +6627,11 @@ bool MainWindow::startDebugConfigurationByName(
   }
 
   if (!currentFilePath.isEmpty()) {
-    on_actionSave_triggered();
+    if (!saveCurrentAndWait()) {
+      statusBar()->showMessage(tr("Could not save %1").arg(currentFilePath),
+                               5000);
+      return false;
+    }
     ensureProjectRootForPath(currentFilePath);
   }
 
@@ -6271,7 +6663,7 @@ bool MainWindow::startDebugConfigurationByName(
         this, tr("Debug Configuration"),
         tr("The selected debug configuration could not be found."));
     SettingsManager::instance().setValue("activeDebugTarget", QString());
-    SettingsManager::instance().saveSettings();
+    SettingsManager::instance().requestSave();
     refreshDebugTargetButton();
     m_debugStartInProgress = false;
     return false;
@@ -6279,7 +6671,7 @@ bool MainWindow::startDebugConfigurationByName(
 
   SettingsManager::instance().setValue("lastDebugConfiguration", selectedName);
   SettingsManager::instance().setValue("activeDebugTarget", selectedName);
-  SettingsManager::instance().saveSettings();
+  SettingsManager::instance().requestSave();
   refreshDebugTargetButton();
 
   DebugConfiguration resolvedConfig;
@@ -6342,7 +6734,11 @@ bool MainWindow::startCompoundDebugConfigurationByName(
   }
 
   if (!currentFilePath.isEmpty()) {
-    on_actionSave_triggered();
+    if (!saveCurrentAndWait()) {
+      statusBar()->showMessage(tr("Could not save %1").arg(currentFilePath),
+                               5000);
+      return false;
+    }
     ensureProjectRootForPath(currentFilePath);
   }
 
@@ -6383,7 +6779,7 @@ bool MainWindow::startCompoundDebugConfigurationByName(
         this, tr("Compound Debug Configuration"),
         tr("The selected compound configuration could not be found."));
     SettingsManager::instance().setValue("activeDebugTarget", QString());
-    SettingsManager::instance().saveSettings();
+    SettingsManager::instance().requestSave();
     refreshDebugTargetButton();
     m_debugStartInProgress = false;
     return false;
@@ -6401,7 +6797,7 @@ bool MainWindow::startCompoundDebugConfigurationByName(
       "activeDebugTarget",
       QString::fromLatin1(kCompoundDebugTargetPrefix) + selectedName);
   SettingsManager::instance().setValue("lastDebugConfiguration", selectedName);
-  SettingsManager::instance().saveSettings();
+  SettingsManager::instance().requestSave();
   refreshDebugTargetButton();
 
   QList<DebugConfiguration> resolvedConfigs;
@@ -6619,7 +7015,11 @@ void MainWindow::runTestsForCurrentContext() {
   }
 
   if (!currentFilePath.isEmpty()) {
-    on_actionSave_triggered();
+    if (!saveCurrentAndWait()) {
+      statusBar()->showMessage(tr("Could not save %1").arg(currentFilePath),
+                               5000);
+      return;
+    }
     ensureProjectRootForPath(currentFilePath);
   }
 
@@ -6700,7 +7100,11 @@ void MainWindow::on_actionStart_Debug_Configuration_triggered() {
   }
 
   if (!currentFilePath.isEmpty()) {
-    on_actionSave_triggered();
+    if (!saveCurrentAndWait()) {
+      statusBar()->showMessage(tr("Could not save %1").arg(currentFilePath),
+                               5000);
+      return;
+    }
     ensureProjectRootForPath(currentFilePath);
   }
 
@@ -6781,7 +7185,7 @@ void MainWindow::on_actionStart_Debug_Configuration_triggered() {
 
   const QString selectedTarget = displayToTarget.value(selectedName);
   SettingsManager::instance().setValue("activeDebugTarget", selectedTarget);
-  SettingsManager::instance().saveSettings();
+  SettingsManager::instance().requestSave();
   refreshDebugTargetButton();
   if (selectedTarget.startsWith(QLatin1String(kCompoundDebugTargetPrefix))) {
     startCompoundDebugConfigurationByName(
@@ -7049,6 +7453,46 @@ void MainWindow::on_actionToggle_CodeLens_triggered(bool checked) {
   }
 }
 
+void MainWindow::on_actionToggle_Paint_Profiler_triggered(bool checked) {
+  PaintProfiler &profiler = PaintProfiler::instance();
+  if (checked) {
+    profiler.reset();
+    profiler.setTracing(true);
+  }
+  profiler.setEnabled(checked);
+
+  if (checked && !m_paintProfilerOverlay) {
+    m_paintProfilerOverlay = new PaintProfilerOverlay(this);
+    statusBar()->addPermanentWidget(m_paintProfilerOverlay);
+  }
+  if (m_paintProfilerOverlay) {
+    m_paintProfilerOverlay->setVisible(checked);
+  }
+
+  if (TextArea *textArea = getCurrentTextArea()) {
+    textArea->viewport()->update();
+  }
+}
+
+void MainWindow::on_actionExport_Paint_Trace_triggered() {
+  QString filePath = QFileDialog::getSaveFileName(
+      this, tr("Export Paint Trace"),
+      QDir::home().filePath("lightpad-paint-trace.json"),
+      tr("Chrome Trace (*.json)"));
+  if (filePath.isEmpty()) {
+    return;
+  }
+
+  if (PaintProfiler::instance().writeChromeTrace(filePath)) {
+    statusBar()->showMessage(tr("Paint trace written to %1").arg(filePath),
+                             5000);
+  } else {
+    statusBar()->showMessage(tr("Could not write paint trace to %1")
+                                 .arg(filePath),
+                             5000);
+  }
+}
+
 void MainWindow::updateHeatmapForCurrentFile() {
   if (!m_heatmapEnabled || !m_gitIntegration ||
       !m_gitIntegration->isValidRepository())
@@ -8275,7 +8719,7 @@ void MainWindow::setProjectRootPath(const QString &path) {
     if (!previousRoot.isEmpty()) {
       persistTreeStateToSettings();
       if (m_globalSettingsLoaded) {
-        SettingsManager::instance().saveSettings();
+        SettingsManager::instance().requestSave();
       }
     }
   }
@@ -8290,7 +8734,7 @@ void MainWindow::setProjectRootPath(const QString &path) {
       if (globalSettings.getValue("lastProjectPath", "").toString() !=
           m_projectRootPath) {
         globalSettings.setValue("lastProjectPath", m_projectRootPath);
-        globalSettings.saveSettings();
+        globalSettings.requestSave();
       }
     }
   }
@@ -8369,6 +8813,7 @@ void MainWindow::ensureFileTreeModel() {
       m_fileTreeSelectionModel->model() == m_fileTreeModel) {
     return;
   }
+  STARTUP_TRACE_SCOPE("MainWindow::ensureFileTreeModel");
 
   if (!m_fileTreeModel) {
     m_fileTreeModel = new GitFileSystemModel(this);
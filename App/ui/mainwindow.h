@@ -7,10 +7,13 @@
 #include <QListView>
 #include <QMainWindow>
 #include <QMap>
+#include <QPointer>
 #include <QSet>
 #include <QTimer>
 #include <memory>
 
+#include "../core/io/filesaver.h"
+#include "../settings/settingsmanager.h"
 #include "../settings/textareasettings.h"
 #include "../settings/theme.h"
 
@@ -21,6 +24,8 @@ class FindReplacePanel;
 class TextArea;
 class ThemeDefinition;
 class QCompleter;
+class QJsonObject;
+class QThread;
 class Preferences;
 class CompletionEngine;
 class QTreeView;
@@ -32,6 +37,7 @@ class GitIntegration;
 class GitFileSystemModel;
 class SourceControlPanel;
 class QDockWidget;
+class LazyDockWidget;
 class QMenu;
 class QFileSystemWatcher;
 class VimMode;
@@ -173,6 +179,8 @@ private slots:
   void on_actionGit_Rebase_triggered();
   void on_actionToggle_Heatmap_triggered(bool checked);
   void on_actionToggle_CodeLens_triggered(bool checked);
+  void on_actionToggle_Paint_Profiler_triggered(bool checked);
+  void on_actionExport_Paint_Trace_triggered();
 
   void on_actionTransform_Uppercase_triggered();
   void on_actionTransform_Lowercase_triggered();
@@ -191,13 +199,22 @@ private slots:
 
 private:
   friend class AutoSaveManager;
+  friend class TabPrewarmWorker;
+
+  struct PrewarmedFile {
+    QString text;
+    FileFormat format;
+    QDateTime lastModified;
+    qint64 size = 0;
+  };
+
   Ui::MainWindow *ui;
   Popup *popupTabWidth;
   Preferences *preferences;
   FindReplacePanel *findReplacePanel;
   TerminalTabWidget *terminalWidget;
-  QDockWidget *m_terminalDock;
-  QDockWidget *m_problemsDock;
+  LazyDockWidget *m_terminalDock;
+  LazyDockWidget *m_problemsDock;
   QCompleter *completer;
   CompletionEngine *m_completionEngine;
   TextAreaSettings settings;
@@ -219,17 +236,22 @@ private:
   class RecentFilesManager *recentFilesManager;
 
   class NavigationHistory *navigationHistory;
+  class DocumentRegistry *m_documentRegistry = nullptr;
+  class PaintProfilerOverlay *m_paintProfilerOverlay = nullptr;
 
   SymbolNavigationService *m_symbolNavService;
 
   class AutoSaveManager *autoSaveManager;
   QHash<QString, QDateTime> m_fileTimestamps;
+  QHash<QString, FileFormat> m_fileFormats;
+  QHash<QString, PrewarmedFile> m_prewarmedFiles;
+  QPointer<QThread> m_tabPrewarmer;
   QFileSystemWatcher *m_openFileWatcher;
   QSet<QString> m_externalChangePrompts;
   QSet<QString> m_internalFileWrites;
   GitIntegration *m_gitIntegration;
   SourceControlPanel *sourceControlPanel;
-  QDockWidget *sourceControlDock;
+  LazyDockWidget *sourceControlDock;
   QSet<QString> m_blameEnabledFiles;
   bool m_inlineBlameEnabled;
   bool m_heatmapEnabled;
@@ -242,9 +264,9 @@ private:
   QMenu *m_debugTargetMenu;
   QTimer m_gitStatusBarTimer;
   DebugPanel *debugPanel;
-  QDockWidget *debugDock;
+  LazyDockWidget *debugDock;
   TestPanel *testPanel;
-  QDockWidget *testDock;
+  LazyDockWidget *testDock;
   MarkdownPreviewPanel *m_markdownPreviewPanel;
   QDockWidget *m_markdownPreviewDock;
   LatexPreviewPanel *m_latexPreviewPanel;
@@ -262,6 +284,9 @@ private:
   QString m_lspStatusLanguageId;
   QMap<QString, int> m_documentVersions;
   QMap<QString, QTimer *> m_diagnosticsChangeTimers;
+  Setting<bool> m_diagnosticsOnType{"diagnostics.onType", true};
+  Setting<bool> m_diagnosticsOnSave{"diagnostics.onSave", true};
+  Setting<int> m_diagnosticsDebounceMs{"diagnostics.debounceMs", 200};
   QMap<QString, QString> m_pendingDiagnosticsTexts;
   QMetaObject::Connection m_breakpointsSetConnection;
   QMetaObject::Connection m_breakpointChangedConnection;
@@ -279,7 +304,13 @@ private:
   void undo();
   void redo();
   void open(const QString &filePath);
+  void finishStreamedOpen(TextArea *textArea, const QString &filePath);
   bool save(const QString &filePath, bool isAutoSave = false);
+  bool saveCurrentAndWait();
+  void submitSave(TextArea *textArea, const QString &filePath,
+                  bool isAutoSave);
+  void finishSave(TextArea *textArea, int revision, const QString &filePath,
+                  const FileSaveResult &result);
   void recordFileTimestamp(const QString &filePath);
   bool checkExternalModification(const QString &filePath) const;
   void setupOpenFileWatcher();
@@ -298,9 +329,13 @@ private:
   void openDebugConfigurationDialog();
   void openTestConfigurationDialog();
   void openShortcutsDialog();
+  void ensureTerminalDock();
+  TerminalTabWidget *createTerminalWidget();
   TerminalTabWidget *ensureTerminalWidget();
   void showTerminalPanel();
   void showTerminal();
+  void ensureProblemsDock();
+  class ProblemsPanel *createProblemsPanel();
   void showProblemsPanel();
   void showCommandPalette();
   void showGoToLineDialog();
@@ -330,7 +365,8 @@ private:
   void openPythonEnvironmentDialog();
   void openLanguageServerStatusDialog();
   void retryLanguageServerForCurrentFile(const QString &languageId);
-  void notifyDiagnosticsFileOpened(const QString &filePath);
+  void notifyDiagnosticsFileOpened(const QString &filePath,
+                                   TextArea *textArea = nullptr);
   void notifyDiagnosticsFileChanged(const QString &filePath,
                                     const QString &text);
   void notifyDiagnosticsFileSaved(const QString &filePath);
@@ -352,11 +388,22 @@ private:
   void loadTreeStateFromSettings(const QString &rootPath);
   void persistTreeStateToSettings();
   void restoreSessionUiState();
+  void restoreHotExitBuffers();
+  void discardHotExitJournal(class LightpadPage *page);
+  void deferTab(const QString &filePath, const QJsonObject &sessionState);
+  void materializeDeferredTab(LightpadTabWidget *tabWidget, int index);
+  void prewarmDeferredTabs();
   QList<LightpadTreeView *> allTreeViews() const;
   void expandIndexInView(QTreeView *treeView, const QModelIndex &index);
+  void ensureSourceControlDock();
   void ensureSourceControlPanel();
+  SourceControlPanel *createSourceControlPanel();
+  void ensureDebugDock();
   void ensureDebugPanel();
+  DebugPanel *createDebugPanel();
+  void ensureTestDock();
   void ensureTestPanel();
+  TestPanel *createTestPanel();
   void trackDockLayoutChanges(QDockWidget *dock);
   void tabifyBottomDock(QDockWidget *dock);
   void syncViewToggleActionStates();
@@ -410,6 +457,7 @@ private:
   void loadSettings();
   void saveSettings();
   QString textAreaSettingsPath() const;
+  QString hotExitDirectory() const;
   void applyHighlightForFile(const QString &filePath);
   QString effectiveLanguageIdForFile(const QString &filePath);
   QString detectLanguageIdForExtension(const QString &extension) const;
@@ -2,16 +2,215 @@
 #include <QAbstractTextDocumentLayout>
 #include <QApplication>
 #include <QMouseEvent>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QScrollBar>
 #include <QTextBlock>
 #include <QTextDocument>
+#include <QThread>
 #include <QTimer>
+#include <QVector>
+#include <QWaitCondition>
 #include <QWheelEvent>
+#include <QtMath>
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+struct MinimapRun {
+  int start;
+  int end;
+  QColor color;
+};
+
+struct MinimapLine {
+  QString text;
+  QVector<MinimapRun> runs;
+};
+
+struct MinimapTileJob {
+  quint64 token = 0;
+  int tile = 0;
+  quint64 generation = 0;
+  int width = 0;
+  qreal lineHeight = 0;
+  qreal charWidth = 0;
+  QColor background;
+  QVector<MinimapLine> lines;
+};
+
+MinimapLine snapshotLine(const QTextBlock &block) {
+  MinimapLine line;
+  line.text = block.text();
+
+  QTextLayout *layout = block.layout();
+  if (!layout || layout->lineCount() == 0) {
+    return line;
+  }
+
+  QVector<QTextLayout::FormatRange> formats = layout->formats();
+  std::sort(formats.begin(), formats.end(),
+            [](const QTextLayout::FormatRange &a,
+               const QTextLayout::FormatRange &b) {
+              return a.start < b.start;
+            });
+  for (const auto &format : formats) {
+    if (format.length > 0 &&
+        format.format.hasProperty(QTextFormat::ForegroundBrush)) {
+      line.runs.append({format.start, format.start + format.length,
+                        format.format.foreground().color()});
+    }
+  }
+  return line;
+}
+
+QImage rasterizeTile(const MinimapTileJob &job) {
+  QImage image(job.width, qCeil(MINIMAP_TILE_LINES * job.lineHeight),
+               QImage::Format_RGB32);
+  image.fill(job.background);
+
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing, false);
+
+  const QColor defaultColor(150, 150, 150);
+  for (int row = 0; row < job.lines.size(); ++row) {
+    const MinimapLine &line = job.lines.at(row);
+    const qreal y = row * job.lineHeight;
+    qreal x = 2;
+    int run = 0;
+
+    for (int i = 0; i < line.text.length() && x < job.width; ++i) {
+      QChar ch = line.text.at(i);
+
+      if (ch.isSpace()) {
+        x += ch == '\t' ? job.charWidth * 4 : job.charWidth;
+        continue;
+      }
+
+      while (run < line.runs.size() && line.runs.at(run).end <= i) {
+        ++run;
+      }
+      const bool styled =
+          run < line.runs.size() && line.runs.at(run).start <= i;
+
+      painter.fillRect(
+          QRectF(x, y, job.charWidth * 0.8, job.lineHeight * 0.7),
+          styled ? line.runs.at(run).color : defaultColor);
+      x += job.charWidth;
+    }
+  }
+
+  return image;
+}
+} // namespace
+
+class MinimapRasterizer : public QThread {
+public:
+  static MinimapRasterizer *instance() {
+    if (!s_instance) {
+      s_instance = new MinimapRasterizer(QCoreApplication::instance());
+      s_instance->start(QThread::LowPriority);
+    }
+    return s_instance;
+  }
+
+  static MinimapRasterizer *existing() { return s_instance; }
+
+  ~MinimapRasterizer() override { stopRendering(); }
+
+  void stopRendering() {
+    {
+      QMutexLocker locker(&m_mutex);
+      m_stopRequested = true;
+      m_jobs.clear();
+    }
+    m_condition.wakeAll();
+    wait();
+  }
+
+  quint64 attach(Minimap *receiver) {
+    const quint64 token = ++m_lastToken;
+    m_receivers.insert(token, receiver);
+    return token;
+  }
+
+  void detach(quint64 token) {
+    m_receivers.remove(token);
+    clear(token);
+  }
+
+  void enqueue(const MinimapTileJob &job) {
+    QMutexLocker locker(&m_mutex);
+    for (MinimapTileJob &queued : m_jobs) {
+      if (queued.token == job.token && queued.tile == job.tile) {
+        queued = job;
+        return;
+      }
+    }
+    m_jobs.append(job);
+    m_condition.wakeOne();
+  }
+
+  void clear(quint64 token) {
+    QMutexLocker locker(&m_mutex);
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(),
+                                [token](const MinimapTileJob &job) {
+                                  return job.token == token;
+                                }),
+                 m_jobs.end());
+  }
+
+protected:
+  void run() override {
+    while (true) {
+      MinimapTileJob job;
+      {
+        QMutexLocker locker(&m_mutex);
+        while (!m_stopRequested && m_jobs.isEmpty()) {
+          m_condition.wait(&m_mutex);
+        }
+        if (m_stopRequested) {
+          return;
+        }
+        job = m_jobs.takeFirst();
+      }
+
+      QImage image = rasterizeTile(job);
+      QMetaObject::invokeMethod(
+          this,
+          [this, token = job.token, tile = job.tile,
+           generation = job.generation, image]() {
+            if (Minimap *receiver = m_receivers.value(token)) {
+              receiver->onTileRendered(tile, generation, image);
+            }
+          },
+          Qt::QueuedConnection);
+    }
+  }
+
+private:
+  explicit MinimapRasterizer(QObject *parent)
+      : QThread(parent), m_lastToken(0), m_stopRequested(false) {}
+
+  static QPointer<MinimapRasterizer> s_instance;
+
+  QHash<quint64, Minimap *> m_receivers;
+  quint64 m_lastToken;
+  QMutex m_mutex;
+  QWaitCondition m_condition;
+  QVector<MinimapTileJob> m_jobs;
+  bool m_stopRequested;
+};
+
+QPointer<MinimapRasterizer> MinimapRasterizer::s_instance;
 
 Minimap::Minimap(QWidget *parent)
     : QWidget(parent), m_sourceEditor(nullptr), m_scale(0.15), m_visible(true),
-      m_isDragging(false), m_documentDirty(true),
+      m_isDragging(false),
+      m_rasterToken(MinimapRasterizer::instance()->attach(this)),
+      m_generation(0), m_blockCount(0), m_linesPerRow(1), m_tileWidth(0),
       m_viewportColor(QColor(100, 149, 237, 60)),
       m_backgroundColor(QColor(30, 30, 30)), m_charWidth(1.5),
       m_lineHeight(3.0), m_maxVisibleLines(0), m_scrollOffset(0),
@@ -22,24 +221,27 @@ Minimap::Minimap(QWidget *parent)
   setCursor(Qt::PointingHandCursor);
 }
 
-Minimap::~Minimap() {}
+Minimap::~Minimap() {
+  if (MinimapRasterizer *rasterizer = MinimapRasterizer::existing()) {
+    rasterizer->detach(m_rasterToken);
+  }
+}
 
 void Minimap::setSourceEditor(QPlainTextEdit *editor) {
   if (m_sourceEditor) {
     disconnect(m_sourceEditor, nullptr, this, nullptr);
+    disconnect(m_sourceEditor->verticalScrollBar(), nullptr, this, nullptr);
   }
 
   m_sourceEditor = editor;
+  syncDocument();
 
   if (m_sourceEditor) {
-    connect(m_sourceEditor, &QPlainTextEdit::textChanged, this,
-            &Minimap::onSourceTextChanged);
     connect(m_sourceEditor->verticalScrollBar(), &QScrollBar::valueChanged,
             this, &Minimap::onSourceScrollChanged);
     connect(m_sourceEditor, &QPlainTextEdit::cursorPositionChanged, this,
             &Minimap::onSourceCursorPositionChanged);
 
-    m_documentDirty = true;
     updateContent();
   }
 }
@@ -50,7 +252,7 @@ void Minimap::setScale(qreal scale) {
   m_scale = qBound(0.05, scale, 0.5);
   m_charWidth = 8.0 * m_scale;
   m_lineHeight = 14.0 * m_scale;
-  m_documentDirty = true;
+  resetTiles();
   update();
 }
 
@@ -68,7 +270,7 @@ void Minimap::updateContent() {
     return;
   }
 
-  renderDocument();
+  syncDocument();
   updateViewportRect();
   update();
 }
@@ -80,10 +282,12 @@ void Minimap::setViewportColor(const QColor &color) {
 
 void Minimap::setBackgroundColor(const QColor &color) {
   m_backgroundColor = color;
-  m_documentDirty = true;
+  resetTiles();
   update();
 }
 
+int Minimap::linesPerRow() const { return m_linesPerRow; }
+
 void Minimap::paintEvent(QPaintEvent *event) {
   Q_UNUSED(event);
 
@@ -96,15 +300,29 @@ void Minimap::paintEvent(QPaintEvent *event) {
     return;
   }
 
-  if (m_documentDirty && !m_updatePending) {
-    renderDocument();
+  syncDocument();
+  if (m_tileWidth != width()) {
+    resetTiles();
   }
 
-  if (!m_documentImage.isNull()) {
-    int sourceY = scrollOffsetInPixels();
-    QRect sourceRect(0, sourceY, m_documentImage.width(), height());
-    QRect destRect(0, 0, width(), height());
-    painter.drawImage(destRect, m_documentImage, sourceRect);
+  const int count = tileCount();
+  if (count > 0) {
+    const int scrollY = scrollOffsetInPixels();
+    const int firstTile = qBound(0, int(scrollY / tileHeight()), count - 1);
+    const int lastTile =
+        qBound(0, int((scrollY + height()) / tileHeight()), count - 1);
+
+    for (int tile = firstTile; tile <= lastTile; ++tile) {
+      auto it = m_tiles.constFind(tile);
+      if (it != m_tiles.constEnd() && !it->image.isNull()) {
+        painter.drawImage(QPointF(0, tile * tileHeight() - scrollY),
+                          it->image);
+      }
+      if (!m_updatePending) {
+        requestTile(tile);
+      }
+    }
+    evictTiles(firstTile, lastTile);
   }
 
   if (!m_viewportRect.isEmpty()) {
@@ -148,12 +366,32 @@ void Minimap::wheelEvent(QWheelEvent *event) {
 void Minimap::resizeEvent(QResizeEvent *event) {
   Q_UNUSED(event);
   m_maxVisibleLines = static_cast<int>(height() / m_lineHeight);
-  m_documentDirty = true;
   updateViewportRect();
 }
 
-void Minimap::onSourceTextChanged() {
-  m_documentDirty = true;
+void Minimap::onSourceContentsChange(int position, int charsRemoved,
+                                     int charsAdded) {
+  Q_UNUSED(charsRemoved);
+  if (!m_document) {
+    return;
+  }
+
+  const int blockCount = m_document->blockCount();
+  if (updateLevelOfDetail()) {
+    resetTiles();
+  } else {
+    const int firstBlock = m_document->findBlock(position).blockNumber();
+    const int lastBlock =
+        m_document->findBlock(position + charsAdded).blockNumber();
+    const int rowsPerTile = MINIMAP_TILE_LINES * m_linesPerRow;
+    const int firstTile = qMax(0, firstBlock) / rowsPerTile;
+    if (blockCount != m_blockCount || lastBlock < 0) {
+      invalidateTiles(firstTile, INT_MAX);
+    } else {
+      invalidateTiles(firstTile, lastBlock / rowsPerTile);
+    }
+  }
+  m_blockCount = blockCount;
 
   if (!m_updatePending) {
     m_updatePending = true;
@@ -174,13 +412,24 @@ void Minimap::onSourceScrollChanged(int value) {
 
 void Minimap::onSourceCursorPositionChanged() {
 
-  if (m_documentDirty) {
+  if (m_updatePending) {
     return;
   }
   updateViewportRect();
   update();
 }
 
+void Minimap::onTileRendered(int tile, quint64 generation,
+                             const QImage &image) {
+  auto it = m_tiles.find(tile);
+  if (it == m_tiles.end() || it->generation != generation) {
+    return;
+  }
+  it->image = image;
+  it->renderedGeneration = generation;
+  update();
+}
+
 void Minimap::updateViewportRect() {
   if (!m_sourceEditor) {
     m_viewportRect = QRect();
@@ -199,7 +448,7 @@ void Minimap::updateViewportRect() {
   int visibleLineCount =
       m_sourceEditor->height() / m_sourceEditor->fontMetrics().lineSpacing();
 
-  qreal lineHeightMinimap = m_lineHeight;
+  qreal lineHeightMinimap = lineStep();
   int totalMinimapHeight = static_cast<int>(totalLines * lineHeightMinimap);
 
   int viewportTop = static_cast<int>(firstVisibleLine * lineHeightMinimap);
@@ -207,10 +456,10 @@ void Minimap::updateViewportRect() {
 
   if (totalMinimapHeight > height()) {
     int maxScrollOffset =
-        static_cast<int>((totalMinimapHeight - height()) / m_lineHeight);
+        static_cast<int>((totalMinimapHeight - height()) / lineHeightMinimap);
     int desiredCenter = viewportTop + viewportHeight / 2;
     int desiredOffset =
-        static_cast<int>((desiredCenter - height() / 2) / m_lineHeight);
+        static_cast<int>((desiredCenter - height() / 2) / lineHeightMinimap);
     m_scrollOffset = qBound(0, desiredOffset, maxScrollOffset);
     viewportTop -= scrollOffsetInPixels();
   } else {
@@ -241,112 +490,123 @@ int Minimap::lineNumberFromY(int y) const {
   }
 
   int adjustedY = y + scrollOffsetInPixels();
-  int lineNumber = static_cast<int>(adjustedY / m_lineHeight);
+  int lineNumber = static_cast<int>(adjustedY / lineStep());
   int totalLines = m_sourceEditor->document()->blockCount();
 
   return qBound(0, lineNumber, totalLines - 1);
 }
 
 int Minimap::scrollOffsetInPixels() const {
-  return static_cast<int>(m_scrollOffset * m_lineHeight);
+  return static_cast<int>(m_scrollOffset * lineStep());
 }
 
-void Minimap::renderDocument() {
-  if (!m_sourceEditor) {
-    m_documentImage = QImage();
-    m_documentDirty = false;
-    return;
-  }
+qreal Minimap::lineStep() const { return m_lineHeight / m_linesPerRow; }
 
-  QTextDocument *doc = m_sourceEditor->document();
-  int totalLines = doc->blockCount();
+qreal Minimap::tileHeight() const { return MINIMAP_TILE_LINES * m_lineHeight; }
 
-  if (totalLines == 0) {
-    m_documentImage = QImage();
-    m_documentDirty = false;
-    return;
+int Minimap::tileCount() const {
+  if (!m_document) {
+    return 0;
   }
+  const int rows =
+      (m_document->blockCount() + m_linesPerRow - 1) / m_linesPerRow;
+  return (rows + MINIMAP_TILE_LINES - 1) / MINIMAP_TILE_LINES;
+}
 
-  int imageWidth = width();
-  int imageHeight = static_cast<int>(totalLines * m_lineHeight) + height();
-
-  imageHeight = qMin(imageHeight, 10000);
-
-  m_documentImage = QImage(imageWidth, imageHeight, QImage::Format_RGB32);
-  m_documentImage.fill(m_backgroundColor);
-
-  QPainter painter(&m_documentImage);
-  painter.setRenderHint(QPainter::Antialiasing, false);
-
-  QTextBlock block = doc->begin();
-  int lineIndex = 0;
-
-  while (block.isValid() && lineIndex * m_lineHeight < imageHeight) {
-    QString text = block.text();
-    qreal y = lineIndex * m_lineHeight;
-    qreal x = 2;
-
-    QTextLayout *layout = block.layout();
-
-    if (layout && layout->lineCount() > 0) {
-
-      QVector<QTextLayout::FormatRange> formats = layout->formats();
+void Minimap::syncDocument() {
+  QTextDocument *document =
+      m_sourceEditor ? m_sourceEditor->document() : nullptr;
+  if (document == m_document) {
+    return;
+  }
 
-      int charIndex = 0;
-      for (int i = 0; i < text.length() && x < imageWidth; ++i) {
-        QChar ch = text[i];
+  if (m_document) {
+    disconnect(m_document, nullptr, this, nullptr);
+  }
+  m_document = document;
+  if (m_document) {
+    connect(m_document, &QTextDocument::contentsChange, this,
+            &Minimap::onSourceContentsChange);
+  }
+  resetTiles();
+}
 
-        if (ch.isSpace()) {
-          if (ch == '\t') {
-            x += m_charWidth * 4;
-          } else {
-            x += m_charWidth;
-          }
-          charIndex++;
-          continue;
-        }
+void Minimap::resetTiles() {
+  m_tiles.clear();
+  MinimapRasterizer::instance()->clear(m_rasterToken);
+  m_tileWidth = width();
+  m_blockCount = m_document ? m_document->blockCount() : 0;
+  updateLevelOfDetail();
+}
 
-        QColor charColor(150, 150, 150);
+bool Minimap::updateLevelOfDetail() {
+  const int lines = m_document ? m_document->blockCount() : 0;
+  const int linesPerRow =
+      qMax(1, qCeil(lines * m_lineHeight / MINIMAP_DETAIL_HEIGHT_LIMIT));
+  if (linesPerRow == m_linesPerRow) {
+    return false;
+  }
+  m_linesPerRow = linesPerRow;
+  return true;
+}
 
-        for (const auto &format : formats) {
-          if (charIndex >= format.start &&
-              charIndex < format.start + format.length) {
-            if (format.format.hasProperty(QTextFormat::ForegroundBrush)) {
-              charColor = format.format.foreground().color();
-            }
-            break;
-          }
-        }
+void Minimap::invalidateTiles(int firstTile, int lastTile) {
+  for (auto it = m_tiles.begin(); it != m_tiles.end(); ++it) {
+    if (it.key() >= firstTile && it.key() <= lastTile) {
+      it->generation = ++m_generation;
+    }
+  }
+}
 
-        painter.fillRect(QRectF(x, y, m_charWidth * 0.8, m_lineHeight * 0.7),
-                         charColor);
-        x += m_charWidth;
-        charIndex++;
+void Minimap::requestTile(int tile) {
+  auto it = m_tiles.find(tile);
+  if (it == m_tiles.end()) {
+    it = m_tiles.insert(tile, MinimapTile());
+    it->generation = ++m_generation;
+  }
+  if (it->renderedGeneration == it->generation ||
+      it->requestedGeneration == it->generation) {
+    return;
+  }
+  it->requestedGeneration = it->generation;
+
+  MinimapTileJob job;
+  job.token = m_rasterToken;
+  job.tile = tile;
+  job.generation = it->generation;
+  job.width = m_tileWidth;
+  job.lineHeight = m_lineHeight;
+  job.charWidth = m_charWidth;
+  job.background = m_backgroundColor;
+
+  const int firstLine = tile * MINIMAP_TILE_LINES * m_linesPerRow;
+  QTextBlock block = m_document->findBlockByNumber(firstLine);
+  for (int row = 0; row < MINIMAP_TILE_LINES && block.isValid(); ++row) {
+    QTextBlock representative = block;
+    for (int i = 0; i < m_linesPerRow && block.isValid(); ++i) {
+      if (block.length() > representative.length()) {
+        representative = block;
       }
-    } else {
+      block = block.next();
+    }
+    job.lines.append(snapshotLine(representative));
+  }
 
-      for (int i = 0; i < text.length() && x < imageWidth; ++i) {
-        QChar ch = text[i];
+  MinimapRasterizer::instance()->enqueue(job);
+}
 
-        if (ch.isSpace()) {
-          if (ch == '\t') {
-            x += m_charWidth * 4;
-          } else {
-            x += m_charWidth;
-          }
-          continue;
-        }
+void Minimap::evictTiles(int firstVisibleTile, int lastVisibleTile) {
+  if (m_tiles.size() <= MINIMAP_MAX_CACHED_TILES) {
+    return;
+  }
 
-        QColor charColor(150, 150, 150);
-        painter.fillRect(QRectF(x, y, m_charWidth * 0.8, m_lineHeight * 0.7),
-                         charColor);
-        x += m_charWidth;
-      }
+  const int margin = MINIMAP_MAX_CACHED_TILES / 4;
+  for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+    if (it.key() < firstVisibleTile - margin ||
+        it.key() > lastVisibleTile + margin) {
+      it = m_tiles.erase(it);
+    } else {
+      ++it;
     }
-
-    block = block.next();
-    lineIndex++;
   }
-
-  m_documentDirty = false;
 }
@@ -1,11 +1,27 @@
 #ifndef MINIMAP_H
 #define MINIMAP_H
 
+#include <QHash>
+#include <QImage>
 #include <QPlainTextEdit>
+#include <QPointer>
 #include <QScrollBar>
 #include <QSyntaxHighlighter>
 #include <QWidget>
 
+class MinimapRasterizer;
+
+constexpr int MINIMAP_TILE_LINES = 128;
+constexpr int MINIMAP_DETAIL_HEIGHT_LIMIT = 65536;
+constexpr int MINIMAP_MAX_CACHED_TILES = 48;
+
+struct MinimapTile {
+  QImage image;
+  quint64 generation = 0;
+  quint64 renderedGeneration = 0;
+  quint64 requestedGeneration = 0;
+};
+
 class Minimap : public QWidget {
   Q_OBJECT
 
@@ -31,6 +47,8 @@ public:
 
   void setBackgroundColor(const QColor &color);
 
+  int linesPerRow() const;
+
 signals:
 
   void scrollRequested(int lineNumber);
@@ -44,24 +62,40 @@ protected:
   void resizeEvent(QResizeEvent *event) override;
 
 private slots:
-  void onSourceTextChanged();
+  void onSourceContentsChange(int position, int charsRemoved, int charsAdded);
   void onSourceScrollChanged(int value);
   void onSourceCursorPositionChanged();
 
 private:
+  friend class MinimapRasterizer;
+
+  void onTileRendered(int tile, quint64 generation, const QImage &image);
   void updateViewportRect();
   void scrollToY(int y);
   int lineNumberFromY(int y) const;
-  void renderDocument();
   int scrollOffsetInPixels() const;
+  qreal lineStep() const;
+  qreal tileHeight() const;
+  int tileCount() const;
+  void syncDocument();
+  void resetTiles();
+  bool updateLevelOfDetail();
+  void invalidateTiles(int firstTile, int lastTile);
+  void requestTile(int tile);
+  void evictTiles(int firstVisibleTile, int lastVisibleTile);
 
   QPlainTextEdit *m_sourceEditor;
+  QPointer<QTextDocument> m_document;
   qreal m_scale;
   bool m_visible;
   bool m_isDragging;
 
-  QImage m_documentImage;
-  bool m_documentDirty;
+  QHash<int, MinimapTile> m_tiles;
+  quint64 m_rasterToken;
+  quint64 m_generation;
+  int m_blockCount;
+  int m_linesPerRow;
+  int m_tileWidth;
 
   QRect m_viewportRect;
   QColor m_viewportColor;
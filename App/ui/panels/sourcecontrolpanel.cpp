@@ -57,11 +57,12 @@ SourceControlPanel::SourceControlPanel(QWidget *parent)
       m_compareBranchesBtn(nullptr), m_worktreeBtn(nullptr),
       m_discardAllBtn(nullptr), m_historyExpanded(false),
       m_updatingBranchSelector(false), m_updatingTree(false), m_stagedCount(0),
-      m_changesCount(0), m_refreshTimer(new QTimer(this)), m_theme(),
-      m_themeInitialized(false) {
+      m_changesCount(0), m_refreshTimer(new QTimer(this)),
+      m_fullRefreshPending(false), m_theme(), m_themeInitialized(false) {
   m_refreshTimer->setSingleShot(true);
   m_refreshTimer->setInterval(0);
-  connect(m_refreshTimer, &QTimer::timeout, this, &SourceControlPanel::refresh);
+  connect(m_refreshTimer, &QTimer::timeout, this,
+          &SourceControlPanel::applyPendingRefresh);
   setupUI();
 }
 
@@ -667,6 +668,8 @@ void SourceControlPanel::setGitIntegration(GitIntegration *git) {
   if (m_git) {
     connect(m_git, &GitIntegration::statusChanged, this,
             &SourceControlPanel::onStatusChanged);
+    connect(m_git, &GitIntegration::workingTreeChanged, this,
+            [this](const QStringList &) { scheduleRefresh(); });
     connect(m_git, &GitIntegration::branchChanged, this,
             &SourceControlPanel::onBranchChanged);
     connect(m_git, &GitIntegration::operationCompleted, this,
@@ -1559,7 +1562,10 @@ void SourceControlPanel::updateHeaderTitle() {
   m_headerTitleLabel->setToolTip(repoRoot);
 }
 
-void SourceControlPanel::onStatusChanged() { scheduleRefresh(); }
+void SourceControlPanel::onStatusChanged() {
+  m_fullRefreshPending = true;
+  scheduleRefresh();
+}
 
 void SourceControlPanel::onBranchChanged(const QString &branchName) {
   Q_UNUSED(branchName);
@@ -1572,6 +1578,17 @@ void SourceControlPanel::scheduleRefresh() {
   }
 }
 
+void SourceControlPanel::applyPendingRefresh() {
+  const bool fullRefresh = m_fullRefreshPending;
+  m_fullRefreshPending = false;
+  if (fullRefresh || !m_git || !m_git->isValidRepository()) {
+    refresh();
+    return;
+  }
+
+  updateTree();
+}
+
 void SourceControlPanel::onBranchSelectorChanged(int index) {
   if (m_updatingBranchSelector || !m_git || index < 0)
     return;
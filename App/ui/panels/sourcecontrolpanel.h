@@ -95,6 +95,7 @@ private:
   void updateCounts();
   void updateHeaderTitle();
   void scheduleRefresh();
+  void applyPendingRefresh();
   bool confirmDestructive(const QString &title, const QString &text);
 
   GitIntegration *m_git;
@@ -163,6 +164,7 @@ private:
   int m_stagedCount;
   int m_changesCount;
   QTimer *m_refreshTimer;
+  bool m_fullRefreshPending;
 };
 
 #endif
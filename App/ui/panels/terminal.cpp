@@ -4,6 +4,9 @@
 #ifndef Q_OS_WIN
 #include "terminalpty.h"
 #endif
+#include "terminalparser.h"
+#include "terminalscreen.h"
+#include "terminalscreenview.h"
 #include "terminalview.h"
 #include "ui_terminal.h"
 
@@ -130,14 +133,17 @@ int findTrailingIncompleteEscapeStart(const QString &text) {
 Terminal::Terminal(QWidget *parent)
     : QWidget(parent), ui(new Ui::Terminal), m_process(nullptr),
 #ifndef Q_OS_WIN
-      m_shellPty(nullptr),
+      m_shellPty(nullptr), m_ptyDecoder(QStringDecoder::System),
 #endif
+      m_repaintTimer(nullptr),
       m_runProcess(nullptr), m_restartTimer(nullptr), m_historyIndex(0),
       m_processRunning(false), m_shellStopRequested(false),
       m_restartShellAfterRun(false), m_autoRestartEnabled(true),
       m_restartAttempts(0), m_backgroundColor("#0e1116"),
       m_textColor("#e6edf3"), m_errorColor("#f44336"), m_linkColor("#58a6ff"),
-      m_scrollbackLines(kDefaultScrollbackLines), m_linkDetectionEnabled(true),
+      m_scrollbackLines(TERMINAL_DEFAULT_SCROLLBACK_LINES),
+      m_scrollbackMegabytes(TERMINAL_DEFAULT_SCROLLBACK_MEGABYTES),
+      m_linkDetectionEnabled(true),
       m_urlRegex(R"((https?://|ftp://|file://)[^\s<>\"\'\]\)]+)"),
       m_filePathRegex(R"((?:^|[\s:])(/[^\s:]+|[A-Za-z]:\\[^\s:]+))"),
       m_inputStartPosition(0), m_ansiForeground(m_textColor), m_ansiRow(0),
@@ -145,9 +151,8 @@ Terminal::Terminal(QWidget *parent)
       m_ansiBold(false), m_ansiDim(false), m_ansiItalic(false),
       m_ansiUnderline(false), m_ansiInverse(false), m_ansiOverwriteMode(false),
       m_ansiChunkUsedScreenOps(false), m_alternateScreenActive(false),
-      m_terminalColumns(80), m_terminalRows(24),
-      m_savedPrimaryInputStartPosition(0), m_savedPrimaryAnsiRow(0),
-      m_savedPrimaryAnsiColumn(0), m_baseFontSize(kDefaultFontSize),
+      m_ptyScreenActive(false), m_terminalColumns(80), m_terminalRows(24),
+      m_gridView(nullptr), m_baseFontSize(kDefaultFontSize),
       m_contextMenu(nullptr), m_copyAction(nullptr), m_stopAction(nullptr),
       m_runInputHistoryIndex(0), m_runInputIndicator(nullptr),
       m_runInputIndicatorTimer(nullptr), m_runInputIndicatorActive(false),
@@ -203,10 +208,30 @@ void Terminal::setupTerminal() {
   monoFont.setPointSize(11);
   ui->textEdit->setFont(monoFont);
   ui->textEdit->setCursorWidth(2);
+  ui->textEdit->setUndoRedoEnabled(false);
 
   ui->textEdit->installEventFilter(this);
   ui->textEdit->viewport()->installEventFilter(this);
 
+  m_gridScreen =
+      std::make_unique<TerminalScreen>(m_terminalColumns, m_terminalRows);
+  m_gridScreen->setScrollbackCapacity(m_scrollbackLines);
+  m_gridScreen->setScrollbackMemoryBudget(
+      static_cast<qint64>(m_scrollbackMegabytes) * 1024 * 1024);
+  m_gridParser = std::make_unique<TerminalParser>(m_gridScreen.get());
+  m_gridView = new TerminalScreenView(this);
+  m_gridView->setObjectName("terminalScreenView");
+  m_gridView->setScreen(m_gridScreen.get());
+  m_gridView->setFont(monoFont);
+  m_gridView->installEventFilter(this);
+  m_gridView->hide();
+  ui->verticalLayout->addWidget(m_gridView);
+
+  m_repaintTimer = new QTimer(this);
+  m_repaintTimer->setSingleShot(true);
+  m_repaintTimer->setTimerType(Qt::PreciseTimer);
+  connect(m_repaintTimer, &QTimer::timeout, this, &Terminal::repaintScreen);
+
   setupContextMenu();
 
   ui->cwdLabel->setFont(monoFont);
@@ -318,14 +343,20 @@ void Terminal::enterAlternateScreen() {
     return;
   }
 
-  m_savedPrimaryScreenText = ui->textEdit->toPlainText();
-  m_savedPrimaryInputStartPosition = m_inputStartPosition;
-  m_savedPrimaryAnsiRow = m_ansiRow;
-  m_savedPrimaryAnsiColumn = m_ansiColumn;
   m_alternateScreenActive = true;
+  m_gridParser->reset();
+  m_gridScreen->reset();
+  m_gridScreen->resize(m_terminalColumns, m_terminalRows);
+  m_gridScreen->setAlternateScreen(true);
+  m_gridScreen->takeScreenSwitch();
 
-  ui->textEdit->clear();
-  resetAnsiState();
+  const bool hadFocus = ui->textEdit->hasFocus();
+  ui->textEdit->hide();
+  m_gridView->show();
+  m_gridView->refresh();
+  if (hadFocus) {
+    m_gridView->setFocus(Qt::OtherFocusReason);
+  }
 }
 
 void Terminal::leaveAlternateScreen() {
@@ -333,20 +364,140 @@ void Terminal::leaveAlternateScreen() {
     return;
   }
 
-  ui->textEdit->setPlainText(m_savedPrimaryScreenText);
   m_alternateScreenActive = false;
   m_ansiOverwriteMode = false;
   m_ansiChunkUsedScreenOps = false;
-  m_ansiRow = m_savedPrimaryAnsiRow;
-  m_ansiColumn = m_savedPrimaryAnsiColumn;
+
+  const bool hadFocus = m_gridView->hasFocus();
+  m_gridView->hide();
+  ui->textEdit->show();
+  if (hadFocus) {
+    ui->textEdit->setFocus(Qt::OtherFocusReason);
+  }
 
   QTextCursor cursor = ansiCursor(false);
   ui->textEdit->setTextCursor(cursor);
-  m_inputStartPosition = qMin(m_savedPrimaryInputStartPosition,
-                              ui->textEdit->document()->characterCount() - 1);
   scrollToBottom();
 }
 
+int Terminal::feedAlternateScreen(const QString &text) {
+  const int consumed = m_gridParser->feed(text);
+
+  const QByteArray responses = m_gridScreen->takeResponses();
+  if (!responses.isEmpty()) {
+    writeToShell(responses);
+  }
+
+  if (m_gridScreen->isAlternateScreen()) {
+    m_gridView->refresh();
+  } else {
+    leaveAlternateScreen();
+  }
+  return consumed;
+}
+
+void Terminal::showPtyScreen() {
+  m_gridParser->reset();
+  if (m_ptyScreenActive) {
+    return;
+  }
+
+  leaveAlternateScreen();
+  m_ptyScreenActive = true;
+  m_gridScreen->reset();
+  m_gridScreen->eraseInDisplay(3);
+  m_gridScreen->resize(m_terminalColumns, m_terminalRows);
+  m_gridView->clearSelection();
+  m_gridView->scrollToBottom();
+
+  QString transcript = ui->textEdit->toPlainText();
+  if (!transcript.isEmpty()) {
+    if (!transcript.endsWith(QLatin1Char('\n'))) {
+      transcript.append(QLatin1Char('\n'));
+    }
+    transcript.replace(QLatin1Char('\n'), QStringLiteral("\r\n"));
+    feedPtyScreen(transcript);
+  }
+
+  const bool hadFocus = ui->textEdit->hasFocus();
+  ui->textEdit->hide();
+  m_gridView->show();
+  m_gridView->refresh();
+  if (hadFocus) {
+    m_gridView->setFocus(Qt::OtherFocusReason);
+  }
+}
+
+void Terminal::hidePtyScreen() {
+  if (!m_ptyScreenActive) {
+    return;
+  }
+
+  m_ptyScreenActive = false;
+  const bool hadFocus = m_gridView->hasFocus();
+  m_gridView->hide();
+  ui->textEdit->show();
+  if (hadFocus) {
+    ui->textEdit->setFocus(Qt::OtherFocusReason);
+  }
+}
+
+void Terminal::feedPtyScreen(const QString &text) {
+  QStringView remaining(text);
+  while (!remaining.isEmpty()) {
+    remaining = remaining.mid(m_gridParser->feed(remaining));
+  }
+
+  const QByteArray responses = m_gridScreen->takeResponses();
+  if (!responses.isEmpty()) {
+    writeToShell(responses);
+  }
+  scheduleScreenRepaint();
+}
+
+void Terminal::scheduleScreenRepaint() {
+  if (m_repaintTimer->isActive()) {
+    return;
+  }
+  const qint64 elapsed = m_repaintClock.isValid() ? m_repaintClock.elapsed()
+                                                  : kRepaintIntervalMs;
+  m_repaintTimer->start(
+      static_cast<int>(qMax<qint64>(0, kRepaintIntervalMs - elapsed)));
+}
+
+void Terminal::repaintScreen() {
+  m_repaintClock.start();
+  m_gridView->refresh();
+}
+
+bool Terminal::hasTerminalSelection() const {
+  if (m_ptyScreenActive || m_alternateScreenActive) {
+    return m_gridView->hasSelection();
+  }
+  return ui->textEdit->textCursor().hasSelection();
+}
+
+void Terminal::copySelection() {
+  if (m_ptyScreenActive || m_alternateScreenActive) {
+    if (m_gridView->hasSelection()) {
+      QApplication::clipboard()->setText(m_gridView->selectedText());
+    }
+    return;
+  }
+  ui->textEdit->copy();
+}
+
+void Terminal::pasteClipboard() {
+  const QString text = QApplication::clipboard()->text();
+  if (isPtyShellActive() &&
+      !(m_runProcess && m_runProcess->state() != QProcess::NotRunning)) {
+    m_gridView->scrollToBottom();
+    writeToShell(text.toUtf8());
+    return;
+  }
+  insertInputText(text);
+}
+
 bool Terminal::hasProtectedInputSurface() const {
   return isPtyShellActive() ||
          (m_runProcess && m_runProcess->state() != QProcess::NotRunning);
@@ -665,14 +816,21 @@ bool Terminal::handlePtyKeyPress(QKeyEvent *keyEvent) {
   const bool shift = mods & Qt::ShiftModifier;
 
   if (ctrl && shift && keyEvent->key() == Qt::Key_C) {
-    if (ui->textEdit->textCursor().hasSelection()) {
-      ui->textEdit->copy();
-    }
+    copySelection();
     return true;
   }
 
   if (ctrl && shift && keyEvent->key() == Qt::Key_V) {
-    writeToShell(QApplication::clipboard()->text().toUtf8());
+    pasteClipboard();
+    return true;
+  }
+
+  if (shift && !ctrl && (keyEvent->key() == Qt::Key_PageUp ||
+                         keyEvent->key() == Qt::Key_PageDown)) {
+    const int page = qMax(1, m_gridScreen->rows() - 1);
+    m_gridView->setScrollOffset(
+        m_gridView->scrollOffset() +
+        (keyEvent->key() == Qt::Key_PageUp ? page : -page));
     return true;
   }
 
@@ -764,12 +922,20 @@ bool Terminal::handlePtyKeyPress(QKeyEvent *keyEvent) {
   }
 
   if (!sequence.isEmpty()) {
+    if ((m_alternateScreenActive || m_ptyScreenActive) &&
+        m_gridScreen->applicationCursorKeys() && sequence.size() == 3 &&
+        sequence.startsWith("\x1b[") &&
+        QByteArrayLiteral("ABCDHF").contains(sequence.at(2))) {
+      sequence[1] = 'O';
+    }
+    m_gridView->scrollToBottom();
     writeToShell(sequence);
     return true;
   }
 
   const QString text = keyEvent->text();
   if (!text.isEmpty()) {
+    m_gridView->scrollToBottom();
     writeToShell(text.toUtf8());
     return true;
   }
@@ -783,18 +949,30 @@ void Terminal::updatePtySize() {
     return;
   }
 
-  QFontMetrics metrics(ui->textEdit->font());
-  int charWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char('M')));
-  int lineHeight = qMax(1, metrics.lineSpacing());
-  const QRect viewport = ui->textEdit->viewport()->rect();
-  const int documentMargin =
-      qMax(0, qRound(ui->textEdit->document()->documentMargin()) * 2);
-  const int availableWidth = qMax(charWidth, viewport.width() - documentMargin -
-                                                 ui->textEdit->cursorWidth());
-  const int availableHeight =
-      qMax(lineHeight, viewport.height() - documentMargin);
-  m_terminalColumns = qMax(20, availableWidth / charWidth);
-  m_terminalRows = qMax(4, availableHeight / lineHeight);
+  const bool gridActive = m_alternateScreenActive || m_ptyScreenActive;
+  if (gridActive) {
+    const QSize grid = m_gridView->gridSize();
+    m_terminalColumns = qMax(20, grid.width());
+    m_terminalRows = qMax(4, grid.height());
+  } else {
+    QFontMetrics metrics(ui->textEdit->font());
+    int charWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char('M')));
+    int lineHeight = qMax(1, metrics.lineSpacing());
+    const QRect viewport = ui->textEdit->viewport()->rect();
+    const int documentMargin =
+        qMax(0, qRound(ui->textEdit->document()->documentMargin()) * 2);
+    const int availableWidth =
+        qMax(charWidth,
+             viewport.width() - documentMargin - ui->textEdit->cursorWidth());
+    const int availableHeight =
+        qMax(lineHeight, viewport.height() - documentMargin);
+    m_terminalColumns = qMax(20, availableWidth / charWidth);
+    m_terminalRows = qMax(4, availableHeight / lineHeight);
+  }
+  if (gridActive) {
+    m_gridScreen->resize(m_terminalColumns, m_terminalRows);
+    m_gridView->refresh();
+  }
   m_shellPty->resize(m_terminalColumns, m_terminalRows);
 #endif
 }
@@ -877,6 +1055,15 @@ QColor Terminal::ansi256Color(int index) const {
   return QColor();
 }
 
+QVector<QColor> Terminal::ansiPalette() const {
+  QVector<QColor> palette;
+  palette.reserve(256);
+  for (int index = 0; index < 256; ++index) {
+    palette.append(ansi256Color(index));
+  }
+  return palette;
+}
+
 bool Terminal::startShell(const QString &workingDirectory) {
 
   if (m_restartTimer && m_restartTimer->isActive()) {
@@ -903,6 +1090,10 @@ bool Terminal::startShell(const QString &workingDirectory) {
     m_process = nullptr;
   }
 
+#ifndef Q_OS_WIN
+  showPtyScreen();
+#endif
+
   if (!workingDirectory.isEmpty()) {
     m_workingDirectory = workingDirectory;
   }
@@ -931,6 +1122,7 @@ bool Terminal::startShell(const QString &workingDirectory) {
     connect(m_shellPty, &TerminalPty::errorOccurred, this,
             &Terminal::onPtyError);
   }
+  m_ptyDecoder.resetState();
 
   QMap<QString, QString> ptyEnv = m_shellProfile.environment;
   ptyEnv.insert("TERM", "ansi");
@@ -1020,9 +1212,12 @@ void Terminal::stopShell() {
       m_shellStopRequested = true;
       m_shellPty->stop();
       m_shellStopRequested = false;
+      m_shellPty->read(-1);
     }
 #endif
     m_pendingAnsiText.clear();
+    hidePtyScreen();
+    leaveAlternateScreen();
     ui->textEdit->setReadOnly(false);
     ui->textEdit->setTextInteractionFlags(Qt::TextEditorInteraction);
     return;
@@ -1133,9 +1328,18 @@ void Terminal::setWorkingDirectory(const QString &directory) {
 }
 
 void Terminal::clear() {
+  if (m_ptyScreenActive) {
+    m_gridView->clearSelection();
+    m_gridView->scrollToBottom();
+    feedPtyScreen(QStringLiteral("\x1b[H\x1b[2J\x1b[3J"));
+    if (isPtyShellActive()) {
+      writeToShell(QByteArray(1, '\x0c'));
+    }
+    return;
+  }
+
+  leaveAlternateScreen();
   ui->textEdit->clear();
-  m_alternateScreenActive = false;
-  m_savedPrimaryScreenText.clear();
   m_pendingAnsiText.clear();
   resetAnsiState();
   m_inputStartPosition = 0;
@@ -1634,17 +1838,31 @@ void Terminal::onProcessFinished(int exitCode,
 }
 
 #ifndef Q_OS_WIN
-void Terminal::onPtyReadyRead(const QByteArray &data) {
-  QString output = QString::fromLocal8Bit(data);
-  appendOutput(output);
+void Terminal::onPtyReadyRead() { flushPtyOutput(); }
+
+void Terminal::flushPtyOutput() {
+  if (!m_shellPty) {
+    return;
+  }
+  const QByteArray data = m_shellPty->read(-1);
+  if (!data.isEmpty()) {
+    feedPtyScreen(m_ptyDecoder.decode(data));
+  }
 }
 
 void Terminal::onPtyFinished(int exitCode, bool crashed) {
   m_processRunning = false;
   if (m_shellStopRequested) {
+    leaveAlternateScreen();
     emit shellFinished(exitCode);
     return;
   }
+  flushPtyOutput();
+  if (m_gridScreen->isAlternateScreen()) {
+    m_gridScreen->setAlternateScreen(false);
+    m_gridScreen->takeScreenSwitch();
+  }
+  leaveAlternateScreen();
   if (crashed) {
     appendOutput(QString("\nShell crashed (exit code: %1)\n").arg(exitCode),
                  true);
@@ -1672,6 +1890,31 @@ void Terminal::onInputSubmitted() {
 }
 
 bool Terminal::eventFilter(QObject *obj, QEvent *event) {
+  if (m_gridView && obj == m_gridView) {
+    if (event->type() == QEvent::KeyPress && isPtyShellActive()) {
+      return handlePtyKeyPress(static_cast<QKeyEvent *>(event));
+    }
+    if (event->type() == QEvent::MouseButtonPress) {
+      QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+      if (mouseEvent->button() == Qt::LeftButton &&
+          (mouseEvent->modifiers() & Qt::ControlModifier)) {
+        const QPoint cell =
+            m_gridView->cellAt(mouseEvent->position().toPoint());
+        const QString link =
+            linkInLine(m_gridView->lineText(cell.y()), cell.x());
+        if (!link.isEmpty()) {
+          onLinkActivated(link);
+          return true;
+        }
+      }
+    }
+    if (event->type() == QEvent::Resize &&
+        (m_alternateScreenActive || m_ptyScreenActive)) {
+      updatePtySize();
+    }
+    return QWidget::eventFilter(obj, event);
+  }
+
   const bool terminalTextObject =
       obj == ui->textEdit || obj == ui->textEdit->viewport();
 
@@ -1854,6 +2097,21 @@ void Terminal::appendOutput(const QString &text, bool isError) {
     return;
   }
 
+  if (m_ptyScreenActive) {
+    QString output = isError ? stripAnsiEscapeCodes(text) : text;
+    output.replace(QLatin1Char('\n'), QStringLiteral("\r\n"));
+    if (isError) {
+      const QColor color(m_errorColor);
+      output = QString("\x1b[38;2;%1;%2;%3m%4\x1b[0m")
+                   .arg(color.red())
+                   .arg(color.green())
+                   .arg(color.blue())
+                   .arg(output);
+    }
+    feedPtyScreen(output);
+    return;
+  }
+
   QString output = text;
   if (!isError) {
     if (!m_pendingAnsiText.isEmpty()) {
@@ -1868,37 +2126,47 @@ void Terminal::appendOutput(const QString &text, bool isError) {
     }
   }
 
-  if (output.isEmpty()) {
-    return;
+  if (isError) {
+    leaveAlternateScreen();
   }
 
-  QTextCursor cursor(ui->textEdit->document());
-  cursor.movePosition(QTextCursor::End);
+  while (!output.isEmpty()) {
+    if (m_alternateScreenActive) {
+      output.remove(0, feedAlternateScreen(output));
+      continue;
+    }
 
-  if (isError) {
-    m_ansiChunkUsedScreenOps = false;
+    QTextCursor cursor(ui->textEdit->document());
+    cursor.movePosition(QTextCursor::End);
 
-    QString cleanText = stripAnsiEscapeCodes(output);
-    if (cleanText.isEmpty()) {
-      return;
+    int consumed = output.size();
+    if (isError) {
+      m_ansiChunkUsedScreenOps = false;
+
+      QString cleanText = stripAnsiEscapeCodes(output);
+      if (cleanText.isEmpty()) {
+        return;
+      }
+      QTextCharFormat errorFormat;
+      errorFormat.setForeground(QColor(m_errorColor));
+      cursor.insertText(cleanText, errorFormat);
+      syncAnsiCursor(cursor);
+    } else {
+      cursor = ansiCursor(false);
+      consumed = appendAnsiText(output, cursor);
     }
-    QTextCharFormat errorFormat;
-    errorFormat.setForeground(QColor(m_errorColor));
-    cursor.insertText(cleanText, errorFormat);
-    syncAnsiCursor(cursor);
-  } else {
-    cursor = ansiCursor(false);
-    appendAnsiText(output, cursor);
-  }
 
-  ui->textEdit->setTextCursor(cursor);
-  scrollToBottom();
+    ui->textEdit->setTextCursor(cursor);
+    scrollToBottom();
 
-  enforceScrollbackLimit();
+    enforceScrollbackLimit();
 
-  QTextCursor endCursor(ui->textEdit->document());
-  endCursor.movePosition(QTextCursor::End);
-  m_inputStartPosition = endCursor.position();
+    QTextCursor endCursor(ui->textEdit->document());
+    endCursor.movePosition(QTextCursor::End);
+    m_inputStartPosition = endCursor.position();
+
+    output.remove(0, consumed);
+  }
 }
 
 void Terminal::appendPrompt() {
@@ -2024,9 +2292,8 @@ QStringList Terminal::getShellArguments() const {
 void Terminal::scrollToBottom() {
   QScrollBar *vScrollBar = ui->textEdit->verticalScrollBar();
   const bool screenLikeChunk =
-      m_alternateScreenActive ||
-      (m_ansiChunkUsedScreenOps &&
-       ui->textEdit->document()->blockCount() <= m_terminalRows);
+      m_ansiChunkUsedScreenOps &&
+      ui->textEdit->document()->blockCount() <= m_terminalRows;
   vScrollBar->setValue(screenLikeChunk ? vScrollBar->minimum()
                                        : vScrollBar->maximum());
 }
@@ -2257,6 +2524,9 @@ void Terminal::updateStyleSheet() {
   ui->textEdit->setVisualTheme(bg, fg, accent, selection, border, glow,
                                td.ui.scanlineEffect,
                                ThemeEngine::instance().glowIntensity());
+  m_gridView->setColors(bg, fg, accent);
+  m_gridView->setSelectionColor(selection);
+  m_gridView->setAnsiPalette(ansiPalette());
 
   QString styleSheet =
       QString("QPlainTextEdit {"
@@ -2471,12 +2741,28 @@ void Terminal::sendText(const QString &text, bool appendNewline) {
 }
 
 void Terminal::setScrollbackLines(int lines) {
-  m_scrollbackLines = lines;
+  m_scrollbackLines = qMax(0, lines);
+  if (m_gridScreen) {
+    m_gridScreen->setScrollbackCapacity(m_scrollbackLines > 0
+                                            ? m_scrollbackLines
+                                            : TERMINAL_MAX_SCROLLBACK_LINES);
+  }
   enforceScrollbackLimit();
 }
 
 int Terminal::scrollbackLines() const { return m_scrollbackLines; }
 
+void Terminal::setScrollbackMemoryLimit(int megabytes) {
+  m_scrollbackMegabytes = qMax(0, megabytes);
+  if (m_gridScreen) {
+    m_gridScreen->setScrollbackMemoryBudget(
+        static_cast<qint64>(m_scrollbackMegabytes) * 1024 * 1024);
+  }
+  enforceScrollbackLimit();
+}
+
+int Terminal::scrollbackMemoryLimit() const { return m_scrollbackMegabytes; }
+
 void Terminal::setLinkDetectionEnabled(bool enabled) {
   m_linkDetectionEnabled = enabled;
 }
@@ -2528,6 +2814,13 @@ QString Terminal::getLinkAtPosition(const QPoint &pos) {
   QString lineText = cursor.selectedText();
 
   int posInLine = ui->textEdit->cursorForPosition(pos).positionInBlock();
+  return linkInLine(lineText, posInLine);
+}
+
+QString Terminal::linkInLine(const QString &lineText, int posInLine) const {
+  if (!m_linkDetectionEnabled) {
+    return QString();
+  }
 
   QRegularExpressionMatchIterator urlMatches = m_urlRegex.globalMatch(lineText);
   while (urlMatches.hasNext()) {
@@ -2616,7 +2909,7 @@ QString Terminal::formatPythonBanner(const PythonEnvironmentInfo &info) const {
   return banner;
 }
 
-void Terminal::appendAnsiText(const QString &text, QTextCursor &cursor) {
+int Terminal::appendAnsiText(const QString &text, QTextCursor &cursor) {
   m_ansiChunkUsedScreenOps = false;
 
   auto parseParam = [](const QString &value, int defaultValue) {
@@ -2920,14 +3213,12 @@ void Terminal::appendAnsiText(const QString &text, QTextCursor &cursor) {
           m_ansiChunkUsedScreenOps = true;
         } else if (final == 'h' || final == 'l') {
           const bool enable = final == 'h';
-          if (params == "?1049" || params == "?1047" || params == "?47") {
-            if (enable) {
-              enterAlternateScreen();
-            } else {
-              leaveAlternateScreen();
-            }
-            cursor = ansiCursor(false);
+          if (enable &&
+              (params == "?1049" || params == "?1047" || params == "?47")) {
             m_ansiChunkUsedScreenOps = true;
+            cursor = ansiCursor(false);
+            enterAlternateScreen();
+            return j + 1;
           }
         }
         i = j;
@@ -3042,6 +3333,7 @@ void Terminal::appendAnsiText(const QString &text, QTextCursor &cursor) {
 
   syncCursorFromState(true);
   syncAnsiCursor(cursor);
+  return text.length();
 }
 
 void Terminal::setupContextMenu() {
@@ -3049,20 +3341,23 @@ void Terminal::setupContextMenu() {
 
   m_copyAction = m_contextMenu->addAction(tr("Copy"));
   m_copyAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_C));
-  connect(m_copyAction, &QAction::triggered, this,
-          [this]() { ui->textEdit->copy(); });
+  connect(m_copyAction, &QAction::triggered, this, &Terminal::copySelection);
 
   QAction *pasteAction = m_contextMenu->addAction(tr("Paste"));
   pasteAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_V));
-  connect(pasteAction, &QAction::triggered, this,
-          [this]() { insertInputText(QApplication::clipboard()->text()); });
+  connect(pasteAction, &QAction::triggered, this, &Terminal::pasteClipboard);
 
   m_contextMenu->addSeparator();
 
   QAction *selectAllAction = m_contextMenu->addAction(tr("Select All"));
   selectAllAction->setShortcut(QKeySequence::SelectAll);
-  connect(selectAllAction, &QAction::triggered, this,
-          [this]() { ui->textEdit->selectAll(); });
+  connect(selectAllAction, &QAction::triggered, this, [this]() {
+    if (m_ptyScreenActive || m_alternateScreenActive) {
+      m_gridView->selectAll();
+    } else {
+      ui->textEdit->selectAll();
+    }
+  });
 
   m_contextMenu->addSeparator();
 
@@ -3075,12 +3370,21 @@ void Terminal::setupContextMenu() {
   QAction *clearAction = m_contextMenu->addAction(tr("Clear"));
   connect(clearAction, &QAction::triggered, this, &Terminal::clear);
 
+  auto showContextMenu = [this](QWidget *source, const QPoint &pos) {
+    m_copyAction->setEnabled(hasTerminalSelection());
+    m_stopAction->setEnabled(canInterruptActiveProcess());
+    m_contextMenu->exec(source->mapToGlobal(pos));
+  };
+
   ui->textEdit->setContextMenuPolicy(Qt::CustomContextMenu);
   connect(ui->textEdit, &QPlainTextEdit::customContextMenuRequested, this,
-          [this](const QPoint &pos) {
-            m_copyAction->setEnabled(ui->textEdit->textCursor().hasSelection());
-            m_stopAction->setEnabled(canInterruptActiveProcess());
-            m_contextMenu->exec(ui->textEdit->mapToGlobal(pos));
+          [this, showContextMenu](const QPoint &pos) {
+            showContextMenu(ui->textEdit, pos);
+          });
+  m_gridView->setContextMenuPolicy(Qt::CustomContextMenu);
+  connect(m_gridView, &QWidget::customContextMenuRequested, this,
+          [this, showContextMenu](const QPoint &pos) {
+            showContextMenu(m_gridView, pos);
           });
 }
 
@@ -3090,6 +3394,7 @@ void Terminal::zoomIn() {
   if (newSize <= kMaxFontSize) {
     font.setPointSize(newSize);
     ui->textEdit->setFont(font);
+    m_gridView->setFont(font);
     m_baseFontSize = newSize;
     emit fontSizeChanged(newSize);
   }
@@ -3101,6 +3406,7 @@ void Terminal::zoomOut() {
   if (newSize >= kMinFontSize) {
     font.setPointSize(newSize);
     ui->textEdit->setFont(font);
+    m_gridView->setFont(font);
     m_baseFontSize = newSize;
     emit fontSizeChanged(newSize);
   }
@@ -3110,6 +3416,7 @@ void Terminal::zoomReset() {
   QFont font = ui->textEdit->font();
   font.setPointSize(kDefaultFontSize);
   ui->textEdit->setFont(font);
+  m_gridView->setFont(font);
   m_baseFontSize = kDefaultFontSize;
   emit fontSizeChanged(kDefaultFontSize);
 }
@@ -3117,28 +3424,41 @@ void Terminal::zoomReset() {
 int Terminal::currentFontSize() const { return m_baseFontSize; }
 
 void Terminal::enforceScrollbackLimit() {
-  if (m_scrollbackLines <= 0) {
+  QTextDocument *doc = ui->textEdit->document();
+  const int excessLines =
+      m_scrollbackLines > 0 ? doc->blockCount() - m_scrollbackLines : 0;
+  const qint64 budgetCharacters =
+      static_cast<qint64>(m_scrollbackMegabytes) * 1024 * 1024 /
+      static_cast<qint64>(sizeof(QChar));
+  const qint64 excessCharacters =
+      m_scrollbackMegabytes > 0 ? doc->characterCount() - budgetCharacters
+                                : 0;
+  if (excessLines <= 0 && excessCharacters <= 0) {
     return;
   }
 
-  QTextDocument *doc = ui->textEdit->document();
-  int blockCount = doc->blockCount();
-
-  if (blockCount > m_scrollbackLines) {
-    QTextCursor cursor(doc);
-    cursor.movePosition(QTextCursor::Start);
-
-    int linesToRemove = blockCount - m_scrollbackLines;
-    for (int i = 0; i < linesToRemove; ++i) {
-      cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor);
+  int removedLength = 0;
+  int linesToRemove = 0;
+  const QTextBlock last = doc->lastBlock();
+  for (QTextBlock block = doc->firstBlock(); block.isValid() && block != last;
+       block = block.next()) {
+    if (linesToRemove >= excessLines && removedLength >= excessCharacters) {
+      break;
     }
-    int removedLength = cursor.selectedText().length();
-    cursor.removeSelectedText();
-
-    m_inputStartPosition = qMax(0, m_inputStartPosition - removedLength);
-    m_ansiRow = qMax(0, m_ansiRow - linesToRemove);
-    m_savedAnsiRow = qMax(0, m_savedAnsiRow - linesToRemove);
+    removedLength += block.length();
+    ++linesToRemove;
+  }
+  if (removedLength <= 0) {
+    return;
   }
+
+  QTextCursor cursor(doc);
+  cursor.setPosition(removedLength, QTextCursor::KeepAnchor);
+  cursor.removeSelectedText();
+
+  m_inputStartPosition = qMax(0, m_inputStartPosition - removedLength);
+  m_ansiRow = qMax(0, m_ansiRow - linesToRemove);
+  m_savedAnsiRow = qMax(0, m_savedAnsiRow - linesToRemove);
 }
 
 QString Terminal::stripAnsiEscapeCodes(const QString &text) {
@@ -7,14 +7,19 @@
 #include <QMenu>
 #include <QProcess>
 #include <QRegularExpression>
+#include <QStringDecoder>
 #include <QStringList>
 #include <QTextCharFormat>
 #include <QTimer>
 #include <QWidget>
+#include <memory>
 
 class QLabel;
 class QAction;
 class QTextCursor;
+class TerminalParser;
+class TerminalScreen;
+class TerminalScreenView;
 #ifndef Q_OS_WIN
 class TerminalPty;
 #endif
@@ -82,6 +87,10 @@ public:
 
   int scrollbackLines() const;
 
+  void setScrollbackMemoryLimit(int megabytes);
+
+  int scrollbackMemoryLimit() const;
+
   void setLinkDetectionEnabled(bool enabled);
 
   bool isLinkDetectionEnabled() const;
@@ -123,7 +132,7 @@ private slots:
   void onInputSubmitted();
   void onLinkActivated(const QString &link);
 #ifndef Q_OS_WIN
-  void onPtyReadyRead(const QByteArray &data);
+  void onPtyReadyRead();
   void onPtyFinished(int exitCode, bool crashed);
   void onPtyError(const QString &message);
 #endif
@@ -156,6 +165,11 @@ private:
   bool handlePtyKeyPress(QKeyEvent *keyEvent);
   bool isPtyShellActive() const;
   void writeToShell(const QByteArray &data);
+#ifndef Q_OS_WIN
+  void flushPtyOutput();
+#endif
+  void scheduleScreenRepaint();
+  void repaintScreen();
   void updatePtySize();
   void handleRunInputHistoryNavigation(bool up);
   QColor ansi256Color(int index) const;
@@ -169,6 +183,7 @@ private:
   void removeInputText(bool backwards);
   QString takePendingInput();
   QString getLinkAtPosition(const QPoint &pos);
+  QString linkInLine(const QString &lineText, int position) const;
   void resetAnsiState();
   QTextCharFormat currentAnsiFormat() const;
   void ensureAnsiLineExists(int row);
@@ -177,15 +192,27 @@ private:
   void syncAnsiCursorToDocumentEnd();
   void enterAlternateScreen();
   void leaveAlternateScreen();
+  int feedAlternateScreen(const QString &text);
+  void showPtyScreen();
+  void hidePtyScreen();
+  void feedPtyScreen(const QString &text);
+  bool hasTerminalSelection() const;
+  void copySelection();
+  void pasteClipboard();
+  QVector<QColor> ansiPalette() const;
   bool hasProtectedInputSurface() const;
   static QString stripAnsiEscapeCodes(const QString &text);
-  void appendAnsiText(const QString &text, QTextCursor &cursor);
+  int appendAnsiText(const QString &text, QTextCursor &cursor);
 
   Ui::Terminal *ui;
   QProcess *m_process;
 #ifndef Q_OS_WIN
   TerminalPty *m_shellPty;
+  QStringDecoder m_ptyDecoder;
 #endif
+  QTimer *m_repaintTimer;
+  QElapsedTimer m_repaintClock;
+  static const int kRepaintIntervalMs = 16;
   QProcess *m_runProcess;
   QTimer *m_restartTimer;
   QString m_workingDirectory;
@@ -208,7 +235,7 @@ private:
   ShellProfile m_shellProfile;
 
   int m_scrollbackLines;
-  static const int kDefaultScrollbackLines = 10000;
+  int m_scrollbackMegabytes;
 
   bool m_linkDetectionEnabled;
   QRegularExpression m_urlRegex;
@@ -229,13 +256,13 @@ private:
   bool m_ansiOverwriteMode;
   bool m_ansiChunkUsedScreenOps;
   bool m_alternateScreenActive;
+  bool m_ptyScreenActive;
   int m_terminalColumns;
   int m_terminalRows;
-  QString m_savedPrimaryScreenText;
   QString m_pendingAnsiText;
-  int m_savedPrimaryInputStartPosition;
-  int m_savedPrimaryAnsiRow;
-  int m_savedPrimaryAnsiColumn;
+  std::unique_ptr<TerminalScreen> m_gridScreen;
+  std::unique_ptr<TerminalParser> m_gridParser;
+  TerminalScreenView *m_gridView;
 
   int m_baseFontSize;
   static const int kMinFontSize = 6;
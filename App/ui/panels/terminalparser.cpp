@@ -0,0 +1,409 @@
+#include "terminalparser.h"
+#include "terminalscreen.h"
+
+TerminalParser::TerminalParser(TerminalScreen *screen)
+    : m_screen(screen), m_state(State::Ground), m_paramCount(0),
+      m_privateMarker(0), m_intermediate(0), m_highSurrogate(0),
+      m_stringEscape(false) {}
+
+void TerminalParser::reset() {
+  m_state = State::Ground;
+  m_paramCount = 0;
+  m_privateMarker = 0;
+  m_intermediate = 0;
+  m_highSurrogate = 0;
+  m_stringEscape = false;
+  m_osc.clear();
+}
+
+void TerminalParser::beginSequence(State state) {
+  m_state = state;
+  m_paramCount = 0;
+  m_privateMarker = 0;
+  m_intermediate = 0;
+  m_stringEscape = false;
+}
+
+int TerminalParser::feed(QStringView text) {
+  const int length = text.size();
+  for (int i = 0; i < length; ++i) {
+    const char16_t ch = text[i].unicode();
+
+    if (m_stringEscape) {
+      m_stringEscape = false;
+      if (ch == u'\\') {
+        if (m_state == State::OscString) {
+          oscDispatch();
+        }
+        m_state = State::Ground;
+        continue;
+      }
+      beginSequence(State::Escape);
+    }
+
+    if (ch == 0x1b) {
+      if (m_state == State::OscString || m_state == State::IgnoredString) {
+        m_stringEscape = true;
+      } else {
+        beginSequence(State::Escape);
+      }
+      continue;
+    }
+
+    if (ch == 0x18 || ch == 0x1a) {
+      m_state = State::Ground;
+      continue;
+    }
+
+    switch (m_state) {
+    case State::Ground:
+      if (ch < 0x20) {
+        execute(ch);
+      } else if (ch != 0x7f) {
+        print(ch);
+      }
+      break;
+
+    case State::Escape:
+      if (ch < 0x20) {
+        execute(ch);
+      } else if (ch == u'[') {
+        m_state = State::CsiEntry;
+      } else if (ch == u']') {
+        m_osc.clear();
+        m_state = State::OscString;
+      } else if (ch == u'P' || ch == u'X' || ch == u'^' || ch == u'_') {
+        m_state = State::IgnoredString;
+      } else if (ch <= 0x2f) {
+        m_intermediate = ch;
+        m_state = State::EscapeIntermediate;
+      } else {
+        m_state = State::Ground;
+        escDispatch(ch);
+      }
+      break;
+
+    case State::EscapeIntermediate:
+      if (ch < 0x20) {
+        execute(ch);
+      } else if (ch <= 0x2f) {
+        m_intermediate = ch;
+      } else {
+        m_state = State::Ground;
+        escDispatch(ch);
+      }
+      break;
+
+    case State::CsiEntry:
+    case State::CsiParam:
+      if (ch < 0x20) {
+        execute(ch);
+      } else if (ch >= u'0' && ch <= u'9') {
+        collectDigit(ch);
+        m_state = State::CsiParam;
+      } else if (ch == u';' || ch == u':') {
+        collectSeparator();
+        m_state = State::CsiParam;
+      } else if (ch >= 0x3c && ch <= 0x3f) {
+        if (m_state == State::CsiEntry) {
+          m_privateMarker = ch;
+          m_state = State::CsiParam;
+        } else {
+          m_state = State::CsiIgnore;
+        }
+      } else if (ch <= 0x2f) {
+        m_intermediate = ch;
+        m_state = State::CsiIntermediate;
+      } else if (ch >= 0x40 && ch <= 0x7e) {
+        m_state = State::Ground;
+        csiDispatch(ch);
+      } else {
+        m_state = State::CsiIgnore;
+      }
+      break;
+
+    case State::CsiIntermediate:
+      if (ch < 0x20) {
+        execute(ch);
+      } else if (ch <= 0x2f) {
+        m_intermediate = ch;
+      } else if (ch >= 0x40 && ch <= 0x7e) {
+        m_state = State::Ground;
+        csiDispatch(ch);
+      } else {
+        m_state = State::CsiIgnore;
+      }
+      break;
+
+    case State::CsiIgnore:
+      if (ch < 0x20) {
+        execute(ch);
+      } else if (ch >= 0x40 && ch <= 0x7e) {
+        m_state = State::Ground;
+      }
+      break;
+
+    case State::OscString:
+      if (ch == 0x07) {
+        oscDispatch();
+        m_state = State::Ground;
+      } else if (ch >= 0x20 && m_osc.size() < TERMINAL_PARSER_MAX_OSC_LENGTH) {
+        m_osc.append(QChar(ch));
+      }
+      break;
+
+    case State::IgnoredString:
+      if (ch == 0x07) {
+        m_state = State::Ground;
+      }
+      break;
+    }
+
+    if (m_screen->takeScreenSwitch()) {
+      return i + 1;
+    }
+  }
+
+  return length;
+}
+
+void TerminalParser::print(char16_t ch) {
+  if (QChar::isHighSurrogate(ch)) {
+    m_highSurrogate = ch;
+    return;
+  }
+
+  if (QChar::isLowSurrogate(ch)) {
+    if (m_highSurrogate) {
+      m_screen->print(QChar::surrogateToUcs4(m_highSurrogate, ch));
+    }
+    m_highSurrogate = 0;
+    return;
+  }
+
+  m_highSurrogate = 0;
+  m_screen->print(ch);
+}
+
+void TerminalParser::execute(char16_t ch) {
+  switch (ch) {
+  case 0x08:
+    m_screen->backspace();
+    break;
+  case 0x09:
+    m_screen->horizontalTab();
+    break;
+  case 0x0a:
+  case 0x0b:
+  case 0x0c:
+    m_screen->lineFeed();
+    break;
+  case 0x0d:
+    m_screen->carriageReturn();
+    break;
+  default:
+    break;
+  }
+}
+
+void TerminalParser::escDispatch(char16_t final) {
+  if (m_intermediate) {
+    return;
+  }
+
+  switch (final) {
+  case u'7':
+    m_screen->saveCursor();
+    break;
+  case u'8':
+    m_screen->restoreCursor();
+    break;
+  case u'D':
+    m_screen->index();
+    break;
+  case u'E':
+    m_screen->nextLine();
+    break;
+  case u'H':
+    m_screen->setTabStop();
+    break;
+  case u'M':
+    m_screen->reverseIndex();
+    break;
+  case u'c':
+    m_screen->reset();
+    break;
+  default:
+    break;
+  }
+}
+
+void TerminalParser::collectDigit(char16_t ch) {
+  if (m_paramCount == 0) {
+    m_params[0] = -1;
+    m_paramCount = 1;
+  }
+
+  int &value = m_params[m_paramCount - 1];
+  value = qMin(TERMINAL_PARSER_MAX_PARAM_VALUE,
+               qMax(0, value) * 10 + (ch - u'0'));
+}
+
+void TerminalParser::collectSeparator() {
+  if (m_paramCount == 0) {
+    m_params[0] = -1;
+    m_paramCount = 1;
+  }
+  if (m_paramCount < TERMINAL_PARSER_MAX_PARAMS) {
+    m_params[m_paramCount++] = -1;
+  }
+}
+
+int TerminalParser::param(int index, int defaultValue) const {
+  if (index >= m_paramCount || m_params[index] < 0) {
+    return defaultValue;
+  }
+  return m_params[index];
+}
+
+int TerminalParser::countParam(int index) const {
+  return qMax(1, param(index, 1));
+}
+
+void TerminalParser::csiDispatch(char16_t final) {
+  if (m_privateMarker == u'?') {
+    if (final == u'h' || final == u'l') {
+      for (int i = 0; i < m_paramCount; ++i) {
+        m_screen->setMode(param(i, 0), true, final == u'h');
+      }
+    }
+    return;
+  }
+
+  if (m_privateMarker || m_intermediate) {
+    return;
+  }
+
+  switch (final) {
+  case u'A':
+    m_screen->cursorUp(countParam(0));
+    break;
+  case u'B':
+  case u'e':
+    m_screen->cursorDown(countParam(0));
+    break;
+  case u'C':
+  case u'a':
+    m_screen->cursorForward(countParam(0));
+    break;
+  case u'D':
+    m_screen->cursorBackward(countParam(0));
+    break;
+  case u'E':
+    m_screen->cursorDown(countParam(0));
+    m_screen->carriageReturn();
+    break;
+  case u'F':
+    m_screen->cursorUp(countParam(0));
+    m_screen->carriageReturn();
+    break;
+  case u'G':
+  case u'`':
+    m_screen->setCursorColumn(countParam(0) - 1);
+    break;
+  case u'H':
+  case u'f':
+    m_screen->setCursorPosition(countParam(0) - 1, countParam(1) - 1);
+    break;
+  case u'd':
+    m_screen->setCursorRow(countParam(0) - 1);
+    break;
+  case u'I':
+    m_screen->horizontalTab(countParam(0));
+    break;
+  case u'Z':
+    m_screen->backwardTab(countParam(0));
+    break;
+  case u'J':
+    m_screen->eraseInDisplay(param(0, 0));
+    break;
+  case u'K':
+    m_screen->eraseInLine(param(0, 0));
+    break;
+  case u'L':
+    m_screen->insertLines(countParam(0));
+    break;
+  case u'M':
+    m_screen->deleteLines(countParam(0));
+    break;
+  case u'P':
+    m_screen->deleteCharacters(countParam(0));
+    break;
+  case u'X':
+    m_screen->eraseCharacters(countParam(0));
+    break;
+  case u'@':
+    m_screen->insertCharacters(countParam(0));
+    break;
+  case u'S':
+    m_screen->scrollUp(countParam(0));
+    break;
+  case u'T':
+    m_screen->scrollDown(countParam(0));
+    break;
+  case u'b':
+    m_screen->repeatLastCharacter(countParam(0));
+    break;
+  case u'g':
+    m_screen->clearTabStop(param(0, 0));
+    break;
+  case u'h':
+  case u'l':
+    for (int i = 0; i < m_paramCount; ++i) {
+      m_screen->setMode(param(i, 0), false, final == u'h');
+    }
+    break;
+  case u'm':
+    m_screen->selectGraphicRendition(m_params, m_paramCount);
+    break;
+  case u'r':
+    m_screen->setScrollRegion(countParam(0) - 1, param(1, 0) - 1);
+    break;
+  case u's':
+    m_screen->saveCursor();
+    break;
+  case u'u':
+    m_screen->restoreCursor();
+    break;
+  case u'n':
+    if (param(0, 0) == 5) {
+      m_screen->queueResponse("\x1b[0n");
+    } else if (param(0, 0) == 6) {
+      m_screen->queueResponse(QByteArray("\x1b[") +
+                              QByteArray::number(m_screen->cursorRow() + 1) +
+                              ';' +
+                              QByteArray::number(m_screen->cursorColumn() + 1) +
+                              'R');
+    }
+    break;
+  case u'c':
+    if (param(0, 0) == 0) {
+      m_screen->queueResponse("\x1b[?1;2c");
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void TerminalParser::oscDispatch() {
+  const int separator = m_osc.indexOf(u';');
+  if (separator <= 0) {
+    return;
+  }
+
+  const QStringView command = QStringView(m_osc).left(separator);
+  if (command == u"0" || command == u"2") {
+    m_screen->setTitle(m_osc.mid(separator + 1));
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef TERMINALPARSER_H
+#define TERMINALPARSER_H
+
+#include <QString>
+#include <QStringView>
+
+class TerminalScreen;
+
+constexpr int TERMINAL_PARSER_MAX_PARAMS = 32;
+constexpr int TERMINAL_PARSER_MAX_PARAM_VALUE = 65535;
+constexpr int TERMINAL_PARSER_MAX_OSC_LENGTH = 4096;
+
+class TerminalParser {
+public:
+  explicit TerminalParser(TerminalScreen *screen);
+
+  int feed(QStringView text);
+  void reset();
+  bool isGround() const { return m_state == State::Ground; }
+
+private:
+  enum class State {
+    Ground,
+    Escape,
+    EscapeIntermediate,
+    CsiEntry,
+    CsiParam,
+    CsiIntermediate,
+    CsiIgnore,
+    OscString,
+    IgnoredString,
+  };
+
+  void execute(char16_t ch);
+  void print(char16_t ch);
+  void escDispatch(char16_t final);
+  void csiDispatch(char16_t final);
+  void oscDispatch();
+  void beginSequence(State state);
+  void collectDigit(char16_t ch);
+  void collectSeparator();
+  int param(int index, int defaultValue) const;
+  int countParam(int index) const;
+
+  TerminalScreen *m_screen;
+  State m_state;
+  int m_params[TERMINAL_PARSER_MAX_PARAMS];
+  int m_paramCount;
+  char16_t m_privateMarker;
+  char16_t m_intermediate;
+  char16_t m_highSurrogate;
+  bool m_stringEscape;
+  QString m_osc;
+};
+
+#endif
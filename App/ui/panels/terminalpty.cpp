@@ -3,11 +3,15 @@
 #ifndef Q_OS_WIN
 
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QProcessEnvironment>
-#include <QSocketNotifier>
+#include <QThread>
 #include <QTimer>
 #include <QVector>
 
+#include <atomic>
+
 #if defined(Q_OS_MACOS)
 #include <util.h>
 #else
@@ -16,6 +20,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
@@ -23,19 +28,175 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+class TerminalPtyReader : public QThread {
+public:
+  TerminalPtyReader(int masterFd, QObject *receiver)
+      : m_masterFd(masterFd), m_receiver(receiver), m_paused(false),
+        m_stopRequested(false) {
+    m_wakeFds[0] = -1;
+    m_wakeFds[1] = -1;
+    if (::pipe(m_wakeFds) == 0) {
+      for (int fd : m_wakeFds) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+      }
+    }
+  }
+
+  ~TerminalPtyReader() override {
+    stopReading();
+    for (int fd : m_wakeFds) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+  }
+
+  void stopReading() {
+    m_stopRequested = true;
+    wake();
+    wait();
+  }
+
+  void drainRemaining() {
+    char buffer[TERMINAL_PTY_READ_CHUNK];
+    qint64 drained = 0;
+    ssize_t count = 0;
+    while (drained < TERMINAL_PTY_BUFFER_LIMIT &&
+           (count = ::read(m_masterFd, buffer, sizeof(buffer))) > 0) {
+      append(buffer, static_cast<int>(count));
+      drained += count;
+    }
+  }
+
+  qint64 bytesAvailable() const {
+    QMutexLocker locker(&m_mutex);
+    return m_buffer.size();
+  }
+
+  QByteArray take(qint64 maxBytes) {
+    QMutexLocker locker(&m_mutex);
+    QByteArray data;
+    if (maxBytes < 0 || maxBytes >= m_buffer.size()) {
+      data.swap(m_buffer);
+    } else {
+      data = m_buffer.left(maxBytes);
+      m_buffer.remove(0, maxBytes);
+    }
+    if (m_paused && m_buffer.size() <= TERMINAL_PTY_RESUME_THRESHOLD) {
+      m_paused = false;
+      wake();
+    }
+    return data;
+  }
+
+protected:
+  void run() override {
+    char buffer[TERMINAL_PTY_READ_CHUNK];
+    while (!m_stopRequested) {
+      bool paused = false;
+      {
+        QMutexLocker locker(&m_mutex);
+        if (m_buffer.size() >= TERMINAL_PTY_BUFFER_LIMIT) {
+          m_paused = true;
+        }
+        paused = m_paused;
+      }
+
+      pollfd fds[2];
+      fds[0].fd = m_wakeFds[0];
+      fds[0].events = POLLIN;
+      fds[0].revents = 0;
+      fds[1].fd = paused ? -1 : m_masterFd;
+      fds[1].events = POLLIN;
+      fds[1].revents = 0;
+      if (::poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+
+      if (fds[0].revents & POLLIN) {
+        char drain[64];
+        while (::read(m_wakeFds[0], drain, sizeof(drain)) > 0) {
+        }
+      }
+
+      if (paused || fds[1].revents == 0) {
+        continue;
+      }
+
+      ssize_t count = 0;
+      while ((count = ::read(m_masterFd, buffer, sizeof(buffer))) > 0) {
+        if (append(buffer, static_cast<int>(count)) >=
+            TERMINAL_PTY_BUFFER_LIMIT) {
+          break;
+        }
+      }
+      if (count > 0) {
+        continue;
+      }
+      if (count < 0 &&
+          (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        continue;
+      }
+      break;
+    }
+  }
+
+private:
+  qint64 append(const char *data, int count) {
+    bool wasEmpty = false;
+    qint64 buffered = 0;
+    {
+      QMutexLocker locker(&m_mutex);
+      wasEmpty = m_buffer.isEmpty();
+      m_buffer.append(data, count);
+      buffered = m_buffer.size();
+    }
+    if (wasEmpty) {
+      QMetaObject::invokeMethod(m_receiver, "notifyReadyRead",
+                                Qt::QueuedConnection);
+    }
+    return buffered;
+  }
+
+  void wake() {
+    if (m_wakeFds[1] >= 0) {
+      const char byte = 0;
+      ssize_t ignored = ::write(m_wakeFds[1], &byte, 1);
+      (void)ignored;
+    }
+  }
+
+  int m_masterFd;
+  int m_wakeFds[2];
+  QObject *m_receiver;
+  mutable QMutex m_mutex;
+  QByteArray m_buffer;
+  bool m_paused;
+  std::atomic<bool> m_stopRequested;
+};
+
 TerminalPty::TerminalPty(QObject *parent)
-    : QObject(parent), m_masterFd(-1), m_pid(-1), m_readNotifier(nullptr),
+    : QObject(parent), m_masterFd(-1), m_pid(-1), m_reader(nullptr),
       m_reapTimer(new QTimer(this)), m_running(false) {
   m_reapTimer->setInterval(80);
   connect(m_reapTimer, &QTimer::timeout, this, &TerminalPty::reapChild);
 }
 
-TerminalPty::~TerminalPty() { stop(); }
+TerminalPty::~TerminalPty() {
+  stop();
+  delete m_reader;
+}
 
 bool TerminalPty::start(const QString &program, const QStringList &arguments,
                         const QString &workingDirectory,
                         const QMap<QString, QString> &environment) {
   stop();
+  delete m_reader;
+  m_reader = nullptr;
 
   QByteArray programBytes = QFile::encodeName(program);
   QByteArray cwdBytes = QFile::encodeName(workingDirectory);
@@ -98,9 +259,8 @@ bool TerminalPty::start(const QString &program, const QStringList &arguments,
     ::fcntl(m_masterFd, F_SETFL, flags | O_NONBLOCK);
   }
 
-  m_readNotifier = new QSocketNotifier(m_masterFd, QSocketNotifier::Read, this);
-  connect(m_readNotifier, &QSocketNotifier::activated, this,
-          &TerminalPty::readAvailable);
+  m_reader = new TerminalPtyReader(m_masterFd, this);
+  m_reader->start();
   m_reapTimer->start();
   return true;
 }
@@ -141,6 +301,14 @@ bool TerminalPty::isRunning() const { return m_running; }
 
 qint64 TerminalPty::processId() const { return m_pid; }
 
+qint64 TerminalPty::bytesAvailable() const {
+  return m_reader ? m_reader->bytesAvailable() : 0;
+}
+
+QByteArray TerminalPty::read(qint64 maxBytes) {
+  return m_reader ? m_reader->take(maxBytes) : QByteArray();
+}
+
 qint64 TerminalPty::writeData(const QByteArray &data) {
   if (!m_running || m_masterFd < 0 || data.isEmpty()) {
     return -1;
@@ -177,29 +345,9 @@ void TerminalPty::resize(int columns, int rows) {
   }
 }
 
-void TerminalPty::readAvailable() {
-  if (m_masterFd < 0) {
-    return;
-  }
-
-  QByteArray data;
-  char buffer[8192];
-  while (true) {
-    ssize_t count = ::read(m_masterFd, buffer, sizeof(buffer));
-    if (count > 0) {
-      data.append(buffer, static_cast<int>(count));
-      continue;
-    }
-    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-      break;
-    }
-    if (count == 0 || (count < 0 && errno != EINTR)) {
-      break;
-    }
-  }
-
-  if (!data.isEmpty()) {
-    emit readyRead(data);
+void TerminalPty::notifyReadyRead() {
+  if (bytesAvailable() > 0) {
+    emit readyRead();
   }
 }
 
@@ -216,10 +364,11 @@ void TerminalPty::reapChild() {
 }
 
 void TerminalPty::closeMaster() {
-  if (m_readNotifier) {
-    m_readNotifier->setEnabled(false);
-    m_readNotifier->deleteLater();
-    m_readNotifier = nullptr;
+  if (m_reader) {
+    m_reader->stopReading();
+    if (m_masterFd >= 0) {
+      m_reader->drainRemaining();
+    }
   }
   if (m_masterFd >= 0) {
     ::close(m_masterFd);
@@ -1,6 +1,7 @@
 #ifndef TERMINALPTY_H
 #define TERMINALPTY_H
 
+#include <QByteArray>
 #include <QMap>
 #include <QObject>
 #include <QString>
@@ -8,8 +9,12 @@
 
 #ifndef Q_OS_WIN
 
-class QSocketNotifier;
 class QTimer;
+class TerminalPtyReader;
+
+constexpr qint64 TERMINAL_PTY_BUFFER_LIMIT = 1024 * 1024;
+constexpr qint64 TERMINAL_PTY_RESUME_THRESHOLD = TERMINAL_PTY_BUFFER_LIMIT / 2;
+constexpr int TERMINAL_PTY_READ_CHUNK = 16384;
 
 class TerminalPty : public QObject {
   Q_OBJECT
@@ -25,17 +30,19 @@ public:
   bool isRunning() const;
   qint64 processId() const;
 
+  qint64 bytesAvailable() const;
+  QByteArray read(qint64 maxBytes);
   qint64 writeData(const QByteArray &data);
   bool interruptProcessGroup();
   void resize(int columns, int rows);
 
 signals:
-  void readyRead(const QByteArray &data);
+  void readyRead();
   void finished(int exitCode, bool crashed);
   void errorOccurred(const QString &message);
 
 private slots:
-  void readAvailable();
+  void notifyReadyRead();
   void reapChild();
 
 private:
@@ -44,7 +51,7 @@ private:
 
   int m_masterFd;
   qint64 m_pid;
-  QSocketNotifier *m_readNotifier;
+  TerminalPtyReader *m_reader;
   QTimer *m_reapTimer;
   bool m_running;
 };
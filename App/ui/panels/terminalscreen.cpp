@@ -0,0 +1,893 @@
+#include "terminalscreen.h"
+
+#include <algorithm>
+#include <numeric>
+
+static void appendCodepoint(QString &text, char32_t codepoint) {
+  if (QChar::requiresSurrogates(codepoint)) {
+    text.append(QChar(QChar::highSurrogate(codepoint)));
+    text.append(QChar(QChar::lowSurrogate(codepoint)));
+  } else {
+    text.append(QChar(static_cast<char16_t>(codepoint)));
+  }
+}
+
+TerminalScrollbackRing::TerminalScrollbackRing(int capacity)
+    : m_start(0), m_count(0), m_pushCount(0), m_memoryBudget(0),
+      m_memoryUsage(0) {
+  m_lines.resize(qMax(0, capacity));
+}
+
+void TerminalScrollbackRing::setCapacity(int capacity) {
+  capacity = qMax(0, capacity);
+  if (capacity == m_lines.size()) {
+    return;
+  }
+
+  QVector<TerminalScrollbackLine> lines(capacity);
+  const int keep = qMin(m_count, capacity);
+  m_memoryUsage = 0;
+  for (int i = 0; i < keep; ++i) {
+    const int source = (m_start + m_count - keep + i) % m_lines.size();
+    lines[i] = std::move(m_lines[source]);
+    m_memoryUsage += footprint(lines[i]);
+  }
+
+  m_lines = std::move(lines);
+  m_start = 0;
+  m_count = keep;
+}
+
+void TerminalScrollbackRing::setMemoryBudget(qint64 bytes) {
+  m_memoryBudget = qMax<qint64>(0, bytes);
+  enforceMemoryBudget();
+}
+
+qint64 TerminalScrollbackRing::footprint(const TerminalScrollbackLine &line) {
+  return static_cast<qint64>(sizeof(TerminalScrollbackLine)) +
+         line.text.size() * static_cast<qint64>(sizeof(QChar)) +
+         line.runs.size() * static_cast<qint64>(sizeof(TerminalAttributeRun));
+}
+
+void TerminalScrollbackRing::push(TerminalScrollbackLine line) {
+  const int capacity = m_lines.size();
+  if (capacity == 0) {
+    return;
+  }
+
+  ++m_pushCount;
+  m_memoryUsage += footprint(line);
+  if (m_count < capacity) {
+    m_lines[(m_start + m_count) % capacity] = std::move(line);
+    ++m_count;
+  } else {
+    m_memoryUsage -= footprint(m_lines[m_start]);
+    m_lines[m_start] = std::move(line);
+    m_start = (m_start + 1) % capacity;
+  }
+  enforceMemoryBudget();
+}
+
+void TerminalScrollbackRing::dropOldest() {
+  m_memoryUsage -= footprint(m_lines[m_start]);
+  m_lines[m_start] = TerminalScrollbackLine();
+  m_start = (m_start + 1) % m_lines.size();
+  --m_count;
+}
+
+void TerminalScrollbackRing::enforceMemoryBudget() {
+  if (m_memoryBudget <= 0) {
+    return;
+  }
+  while (m_count > 1 && m_memoryUsage > m_memoryBudget) {
+    dropOldest();
+  }
+}
+
+const TerminalScrollbackLine &TerminalScrollbackRing::at(int index) const {
+  return m_lines.at((m_start + index) % m_lines.size());
+}
+
+void TerminalScrollbackRing::clear() {
+  m_lines = QVector<TerminalScrollbackLine>(m_lines.size());
+  m_start = 0;
+  m_count = 0;
+  m_memoryUsage = 0;
+}
+
+TerminalScreen::TerminalScreen(int columns, int rows)
+    : m_columns(qMax(1, columns)), m_rows(qMax(1, rows)),
+      m_active(&m_primary), m_cursorRow(0), m_cursorColumn(0),
+      m_wrapPending(false), m_cursorVisible(true), m_autoWrap(true),
+      m_originMode(false), m_insertMode(false),
+      m_applicationCursorKeys(false), m_bracketedPaste(false),
+      m_screenSwitched(false), m_scrollTop(0), m_scrollBottom(m_rows - 1),
+      m_lastPrinted(U' '), m_penIndex(0), m_blankIndex(0),
+      m_hasDamage(false) {
+  m_attributeTable.append(TerminalCellAttributes());
+  m_attributeLookup.insert(TerminalCellAttributes().key(), 0);
+
+  initBuffer(m_primary);
+  initBuffer(m_alternate);
+  resetTabStops();
+  m_damage = QBitArray(m_rows);
+  damageAll();
+}
+
+void TerminalScreen::initBuffer(Buffer &buffer) {
+  buffer.cells.fill(TerminalCell(), m_columns * m_rows);
+  buffer.rowMap.resize(m_rows);
+  std::iota(buffer.rowMap.begin(), buffer.rowMap.end(), 0);
+  buffer.wrapped.fill(false, m_rows);
+}
+
+void TerminalScreen::resetTabStops() {
+  m_tabStops.fill(false, m_columns);
+  for (int column = 0; column < m_columns; column += 8) {
+    m_tabStops[column] = true;
+  }
+}
+
+void TerminalScreen::resize(int columns, int rows) {
+  columns = qMax(1, columns);
+  rows = qMax(1, rows);
+  if (columns == m_columns && rows == m_rows) {
+    return;
+  }
+
+  const int dropTop = qMax(0, m_cursorRow - (rows - 1));
+  Buffer &inactive = isAlternateScreen() ? m_primary : m_alternate;
+  resizeBuffer(*m_active, columns, rows, dropTop);
+  resizeBuffer(inactive, columns, rows, 0);
+
+  m_columns = columns;
+  m_rows = rows;
+  m_cursorRow -= dropTop;
+  m_wrapPending = false;
+  m_scrollTop = 0;
+  m_scrollBottom = m_rows - 1;
+  resetTabStops();
+  clampCursor();
+
+  m_damage = QBitArray(m_rows);
+  damageAll();
+}
+
+void TerminalScreen::resizeBuffer(Buffer &buffer, int columns, int rows,
+                                  int dropTop) {
+  QVector<TerminalCell> cells(columns * rows);
+  QVector<bool> wrapped(rows, false);
+
+  const bool keepInScrollback = &buffer == &m_primary;
+  for (int row = 0; row < dropTop && row < m_rows; ++row) {
+    const int physical = buffer.rowMap[row];
+    if (keepInScrollback) {
+      pushScrollback(buffer.cells.constData() + physical * m_columns,
+                     buffer.wrapped[physical]);
+    }
+  }
+
+  const int copyRows = qMin(rows, m_rows - dropTop);
+  const int copyColumns = qMin(columns, m_columns);
+  for (int row = 0; row < copyRows; ++row) {
+    const int physical = buffer.rowMap[row + dropTop];
+    const TerminalCell *source =
+        buffer.cells.constData() + physical * m_columns;
+    std::copy(source, source + copyColumns, cells.data() + row * columns);
+    wrapped[row] = buffer.wrapped[physical] && columns == m_columns;
+  }
+
+  buffer.cells = std::move(cells);
+  buffer.wrapped = std::move(wrapped);
+  buffer.rowMap.resize(rows);
+  std::iota(buffer.rowMap.begin(), buffer.rowMap.end(), 0);
+}
+
+const TerminalCell *TerminalScreen::rowCells(int row) const {
+  return m_active->cells.constData() + m_active->rowMap[row] * m_columns;
+}
+
+TerminalCell *TerminalScreen::mutableRow(int row) {
+  return m_active->cells.data() + m_active->rowMap[row] * m_columns;
+}
+
+const TerminalCell &TerminalScreen::cell(int row, int column) const {
+  return rowCells(row)[column];
+}
+
+QString TerminalScreen::rowText(int row) const {
+  const TerminalCell *cells = rowCells(row);
+  int end = m_columns;
+  while (end > 0 && cells[end - 1].codepoint == U' ') {
+    --end;
+  }
+
+  QString text;
+  text.reserve(end);
+  for (int column = 0; column < end; ++column) {
+    appendCodepoint(text, cells[column].codepoint);
+  }
+  return text;
+}
+
+QVector<TerminalAttributeRun> TerminalScreen::rowRuns(int row) const {
+  QVector<TerminalAttributeRun> runs;
+  const TerminalCell *cells = rowCells(row);
+  int column = 0;
+  while (column < m_columns) {
+    const quint16 index = cells[column].attributes;
+    int end = column + 1;
+    while (end < m_columns && cells[end].attributes == index) {
+      ++end;
+    }
+    runs.append({column, end - column, m_attributeTable.at(index)});
+    column = end;
+  }
+  return runs;
+}
+
+bool TerminalScreen::isRowWrapped(int row) const {
+  return m_active->wrapped.at(m_active->rowMap.at(row));
+}
+
+const TerminalCellAttributes &TerminalScreen::attributes(quint16 index) const {
+  return index < m_attributeTable.size() ? m_attributeTable.at(index)
+                                         : m_attributeTable.at(0);
+}
+
+void TerminalScreen::setScrollbackCapacity(int lines) {
+  m_scrollback.setCapacity(lines);
+}
+
+void TerminalScreen::setScrollbackMemoryBudget(qint64 bytes) {
+  m_scrollback.setMemoryBudget(bytes);
+}
+
+bool TerminalScreen::isRowDamaged(int row) const {
+  return row >= 0 && row < m_damage.size() && m_damage.testBit(row);
+}
+
+QBitArray TerminalScreen::takeDamage() {
+  QBitArray damage = m_damage;
+  m_damage.fill(false);
+  m_hasDamage = false;
+  return damage;
+}
+
+void TerminalScreen::damageAll() {
+  m_damage.fill(true);
+  m_hasDamage = true;
+}
+
+void TerminalScreen::damageRow(int row) {
+  m_damage.setBit(row);
+  m_hasDamage = true;
+}
+
+void TerminalScreen::damageRows(int first, int last) {
+  if (first > last) {
+    return;
+  }
+  m_damage.fill(true, first, last + 1);
+  m_hasDamage = true;
+}
+
+void TerminalScreen::queueResponse(const QByteArray &response) {
+  m_responses.append(response);
+}
+
+QByteArray TerminalScreen::takeResponses() {
+  QByteArray responses;
+  responses.swap(m_responses);
+  return responses;
+}
+
+void TerminalScreen::print(char32_t codepoint) {
+  if (m_wrapPending) {
+    m_wrapPending = false;
+    if (m_autoWrap) {
+      m_active->wrapped[m_active->rowMap[m_cursorRow]] = true;
+      m_cursorColumn = 0;
+      index();
+    }
+  }
+
+  if (m_insertMode) {
+    insertCharacters(1);
+  }
+
+  TerminalCell &target = mutableRow(m_cursorRow)[m_cursorColumn];
+  target.codepoint = codepoint;
+  target.attributes = m_penIndex;
+  damageRow(m_cursorRow);
+  m_lastPrinted = codepoint;
+
+  if (m_cursorColumn + 1 >= m_columns) {
+    m_wrapPending = true;
+  } else {
+    ++m_cursorColumn;
+  }
+}
+
+void TerminalScreen::repeatLastCharacter(int count) {
+  count = qBound(1, count, m_columns * m_rows);
+  for (int i = 0; i < count; ++i) {
+    print(m_lastPrinted);
+  }
+}
+
+void TerminalScreen::lineFeed() {
+  m_wrapPending = false;
+  index();
+}
+
+void TerminalScreen::carriageReturn() {
+  m_wrapPending = false;
+  m_cursorColumn = 0;
+}
+
+void TerminalScreen::backspace() {
+  m_wrapPending = false;
+  if (m_cursorColumn > 0) {
+    --m_cursorColumn;
+  }
+}
+
+void TerminalScreen::horizontalTab(int count) {
+  m_wrapPending = false;
+  for (int i = 0; i < qMax(1, count); ++i) {
+    int column = m_cursorColumn + 1;
+    while (column < m_columns && !m_tabStops[column]) {
+      ++column;
+    }
+    m_cursorColumn = qMin(column, m_columns - 1);
+  }
+}
+
+void TerminalScreen::backwardTab(int count) {
+  m_wrapPending = false;
+  for (int i = 0; i < qMax(1, count); ++i) {
+    int column = m_cursorColumn - 1;
+    while (column > 0 && !m_tabStops[column]) {
+      --column;
+    }
+    m_cursorColumn = qMax(0, column);
+  }
+}
+
+void TerminalScreen::setTabStop() { m_tabStops[m_cursorColumn] = true; }
+
+void TerminalScreen::clearTabStop(int mode) {
+  if (mode == 0) {
+    m_tabStops[m_cursorColumn] = false;
+  } else if (mode == 3) {
+    m_tabStops.fill(false);
+  }
+}
+
+void TerminalScreen::index() {
+  if (m_cursorRow == m_scrollBottom) {
+    scrollRegionUp(m_scrollTop, m_scrollBottom, 1, true);
+  } else if (m_cursorRow < m_rows - 1) {
+    ++m_cursorRow;
+  }
+}
+
+void TerminalScreen::reverseIndex() {
+  m_wrapPending = false;
+  if (m_cursorRow == m_scrollTop) {
+    scrollRegionDown(m_scrollTop, m_scrollBottom, 1);
+  } else if (m_cursorRow > 0) {
+    --m_cursorRow;
+  }
+}
+
+void TerminalScreen::nextLine() {
+  carriageReturn();
+  index();
+}
+
+void TerminalScreen::cursorUp(int count) {
+  m_wrapPending = false;
+  const int top = m_cursorRow >= m_scrollTop ? m_scrollTop : 0;
+  m_cursorRow = qMax(top, m_cursorRow - qMax(1, count));
+}
+
+void TerminalScreen::cursorDown(int count) {
+  m_wrapPending = false;
+  const int bottom =
+      m_cursorRow <= m_scrollBottom ? m_scrollBottom : m_rows - 1;
+  m_cursorRow = qMin(bottom, m_cursorRow + qMax(1, count));
+}
+
+void TerminalScreen::cursorForward(int count) {
+  m_wrapPending = false;
+  m_cursorColumn = qMin(m_columns - 1, m_cursorColumn + qMax(1, count));
+}
+
+void TerminalScreen::cursorBackward(int count) {
+  m_wrapPending = false;
+  m_cursorColumn = qMax(0, m_cursorColumn - qMax(1, count));
+}
+
+void TerminalScreen::setCursorPosition(int row, int column) {
+  m_wrapPending = false;
+  if (m_originMode) {
+    m_cursorRow = qBound(m_scrollTop, row + m_scrollTop, m_scrollBottom);
+  } else {
+    m_cursorRow = qBound(0, row, m_rows - 1);
+  }
+  m_cursorColumn = qBound(0, column, m_columns - 1);
+}
+
+void TerminalScreen::setCursorRow(int row) {
+  setCursorPosition(row, m_cursorColumn);
+}
+
+void TerminalScreen::setCursorColumn(int column) {
+  m_wrapPending = false;
+  m_cursorColumn = qBound(0, column, m_columns - 1);
+}
+
+void TerminalScreen::saveCursor() {
+  SavedCursor &saved =
+      isAlternateScreen() ? m_savedAlternateCursor : m_savedPrimaryCursor;
+  saved.row = m_cursorRow;
+  saved.column = m_cursorColumn;
+  saved.attributes = m_pen;
+  saved.originMode = m_originMode;
+}
+
+void TerminalScreen::restoreCursor() {
+  const SavedCursor &saved =
+      isAlternateScreen() ? m_savedAlternateCursor : m_savedPrimaryCursor;
+  m_cursorRow = saved.row;
+  m_cursorColumn = saved.column;
+  m_originMode = saved.originMode;
+  m_pen = saved.attributes;
+  m_wrapPending = false;
+  updatePen();
+  clampCursor();
+}
+
+void TerminalScreen::clampCursor() {
+  m_cursorRow = qBound(0, m_cursorRow, m_rows - 1);
+  m_cursorColumn = qBound(0, m_cursorColumn, m_columns - 1);
+}
+
+TerminalCell TerminalScreen::blankCell() const {
+  TerminalCell blank;
+  blank.attributes = m_blankIndex;
+  return blank;
+}
+
+void TerminalScreen::clearRow(int row, int from, int to) {
+  from = qBound(0, from, m_columns);
+  to = qBound(from, to, m_columns);
+  if (from == to) {
+    return;
+  }
+
+  TerminalCell *cells = mutableRow(row);
+  std::fill(cells + from, cells + to, blankCell());
+  if (to == m_columns) {
+    m_active->wrapped[m_active->rowMap[row]] = false;
+  }
+  damageRow(row);
+}
+
+void TerminalScreen::eraseInLine(int mode) {
+  m_wrapPending = false;
+  if (mode == 0) {
+    clearRow(m_cursorRow, m_cursorColumn, m_columns);
+  } else if (mode == 1) {
+    clearRow(m_cursorRow, 0, m_cursorColumn + 1);
+  } else if (mode == 2) {
+    clearRow(m_cursorRow, 0, m_columns);
+  }
+}
+
+void TerminalScreen::eraseInDisplay(int mode) {
+  m_wrapPending = false;
+  if (mode == 0) {
+    clearRow(m_cursorRow, m_cursorColumn, m_columns);
+    for (int row = m_cursorRow + 1; row < m_rows; ++row) {
+      clearRow(row, 0, m_columns);
+    }
+  } else if (mode == 1) {
+    for (int row = 0; row < m_cursorRow; ++row) {
+      clearRow(row, 0, m_columns);
+    }
+    clearRow(m_cursorRow, 0, m_cursorColumn + 1);
+  } else if (mode == 2) {
+    for (int row = 0; row < m_rows; ++row) {
+      clearRow(row, 0, m_columns);
+    }
+  } else if (mode == 3) {
+    m_scrollback.clear();
+  }
+}
+
+void TerminalScreen::eraseCharacters(int count) {
+  m_wrapPending = false;
+  clearRow(m_cursorRow, m_cursorColumn, m_cursorColumn + qMax(1, count));
+}
+
+void TerminalScreen::deleteCharacters(int count) {
+  m_wrapPending = false;
+  count = qBound(1, count, m_columns - m_cursorColumn);
+  TerminalCell *cells = mutableRow(m_cursorRow);
+  std::copy(cells + m_cursorColumn + count, cells + m_columns,
+            cells + m_cursorColumn);
+  std::fill(cells + m_columns - count, cells + m_columns, blankCell());
+  damageRow(m_cursorRow);
+}
+
+void TerminalScreen::insertCharacters(int count) {
+  m_wrapPending = false;
+  count = qBound(1, count, m_columns - m_cursorColumn);
+  TerminalCell *cells = mutableRow(m_cursorRow);
+  std::copy_backward(cells + m_cursorColumn, cells + m_columns - count,
+                     cells + m_columns);
+  std::fill(cells + m_cursorColumn, cells + m_cursorColumn + count,
+            blankCell());
+  damageRow(m_cursorRow);
+}
+
+void TerminalScreen::insertLines(int count) {
+  if (m_cursorRow < m_scrollTop || m_cursorRow > m_scrollBottom) {
+    return;
+  }
+  scrollRegionDown(m_cursorRow, m_scrollBottom, qMax(1, count));
+  carriageReturn();
+}
+
+void TerminalScreen::deleteLines(int count) {
+  if (m_cursorRow < m_scrollTop || m_cursorRow > m_scrollBottom) {
+    return;
+  }
+  scrollRegionUp(m_cursorRow, m_scrollBottom, qMax(1, count), false);
+  carriageReturn();
+}
+
+void TerminalScreen::scrollUp(int count) {
+  scrollRegionUp(m_scrollTop, m_scrollBottom, qMax(1, count), true);
+}
+
+void TerminalScreen::scrollDown(int count) {
+  scrollRegionDown(m_scrollTop, m_scrollBottom, qMax(1, count));
+}
+
+void TerminalScreen::scrollRegionUp(int top, int bottom, int count,
+                                    bool keepInScrollback) {
+  count = qBound(0, count, bottom - top + 1);
+  if (count == 0) {
+    return;
+  }
+
+  if (keepInScrollback && top == 0 && !isAlternateScreen()) {
+    for (int row = 0; row < count; ++row) {
+      const int physical = m_active->rowMap[row];
+      pushScrollback(m_active->cells.constData() + physical * m_columns,
+                     m_active->wrapped[physical]);
+    }
+  }
+
+  QVector<int> &rowMap = m_active->rowMap;
+  std::rotate(rowMap.begin() + top, rowMap.begin() + top + count,
+              rowMap.begin() + bottom + 1);
+  for (int row = bottom - count + 1; row <= bottom; ++row) {
+    clearRow(row, 0, m_columns);
+  }
+  damageRows(top, bottom);
+}
+
+void TerminalScreen::scrollRegionDown(int top, int bottom, int count) {
+  count = qBound(0, count, bottom - top + 1);
+  if (count == 0) {
+    return;
+  }
+
+  QVector<int> &rowMap = m_active->rowMap;
+  std::rotate(rowMap.begin() + top, rowMap.begin() + bottom + 1 - count,
+              rowMap.begin() + bottom + 1);
+  for (int row = top; row < top + count; ++row) {
+    clearRow(row, 0, m_columns);
+  }
+  damageRows(top, bottom);
+}
+
+void TerminalScreen::setScrollRegion(int top, int bottom) {
+  if (bottom < 0 || bottom >= m_rows) {
+    bottom = m_rows - 1;
+  }
+  top = qMax(0, top);
+  if (top < bottom) {
+    m_scrollTop = top;
+    m_scrollBottom = bottom;
+  } else {
+    m_scrollTop = 0;
+    m_scrollBottom = m_rows - 1;
+  }
+  setCursorPosition(0, 0);
+}
+
+void TerminalScreen::pushScrollback(const TerminalCell *cells, bool wrapped) {
+  if (m_scrollback.capacity() == 0) {
+    return;
+  }
+
+  int end = m_columns;
+  while (end > 0 && cells[end - 1].codepoint == U' ' &&
+         m_attributeTable.at(cells[end - 1].attributes).background ==
+             TerminalColor::Default) {
+    --end;
+  }
+
+  TerminalScrollbackLine line;
+  line.wrapped = wrapped;
+  line.text.reserve(end);
+  int column = 0;
+  while (column < end) {
+    const quint16 index = cells[column].attributes;
+    TerminalAttributeRun run;
+    run.start = line.text.size();
+    run.attributes = m_attributeTable.at(index);
+    while (column < end && cells[column].attributes == index) {
+      appendCodepoint(line.text, cells[column].codepoint);
+      ++column;
+    }
+    run.length = line.text.size() - run.start;
+    if (index != 0) {
+      line.runs.append(run);
+    }
+  }
+
+  m_scrollback.push(std::move(line));
+}
+
+void TerminalScreen::selectGraphicRendition(const int *params, int count) {
+  if (count <= 0) {
+    m_pen = TerminalCellAttributes();
+    updatePen();
+    return;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    const int code = qMax(0, params[i]);
+    if (code == 0) {
+      m_pen = TerminalCellAttributes();
+    } else if (code == 1) {
+      m_pen.flags |= TerminalCellAttributes::Bold;
+    } else if (code == 2) {
+      m_pen.flags |= TerminalCellAttributes::Dim;
+    } else if (code == 3) {
+      m_pen.flags |= TerminalCellAttributes::Italic;
+    } else if (code == 4) {
+      m_pen.flags |= TerminalCellAttributes::Underline;
+    } else if (code == 7) {
+      m_pen.flags |= TerminalCellAttributes::Inverse;
+    } else if (code == 8) {
+      m_pen.flags |= TerminalCellAttributes::Hidden;
+    } else if (code == 9) {
+      m_pen.flags |= TerminalCellAttributes::Strikeout;
+    } else if (code == 21 || code == 22) {
+      m_pen.flags &=
+          ~(TerminalCellAttributes::Bold | TerminalCellAttributes::Dim);
+    } else if (code == 23) {
+      m_pen.flags &= ~TerminalCellAttributes::Italic;
+    } else if (code == 24) {
+      m_pen.flags &= ~TerminalCellAttributes::Underline;
+    } else if (code == 27) {
+      m_pen.flags &= ~TerminalCellAttributes::Inverse;
+    } else if (code == 28) {
+      m_pen.flags &= ~TerminalCellAttributes::Hidden;
+    } else if (code == 29) {
+      m_pen.flags &= ~TerminalCellAttributes::Strikeout;
+    } else if (code >= 30 && code <= 37) {
+      m_pen.foreground = TerminalColor::indexed(code - 30);
+    } else if (code == 39) {
+      m_pen.foreground = TerminalColor::Default;
+    } else if (code >= 40 && code <= 47) {
+      m_pen.background = TerminalColor::indexed(code - 40);
+    } else if (code == 49) {
+      m_pen.background = TerminalColor::Default;
+    } else if (code >= 90 && code <= 97) {
+      m_pen.foreground = TerminalColor::indexed(code - 90 + 8);
+    } else if (code >= 100 && code <= 107) {
+      m_pen.background = TerminalColor::indexed(code - 100 + 8);
+    } else if ((code == 38 || code == 48) && i + 1 < count) {
+      quint32 color = TerminalColor::Default;
+      const int mode = params[i + 1];
+      if (mode == 5 && i + 2 < count) {
+        color = TerminalColor::indexed(qMax(0, params[i + 2]));
+        i += 2;
+      } else if (mode == 2 && i + 4 < count) {
+        color = TerminalColor::rgb(qMax(0, params[i + 2]),
+                                   qMax(0, params[i + 3]),
+                                   qMax(0, params[i + 4]));
+        i += 4;
+      } else {
+        ++i;
+        continue;
+      }
+      if (code == 38) {
+        m_pen.foreground = color;
+      } else {
+        m_pen.background = color;
+      }
+    }
+  }
+
+  updatePen();
+}
+
+void TerminalScreen::updatePen() {
+  m_penIndex = internAttributes(m_pen);
+  TerminalCellAttributes blank;
+  blank.background = m_pen.background;
+  m_blankIndex = internAttributes(blank);
+}
+
+quint16 TerminalScreen::internAttributes(
+    const TerminalCellAttributes &attributes) {
+  const quint64 key = attributes.key();
+  auto it = m_attributeLookup.constFind(key);
+  if (it != m_attributeLookup.constEnd()) {
+    return it.value();
+  }
+
+  if (m_attributeTable.size() >= TERMINAL_MAX_ATTRIBUTES) {
+    compactAttributes();
+    it = m_attributeLookup.constFind(key);
+    if (it != m_attributeLookup.constEnd()) {
+      return it.value();
+    }
+    if (m_attributeTable.size() >= TERMINAL_MAX_ATTRIBUTES) {
+      return 0;
+    }
+  }
+
+  const quint16 index = static_cast<quint16>(m_attributeTable.size());
+  m_attributeTable.append(attributes);
+  m_attributeLookup.insert(key, index);
+  return index;
+}
+
+void TerminalScreen::compactAttributes() {
+  QVector<int> remap(m_attributeTable.size(), -1);
+  QVector<TerminalCellAttributes> table;
+  QHash<quint64, quint16> lookup;
+  table.append(TerminalCellAttributes());
+  lookup.insert(TerminalCellAttributes().key(), 0);
+  remap[0] = 0;
+
+  auto remapIndex = [&](quint16 &index) {
+    int &mapped = remap[index];
+    if (mapped < 0) {
+      mapped = table.size();
+      const TerminalCellAttributes &attributes = m_attributeTable.at(index);
+      table.append(attributes);
+      lookup.insert(attributes.key(), static_cast<quint16>(mapped));
+    }
+    index = static_cast<quint16>(mapped);
+  };
+
+  for (Buffer *buffer : {&m_primary, &m_alternate}) {
+    for (TerminalCell &cell : buffer->cells) {
+      remapIndex(cell.attributes);
+    }
+  }
+  remapIndex(m_penIndex);
+  remapIndex(m_blankIndex);
+
+  m_attributeTable = std::move(table);
+  m_attributeLookup = std::move(lookup);
+}
+
+void TerminalScreen::setMode(int mode, bool privateMode, bool enabled) {
+  if (!privateMode) {
+    if (mode == 4) {
+      m_insertMode = enabled;
+    }
+    return;
+  }
+
+  switch (mode) {
+  case 1:
+    m_applicationCursorKeys = enabled;
+    break;
+  case 6:
+    m_originMode = enabled;
+    setCursorPosition(0, 0);
+    break;
+  case 7:
+    m_autoWrap = enabled;
+    if (!enabled) {
+      m_wrapPending = false;
+    }
+    break;
+  case 25:
+    m_cursorVisible = enabled;
+    damageRow(m_cursorRow);
+    break;
+  case 47:
+  case 1047:
+    setAlternateScreen(enabled);
+    break;
+  case 1048:
+    if (enabled) {
+      saveCursor();
+    } else {
+      restoreCursor();
+    }
+    break;
+  case 1049:
+    if (enabled) {
+      saveCursor();
+      setAlternateScreen(true);
+    } else {
+      setAlternateScreen(false);
+      restoreCursor();
+    }
+    break;
+  case 2004:
+    m_bracketedPaste = enabled;
+    break;
+  default:
+    break;
+  }
+}
+
+void TerminalScreen::setAlternateScreen(bool enabled) {
+  if (enabled == isAlternateScreen()) {
+    return;
+  }
+
+  if (enabled) {
+    m_active = &m_alternate;
+    initBuffer(m_alternate);
+  } else {
+    m_active = &m_primary;
+  }
+
+  m_scrollTop = 0;
+  m_scrollBottom = m_rows - 1;
+  m_wrapPending = false;
+  m_screenSwitched = true;
+  clampCursor();
+  damageAll();
+}
+
+void TerminalScreen::setTitle(const QString &title) { m_title = title; }
+
+void TerminalScreen::reset() {
+  if (isAlternateScreen()) {
+    m_screenSwitched = true;
+  }
+
+  m_active = &m_primary;
+  initBuffer(m_primary);
+  initBuffer(m_alternate);
+  m_pen = TerminalCellAttributes();
+  updatePen();
+
+  m_cursorRow = 0;
+  m_cursorColumn = 0;
+  m_wrapPending = false;
+  m_cursorVisible = true;
+  m_autoWrap = true;
+  m_originMode = false;
+  m_insertMode = false;
+  m_applicationCursorKeys = false;
+  m_bracketedPaste = false;
+  m_scrollTop = 0;
+  m_scrollBottom = m_rows - 1;
+  m_lastPrinted = U' ';
+  m_savedPrimaryCursor = SavedCursor();
+  m_savedAlternateCursor = SavedCursor();
+  m_title.clear();
+  m_responses.clear();
+  resetTabStops();
+  damageAll();
+}
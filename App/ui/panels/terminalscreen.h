@@ -0,0 +1,262 @@
+#ifndef TERMINALSCREEN_H
+#define TERMINALSCREEN_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+constexpr int TERMINAL_DEFAULT_SCROLLBACK_LINES = 10000;
+constexpr int TERMINAL_MAX_SCROLLBACK_LINES = 100000;
+constexpr int TERMINAL_DEFAULT_SCROLLBACK_MEGABYTES = 32;
+constexpr int TERMINAL_MAX_ATTRIBUTES = 0xffff;
+
+namespace TerminalColor {
+constexpr quint32 Default = 0;
+constexpr quint32 IndexedTag = 0x01000000;
+constexpr quint32 RgbTag = 0x02000000;
+constexpr quint32 TagMask = 0xff000000;
+
+constexpr quint32 indexed(int index) {
+  return IndexedTag | (static_cast<quint32>(index) & 0xff);
+}
+constexpr quint32 rgb(int r, int g, int b) {
+  return RgbTag | ((static_cast<quint32>(r) & 0xff) << 16) |
+         ((static_cast<quint32>(g) & 0xff) << 8) |
+         (static_cast<quint32>(b) & 0xff);
+}
+constexpr bool isIndexed(quint32 color) {
+  return (color & TagMask) == IndexedTag;
+}
+constexpr bool isRgb(quint32 color) { return (color & TagMask) == RgbTag; }
+} // namespace TerminalColor
+
+struct TerminalCellAttributes {
+  enum Flag : quint8 {
+    Bold = 0x01,
+    Dim = 0x02,
+    Italic = 0x04,
+    Underline = 0x08,
+    Inverse = 0x10,
+    Hidden = 0x20,
+    Strikeout = 0x40,
+  };
+
+  quint32 foreground = TerminalColor::Default;
+  quint32 background = TerminalColor::Default;
+  quint8 flags = 0;
+
+  bool hasFlag(Flag flag) const { return flags & flag; }
+  quint64 key() const {
+    return (static_cast<quint64>(flags) << 56) |
+           (static_cast<quint64>(foreground & 0x03ffffff) << 28) |
+           (background & 0x0fffffff);
+  }
+  bool operator==(const TerminalCellAttributes &other) const {
+    return foreground == other.foreground &&
+           background == other.background && flags == other.flags;
+  }
+  bool operator!=(const TerminalCellAttributes &other) const {
+    return !(*this == other);
+  }
+};
+
+struct TerminalCell {
+  char32_t codepoint = U' ';
+  quint16 attributes = 0;
+};
+
+struct TerminalAttributeRun {
+  int start = 0;
+  int length = 0;
+  TerminalCellAttributes attributes;
+};
+
+struct TerminalScrollbackLine {
+  QString text;
+  QVector<TerminalAttributeRun> runs;
+  bool wrapped = false;
+};
+
+class TerminalScrollbackRing {
+public:
+  explicit TerminalScrollbackRing(
+      int capacity = TERMINAL_DEFAULT_SCROLLBACK_LINES);
+
+  void setCapacity(int capacity);
+  int capacity() const { return m_lines.size(); }
+  void setMemoryBudget(qint64 bytes);
+  qint64 memoryBudget() const { return m_memoryBudget; }
+  qint64 memoryUsage() const { return m_memoryUsage; }
+  int size() const { return m_count; }
+  bool isEmpty() const { return m_count == 0; }
+  qint64 pushCount() const { return m_pushCount; }
+
+  void push(TerminalScrollbackLine line);
+  const TerminalScrollbackLine &at(int index) const;
+  void clear();
+
+  static qint64 footprint(const TerminalScrollbackLine &line);
+
+private:
+  void dropOldest();
+  void enforceMemoryBudget();
+
+  QVector<TerminalScrollbackLine> m_lines;
+  int m_start;
+  int m_count;
+  qint64 m_pushCount;
+  qint64 m_memoryBudget;
+  qint64 m_memoryUsage;
+};
+
+class TerminalScreen {
+public:
+  explicit TerminalScreen(int columns = 80, int rows = 24);
+
+  void resize(int columns, int rows);
+  int columns() const { return m_columns; }
+  int rows() const { return m_rows; }
+
+  const TerminalCell *rowCells(int row) const;
+  const TerminalCell &cell(int row, int column) const;
+  QString rowText(int row) const;
+  QVector<TerminalAttributeRun> rowRuns(int row) const;
+  bool isRowWrapped(int row) const;
+  const TerminalCellAttributes &attributes(quint16 index) const;
+
+  int cursorRow() const { return m_cursorRow; }
+  int cursorColumn() const { return m_cursorColumn; }
+  bool isCursorVisible() const { return m_cursorVisible; }
+  bool isAlternateScreen() const { return m_active == &m_alternate; }
+  bool applicationCursorKeys() const { return m_applicationCursorKeys; }
+  bool bracketedPaste() const { return m_bracketedPaste; }
+  QString title() const { return m_title; }
+
+  const TerminalScrollbackRing &scrollback() const { return m_scrollback; }
+  void setScrollbackCapacity(int lines);
+  void setScrollbackMemoryBudget(qint64 bytes);
+
+  bool hasDamage() const { return m_hasDamage; }
+  bool isRowDamaged(int row) const;
+  QBitArray takeDamage();
+  void damageAll();
+
+  bool takeScreenSwitch() {
+    const bool switched = m_screenSwitched;
+    m_screenSwitched = false;
+    return switched;
+  }
+
+  void queueResponse(const QByteArray &response);
+  QByteArray takeResponses();
+
+  void print(char32_t codepoint);
+  void repeatLastCharacter(int count);
+  void lineFeed();
+  void carriageReturn();
+  void backspace();
+  void horizontalTab(int count = 1);
+  void backwardTab(int count = 1);
+  void setTabStop();
+  void clearTabStop(int mode);
+  void index();
+  void reverseIndex();
+  void nextLine();
+
+  void cursorUp(int count);
+  void cursorDown(int count);
+  void cursorForward(int count);
+  void cursorBackward(int count);
+  void setCursorPosition(int row, int column);
+  void setCursorRow(int row);
+  void setCursorColumn(int column);
+  void saveCursor();
+  void restoreCursor();
+
+  void eraseInLine(int mode);
+  void eraseInDisplay(int mode);
+  void eraseCharacters(int count);
+  void deleteCharacters(int count);
+  void insertCharacters(int count);
+  void insertLines(int count);
+  void deleteLines(int count);
+  void scrollUp(int count);
+  void scrollDown(int count);
+  void setScrollRegion(int top, int bottom);
+
+  void selectGraphicRendition(const int *params, int count);
+  void setMode(int mode, bool privateMode, bool enabled);
+  void setAlternateScreen(bool enabled);
+  void setTitle(const QString &title);
+  void reset();
+
+private:
+  struct Buffer {
+    QVector<TerminalCell> cells;
+    QVector<int> rowMap;
+    QVector<bool> wrapped;
+  };
+
+  struct SavedCursor {
+    int row = 0;
+    int column = 0;
+    TerminalCellAttributes attributes;
+    bool originMode = false;
+  };
+
+  void initBuffer(Buffer &buffer);
+  void resizeBuffer(Buffer &buffer, int columns, int rows, int dropTop);
+  void resetTabStops();
+  TerminalCell *mutableRow(int row);
+  void clearRow(int row, int from, int to);
+  void scrollRegionUp(int top, int bottom, int count, bool keepInScrollback);
+  void scrollRegionDown(int top, int bottom, int count);
+  void pushScrollback(const TerminalCell *cells, bool wrapped);
+  void damageRow(int row);
+  void damageRows(int first, int last);
+  void clampCursor();
+  quint16 internAttributes(const TerminalCellAttributes &attributes);
+  void compactAttributes();
+  void updatePen();
+  TerminalCell blankCell() const;
+
+  int m_columns;
+  int m_rows;
+  Buffer m_primary;
+  Buffer m_alternate;
+  Buffer *m_active;
+
+  int m_cursorRow;
+  int m_cursorColumn;
+  bool m_wrapPending;
+  bool m_cursorVisible;
+  bool m_autoWrap;
+  bool m_originMode;
+  bool m_insertMode;
+  bool m_applicationCursorKeys;
+  bool m_bracketedPaste;
+  bool m_screenSwitched;
+  int m_scrollTop;
+  int m_scrollBottom;
+  char32_t m_lastPrinted;
+  SavedCursor m_savedPrimaryCursor;
+  SavedCursor m_savedAlternateCursor;
+  QVector<bool> m_tabStops;
+
+  TerminalCellAttributes m_pen;
+  quint16 m_penIndex;
+  quint16 m_blankIndex;
+  QVector<TerminalCellAttributes> m_attributeTable;
+  QHash<quint64, quint16> m_attributeLookup;
+
+  QBitArray m_damage;
+  bool m_hasDamage;
+
+  TerminalScrollbackRing m_scrollback;
+  QString m_title;
+  QByteArray m_responses;
+};
+
+#endif
@@ -0,0 +1,465 @@
+#include "terminalscreenview.h"
+
+#include <QEvent>
+#include <QFontMetrics>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QWheelEvent>
+
+TerminalScreenView::TerminalScreenView(QWidget *parent)
+    : QWidget(parent), m_screen(nullptr), m_background("#0e1116"),
+      m_foreground("#e6edf3"), m_cursorColor("#7dffb2"),
+      m_selectionColor(125, 255, 178, 87), m_cellWidth(1), m_cellHeight(1),
+      m_ascent(0), m_lastCursorRow(-1), m_lastCursorColumn(-1),
+      m_scrollOffset(0), m_lastPushCount(0), m_selecting(false) {
+  setAttribute(Qt::WA_OpaquePaintEvent, true);
+  setFocusPolicy(Qt::StrongFocus);
+  setAttribute(Qt::WA_InputMethodEnabled, true);
+  setCursor(Qt::IBeamCursor);
+  updateMetrics();
+}
+
+void TerminalScreenView::setScreen(TerminalScreen *screen) {
+  m_screen = screen;
+  m_lastCursorRow = -1;
+  m_lastCursorColumn = -1;
+  m_scrollOffset = 0;
+  m_lastPushCount = m_screen ? m_screen->scrollback().pushCount() : 0;
+  m_selectionAnchor = QPoint();
+  m_selectionCursor = QPoint();
+  if (m_screen) {
+    m_screen->damageAll();
+  }
+  update();
+}
+
+void TerminalScreenView::setColors(const QColor &background,
+                                   const QColor &foreground,
+                                   const QColor &cursor) {
+  m_background = background.isValid() ? background : m_background;
+  m_foreground = foreground.isValid() ? foreground : m_foreground;
+  m_cursorColor = cursor.isValid() ? cursor : m_cursorColor;
+  update();
+}
+
+void TerminalScreenView::setSelectionColor(const QColor &selection) {
+  if (!selection.isValid()) {
+    return;
+  }
+  m_selectionColor = selection;
+  m_selectionColor.setAlphaF(0.34);
+  update();
+}
+
+void TerminalScreenView::setAnsiPalette(const QVector<QColor> &palette) {
+  m_palette = palette;
+  update();
+}
+
+QSize TerminalScreenView::gridSize() const {
+  return QSize(qMax(1, width() / m_cellWidth),
+               qMax(1, height() / m_cellHeight));
+}
+
+QRect TerminalScreenView::rowRect(int row) const {
+  return QRect(0, row * m_cellHeight, width(), m_cellHeight);
+}
+
+void TerminalScreenView::setScrollOffset(int lines) {
+  const int limit = m_screen && !m_screen->isAlternateScreen()
+                        ? m_screen->scrollback().size()
+                        : 0;
+  lines = qBound(0, lines, limit);
+  if (lines == m_scrollOffset) {
+    return;
+  }
+  m_scrollOffset = lines;
+  update();
+}
+
+int TerminalScreenView::screenLine() const {
+  return m_screen ? static_cast<int>(m_screen->scrollback().pushCount()) : 0;
+}
+
+int TerminalScreenView::firstLine() const {
+  return m_screen ? screenLine() - m_screen->scrollback().size() : 0;
+}
+
+int TerminalScreenView::topLine() const {
+  return screenLine() - m_scrollOffset;
+}
+
+QPoint TerminalScreenView::cellAt(const QPoint &position) const {
+  const int columns = m_screen ? m_screen->columns() : 0;
+  const int rows = m_screen ? m_screen->rows() : 1;
+  const int column =
+      qBound(0, (position.x() + m_cellWidth / 2) / m_cellWidth, columns);
+  const int row = qBound(0, position.y() / m_cellHeight, rows - 1);
+  return QPoint(column, topLine() + row);
+}
+
+QString TerminalScreenView::lineText(int line) const {
+  if (!m_screen) {
+    return QString();
+  }
+  const int row = line - screenLine();
+  if (row >= 0) {
+    return row < m_screen->rows() ? m_screen->rowText(row) : QString();
+  }
+  const int index = line - firstLine();
+  return index >= 0 ? m_screen->scrollback().at(index).text : QString();
+}
+
+bool TerminalScreenView::isLineWrapped(int line) const {
+  const int row = line - screenLine();
+  if (row >= 0) {
+    return row < m_screen->rows() && m_screen->isRowWrapped(row);
+  }
+  const int index = line - firstLine();
+  return index >= 0 && m_screen->scrollback().at(index).wrapped;
+}
+
+QString TerminalScreenView::selectedText() const {
+  if (!m_screen || !hasSelection()) {
+    return QString();
+  }
+
+  QPoint start = m_selectionAnchor;
+  QPoint end = m_selectionCursor;
+  if (end.y() < start.y() || (end.y() == start.y() && end.x() < start.x())) {
+    qSwap(start, end);
+  }
+
+  QString text;
+  for (int line = start.y(); line <= end.y(); ++line) {
+    const QString content = lineText(line);
+    const int from = line == start.y() ? start.x() : 0;
+    const int to = line == end.y() ? end.x() : content.size();
+    if (to > from) {
+      text += content.mid(from, to - from);
+    }
+    if (line < end.y() && !isLineWrapped(line)) {
+      text += QLatin1Char('\n');
+    }
+  }
+  return text;
+}
+
+void TerminalScreenView::selectAll() {
+  if (!m_screen) {
+    return;
+  }
+  m_selectionAnchor = QPoint(0, firstLine());
+  m_selectionCursor =
+      QPoint(m_screen->columns(), screenLine() + m_screen->rows() - 1);
+  update();
+}
+
+void TerminalScreenView::clearSelection() {
+  if (!hasSelection()) {
+    return;
+  }
+  m_selectionAnchor = QPoint();
+  m_selectionCursor = QPoint();
+  update();
+}
+
+QRegion TerminalScreenView::refresh() {
+  QRegion region;
+  if (!m_screen) {
+    return region;
+  }
+
+  const qint64 pushCount = m_screen->scrollback().pushCount();
+  const int pushed = static_cast<int>(pushCount - m_lastPushCount);
+  m_lastPushCount = pushCount;
+  if (m_scrollOffset > 0 && (pushed > 0 || m_screen->hasDamage())) {
+    m_scrollOffset = m_screen->isAlternateScreen()
+                         ? 0
+                         : qMin(m_scrollOffset + pushed,
+                                m_screen->scrollback().size());
+    m_screen->takeDamage();
+    region = rect();
+    update();
+    return region;
+  }
+
+  const int cursorRow = m_screen->cursorRow();
+  const int cursorColumn = m_screen->cursorColumn();
+  const bool cursorMoved =
+      cursorRow != m_lastCursorRow || cursorColumn != m_lastCursorColumn;
+  if (!m_screen->hasDamage() && !cursorMoved) {
+    return region;
+  }
+
+  const QBitArray damage = m_screen->takeDamage();
+  int row = 0;
+  while (row < damage.size()) {
+    if (!damage.testBit(row)) {
+      ++row;
+      continue;
+    }
+    const int first = row;
+    while (row < damage.size() && damage.testBit(row)) {
+      ++row;
+    }
+    region += QRect(0, first * m_cellHeight, width(),
+                    (row - first) * m_cellHeight);
+  }
+
+  if (cursorMoved) {
+    if (m_lastCursorRow >= 0) {
+      region += rowRect(m_lastCursorRow);
+    }
+    region += rowRect(cursorRow);
+  }
+
+  m_lastCursorRow = cursorRow;
+  m_lastCursorColumn = cursorColumn;
+  update(region);
+  return region;
+}
+
+void TerminalScreenView::paintEvent(QPaintEvent *event) {
+  QPainter painter(this);
+  painter.fillRect(event->rect(), m_background);
+  if (!m_screen) {
+    return;
+  }
+
+  const int firstRow = qMax(0, event->rect().top() / m_cellHeight);
+  const int lastRow =
+      qMin(m_screen->rows() - 1, event->rect().bottom() / m_cellHeight);
+  const TerminalScrollbackRing &scrollback = m_screen->scrollback();
+  const int oldest = firstLine();
+  const int screenTop = screenLine();
+  const int top = topLine();
+  for (int row = firstRow; row <= lastRow; ++row) {
+    const int line = top + row;
+    const int y = row * m_cellHeight;
+    if (line >= screenTop) {
+      paintRow(painter, y, line - screenTop);
+    } else if (line >= oldest) {
+      paintScrollbackLine(painter, y, scrollback.at(line - oldest));
+    }
+  }
+  paintSelection(painter, firstRow, lastRow);
+
+  const int cursorRow = m_screen->cursorRow() + m_scrollOffset;
+  if (m_screen->isCursorVisible() && cursorRow >= firstRow &&
+      cursorRow <= lastRow) {
+    const QRect cursorRect(m_screen->cursorColumn() * m_cellWidth,
+                           cursorRow * m_cellHeight, m_cellWidth,
+                           m_cellHeight);
+    if (hasFocus()) {
+      QColor fill = m_cursorColor;
+      fill.setAlphaF(0.7);
+      painter.fillRect(cursorRect, fill);
+    } else {
+      painter.setPen(m_cursorColor);
+      painter.drawRect(cursorRect.adjusted(0, 0, -1, -1));
+    }
+  }
+}
+
+void TerminalScreenView::paintRow(QPainter &painter, int y, int row) {
+  const TerminalCell *cells = m_screen->rowCells(row);
+  const int columns = m_screen->columns();
+
+  QString text;
+  int column = 0;
+  while (column < columns) {
+    const quint16 index = cells[column].attributes;
+    int end = column + 1;
+    while (end < columns && cells[end].attributes == index) {
+      ++end;
+    }
+
+    text.clear();
+    for (int i = column; i < end; ++i) {
+      const char32_t codepoint = cells[i].codepoint;
+      if (QChar::requiresSurrogates(codepoint)) {
+        text.append(QChar(QChar::highSurrogate(codepoint)));
+        text.append(QChar(QChar::lowSurrogate(codepoint)));
+      } else {
+        text.append(QChar(static_cast<char16_t>(codepoint)));
+      }
+    }
+
+    paintRun(painter,
+             QRect(column * m_cellWidth, y, (end - column) * m_cellWidth,
+                   m_cellHeight),
+             text, m_screen->attributes(index));
+    column = end;
+  }
+}
+
+void TerminalScreenView::paintScrollbackLine(
+    QPainter &painter, int y, const TerminalScrollbackLine &line) {
+  const TerminalCellAttributes plain;
+  auto paintSpan = [&](int start, int end,
+                       const TerminalCellAttributes &attributes) {
+    if (end > start) {
+      paintRun(painter,
+               QRect(start * m_cellWidth, y, (end - start) * m_cellWidth,
+                     m_cellHeight),
+               line.text.mid(start, end - start), attributes);
+    }
+  };
+
+  int position = 0;
+  for (const TerminalAttributeRun &run : line.runs) {
+    paintSpan(position, run.start, plain);
+    paintSpan(run.start, run.start + run.length, run.attributes);
+    position = run.start + run.length;
+  }
+  paintSpan(position, line.text.size(), plain);
+}
+
+void TerminalScreenView::paintRun(QPainter &painter, const QRect &rect,
+                                  const QString &text,
+                                  const TerminalCellAttributes &attributes) {
+  QColor foreground = resolveColor(attributes.foreground, m_foreground);
+  QColor background = resolveColor(attributes.background, m_background);
+  if (attributes.hasFlag(TerminalCellAttributes::Dim)) {
+    foreground = foreground.darker(135);
+  }
+  if (attributes.hasFlag(TerminalCellAttributes::Inverse)) {
+    qSwap(foreground, background);
+  }
+  if (background != m_background) {
+    painter.fillRect(rect, background);
+  }
+
+  bool blank = true;
+  for (const QChar &ch : text) {
+    if (ch != QLatin1Char(' ')) {
+      blank = false;
+      break;
+    }
+  }
+
+  const bool decorated =
+      attributes.hasFlag(TerminalCellAttributes::Underline) ||
+      attributes.hasFlag(TerminalCellAttributes::Strikeout);
+  if ((blank && !decorated) ||
+      attributes.hasFlag(TerminalCellAttributes::Hidden)) {
+    return;
+  }
+
+  QFont runFont = font();
+  runFont.setBold(attributes.hasFlag(TerminalCellAttributes::Bold));
+  runFont.setItalic(attributes.hasFlag(TerminalCellAttributes::Italic));
+  runFont.setUnderline(attributes.hasFlag(TerminalCellAttributes::Underline));
+  runFont.setStrikeOut(attributes.hasFlag(TerminalCellAttributes::Strikeout));
+  painter.setFont(runFont);
+  painter.setPen(foreground);
+  painter.drawText(rect.left(), rect.top() + m_ascent, text);
+}
+
+void TerminalScreenView::paintSelection(QPainter &painter, int firstRow,
+                                        int lastRow) {
+  if (!hasSelection()) {
+    return;
+  }
+
+  QPoint start = m_selectionAnchor;
+  QPoint end = m_selectionCursor;
+  if (end.y() < start.y() || (end.y() == start.y() && end.x() < start.x())) {
+    qSwap(start, end);
+  }
+
+  const int top = topLine();
+  for (int row = firstRow; row <= lastRow; ++row) {
+    const int line = top + row;
+    if (line < start.y() || line > end.y()) {
+      continue;
+    }
+    const int from = line == start.y() ? start.x() : 0;
+    const int to = line == end.y() ? end.x() : m_screen->columns();
+    if (to > from) {
+      painter.fillRect(QRect(from * m_cellWidth, row * m_cellHeight,
+                             (to - from) * m_cellWidth, m_cellHeight),
+                       m_selectionColor);
+    }
+  }
+}
+
+QColor TerminalScreenView::resolveColor(quint32 color,
+                                        const QColor &fallback) const {
+  if (TerminalColor::isIndexed(color)) {
+    const int index = static_cast<int>(color & 0xff);
+    return index < m_palette.size() ? m_palette.at(index) : fallback;
+  }
+  if (TerminalColor::isRgb(color)) {
+    return QColor((color >> 16) & 0xff, (color >> 8) & 0xff, color & 0xff);
+  }
+  return fallback;
+}
+
+void TerminalScreenView::changeEvent(QEvent *event) {
+  if (event->type() == QEvent::FontChange) {
+    updateMetrics();
+    update();
+  }
+  QWidget::changeEvent(event);
+}
+
+void TerminalScreenView::mousePressEvent(QMouseEvent *event) {
+  if (event->button() != Qt::LeftButton || !m_screen) {
+    QWidget::mousePressEvent(event);
+    return;
+  }
+  m_selecting = true;
+  m_selectionAnchor = cellAt(event->position().toPoint());
+  m_selectionCursor = m_selectionAnchor;
+  update();
+  event->accept();
+}
+
+void TerminalScreenView::mouseMoveEvent(QMouseEvent *event) {
+  if (!m_selecting || !(event->buttons() & Qt::LeftButton)) {
+    QWidget::mouseMoveEvent(event);
+    return;
+  }
+  const QPoint cell = cellAt(event->position().toPoint());
+  if (cell != m_selectionCursor) {
+    m_selectionCursor = cell;
+    update();
+  }
+  event->accept();
+}
+
+void TerminalScreenView::mouseReleaseEvent(QMouseEvent *event) {
+  if (event->button() == Qt::LeftButton) {
+    m_selecting = false;
+  }
+  QWidget::mouseReleaseEvent(event);
+}
+
+void TerminalScreenView::wheelEvent(QWheelEvent *event) {
+  const int delta = event->angleDelta().y();
+  if (!m_screen || m_screen->isAlternateScreen() || delta == 0) {
+    event->ignore();
+    return;
+  }
+  int lines = delta * TERMINAL_VIEW_WHEEL_LINES / 120;
+  if (lines == 0) {
+    lines = delta > 0 ? 1 : -1;
+  }
+  setScrollOffset(m_scrollOffset + lines);
+  event->accept();
+}
+
+bool TerminalScreenView::focusNextPrevChild(bool next) {
+  Q_UNUSED(next);
+  return false;
+}
+
+void TerminalScreenView::updateMetrics() {
+  const QFontMetrics metrics(font());
+  m_cellWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char('M')));
+  m_cellHeight = qMax(1, metrics.lineSpacing());
+  m_ascent = metrics.ascent();
+}
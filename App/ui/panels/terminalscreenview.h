@@ -0,0 +1,87 @@
+#ifndef TERMINALSCREENVIEW_H
+#define TERMINALSCREENVIEW_H
+
+#include <QColor>
+#include <QPoint>
+#include <QRegion>
+#include <QVector>
+#include <QWidget>
+
+#include "terminalscreen.h"
+
+constexpr int TERMINAL_VIEW_WHEEL_LINES = 3;
+
+class TerminalScreenView : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit TerminalScreenView(QWidget *parent = nullptr);
+
+  void setScreen(TerminalScreen *screen);
+  TerminalScreen *screen() const { return m_screen; }
+
+  void setColors(const QColor &background, const QColor &foreground,
+                 const QColor &cursor);
+  void setSelectionColor(const QColor &selection);
+  void setAnsiPalette(const QVector<QColor> &palette);
+
+  QSize cellSize() const { return QSize(m_cellWidth, m_cellHeight); }
+  QSize gridSize() const;
+  QRect rowRect(int row) const;
+
+  int scrollOffset() const { return m_scrollOffset; }
+  void setScrollOffset(int lines);
+  void scrollToBottom() { setScrollOffset(0); }
+
+  QPoint cellAt(const QPoint &position) const;
+  QString lineText(int line) const;
+
+  bool hasSelection() const { return m_selectionAnchor != m_selectionCursor; }
+  QString selectedText() const;
+  void selectAll();
+  void clearSelection();
+
+  QRegion refresh();
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  void changeEvent(QEvent *event) override;
+  void mousePressEvent(QMouseEvent *event) override;
+  void mouseMoveEvent(QMouseEvent *event) override;
+  void mouseReleaseEvent(QMouseEvent *event) override;
+  void wheelEvent(QWheelEvent *event) override;
+  bool focusNextPrevChild(bool next) override;
+
+private:
+  void updateMetrics();
+  int firstLine() const;
+  int screenLine() const;
+  int topLine() const;
+  bool isLineWrapped(int line) const;
+  void paintRow(QPainter &painter, int y, int row);
+  void paintScrollbackLine(QPainter &painter, int y,
+                           const TerminalScrollbackLine &line);
+  void paintRun(QPainter &painter, const QRect &rect, const QString &text,
+                const TerminalCellAttributes &attributes);
+  void paintSelection(QPainter &painter, int firstRow, int lastRow);
+  QColor resolveColor(quint32 color, const QColor &fallback) const;
+
+  TerminalScreen *m_screen;
+  QColor m_background;
+  QColor m_foreground;
+  QColor m_cursorColor;
+  QColor m_selectionColor;
+  QVector<QColor> m_palette;
+  int m_cellWidth;
+  int m_cellHeight;
+  int m_ascent;
+  int m_lastCursorRow;
+  int m_lastCursorColumn;
+  int m_scrollOffset;
+  qint64 m_lastPushCount;
+  QPoint m_selectionAnchor;
+  QPoint m_selectionCursor;
+  bool m_selecting;
+};
+
+#endif
@@ -36,7 +36,8 @@ TerminalTabWidget::TerminalTabWidget(QWidget *parent)
       m_splitTabWidget(nullptr), m_activeTabWidget(nullptr),
       m_newTerminalButton(nullptr), m_clearButton(nullptr),
       m_killButton(nullptr), m_closeButton(nullptr),
-      m_shellProfileMenu(nullptr), m_terminalCounter(0) {
+      m_shellProfileMenu(nullptr), m_terminalCounter(0),
+      m_scrollbackMegabytes(-1) {
   setObjectName("TerminalTabWidget");
   setContentsMargins(0, 0, 0, 0);
   setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -216,6 +217,9 @@ TerminalTabWidget::addTerminalToTabWidget(QTabWidget *tabWidget,
                                           const QString &workingDirectory,
                                           const QString &tabName) {
   Terminal *terminal = new Terminal(this);
+  if (m_scrollbackMegabytes >= 0) {
+    terminal->setScrollbackMemoryLimit(m_scrollbackMegabytes);
+  }
   if (!workingDirectory.isEmpty()) {
     terminal->setWorkingDirectory(workingDirectory);
   }
@@ -542,6 +546,16 @@ void TerminalTabWidget::applyTheme(const Theme &theme) {
   }
 }
 
+void TerminalTabWidget::setScrollbackMemoryLimit(int megabytes) {
+  m_scrollbackMegabytes = qMax(0, megabytes);
+  for (int i = 0; i < terminalCount(); ++i) {
+    Terminal *terminal = terminalAt(i);
+    if (terminal) {
+      terminal->setScrollbackMemoryLimit(m_scrollbackMegabytes);
+    }
+  }
+}
+
 void TerminalTabWidget::sendTextToTerminal(const QString &text,
                                            bool appendNewline) {
   Terminal *terminal = currentTerminal();
@@ -54,6 +54,8 @@ public:
 
   void applyTheme(const Theme &theme);
 
+  void setScrollbackMemoryLimit(int megabytes);
+
   void sendTextToTerminal(const QString &text, bool appendNewline = false);
 
   void splitHorizontal();
@@ -112,6 +114,7 @@ private:
   QToolButton *m_closeButton;
   QMenu *m_shellProfileMenu;
   int m_terminalCounter;
+  int m_scrollbackMegabytes;
   QString m_currentWorkingDirectory;
 };
 
@@ -0,0 +1,37 @@
+#include "lazydockwidget.h"
+
+LazyDockWidget::LazyDockWidget(const QString &title, Factory factory,
+                               QWidget *parent)
+    : QDockWidget(title, parent), m_factory(std::move(factory)),
+      m_materialized(false) {
+  setWidget(new QWidget(this));
+}
+
+QWidget *LazyDockWidget::materialize() {
+  if (m_materialized) {
+    return widget();
+  }
+  m_materialized = true;
+
+  const Factory factory = std::move(m_factory);
+  m_factory = nullptr;
+  QWidget *placeholder = widget();
+  QWidget *content = factory ? factory() : nullptr;
+  if (!content) {
+    return placeholder;
+  }
+
+  setWidget(content);
+  content->show();
+  if (placeholder && placeholder != content) {
+    placeholder->hide();
+    placeholder->deleteLater();
+  }
+  emit materialized(content);
+  return content;
+}
+
+void LazyDockWidget::showEvent(QShowEvent *event) {
+  materialize();
+  QDockWidget::showEvent(event);
+}
@@ -0,0 +1,31 @@
+#ifndef LAZYDOCKWIDGET_H
+#define LAZYDOCKWIDGET_H
+
+#include <QDockWidget>
+#include <functional>
+
+class LazyDockWidget : public QDockWidget {
+  Q_OBJECT
+
+public:
+  using Factory = std::function<QWidget *()>;
+
+  LazyDockWidget(const QString &title, Factory factory,
+                 QWidget *parent = nullptr);
+
+  bool isMaterialized() const { return m_materialized; }
+
+  QWidget *materialize();
+
+signals:
+  void materialized(QWidget *content);
+
+protected:
+  void showEvent(QShowEvent *event) override;
+
+private:
+  Factory m_factory;
+  bool m_materialized;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "paintprofileroverlay.h"
+#include "../../core/profiling/paintprofiler.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+namespace {
+QString formatMilliseconds(qint64 nanoseconds) {
+  return QString::number(nanoseconds / 1000000.0, 'f', 2) + " ms";
+}
+} // namespace
+
+PaintProfilerOverlay::PaintProfilerOverlay(QWidget *parent) : QLabel(parent) {
+  setStyleSheet("QLabel { padding: 0 6px; font-family: monospace; }");
+  setText(tr("paint: waiting for frame"));
+
+  m_refreshTimer.setSingleShot(true);
+  m_refreshTimer.setInterval(PAINT_PROFILER_OVERLAY_REFRESH_MS);
+  connect(&m_refreshTimer, &QTimer::timeout, this,
+          &PaintProfilerOverlay::refresh);
+  connect(&PaintProfiler::instance(), &PaintProfiler::frameFinished, this,
+          [this]() {
+            if (!m_refreshTimer.isActive()) {
+              m_refreshTimer.start();
+            }
+          });
+}
+
+void PaintProfilerOverlay::refresh() {
+  const PaintProfiler::Breakdown frame = PaintProfiler::instance().lastFrame();
+  const QHash<QString, qint64> counters = PaintProfiler::instance().counters();
+
+  QStringList summary;
+  for (int i = 0;
+       i < frame.size() && i < PAINT_PROFILER_OVERLAY_SUMMARY_ENTRIES; ++i) {
+    summary << QString("%1 %2").arg(frame.at(i).first,
+                                    formatMilliseconds(frame.at(i).second));
+  }
+  setText(summary.isEmpty() ? tr("paint: idle") : summary.join(" | "));
+
+  QStringList details;
+  details << tr("Last frame:");
+  for (const auto &entry : frame) {
+    details << QString("  %1: %2").arg(entry.first,
+                                      formatMilliseconds(entry.second));
+  }
+  details << tr("Counters (frame %1):")
+                 .arg(PaintProfiler::instance().frameCount());
+  QStringList counterNames = counters.keys();
+  std::sort(counterNames.begin(), counterNames.end());
+  for (const QString &name : counterNames) {
+    details << QString("  %1: %2").arg(name).arg(counters.value(name));
+  }
+  setToolTip(details.join('\n'));
+}
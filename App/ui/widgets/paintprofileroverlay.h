@@ -0,0 +1,22 @@
+#ifndef PAINTPROFILEROVERLAY_H
+#define PAINTPROFILEROVERLAY_H
+
+#include <QLabel>
+#include <QTimer>
+
+constexpr int PAINT_PROFILER_OVERLAY_REFRESH_MS = 250;
+constexpr int PAINT_PROFILER_OVERLAY_SUMMARY_ENTRIES = 4;
+
+class PaintProfilerOverlay : public QLabel {
+  Q_OBJECT
+
+public:
+  explicit PaintProfilerOverlay(QWidget *parent = nullptr);
+
+  void refresh();
+
+private:
+  QTimer m_refreshTimer;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "core/editor/bracketindex.h"
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtTest/QtTest>
+
+class TestBracketIndex : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testMatchWithinLine();
+  void testMatchAcrossManyBlocks();
+  void testSkipsStringsAndComments();
+  void testBlockCommentStateCarries();
+  void testIncrementalEdits();
+  void testLineInsertsAndRemovals();
+  void testLargeDocument();
+  void testSharedIndexPerDocument();
+};
+
+void TestBracketIndex::testMatchWithinLine() {
+  QTextDocument document("f(a[1], {b})");
+  BracketIndex index(&document);
+
+  QCOMPARE(index.findMatchingBracket(1), 11);
+  QCOMPARE(index.findMatchingBracket(11), 1);
+  QCOMPARE(index.findMatchingBracket(3), 5);
+  QCOMPARE(index.findMatchingBracket(8), 10);
+  QCOMPARE(index.findMatchingBracket(0), -1);
+}
+
+void TestBracketIndex::testMatchAcrossManyBlocks() {
+  QString text = "int main() {\n";
+  for (int i = 0; i < 500; ++i) {
+    text += QString("  if (x) { call(%1); }\n").arg(i);
+  }
+  text += "}\n";
+  QTextDocument document(text);
+  BracketIndex index(&document);
+
+  const int open = text.indexOf('{');
+  const int close = text.lastIndexOf('}');
+  QCOMPARE(index.findMatchingBracket(open), close);
+  QCOMPARE(index.findMatchingBracket(close), open);
+
+  const int inner = text.indexOf("{ call(250)");
+  QCOMPARE(index.findMatchingBracket(inner), text.indexOf('}', inner));
+}
+
+void TestBracketIndex::testSkipsStringsAndComments() {
+  const QString text = "call(\")\", ')', // )\n"
+                       "  /* ( */ x)";
+  QTextDocument document(text);
+  BracketIndex index(&document);
+  index.setLanguage("cpp");
+
+  QCOMPARE(index.findMatchingBracket(4), text.lastIndexOf(')'));
+  QCOMPARE(index.findMatchingBracket(text.indexOf("( */")), -1);
+
+  index.setLanguage("plaintext");
+  QCOMPARE(index.findMatchingBracket(4), text.indexOf(')'));
+}
+
+void TestBracketIndex::testBlockCommentStateCarries() {
+  const QString text = "a(\nb)\nc";
+  QTextDocument document(text);
+  BracketIndex index(&document);
+  index.setLanguage("cpp");
+  QCOMPARE(index.findMatchingBracket(1), 4);
+
+  QTextCursor cursor(&document);
+  cursor.setPosition(3);
+  cursor.insertText("/*");
+  QCOMPARE(index.findMatchingBracket(1), -1);
+
+  cursor.movePosition(QTextCursor::End);
+  cursor.insertText("*/)");
+  QCOMPARE(index.findMatchingBracket(1),
+           document.toPlainText().lastIndexOf(')'));
+}
+
+void TestBracketIndex::testIncrementalEdits() {
+  QString text;
+  for (int i = 0; i < 200; ++i) {
+    text += "(\n";
+  }
+  for (int i = 0; i < 200; ++i) {
+    text += ")\n";
+  }
+  QTextDocument document(text);
+  BracketIndex index(&document);
+  QCOMPARE(index.findMatchingBracket(0),
+           document.toPlainText().lastIndexOf(')'));
+
+  QTextCursor cursor(&document);
+  cursor.setPosition(2);
+  cursor.insertText(")");
+  QCOMPARE(index.findMatchingBracket(0), 2);
+
+  cursor.setPosition(2);
+  cursor.deleteChar();
+  cursor.insertText("x\n");
+  const QString edited = document.toPlainText();
+  QCOMPARE(index.findMatchingBracket(0), edited.lastIndexOf(')'));
+  QCOMPARE(index.findMatchingBracket(edited.lastIndexOf(')')), 0);
+}
+
+void TestBracketIndex::testLineInsertsAndRemovals() {
+  QString text;
+  for (int i = 0; i < 300; ++i) {
+    text += "(\n";
+  }
+  for (int i = 0; i < 300; ++i) {
+    text += ")\n";
+  }
+  QTextDocument document(text);
+  BracketIndex index(&document);
+  QCOMPARE(index.findMatchingBracket(0),
+           document.toPlainText().lastIndexOf(')'));
+
+  QTextCursor cursor(&document);
+  for (int round = 0; round < 20; ++round) {
+    cursor.setPosition(document.findBlockByNumber(150 + round).position());
+    cursor.insertText(QString("x\n").repeated(40 + round));
+    QString edited = document.toPlainText();
+    QCOMPARE(index.findMatchingBracket(0), edited.lastIndexOf(')'));
+
+    cursor.setPosition(document.findBlockByNumber(155 + round).position());
+    cursor.setPosition(document.findBlockByNumber(175 + round).position(),
+                       QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    edited = document.toPlainText();
+    QCOMPARE(index.findMatchingBracket(edited.lastIndexOf(')')), 0);
+  }
+
+  cursor.setPosition(document.findBlockByNumber(10).position());
+  cursor.insertText(")\n");
+  const QString edited = document.toPlainText();
+  QCOMPARE(index.findMatchingBracket(edited.indexOf(')')),
+           edited.indexOf(')') - 2);
+}
+
+void TestBracketIndex::testLargeDocument() {
+  QString text = "{\n";
+  const QString line = "  value = compute(alpha, beta[gamma]);\n";
+  while (text.size() < 1000000) {
+    text += line;
+  }
+  text += "}";
+  QTextDocument document(text);
+  BracketIndex index(&document);
+
+  QCOMPARE(index.findMatchingBracket(0), text.size() - 1);
+  QCOMPARE(index.findMatchingBracket(text.size() - 1), 0);
+}
+
+void TestBracketIndex::testSharedIndexPerDocument() {
+  QTextDocument document("()");
+  BracketIndex *index = BracketIndex::forDocument(&document);
+  QVERIFY(index);
+  QCOMPARE(BracketIndex::forDocument(&document), index);
+  QCOMPARE(index->findMatchingBracket(0), 1);
+}
+
+QTEST_MAIN(TestBracketIndex)
+#include "test_bracketindex.moc"
@@ -1,6 +1,9 @@
+#include "core/editor/blockmetadata.h"
 #include "core/editor/codefolding.h"
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QTextBlock>
+#include <QTextCursor>
 #include <QTextDocument>
 #include <QtTest/QtTest>
 
@@ -36,6 +39,9 @@ private slots:
   void testRestoreFoldState();
   void testNullDocument();
   void testFoldBlockAlreadyFolded();
+  void testMetadataFollowsEdits();
+  void testFoldAllMatchesSingleQueries();
+  void testChangedRangeCoversOnlyToggledBlocks();
 
 private:
   QTextDocument *m_document = nullptr;
@@ -263,5 +269,83 @@ void TestCodeFolding::testFoldBlockAlreadyFolded() {
   QVERIFY(!m_manager->foldBlock(0));
 }
 
+void TestCodeFolding::testMetadataFollowsEdits() {
+  m_document->setPlainText("a {\nb;\n}\nc;\n");
+  BlockMetadataCache *cache = BlockMetadataCache::forDocument(m_document);
+  QCOMPARE(BlockMetadataCache::forDocument(m_document), cache);
+  QCOMPARE(m_manager->getFoldingLevel(3), 0);
+  QCOMPARE(cache->facts(m_document->findBlockByNumber(1))->indentWidth, 0);
+
+  QTextCursor cursor(m_document->findBlockByNumber(1));
+  cursor.insertText("\t  ");
+  QCOMPARE(cache->facts(m_document->findBlockByNumber(1))->indentWidth, 6);
+
+  cursor.setPosition(0);
+  cursor.insertText("{\n");
+  QCOMPARE(m_manager->getFoldingLevel(4), 1);
+  QCOMPARE(m_manager->findFoldEndBlock(1), 3);
+}
+
+void TestCodeFolding::testFoldAllMatchesSingleQueries() {
+  m_document->setPlainText("#region Setup\n"
+                           "// one\n"
+                           "// two\n"
+                           "// three\n"
+                           "int main() {\n"
+                           "  if (x) {\n"
+                           "    call();\n"
+                           "  } else {\n"
+                           "    other();\n"
+                           "  }\n"
+                           "}\n"
+                           "#endregion\n"
+                           "def f():\n"
+                           "    a = 1\n"
+                           "\n"
+                           "    if a:\n"
+                           "        b()\n"
+                           "c = 2\n"
+                           "/* tail\n"
+                           " */\n");
+
+  QSet<int> expectedFolds;
+  QVector<bool> expectedVisible(m_document->blockCount(), true);
+  for (int i = 0; i < m_document->blockCount(); ++i) {
+    if (!m_manager->isFoldable(i))
+      continue;
+    expectedFolds.insert(i);
+    for (int j = i + 1; j <= m_manager->findFoldEndBlock(i); ++j)
+      expectedVisible[j] = false;
+  }
+
+  m_manager->foldAll();
+  QCOMPARE(m_manager->foldedBlocks(), expectedFolds);
+  for (int i = 0; i < m_document->blockCount(); ++i)
+    QCOMPARE(m_document->findBlockByNumber(i).isVisible(), expectedVisible[i]);
+}
+
+void TestCodeFolding::testChangedRangeCoversOnlyToggledBlocks() {
+  m_document->setPlainText("a;\nb {\n  c;\n  d;\n}\ne;\nf {\n  g;\n}\n");
+  int first = -1;
+  int last = -1;
+  QVERIFY(!m_manager->takeChangedRange(&first, &last));
+
+  QVERIFY(m_manager->foldBlock(1));
+  QVERIFY(m_manager->takeChangedRange(&first, &last));
+  QCOMPARE(first, 2);
+  QCOMPARE(last, 4);
+  QVERIFY(!m_manager->takeChangedRange(&first, &last));
+
+  m_manager->foldAll();
+  QVERIFY(m_manager->takeChangedRange(&first, &last));
+  QCOMPARE(first, 7);
+  QCOMPARE(last, 8);
+
+  m_manager->unfoldAll();
+  QVERIFY(m_manager->takeChangedRange(&first, &last));
+  QCOMPARE(first, 2);
+  QCOMPARE(last, 8);
+}
+
 QTEST_MAIN(TestCodeFolding)
 #include "test_codefolding.moc"
@@ -2,6 +2,7 @@
 #include "completion/completionproviderregistry.h"
 #include "completion/icompletionprovider.h"
 #include <QSignalSpy>
+#include <QTextDocument>
 #include <QtTest/QtTest>
 #include <memory>
 
@@ -75,6 +76,45 @@ private:
   std::function<void(const QList<CompletionItem> &)> m_pendingCallback;
 };
 
+class ListProvider : public ICompletionProvider {
+public:
+  ListProvider(const QString &id, const QStringList &labels)
+      : m_id(id), m_labels(labels) {}
+
+  QString id() const override { return m_id; }
+  QString displayName() const override { return m_id; }
+  int basePriority() const override { return 100; }
+  QStringList supportedLanguages() const override { return {"*"}; }
+
+  void requestCompletions(
+      const CompletionContext &context,
+      std::function<void(const QList<CompletionItem> &)> callback) override {
+    Q_UNUSED(context);
+    ++m_requestCount;
+    QList<CompletionItem> items;
+    for (const QString &label : m_labels) {
+      CompletionItem item;
+      item.label = label;
+      item.priority = basePriority();
+      item.providerId = m_id;
+      items.append(item);
+    }
+    callback(items);
+  }
+
+  bool lastResultsIncomplete() const override { return m_incomplete; }
+
+  void setIncomplete(bool incomplete) { m_incomplete = incomplete; }
+
+  int requestCount() const { return m_requestCount; }
+
+private:
+  QString m_id;
+  QStringList m_labels;
+  bool m_incomplete = false;
+  int m_requestCount = 0;
+};
+
 class TestCompletionEngine : public QObject {
   Q_OBJECT
 
@@ -84,11 +124,42 @@ private slots:
   void testCompletionsReadyEmittedOnce();
   void testMultipleProvidersEmitOnce();
   void testStaleCallbackIgnored();
+  void testRefinesCachedCandidatesWithoutRequery();
+  void testIncompleteResultsRequery();
+  void testMovedAnchorRequeries();
+  void testSharedEngineKeepsDocumentsApart();
+  void testClearingOtherDocumentKeepsCandidates();
+  void testCandidatesKeptBeyondMaxResults();
+  void testFuzzyRankingPrefersWordBoundaries();
 
 private:
+  static CompletionContext typingContext(const QString &prefix, int anchor);
+  static QStringList labels(const QList<CompletionItem> &items);
+
   CompletionEngine *m_engine;
 };
 
+CompletionContext TestCompletionEngine::typingContext(const QString &prefix,
+                                                      int anchor) {
+  CompletionContext ctx;
+  ctx.documentUri = "file:///tmp/main.cpp";
+  ctx.languageId = "cpp";
+  ctx.prefix = prefix;
+  ctx.line = 4;
+  ctx.column = anchor + static_cast<int>(prefix.size());
+  ctx.triggerKind = CompletionTriggerKind::TriggerCharacter;
+  ctx.isAutoComplete = true;
+  return ctx;
+}
+
+QStringList TestCompletionEngine::labels(const QList<CompletionItem> &items) {
+  QStringList result;
+  for (const CompletionItem &item : items) {
+    result.append(item.label);
+  }
+  return result;
+}
+
 void TestCompletionEngine::init() {
   CompletionProviderRegistry::instance().clear();
   m_engine = new CompletionEngine(this);
@@ -184,5 +255,171 @@ void TestCompletionEngine::testStaleCallbackIgnored() {
   QCOMPARE(spy.count(), 1);
 }
 
+void TestCompletionEngine::testRefinesCachedCandidatesWithoutRequery() {
+  auto provider = std::make_shared<ListProvider>(
+      "list", QStringList{"foobar", "format", "fooBaz", "barfoo"});
+  CompletionProviderRegistry::instance().registerProvider(provider);
+  m_engine->setLanguage("cpp");
+
+  CompletionContext ctx = typingContext("fo", 8);
+  ctx.isAutoComplete = false;
+  ctx.triggerKind = CompletionTriggerKind::Invoked;
+  m_engine->requestCompletions(ctx);
+  QCOMPARE(provider->requestCount(), 1);
+  QCOMPARE(m_engine->candidateCount(), 4);
+  QVERIFY(m_engine->hasReusableCandidates());
+
+  QSignalSpy spy(m_engine, &CompletionEngine::completionsReady);
+  m_engine->requestCompletions(typingContext("foo", 8));
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(provider->requestCount(), 1);
+  QStringList results =
+      labels(spy.takeFirst().at(0).value<QList<CompletionItem>>());
+  QVERIFY(results.contains("foobar"));
+  QVERIFY(results.contains("fooBaz"));
+  QVERIFY(!results.contains("format"));
+
+  m_engine->requestCompletions(typingContext("fooB", 8));
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(provider->requestCount(), 1);
+  results = labels(spy.takeFirst().at(0).value<QList<CompletionItem>>());
+  QCOMPARE(results.first(), QString("fooBaz"));
+}
+
+void TestCompletionEngine::testIncompleteResultsRequery() {
+  auto provider =
+      std::make_shared<ListProvider>("list", QStringList{"foobar", "format"});
+  provider->setIncomplete(true);
+  CompletionProviderRegistry::instance().registerProvider(provider);
+  m_engine->setLanguage("cpp");
+  m_engine->setAutoTriggerDelay(0);
+
+  m_engine->requestCompletions(typingContext("fo", 0));
+  QTRY_COMPARE(provider->requestCount(), 1);
+  QVERIFY(!m_engine->hasReusableCandidates());
+
+  m_engine->requestCompletions(typingContext("foo", 0));
+  QCOMPARE(provider->requestCount(), 1);
+  QTRY_COMPARE(provider->requestCount(), 2);
+}
+
+void TestCompletionEngine::testMovedAnchorRequeries() {
+  auto provider =
+      std::make_shared<ListProvider>("list", QStringList{"foobar", "format"});
+  CompletionProviderRegistry::instance().registerProvider(provider);
+  m_engine->setLanguage("cpp");
+  m_engine->setAutoTriggerDelay(0);
+
+  m_engine->requestCompletions(typingContext("fo", 0));
+  QTRY_COMPARE(provider->requestCount(), 1);
+
+  m_engine->requestCompletions(typingContext("foo", 6));
+  QTRY_COMPARE(provider->requestCount(), 2);
+
+  CompletionContext otherDocument = typingContext("foob", 6);
+  otherDocument.documentUri = "file:///tmp/other.cpp";
+  m_engine->requestCompletions(otherDocument);
+  QTRY_COMPARE(provider->requestCount(), 3);
+}
+
+void TestCompletionEngine::testSharedEngineKeepsDocumentsApart() {
+  auto provider =
+      std::make_shared<ListProvider>("list", QStringList{"foobar", "format"});
+  CompletionProviderRegistry::instance().registerProvider(provider);
+  m_engine->setLanguage("cpp");
+  m_engine->setAutoTriggerDelay(0);
+
+  QTextDocument first;
+  QTextDocument second;
+  CompletionContext ctx = typingContext("fo", 0);
+  ctx.document = &first;
+  m_engine->requestCompletions(ctx);
+  QTRY_COMPARE(provider->requestCount(), 1);
+
+  ctx = typingContext("foo", 0);
+  ctx.document = &second;
+  m_engine->requestCompletions(ctx);
+  QTRY_COMPARE(provider->requestCount(), 2);
+
+  ctx = typingContext("foob", 0);
+  ctx.document = &second;
+  m_engine->requestCompletions(ctx);
+  QCOMPARE(provider->requestCount(), 2);
+  QCOMPARE(labels(m_engine->lastResults()), QStringList{"foobar"});
+}
+
+void TestCompletionEngine::testClearingOtherDocumentKeepsCandidates() {
+  auto provider =
+      std::make_shared<ListProvider>("list", QStringList{"foobar", "format"});
+  CompletionProviderRegistry::instance().registerProvider(provider);
+  m_engine->setLanguage("cpp");
+  m_engine->setAutoTriggerDelay(0);
+
+  QTextDocument first;
+  QTextDocument second;
+  CompletionContext ctx = typingContext("fo", 0);
+  ctx.document = &first;
+  m_engine->requestCompletions(ctx);
+  QTRY_VERIFY(m_engine->hasReusableCandidates());
+
+  m_engine->clearCandidates(&second);
+  QVERIFY(m_engine->hasReusableCandidates());
+
+  m_engine->clearCandidates(&first);
+  QVERIFY(!m_engine->hasReusableCandidates());
+
+  ctx = typingContext("foo", 0);
+  ctx.document = &first;
+  m_engine->requestCompletions(ctx);
+  QTRY_COMPARE(provider->requestCount(), 2);
+}
+
+void TestCompletionEngine::testCandidatesKeptBeyondMaxResults() {
+  QStringList words;
+  for (int i = 0; i < 10; ++i) {
+    words.append(QString("item%1").arg(i));
+  }
+  words.append("itemTarget");
+  auto provider = std::make_shared<ListProvider>("list", words);
+  CompletionProviderRegistry::instance().registerProvider(provider);
+  m_engine->setLanguage("cpp");
+  m_engine->setMaxResults(3);
+
+  CompletionContext ctx = typingContext("it", 0);
+  ctx.isAutoComplete = false;
+  QSignalSpy spy(m_engine, &CompletionEngine::completionsReady);
+  m_engine->requestCompletions(ctx);
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(spy.takeFirst().at(0).value<QList<CompletionItem>>().size(), 3);
+  QCOMPARE(m_engine->candidateCount(), 11);
+
+  m_engine->requestCompletions(typingContext("itemT", 0));
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(provider->requestCount(), 1);
+  const QStringList results =
+      labels(spy.takeFirst().at(0).value<QList<CompletionItem>>());
+  QCOMPARE(results, QStringList{"itemTarget"});
+}
+
+void TestCompletionEngine::testFuzzyRankingPrefersWordBoundaries() {
+  auto provider = std::make_shared<ListProvider>(
+      "list", QStringList{"grove", "getValue", "gravel", "string"});
+  CompletionProviderRegistry::instance().registerProvider(provider);
+  m_engine->setLanguage("cpp");
+
+  CompletionContext ctx = typingContext("gV", 0);
+  ctx.isAutoComplete = false;
+  QSignalSpy spy(m_engine, &CompletionEngine::completionsReady);
+  m_engine->requestCompletions(ctx);
+  QCOMPARE(spy.count(), 1);
+  const QStringList results =
+      labels(spy.takeFirst().at(0).value<QList<CompletionItem>>());
+  QCOMPARE(results.size(), 3);
+  QCOMPARE(results.first(), QString("getValue"));
+  QVERIFY(!results.contains("string"));
+
+  QCOMPARE(labels(m_engine->filterResults("str")), QStringList{"string"});
+}
+
 QTEST_MAIN(TestCompletionEngine)
 #include "test_completionengine.moc"
@@ -0,0 +1,250 @@
+#include "core/editor/decorationstore.h"
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtTest/QtTest>
+
+class TestDecorationStore : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testForDocumentReturnsSameStore();
+  void testOverlappingQuery();
+  void testStartingInQuery();
+  void testDiagnosticsFollowInsertions();
+  void testDeletionCollapsesDiagnostic();
+  void testFormatOnlyChangeKeepsPositions();
+  void testLineTextsMoveWithLines();
+  void testDeletedLineDropsLineText();
+  void testLargeDiagnosticSet();
+  void testRepeatedEditsKeepPositions();
+
+private:
+  static LspDiagnostic makeDiagnostic(int line, int startCol, int endCol,
+                                      LspDiagnosticSeverity severity,
+                                      const QString &message);
+};
+
+LspDiagnostic TestDecorationStore::makeDiagnostic(
+    int line, int startCol, int endCol, LspDiagnosticSeverity severity,
+    const QString &message) {
+  LspDiagnostic diag;
+  diag.range = {{line, startCol}, {line, endCol}};
+  diag.severity = severity;
+  diag.message = message;
+  return diag;
+}
+
+void TestDecorationStore::testForDocumentReturnsSameStore() {
+  QTextDocument document;
+  DecorationStore *store = DecorationStore::forDocument(&document);
+  QVERIFY(store);
+  QCOMPARE(DecorationStore::forDocument(&document), store);
+  QVERIFY(!DecorationStore::forDocument(nullptr));
+}
+
+void TestDecorationStore::testOverlappingQuery() {
+  QTextDocument document("alpha\nbeta\ngamma\ndelta\n");
+  DecorationStore *store = DecorationStore::forDocument(&document);
+  store->setDiagnostics(
+      {makeDiagnostic(0, 0, 5, LspDiagnosticSeverity::Error, "a"),
+       makeDiagnostic(2, 1, 3, LspDiagnosticSeverity::Warning, "g"),
+       makeDiagnostic(3, 0, 5, LspDiagnosticSeverity::Hint, "d")});
+
+  QCOMPARE(store->count(DecorationKind::Diagnostic), 3);
+
+  const int gammaStart = document.findBlockByNumber(2).position();
+  const QVector<Decoration> hits = store->overlapping(
+      DecorationKind::Diagnostic, gammaStart, gammaStart + 4);
+  QCOMPARE(hits.size(), 1);
+  QCOMPARE(store->diagnostic(hits.first()).message, QString("g"));
+  QVERIFY(store->severity(hits.first()) == LspDiagnosticSeverity::Warning);
+
+  QCOMPARE(store->overlapping(DecorationKind::Diagnostic, 0, 100).size(), 3);
+  QVERIFY(store->overlapping(DecorationKind::Diagnostic, 6, 10).isEmpty());
+}
+
+void TestDecorationStore::testStartingInQuery() {
+  QTextDocument document("one\ntwo\nthree\n");
+  DecorationStore *store = DecorationStore::forDocument(&document);
+  store->setDiagnostics(
+      {makeDiagnostic(1, 0, 3, LspDiagnosticSeverity::Error, "first"),
+       makeDiagnostic(1, 1, 2, LspDiagnosticSeverity::Hint, "second"),
+       makeDiagnostic(2, 0, 1, LspDiagnosticSeverity::Error, "third")});
+
+  const QList<LspDiagnostic> onLine = store->diagnosticsOnLine(1);
+  QCOMPARE(onLine.size(), 2);
+  QCOMPARE(onLine.at(0).message, QString("first"));
+  QCOMPARE(onLine.at(1).message, QString("second"));
+  QVERIFY(store->diagnosticsOnLine(0).isEmpty());
+}
+
+void TestDecorationStore::testDiagnosticsFollowInsertions() {
+  QTextDocument document("int a;\nint b;\n");
+  DecorationStore *store = DecorationStore::forDocument(&document);
+  store->setDiagnostics(
+      {makeDiagnostic(1, 4, 5, LspDiagnosticSeverity::Error, "b")});
+
+  QTextCursor cursor(&document);
+  cursor.insertText("// header\n\n");
+
+  const QList<LspDiagnostic> diagnostics = store->diagnostics();
+  QCOMPARE(diagnostics.size(), 1);
+  QCOMPARE(diagnostics.first().range.start.line, 3);
+  QCOMPARE(diagnostics.first().range.start.character, 4);
+  QCOMPARE(diagnostics.first().range.end.character, 5);
+
+  cursor.setPosition(document.findBlockByNumber(3).position());
+  cursor.insertText("  ");
+  const LspDiagnostic moved = store->diagnostics().first();
+  QCOMPARE(moved.range.start.line, 3);
+  QCOMPARE(moved.range.start.character, 6);
+}
+
+void TestDecorationStore::testDeletionCollapsesDiagnostic() {
+  QTextDocument document("keep\nremove me\nkeep\n");
+  DecorationStore *store = DecorationStore::forDocument(&document);
+  store->setDiagnostics(
+      {makeDiagnostic(1, 0, 6, LspDiagnosticSeverity::Warning, "gone")});
+
+  QTextCursor cursor(&document);
+  cursor.setPosition(document.findBlockByNumber(1).position());
+  cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor);
+  cursor.removeSelectedText();
+
+  const QList<LspDiagnostic> diagnostics = store->diagnostics();
+  QCOMPARE(diagnostics.size(), 1);
+  QCOMPARE(diagnostics.first().range.start.line, 1);
+  QCOMPARE(diagnostics.first().range.start.character, 0);
+  QCOMPARE(diagnostics.first().range.end.character, 0);
+}
+
+void TestDecorationStore::testFormatOnlyChangeKeepsPositions() {
+  QTextDocument document("hello world\n");
+  DecorationStore *store = DecorationStore::forDocument(&document);
+  store->setDiagnostics(
+      {makeDiagnostic(0, 6, 11, LspDiagnosticSeverity::Error, "w")});
+
+  document.markContentsDirty(0, document.characterCount());
+
+  const LspDiagnostic diag = store->diagnostics().first();
+  QCOMPARE(diag.range.start.character, 6);
+  QCOMPARE(diag.range.end.character, 11);
+}
+
+void TestDecorationStore::testLineTextsMoveWithLines() {
+  QTextDocument document("void a();\nvoid b();\n");
+  DecorationStore *store = DecorationStore::forDocument(&document);
+  store->setLineTexts(DecorationKind::CodeLens, {{1, "2 references"}});
+
+  QTextCursor cursor(&document);
+  cursor.insertText("\n\n");
+
+  const QTextBlock moved = document.findBlockByNumber(3);
+  const QVector<Decoration> lenses =
+      store->startingIn(DecorationKind::CodeLens, moved.position(),
+                        moved.position() + moved.length() - 1);
+  QCOMPARE(lenses.size(), 1);
+  QCOMPARE(store->text(DecorationKind::CodeLens, lenses.first()),
+           QString("2 references"));
+  QVERIFY(store->isEmpty(DecorationKind::InlineBlame));
+}
+
+void TestDecorationStore::testDeletedLineDropsLineText() {
+  QTextDocument document("a\nb\nc\n");
+  DecorationStore *store = DecorationStore::forDocument(&document);
+  store->setLineTexts(DecorationKind::InlineBlame,
+                      {{0, "first"}, {1, "second"}, {2, "third"}});
+
+  QTextCursor cursor(&document);
+  cursor.setPosition(document.findBlockByNumber(0).position() + 1);
+  cursor.setPosition(document.findBlockByNumber(1).position() + 1,
+                     QTextCursor::KeepAnchor);
+  cursor.removeSelectedText();
+
+  QCOMPARE(store->count(DecorationKind::InlineBlame), 2);
+  const QVector<Decoration> remaining =
+      store->startingIn(DecorationKind::InlineBlame, 0, 100);
+  QCOMPARE(store->text(DecorationKind::InlineBlame, remaining.at(0)),
+           QString("first"));
+  QCOMPARE(store->text(DecorationKind::InlineBlame, remaining.at(1)),
+           QString("third"));
+
+  store->clear(DecorationKind::InlineBlame);
+  QVERIFY(store->isEmpty(DecorationKind::InlineBlame));
+}
+
+void TestDecorationStore::testLargeDiagnosticSet() {
+  QStringList lines;
+  for (int i = 0; i < 5000; ++i) {
+    lines << QString("int value%1 = %1;").arg(i);
+  }
+  QTextDocument document(lines.join('\n'));
+  DecorationStore *store = DecorationStore::forDocument(&document);
+
+  QList<LspDiagnostic> diagnostics;
+  for (int i = 0; i < 5000; ++i) {
+    diagnostics.append(makeDiagnostic(i, 4, 9, LspDiagnosticSeverity::Warning,
+                                      QString::number(i)));
+  }
+  store->setDiagnostics(diagnostics);
+
+  const QTextBlock first = document.findBlockByNumber(2500);
+  const QTextBlock last = document.findBlockByNumber(2509);
+  const QVector<Decoration> visible =
+      store->overlapping(DecorationKind::Diagnostic, first.position(),
+                         last.position() + last.length());
+  QCOMPARE(visible.size(), 10);
+  QCOMPARE(store->diagnostic(visible.first()).message, QString("2500"));
+  QCOMPARE(store->diagnostic(visible.last()).message, QString("2509"));
+}
+
+void TestDecorationStore::testRepeatedEditsKeepPositions() {
+  QStringList lines;
+  for (int i = 0; i < 1000; ++i) {
+    lines << QString("int value%1 = %1;").arg(i);
+  }
+  QTextDocument document(lines.join('\n'));
+  DecorationStore *store = DecorationStore::forDocument(&document);
+
+  QList<LspDiagnostic> diagnostics;
+  QMap<int, QString> texts;
+  for (int i = 0; i < 1000; ++i) {
+    diagnostics.append(makeDiagnostic(i, 4, 9, LspDiagnosticSeverity::Warning,
+                                      QString::number(i)));
+    texts.insert(i, QString::number(i));
+  }
+  store->setDiagnostics(diagnostics);
+  store->setLineTexts(DecorationKind::InlineBlame, texts);
+
+  QTextCursor cursor(&document);
+  for (int i = 0; i < 50; ++i) {
+    cursor.setPosition(document.findBlockByNumber(10).position());
+    cursor.insertText("x");
+  }
+  cursor.setPosition(document.findBlockByNumber(100).position());
+  cursor.setPosition(document.findBlockByNumber(900).position(),
+                     QTextCursor::KeepAnchor);
+  cursor.removeSelectedText();
+
+  const QList<LspDiagnostic> shifted = store->diagnosticsOnLine(10);
+  QCOMPARE(shifted.size(), 1);
+  QCOMPARE(shifted.first().range.start.character, 54);
+
+  const QList<LspDiagnostic> collapsed = store->diagnosticsOnLine(100);
+  QCOMPARE(collapsed.size(), 801);
+  QCOMPARE(collapsed.last().message, QString("900"));
+  QCOMPARE(collapsed.last().range.start.character, 4);
+
+  QCOMPARE(store->count(DecorationKind::InlineBlame), 201);
+  const QTextBlock moved = document.findBlockByNumber(150);
+  const QVector<Decoration> blame =
+      store->startingIn(DecorationKind::InlineBlame, moved.position(),
+                        moved.position() + moved.length() - 1);
+  QCOMPARE(blame.size(), 1);
+  QCOMPARE(store->text(DecorationKind::InlineBlame, blame.first()),
+           QString("950"));
+}
+
+QTEST_MAIN(TestDecorationStore)
+#include "test_decorationstore.moc"
@@ -0,0 +1,82 @@
+#include "core/documentregistry.h"
+#include <QPlainTextEdit>
+#include <QSignalSpy>
+#include <QTextDocument>
+#include <QtTest/QtTest>
+
+class TestDocumentRegistry : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testFirstViewKeepsItsDocument();
+  void testSharedDocumentOutlivesOriginalView();
+  void testUnregisterReleasesDocument();
+  void testReRegisterMovesView();
+};
+
+void TestDocumentRegistry::testFirstViewKeepsItsDocument() {
+  DocumentRegistry registry;
+  QPlainTextEdit view;
+
+  registry.registerView("/tmp/a.cpp", &view);
+  QCOMPARE(registry.viewCount("/tmp/a.cpp"), 1);
+  QCOMPARE(registry.primaryView("/tmp/a.cpp"), &view);
+  QCOMPARE(registry.document("/tmp/a.cpp"), view.document());
+  QVERIFY(view.document()->parent() != &registry);
+  QCOMPARE(registry.filePathForView(&view), QString("/tmp/a.cpp"));
+}
+
+void TestDocumentRegistry::testSharedDocumentOutlivesOriginalView() {
+  DocumentRegistry registry;
+  QSignalSpy released(&registry, &DocumentRegistry::documentReleased);
+  auto *first = new QPlainTextEdit;
+  QPlainTextEdit second;
+  first->setPlainText("shared");
+
+  registry.registerView("/tmp/b.cpp", first);
+  second.setDocument(first->document());
+  registry.registerView("/tmp/b.cpp", &second);
+  QCOMPARE(registry.viewCount("/tmp/b.cpp"), 2);
+  QCOMPARE(first->document()->parent(), &registry);
+
+  delete first;
+  QCOMPARE(registry.viewCount("/tmp/b.cpp"), 1);
+  QCOMPARE(registry.primaryView("/tmp/b.cpp"), &second);
+  QCOMPARE(second.toPlainText(), QString("shared"));
+  QCOMPARE(released.count(), 0);
+
+  second.insertPlainText("!");
+  QCOMPARE(registry.document("/tmp/b.cpp")->toPlainText(),
+           QString("!shared"));
+}
+
+void TestDocumentRegistry::testUnregisterReleasesDocument() {
+  DocumentRegistry registry;
+  QSignalSpy released(&registry, &DocumentRegistry::documentReleased);
+  QPlainTextEdit view;
+
+  registry.registerView("/tmp/c.cpp", &view);
+  registry.unregisterView(&view);
+  QCOMPARE(registry.viewCount("/tmp/c.cpp"), 0);
+  QCOMPARE(registry.primaryView("/tmp/c.cpp"), nullptr);
+  QCOMPARE(registry.document("/tmp/c.cpp"), nullptr);
+  QCOMPARE(released.count(), 1);
+  QCOMPARE(released.first().first().toString(), QString("/tmp/c.cpp"));
+  QVERIFY(view.document());
+}
+
+void TestDocumentRegistry::testReRegisterMovesView() {
+  DocumentRegistry registry;
+  QPlainTextEdit view;
+
+  registry.registerView("/tmp/d.cpp", &view);
+  registry.registerView("/tmp/d.cpp", &view);
+  QCOMPARE(registry.viewCount("/tmp/d.cpp"), 1);
+
+  registry.registerView("/tmp/e.cpp", &view);
+  QCOMPARE(registry.viewCount("/tmp/d.cpp"), 0);
+  QCOMPARE(registry.primaryView("/tmp/e.cpp"), &view);
+}
+
+QTEST_MAIN(TestDocumentRegistry)
+#include "test_documentregistry.moc"
@@ -0,0 +1,179 @@
+#include "core/io/fileloader.h"
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestFileLoader : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testDetectUtf8();
+  void testDetectBom();
+  void testDetectLatin1Fallback();
+  void testDetectLineEndings();
+  void testNormalizeAcrossChunks();
+  void testReadAll();
+  void testStreamingLoad();
+  void testLoadWaitsForAcknowledgement();
+  void testMissingFileFails();
+
+private:
+  static QString writeFile(const QTemporaryDir &dir, const QString &name,
+                           const QByteArray &data);
+};
+
+QString TestFileLoader::writeFile(const QTemporaryDir &dir,
+                                  const QString &name,
+                                  const QByteArray &data) {
+  const QString path = dir.filePath(name);
+  QFile file(path);
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(data);
+  }
+  return path;
+}
+
+void TestFileLoader::testDetectUtf8() {
+  const FileFormat format = FileLoader::detectFormat("h\xC3\xA9llo\n");
+  QVERIFY(format.encoding == QStringConverter::Utf8);
+  QVERIFY(!format.hasBom);
+  QVERIFY(format.lineEnding == FileLineEnding::LF);
+}
+
+void TestFileLoader::testDetectBom() {
+  FileFormat format = FileLoader::detectFormat("\xEF\xBB\xBFtext");
+  QVERIFY(format.encoding == QStringConverter::Utf8);
+  QVERIFY(format.hasBom);
+
+  format = FileLoader::detectFormat(QByteArray("\xFF\xFEt\0\r\0\n\0", 8));
+  QVERIFY(format.encoding == QStringConverter::Utf16LE);
+  QVERIFY(format.lineEnding == FileLineEnding::CRLF);
+
+  format = FileLoader::detectFormat(QByteArray("\xFE\xFF\0t", 4));
+  QVERIFY(format.encoding == QStringConverter::Utf16BE);
+}
+
+void TestFileLoader::testDetectLatin1Fallback() {
+  const FileFormat format = FileLoader::detectFormat("caf\xE9 au lait\n");
+  QVERIFY(format.encoding == QStringConverter::Latin1);
+}
+
+void TestFileLoader::testDetectLineEndings() {
+  QVERIFY(FileLoader::detectFormat("a\r\nb\r\n").lineEnding ==
+          FileLineEnding::CRLF);
+  QVERIFY(FileLoader::detectFormat("a\rb\r").lineEnding == FileLineEnding::CR);
+  QVERIFY(FileLoader::detectFormat("a\nb\r\n").lineEnding ==
+          FileLineEnding::LF);
+}
+
+void TestFileLoader::testNormalizeAcrossChunks() {
+  bool pending = false;
+  QString text = FileLoader::normalizeLineEndings("one\r", &pending, false);
+  QCOMPARE(text, QString("one"));
+  QVERIFY(pending);
+
+  text += FileLoader::normalizeLineEndings("\ntwo\r\n", &pending, false);
+  QCOMPARE(text, QString("one\ntwo\n"));
+  QVERIFY(!pending);
+
+  text += FileLoader::normalizeLineEndings("end\r", &pending, true);
+  QCOMPARE(text, QString("one\ntwo\nend\r"));
+  QVERIFY(!pending);
+}
+
+void TestFileLoader::testReadAll() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path =
+      writeFile(dir, "crlf.txt", "\xEF\xBB\xBFline 1\r\nline 2\r\n");
+
+  QString text;
+  FileFormat format;
+  QVERIFY(FileLoader::readAll(path, &text, &format, nullptr));
+  QCOMPARE(text, QString("line 1\nline 2\n"));
+  QVERIFY(format.hasBom);
+  QVERIFY(format.lineEnding == FileLineEnding::CRLF);
+}
+
+void TestFileLoader::testStreamingLoad() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QByteArray data;
+  QString expected;
+  for (int i = 0; i < 2000; ++i) {
+    data += QString("line %1 \xC3\xA9\r\n").arg(i).toUtf8();
+    expected += QString("line %1 é\n").arg(i);
+  }
+  const QString path = writeFile(dir, "large.txt", data);
+
+  FileLoader loader(path);
+  loader.setChunkSize(1001);
+  QString loaded;
+  int chunks = 0;
+  connect(&loader, &FileLoader::chunkLoaded, this,
+          [&loader, &loaded, &chunks](const QString &text) {
+            loaded += text;
+            ++chunks;
+            loader.acknowledgeChunk();
+          });
+  QSignalSpy finished(&loader, &FileLoader::finished);
+  loader.start();
+
+  QVERIFY(finished.wait(5000));
+  QVERIFY(loader.isFinished());
+  QVERIFY(chunks > 1);
+  QCOMPARE(loaded, expected);
+  QCOMPARE(loader.bytesRead(), qint64(data.size()));
+  QVERIFY(loader.format().lineEnding == FileLineEnding::CRLF);
+}
+
+void TestFileLoader::testLoadWaitsForAcknowledgement() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = writeFile(dir, "slow.txt", QByteArray(20000, 'x'));
+
+  FileLoader loader(path);
+  loader.setChunkSize(1000);
+  int chunks = 0;
+  connect(&loader, &FileLoader::chunkLoaded, this,
+          [&chunks](const QString &) { ++chunks; });
+  QSignalSpy finished(&loader, &FileLoader::finished);
+  loader.start();
+
+  QTRY_COMPARE(chunks, FILE_LOADER_MAX_CHUNKS_IN_FLIGHT);
+  QTest::qWait(100);
+  QCOMPARE(chunks, FILE_LOADER_MAX_CHUNKS_IN_FLIGHT);
+  QVERIFY(!loader.isFinished());
+
+  loader.acknowledgeChunk();
+  QTRY_COMPARE(chunks, FILE_LOADER_MAX_CHUNKS_IN_FLIGHT + 1);
+
+  connect(&loader, &FileLoader::chunkLoaded, &loader,
+          &FileLoader::acknowledgeChunk);
+  for (int i = 0; i < FILE_LOADER_MAX_CHUNKS_IN_FLIGHT; ++i) {
+    loader.acknowledgeChunk();
+  }
+  QVERIFY(finished.wait(5000));
+  QCOMPARE(chunks, 20);
+}
+
+void TestFileLoader::testMissingFileFails() {
+  QTemporaryDir dir;
+  FileLoader loader(dir.filePath("missing.txt"));
+  QSignalSpy failed(&loader, &FileLoader::failed);
+  loader.start();
+
+  QVERIFY(failed.wait(5000));
+  QVERIFY(!loader.isFinished());
+
+  QString text;
+  QString error;
+  QVERIFY(!FileLoader::readAll(dir.filePath("missing.txt"), &text, nullptr,
+                               &error));
+  QVERIFY(!error.isEmpty());
+}
+
+QTEST_MAIN(TestFileLoader)
+#include "test_fileloader.moc"
@@ -0,0 +1,215 @@
+#include "core/io/filesaver.h"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestFileSaver : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testEncodeKeepsLineEndingAndBom();
+  void testEncodeUtf16();
+  void testEncodeFallsBackToUtf8();
+  void testWriteAtomicallyReplacesFile();
+  void testWriteAtomicallyReportsErrors();
+  void testSyncPolicyStrings();
+  void testAsyncSaveReportsResult();
+  void testLastQueuedSaveWins();
+  void testBatchOfSaves();
+  void testWaitForPathReportsOutcome();
+  void testOutcomeIsReleasedOnceDelivered();
+
+private:
+  static QByteArray readFile(const QString &path);
+};
+
+QByteArray TestFileSaver::readFile(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+  return file.readAll();
+}
+
+void TestFileSaver::testEncodeKeepsLineEndingAndBom() {
+  FileFormat format;
+  QCOMPARE(FileSaver::encode("a\nb\n", format), QByteArray("a\nb\n"));
+
+  format.lineEnding = FileLineEnding::CRLF;
+  format.hasBom = true;
+  QCOMPARE(FileSaver::encode("a\nb\n", format),
+           QByteArray("\xEF\xBB\xBF"
+                      "a\r\nb\r\n"));
+
+  format.lineEnding = FileLineEnding::CR;
+  format.hasBom = false;
+  QCOMPARE(FileSaver::encode("a\nb", format), QByteArray("a\rb"));
+}
+
+void TestFileSaver::testEncodeUtf16() {
+  FileFormat format;
+  format.encoding = QStringConverter::Utf16LE;
+  format.hasBom = true;
+  QCOMPARE(FileSaver::encode("t\n", format),
+           QByteArray("\xFF\xFEt\0\n\0", 6));
+}
+
+void TestFileSaver::testEncodeFallsBackToUtf8() {
+  FileFormat format;
+  format.encoding = QStringConverter::Latin1;
+  QCOMPARE(FileSaver::encode(QString::fromUtf8("caf\xC3\xA9"), format),
+           QByteArray("caf\xE9"));
+  QCOMPARE(FileSaver::encode(QString::fromUtf8("\xE2\x82\xAC"), format),
+           QByteArray("\xE2\x82\xAC"));
+}
+
+void TestFileSaver::testWriteAtomicallyReplacesFile() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("file.txt");
+
+  QString error;
+  QVERIFY(FileSaver::writeAtomically(path, "first version", true, &error));
+  QVERIFY(FileSaver::writeAtomically(path, "second", false, &error));
+  QVERIFY(error.isEmpty());
+  QCOMPARE(readFile(path), QByteArray("second"));
+  QCOMPARE(QDir(dir.path()).entryList(QDir::Files | QDir::Hidden).size(), 1);
+}
+
+void TestFileSaver::testWriteAtomicallyReportsErrors() {
+  QTemporaryDir dir;
+  QString error;
+  QVERIFY(!FileSaver::writeAtomically(dir.filePath("missing/file.txt"), "x",
+                                      false, &error));
+  QVERIFY(!error.isEmpty());
+}
+
+void TestFileSaver::testSyncPolicyStrings() {
+  QVERIFY(FileSaver::syncPolicyFromString("never") == SaveSyncPolicy::Never);
+  QVERIFY(FileSaver::syncPolicyFromString("always") ==
+          SaveSyncPolicy::Always);
+  QVERIFY(FileSaver::syncPolicyFromString("bogus") ==
+          SaveSyncPolicy::ExplicitSaves);
+  QCOMPARE(FileSaver::syncPolicyToString(SaveSyncPolicy::ExplicitSaves),
+           QString("explicit"));
+}
+
+void TestFileSaver::testAsyncSaveReportsResult() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  FileSaver &saver = FileSaver::instance();
+  const int completedBefore = saver.completedCount();
+
+  FileSaveRequest request;
+  request.filePath = dir.filePath("async.txt");
+  request.text = "line 1\nline 2\n";
+  request.format.lineEnding = FileLineEnding::CRLF;
+
+  FileSaveResult received;
+  bool called = false;
+  saver.save(request, this,
+             [&received, &called](const FileSaveResult &result) {
+               received = result;
+               called = true;
+             });
+
+  QTRY_VERIFY(called);
+  QVERIFY(received.success);
+  QVERIFY(!received.isAutoSave);
+  QCOMPARE(received.bytesWritten, qint64(16));
+  QVERIFY(received.writeMs >= 0.0);
+  QCOMPARE(saver.completedCount(), completedBefore + 1);
+  QVERIFY(saver.averageLatencyMs() >= 0.0);
+  QCOMPARE(readFile(request.filePath), QByteArray("line 1\r\nline 2\r\n"));
+}
+
+void TestFileSaver::testLastQueuedSaveWins() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  FileSaver &saver = FileSaver::instance();
+
+  FileSaveRequest request;
+  request.filePath = dir.filePath("twice.txt");
+  int calls = 0;
+  auto callback = [&calls](const FileSaveResult &result) {
+    QVERIFY(result.success);
+    ++calls;
+  };
+
+  request.text = "one";
+  saver.save(request, this, callback);
+  request.text = "two";
+  saver.save(request, this, callback);
+  saver.waitForIdle();
+
+  QCOMPARE(calls, 2);
+  QCOMPARE(saver.pendingCount(), 0);
+  QCOMPARE(readFile(request.filePath), QByteArray("two"));
+}
+
+void TestFileSaver::testBatchOfSaves() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  FileSaver &saver = FileSaver::instance();
+
+  int succeeded = 0;
+  for (int i = 0; i < 30; ++i) {
+    FileSaveRequest request;
+    request.filePath = dir.filePath(QString("buffer%1.txt").arg(i));
+    request.text = QString("buffer %1\n").arg(i).repeated(1000);
+    request.isAutoSave = true;
+    saver.save(request, this, [&succeeded](const FileSaveResult &result) {
+      if (result.success && result.isAutoSave) {
+        ++succeeded;
+      }
+    });
+  }
+  saver.waitForIdle();
+
+  QCOMPARE(succeeded, 30);
+  QCOMPARE(readFile(dir.filePath("buffer29.txt")).left(10),
+           QByteArray("buffer 29\n"));
+}
+
+void TestFileSaver::testWaitForPathReportsOutcome() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  FileSaver &saver = FileSaver::instance();
+
+  FileSaveRequest request;
+  request.filePath = dir.filePath("explicit.txt");
+  request.text = "saved";
+  bool delivered = false;
+  saver.save(request, this,
+             [&delivered](const FileSaveResult &) { delivered = true; });
+  QVERIFY(saver.waitForIdle(request.filePath));
+  QVERIFY(delivered);
+  QCOMPARE(readFile(request.filePath), QByteArray("saved"));
+
+  FileSaveRequest missing;
+  missing.filePath = dir.filePath("missing/explicit.txt");
+  missing.text = "lost";
+  saver.save(missing);
+  QVERIFY(!saver.waitForIdle(missing.filePath));
+}
+
+void TestFileSaver::testOutcomeIsReleasedOnceDelivered() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  FileSaver &saver = FileSaver::instance();
+
+  FileSaveRequest request;
+  request.filePath = dir.filePath("released.txt");
+  request.text = "saved";
+  saver.save(request);
+  QVERIFY(saver.waitForIdle(request.filePath));
+  QVERIFY(!saver.waitForIdle(request.filePath));
+
+  saver.save(request);
+  saver.waitForIdle();
+  QVERIFY(!saver.waitForIdle(request.filePath));
+}
+
+QTEST_MAIN(TestFileSaver)
+#include "test_filesaver.moc"
@@ -0,0 +1,80 @@
+#include "completion/fuzzymatcher.h"
+#include <QtTest/QtTest>
+
+class TestFuzzyMatcher : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testEmptyPatternMatchesEverything();
+  void testSubsequenceRequired();
+  void testCaseInsensitiveMatch();
+  void testPrefixBeatsScatteredMatch();
+  void testCamelCaseBoundaryBeatsInnerMatch();
+  void testSnakeCaseBoundaryBeatsInnerMatch();
+  void testConsecutiveRunBeatsGaps();
+  void testExactCaseBreaksTie();
+  void testWordBoundaries();
+};
+
+void TestFuzzyMatcher::testEmptyPatternMatchesEverything() {
+  FuzzyMatcher matcher("");
+  QVERIFY(matcher.matches("anything"));
+  QCOMPARE(matcher.score("anything"), 0);
+}
+
+void TestFuzzyMatcher::testSubsequenceRequired() {
+  FuzzyMatcher matcher("gtv");
+  QVERIFY(matcher.matches("getValue"));
+  QVERIFY(!matcher.matches("vtg"));
+  QCOMPARE(matcher.score("vtg"), FUZZY_NO_MATCH);
+  QCOMPARE(FuzzyMatcher("longer").score("long"), FUZZY_NO_MATCH);
+}
+
+void TestFuzzyMatcher::testCaseInsensitiveMatch() {
+  FuzzyMatcher matcher("SETV");
+  QVERIFY(matcher.matches("setValue"));
+  QVERIFY(matcher.score("setValue") > FUZZY_NO_MATCH);
+}
+
+void TestFuzzyMatcher::testPrefixBeatsScatteredMatch() {
+  FuzzyMatcher matcher("str");
+  QVERIFY(matcher.score("string") > matcher.score("sorter"));
+  QVERIFY(matcher.score("string") > matcher.score("isStr"));
+}
+
+void TestFuzzyMatcher::testCamelCaseBoundaryBeatsInnerMatch() {
+  FuzzyMatcher matcher("gV");
+  QVERIFY(matcher.score("getValue") > matcher.score("grove"));
+
+  FuzzyMatcher acronym("hs");
+  QVERIFY(acronym.score("HTTPServer") > acronym.score("hashes"));
+}
+
+void TestFuzzyMatcher::testSnakeCaseBoundaryBeatsInnerMatch() {
+  FuzzyMatcher matcher("fb");
+  QVERIFY(matcher.score("foo_bar") > matcher.score("fabric"));
+}
+
+void TestFuzzyMatcher::testConsecutiveRunBeatsGaps() {
+  FuzzyMatcher matcher("val");
+  QVERIFY(matcher.score("value") > matcher.score("vertical"));
+}
+
+void TestFuzzyMatcher::testExactCaseBreaksTie() {
+  FuzzyMatcher matcher("val");
+  QVERIFY(matcher.score("value") > matcher.score("Value"));
+}
+
+void TestFuzzyMatcher::testWordBoundaries() {
+  QVERIFY(FuzzyMatcher::isWordBoundary("getValue", 0));
+  QVERIFY(FuzzyMatcher::isWordBoundary("getValue", 3));
+  QVERIFY(!FuzzyMatcher::isWordBoundary("getValue", 4));
+  QVERIFY(FuzzyMatcher::isWordBoundary("foo_bar", 4));
+  QVERIFY(!FuzzyMatcher::isWordBoundary("foo_bar", 3));
+  QVERIFY(FuzzyMatcher::isWordBoundary("HTTPServer", 4));
+  QVERIFY(!FuzzyMatcher::isWordBoundary("HTTPServer", 3));
+  QVERIFY(FuzzyMatcher::isWordBoundary("vec3", 3));
+}
+
+QTEST_MAIN(TestFuzzyMatcher)
+#include "test_fuzzymatcher.moc"
@@ -1,7 +1,9 @@
 #include "git/gitintegration.h"
+#include "git/gitrepositorywatcher.h"
 #include <QDir>
 #include <QFile>
 #include <QProcess>
+#include <QSignalSpy>
 #include <QTemporaryDir>
 #include <QtTest/QtTest>
 
@@ -48,6 +50,10 @@ private slots:
   void testSquashCommits();
   void testMoveCommitToBranch();
 
+  void testRepositoryWatcherReportsExternalChanges();
+  void testRelativeToRepositoryRequiresSeparator();
+  void testHeadBlobLoadsAsynchronously();
+
 private:
   QTemporaryDir m_tempDir;
   QString m_repoPath;
@@ -998,5 +1004,108 @@ void TestGitIntegration::testMoveCommitToBranch() {
   QVERIFY(!git.moveCommitToBranch(moveHash, ""));
 }
 
+void TestGitIntegration::testRepositoryWatcherReportsExternalChanges() {
+  GitIntegration git;
+  QVERIFY(git.setRepositoryPath(m_repoPath));
+  git.setFileSystemWatchingEnabled(true);
+  QVERIFY(git.isFileSystemWatchingEnabled());
+  GitRepositoryWatcher *watcher = git.repositoryWatcher();
+  watcher->setDebounceInterval(60 * 60 * 1000);
+  const QString root = QDir::cleanPath(git.repositoryPath());
+  QVERIFY(watcher->watchedDirectories().contains(root));
+  QVERIFY(watcher->watchedFiles().contains(root + "/initial.txt"));
+
+  QSignalSpy treeSpy(&git, &GitIntegration::workingTreeChanged);
+  QSignalSpy statusSpy(&git, &GitIntegration::statusChanged);
+
+  for (int i = 0; i < 20; ++i) {
+    createTestFile(QString("watched_%1.txt").arg(i), "burst\n");
+  }
+  QTRY_VERIFY_WITH_TIMEOUT(watcher->hasPendingChanges(), 5000);
+  watcher->flush();
+  QCOMPARE(treeSpy.count(), 1);
+  QCOMPARE(statusSpy.count(), 0);
+  QVERIFY(treeSpy.first().first().toStringList().contains(root));
+
+  QList<GitFileInfo> scoped =
+      git.getStatusForPaths({git.repositoryPath() + "/watched_0.txt"});
+  QCOMPARE(scoped.size(), 1);
+  QCOMPARE(scoped.first().workTreeStatus, GitFileStatus::Untracked);
+
+  QVERIFY(QDir(m_repoPath).mkpath("fresh_dir"));
+  QTRY_VERIFY_WITH_TIMEOUT(
+      watcher->watchedDirectories().contains(root + "/fresh_dir"), 5000);
+  watcher->flush();
+  treeSpy.clear();
+  createTestFile("fresh_dir/new.txt", "new\n");
+  QTRY_VERIFY_WITH_TIMEOUT(watcher->hasPendingChanges(), 5000);
+  watcher->flush();
+  QCOMPARE(treeSpy.count(), 1);
+  QVERIFY(treeSpy.first().first().toStringList().contains(root +
+                                                           "/fresh_dir"));
+
+  treeSpy.clear();
+  QFile initial(m_repoPath + "/initial.txt");
+  QVERIFY(initial.open(QIODevice::Append));
+  initial.write("edited in place\n");
+  initial.close();
+  QTRY_VERIFY_WITH_TIMEOUT(watcher->hasPendingChanges(), 5000);
+  watcher->flush();
+  QCOMPARE(treeSpy.count(), 1);
+  QVERIFY(treeSpy.first().first().toStringList().contains(root));
+
+  treeSpy.clear();
+  QVERIFY(runGitCommand({"add", "watched_0.txt"}));
+  QTRY_VERIFY_WITH_TIMEOUT(watcher->hasPendingChanges(), 5000);
+  watcher->flush();
+  QCOMPARE(statusSpy.count(), 1);
+  QCOMPARE(treeSpy.count(), 0);
+
+  runGitCommand({"rm", "--cached", "-q", "watched_0.txt"});
+  runGitCommand({"checkout", "--", "initial.txt"});
+  QDir(m_repoPath + "/fresh_dir").removeRecursively();
+  for (int i = 0; i < 20; ++i) {
+    QFile::remove(m_repoPath + QString("/watched_%1.txt").arg(i));
+  }
+}
+
+void TestGitIntegration::testRelativeToRepositoryRequiresSeparator() {
+  GitIntegration git;
+  QVERIFY(git.setRepositoryPath(m_repoPath));
+
+  QCOMPARE(git.relativeToRepository(m_repoPath + "/initial.txt"),
+           QString("initial.txt"));
+  QCOMPARE(git.relativeToRepository(m_repoPath + "-sibling/initial.txt"),
+           m_repoPath + "-sibling/initial.txt");
+}
+
+void TestGitIntegration::testHeadBlobLoadsAsynchronously() {
+  GitIntegration git;
+  QVERIFY(git.setRepositoryPath(m_repoPath));
+  QSignalSpy blobSpy(&git, &GitIntegration::headBlobLoaded);
+  QSignalSpy headSpy(&git, &GitIntegration::headChanged);
+
+  git.requestHeadBlob(m_repoPath + "/initial.txt");
+  QCOMPARE(blobSpy.count(), 0);
+  QTRY_COMPARE_WITH_TIMEOUT(blobSpy.count(), 1, 5000);
+  QCOMPARE(blobSpy.first().at(0).toString(), QString("initial.txt"));
+  QVERIFY(!blobSpy.first().at(1).toString().isEmpty());
+  QCOMPARE(blobSpy.first().at(2).toString(), QString("Initial content\n"));
+
+  git.requestHeadBlob(m_repoPath + "/initial.txt");
+  QCOMPARE(blobSpy.count(), 2);
+
+  createTestFile("head_tracked.txt", "first\n");
+  QVERIFY(git.stageFile("head_tracked.txt"));
+  QVERIFY(git.commit("Track head file"));
+  QTRY_COMPARE_WITH_TIMEOUT(headSpy.count(), 1, 5000);
+  QCOMPARE(headSpy.first().first().toStringList(),
+           QStringList({"head_tracked.txt"}));
+
+  git.requestHeadBlob(m_repoPath + "/head_tracked.txt");
+  QTRY_COMPARE_WITH_TIMEOUT(blobSpy.count(), 3, 5000);
+  QCOMPARE(blobSpy.last().at(2).toString(), QString("first\n"));
+}
+
 QTEST_MAIN(TestGitIntegration)
 #include "test_gitintegration.moc"
@@ -0,0 +1,153 @@
+#include "git/gitdifftracker.h"
+#include "git/gitlinediff.h"
+#include <QSignalSpy>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtTest/QtTest>
+
+class TestGitLineDiff : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testIdenticalInputsHaveNoHunks();
+  void testPureInsertion();
+  void testPureDeletion();
+  void testModification();
+  void testMultipleHunks();
+  void testSplitLinesStripsCarriageReturn();
+  void testHunkAtLineIncludesContext();
+  void testTrackerFollowsEdits();
+  void testTrackerClearBaseEmitsEmptyDiff();
+};
+
+void TestGitLineDiff::testIdenticalInputsHaveNoHunks() {
+  QStringList lines = {"a", "b", "c"};
+  QVERIFY(GitLineDiff::computeHunks(lines, lines).isEmpty());
+  QVERIFY(GitLineDiff::computeHunks({}, {}).isEmpty());
+}
+
+void TestGitLineDiff::testPureInsertion() {
+  QList<GitLineDiffHunk> hunks =
+      GitLineDiff::computeHunks({"a", "b"}, {"a", "x", "y", "b"});
+  QCOMPARE(hunks.size(), 1);
+  QCOMPARE(hunks[0].oldStart, 1);
+  QCOMPARE(hunks[0].oldCount, 0);
+  QCOMPARE(hunks[0].newStart, 1);
+  QCOMPARE(hunks[0].newCount, 2);
+
+  QList<GitDiffLineInfo> info = GitLineDiff::toDiffLineInfo(hunks);
+  QCOMPARE(info.size(), 2);
+  QCOMPARE(info[0].lineNumber, 2);
+  QCOMPARE(info[0].type, GitDiffLineInfo::Type::Added);
+  QCOMPARE(info[1].lineNumber, 3);
+}
+
+void TestGitLineDiff::testPureDeletion() {
+  QList<GitLineDiffHunk> hunks =
+      GitLineDiff::computeHunks({"a", "b", "c"}, {"a", "c"});
+  QCOMPARE(hunks.size(), 1);
+  QCOMPARE(hunks[0].oldCount, 1);
+  QCOMPARE(hunks[0].newCount, 0);
+
+  QList<GitDiffLineInfo> info = GitLineDiff::toDiffLineInfo(hunks);
+  QCOMPARE(info.size(), 1);
+  QCOMPARE(info[0].lineNumber, 1);
+  QCOMPARE(info[0].type, GitDiffLineInfo::Type::Deleted);
+
+  QList<GitLineDiffHunk> atTop = GitLineDiff::computeHunks({"a", "b"}, {"b"});
+  QCOMPARE(GitLineDiff::toDiffLineInfo(atTop)[0].lineNumber, 1);
+}
+
+void TestGitLineDiff::testModification() {
+  QList<GitLineDiffHunk> hunks =
+      GitLineDiff::computeHunks({"a", "b", "c"}, {"a", "B", "c"});
+  QCOMPARE(hunks.size(), 1);
+  QCOMPARE(hunks[0].oldCount, 1);
+  QCOMPARE(hunks[0].newCount, 1);
+
+  QList<QPair<int, int>> gutter =
+      GitLineDiff::toGutterLines(GitLineDiff::toDiffLineInfo(hunks));
+  QCOMPARE(gutter.size(), 1);
+  QCOMPARE(gutter[0], qMakePair(2, 1));
+}
+
+void TestGitLineDiff::testMultipleHunks() {
+  QStringList oldLines = {"1", "2", "3", "4", "5", "6", "7", "8"};
+  QStringList newLines = {"0", "1", "2", "3", "4", "6", "7", "eight"};
+  QList<GitLineDiffHunk> hunks = GitLineDiff::computeHunks(oldLines, newLines);
+  QCOMPARE(hunks.size(), 3);
+  QCOMPARE(hunks[0].oldCount, 0);
+  QCOMPARE(hunks[0].newCount, 1);
+  QCOMPARE(hunks[1].oldStart, 4);
+  QCOMPARE(hunks[1].newCount, 0);
+  QCOMPARE(hunks[2].oldStart, 7);
+  QCOMPARE(hunks[2].newStart, 7);
+}
+
+void TestGitLineDiff::testSplitLinesStripsCarriageReturn() {
+  QStringList lines = GitLineDiff::splitLines("a\r\nb\n");
+  QCOMPARE(lines, QStringList({"a", "b", ""}));
+}
+
+void TestGitLineDiff::testHunkAtLineIncludesContext() {
+  QStringList oldLines = {"1", "2", "3", "4", "5", "6", "7"};
+  QStringList newLines = {"1", "2", "3", "four", "5", "6", "7"};
+  QList<GitLineDiffHunk> hunks = GitLineDiff::computeHunks(oldLines, newLines);
+
+  GitDiffHunk hunk = GitLineDiff::hunkAtLine(oldLines, newLines, hunks, 4);
+  QCOMPARE(hunk.startLine, 1);
+  QCOMPARE(hunk.lineCount, 7);
+  QCOMPARE(hunk.header, QString("@@ -1,7 +1,7 @@"));
+  QVERIFY(hunk.lines.contains("-4"));
+  QVERIFY(hunk.lines.contains("+four"));
+
+  GitDiffHunk none = GitLineDiff::hunkAtLine(oldLines, newLines, hunks, 1);
+  QVERIFY(none.lines.isEmpty());
+}
+
+void TestGitLineDiff::testTrackerFollowsEdits() {
+  QTextDocument document;
+  document.setPlainText("alpha\nbeta\ngamma");
+
+  GitDiffTracker tracker(&document);
+  QSignalSpy spy(&tracker, &GitDiffTracker::diffChanged);
+  tracker.setBaseText("alpha\nbeta\ngamma");
+  QCOMPARE(spy.count(), 1);
+  QVERIFY(tracker.hunks().isEmpty());
+
+  QTextCursor cursor(document.findBlockByNumber(1));
+  cursor.movePosition(QTextCursor::EndOfBlock);
+  cursor.insertText("!");
+  tracker.flush();
+  QCOMPARE(tracker.gutterLines(), QList<QPair<int, int>>({qMakePair(2, 1)}));
+
+  cursor.insertText("\ninserted");
+  tracker.flush();
+  QList<GitDiffLineInfo> info = tracker.diffLines();
+  QCOMPARE(info.size(), 2);
+  QCOMPARE(info[1].lineNumber, 3);
+
+  cursor.movePosition(QTextCursor::Start);
+  cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+  cursor.insertText("alpha\nbeta\ngamma");
+  tracker.flush();
+  QVERIFY(tracker.hunks().isEmpty());
+}
+
+void TestGitLineDiff::testTrackerClearBaseEmitsEmptyDiff() {
+  QTextDocument document;
+  document.setPlainText("one\ntwo");
+
+  GitDiffTracker tracker(&document);
+  tracker.setBaseText("one");
+  QVERIFY(!tracker.hunks().isEmpty());
+
+  QSignalSpy spy(&tracker, &GitDiffTracker::diffChanged);
+  tracker.clearBase();
+  QCOMPARE(spy.count(), 1);
+  QVERIFY(spy.first().first().value<QList<QPair<int, int>>>().isEmpty());
+  QVERIFY(!tracker.hasBase());
+}
+
+QTEST_MAIN(TestGitLineDiff)
+#include "test_gitlinediff.moc"
@@ -0,0 +1,285 @@
+#include "core/io/hotexitjournal.h"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtTest/QtTest>
+
+class TestHotExitJournal : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testForDocumentReturnsSameJournal();
+  void testUnmodifiedDocumentWritesNothing();
+  void testEditsAreReplayed();
+  void testFormatOnlyChangeIsIgnored();
+  void testSaveRemovesJournal();
+  void testCompactionKeepsText();
+  void testFilePathChangeIsRecorded();
+  void testRecoverSkipsLiveJournals();
+  void testTornRecordIsIgnored();
+  void testDiscardRemovesJournal();
+  void testCleanFileReferencesBase();
+  void testChangedBaseIsRejected();
+  void testEditBeforeBaseHashFallsBackToSnapshot();
+
+private:
+  static QString writeFile(const QTemporaryDir &dir, const QString &text);
+  static QTextDocument *makeDocument(const QString &text, QObject *parent);
+  static void startRecording(QTextDocument *document, HotExitJournal *journal);
+};
+
+QTextDocument *TestHotExitJournal::makeDocument(const QString &text,
+                                                QObject *parent) {
+  auto *document = new QTextDocument(text, parent);
+  document->setModified(false);
+  return document;
+}
+
+QString TestHotExitJournal::writeFile(const QTemporaryDir &dir,
+                                      const QString &text) {
+  const QString filePath = dir.filePath("base.txt");
+  QFile file(filePath);
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(text.toUtf8());
+  }
+  return filePath;
+}
+
+void TestHotExitJournal::startRecording(QTextDocument *document,
+                                        HotExitJournal *journal) {
+  QTextCursor cursor(document);
+  cursor.insertText(">");
+  QTRY_VERIFY(journal->isRecording());
+  journal->flush();
+}
+
+void TestHotExitJournal::testForDocumentReturnsSameJournal() {
+  QTemporaryDir dir;
+  QTextDocument document;
+  HotExitJournal *journal = HotExitJournal::forDocument(&document, dir.path());
+  QVERIFY(journal);
+  QCOMPARE(HotExitJournal::forDocument(&document, dir.path()), journal);
+  QCOMPARE(HotExitJournal::find(&document), journal);
+  QVERIFY(!HotExitJournal::find(nullptr));
+}
+
+void TestHotExitJournal::testUnmodifiedDocumentWritesNothing() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument("clean", this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  QCoreApplication::processEvents();
+
+  QVERIFY(!journal->isRecording());
+  QVERIFY(QDir(dir.path()).entryList(QDir::Files).isEmpty());
+  delete document;
+}
+
+void TestHotExitJournal::testEditsAreReplayed() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument("alpha\nbeta\ngamma", this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  journal->setFilePath("/project/notes.txt");
+  startRecording(document, journal);
+
+  QTextCursor cursor(document);
+  cursor.movePosition(QTextCursor::End);
+  cursor.insertText("\ndelta");
+  cursor.setPosition(1);
+  cursor.setPosition(7, QTextCursor::KeepAnchor);
+  cursor.insertText("ALPHA\nBETA");
+  cursor.setPosition(0);
+  cursor.deleteChar();
+  QVERIFY(journal->pendingEditBytes() > 0);
+
+  RecoveredBuffer buffer;
+  QVERIFY(HotExitJournal::readJournal(journal->journalPath(), &buffer));
+  QCOMPARE(buffer.text, document->toPlainText());
+  QCOMPARE(buffer.filePath, QString("/project/notes.txt"));
+  delete document;
+}
+
+void TestHotExitJournal::testFormatOnlyChangeIsIgnored() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument("some text", this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  startRecording(document, journal);
+
+  const qint64 before = journal->pendingEditBytes();
+  document->markContentsDirty(0, document->characterCount());
+  QCOMPARE(journal->pendingEditBytes(), before);
+  delete document;
+}
+
+void TestHotExitJournal::testSaveRemovesJournal() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument("draft", this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  startRecording(document, journal);
+
+  const QString journalPath = journal->journalPath();
+  QVERIFY(QFile::exists(journalPath));
+  document->setModified(false);
+  QVERIFY(!journal->isRecording());
+  QVERIFY(!QFile::exists(journalPath));
+  delete document;
+}
+
+void TestHotExitJournal::testCompactionKeepsText() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument(QString(), this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  startRecording(document, journal);
+
+  QTextCursor cursor(document);
+  for (int i = 0; i < 200; ++i) {
+    cursor.insertText(QString("line %1\n").arg(i));
+  }
+  const qint64 grown = QFileInfo(journal->journalPath()).size();
+
+  journal->compact();
+  QCOMPARE(journal->pendingEditBytes(), qint64(0));
+  cursor.insertText("tail");
+  journal->flush();
+  QVERIFY(QFileInfo(journal->journalPath()).size() < grown);
+
+  RecoveredBuffer buffer;
+  QVERIFY(HotExitJournal::readJournal(journal->journalPath(), &buffer));
+  QCOMPARE(buffer.text, document->toPlainText());
+  delete document;
+}
+
+void TestHotExitJournal::testFilePathChangeIsRecorded() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument("untitled text", this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  startRecording(document, journal);
+
+  journal->setFilePath("/project/renamed.txt");
+  RecoveredBuffer buffer;
+  QVERIFY(HotExitJournal::readJournal(journal->journalPath(), &buffer));
+  QCOMPARE(buffer.filePath, QString("/project/renamed.txt"));
+  delete document;
+}
+
+void TestHotExitJournal::testRecoverSkipsLiveJournals() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument("unsaved", this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  startRecording(document, journal);
+  const QString journalPath = journal->journalPath();
+  const QString expected = document->toPlainText();
+
+  QVERIFY(HotExitJournal::recover(dir.path()).isEmpty());
+
+  delete document;
+  QVERIFY(QFile::exists(journalPath));
+
+  const QList<RecoveredBuffer> buffers = HotExitJournal::recover(dir.path());
+  QCOMPARE(buffers.size(), 1);
+  QCOMPARE(buffers.first().text, expected);
+  QVERIFY(buffers.first().filePath.isEmpty());
+
+  HotExitJournal::removeJournal(journalPath);
+  QVERIFY(!QFile::exists(journalPath));
+}
+
+void TestHotExitJournal::testTornRecordIsIgnored() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument("before crash", this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  startRecording(document, journal);
+  const QString journalPath = journal->journalPath();
+  const QString expected = document->toPlainText();
+  delete document;
+
+  QFile file(journalPath);
+  QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+  file.write(QByteArray("\x02\x00\x00", 3));
+  file.close();
+
+  RecoveredBuffer buffer;
+  QVERIFY(HotExitJournal::readJournal(journalPath, &buffer));
+  QCOMPARE(buffer.text, expected);
+}
+
+void TestHotExitJournal::testDiscardRemovesJournal() {
+  QTemporaryDir dir;
+  QTextDocument *document = makeDocument("closed tab", this);
+  HotExitJournal *journal = HotExitJournal::forDocument(document, dir.path());
+  startRecording(document, journal);
+  const QString journalPath = journal->journalPath();
+
+  journal->discard();
+  QVERIFY(!QFile::exists(journalPath));
+  QVERIFY(HotExitJournal::recover(dir.path()).isEmpty());
+  delete document;
+}
+
+void TestHotExitJournal::testCleanFileReferencesBase() {
+  QTemporaryDir dir;
+  QString original;
+  for (int i = 0; i < 500; ++i) {
+    original += QString("line %1\n").arg(i);
+  }
+  const QString filePath = writeFile(dir, original);
+  QTextDocument *document = makeDocument(original, this);
+  HotExitJournal *journal =
+      HotExitJournal::forDocument(document, dir.filePath("journals"));
+  journal->setFilePath(filePath);
+  journal->flush();
+
+  QTextCursor cursor(document);
+  cursor.insertText(">");
+  QVERIFY(journal->isRecording());
+  QVERIFY(QFileInfo(journal->journalPath()).size() < original.size() / 10);
+
+  cursor.movePosition(QTextCursor::End);
+  cursor.insertText("tail");
+  RecoveredBuffer buffer;
+  QVERIFY(HotExitJournal::readJournal(journal->journalPath(), &buffer));
+  QCOMPARE(buffer.text, document->toPlainText());
+  QCOMPARE(buffer.filePath, filePath);
+  delete document;
+}
+
+void TestHotExitJournal::testChangedBaseIsRejected() {
+  QTemporaryDir dir;
+  const QString filePath = writeFile(dir, "on disk");
+  QTextDocument *document = makeDocument("on disk", this);
+  HotExitJournal *journal =
+      HotExitJournal::forDocument(document, dir.filePath("journals"));
+  journal->setFilePath(filePath);
+  journal->flush();
+
+  QTextCursor cursor(document);
+  cursor.insertText(">");
+  QVERIFY(journal->isRecording());
+  const QString journalPath = journal->journalPath();
+  delete document;
+
+  writeFile(dir, "changed elsewhere");
+  RecoveredBuffer buffer;
+  QVERIFY(!HotExitJournal::readJournal(journalPath, &buffer));
+}
+
+void TestHotExitJournal::testEditBeforeBaseHashFallsBackToSnapshot() {
+  QTemporaryDir dir;
+  const QString filePath = writeFile(dir, "on disk");
+  QTextDocument *document = makeDocument("on disk", this);
+  HotExitJournal *journal =
+      HotExitJournal::forDocument(document, dir.filePath("journals"));
+  journal->setFilePath(filePath);
+  startRecording(document, journal);
+  const QString journalPath = journal->journalPath();
+  delete document;
+
+  writeFile(dir, "changed elsewhere");
+  RecoveredBuffer buffer;
+  QVERIFY(HotExitJournal::readJournal(journalPath, &buffer));
+  QCOMPARE(buffer.text, QString(">on disk"));
+}
+
+QTEST_MAIN(TestHotExitJournal)
+#include "test_hotexitjournal.moc"
@@ -0,0 +1,227 @@
+#include "completion/identifierindex.h"
+#include "completion/providers/bufferwordcompletionprovider.h"
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtTest/QtTest>
+
+class TestIdentifierIndex : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testTokenize();
+  void testTrieCountsAndRemoval();
+  void testPrefixMatchesRankByFrequency();
+  void testPrefixMatchesIgnoreCase();
+  void testRecencyBreaksTies();
+  void testFuzzyMatches();
+  void testLimitedMatchesKeepBest();
+  void testDocumentEditsUpdateIndex();
+  void testBlockSplitAndMergeKeepCounts();
+  void testDeletedDocumentIsForgotten();
+  void testProviderSkipsTypedWord();
+
+private:
+  static QStringList words(const QList<IdentifierMatch> &matches);
+};
+
+QStringList TestIdentifierIndex::words(const QList<IdentifierMatch> &matches) {
+  QStringList result;
+  for (const IdentifierMatch &match : matches) {
+    result.append(match.word);
+  }
+  return result;
+}
+
+void TestIdentifierIndex::testTokenize() {
+  QCOMPARE(IdentifierIndex::tokenize(
+               "int value_1 = compute(x, 0x1fab) + _privateName; // ab"),
+           QStringList({"int", "value_1", "compute", "_privateName"}));
+  QCOMPARE(IdentifierIndex::tokenize(QString(80, QLatin1Char('a'))),
+           QStringList());
+  QCOMPARE(IdentifierIndex::tokenize("größe über"),
+           QStringList({"größe", "über"}));
+}
+
+void TestIdentifierIndex::testTrieCountsAndRemoval() {
+  IdentifierTrie trie;
+  trie.add("alpha", 1, 1);
+  trie.add("alpha", 1, 1);
+  trie.add("alphabet", 1, 1);
+  QCOMPARE(trie.count("alpha"), 2);
+  QCOMPARE(trie.count("alph"), 0);
+  QCOMPARE(trie.wordCount(), 2);
+
+  trie.add("alpha", -2, 2);
+  QCOMPARE(trie.count("alpha"), 0);
+  QCOMPARE(trie.wordCount(), 1);
+  QCOMPARE(words(trie.prefixMatches("al", 10, 2)), QStringList({"alphabet"}));
+
+  trie.add("missing", -1, 2);
+  QCOMPARE(trie.wordCount(), 1);
+}
+
+void TestIdentifierIndex::testPrefixMatchesRankByFrequency() {
+  IdentifierTrie trie;
+  for (int i = 0; i < 5; ++i) {
+    trie.add("requestCount", 1, 0);
+  }
+  trie.add("requestId", 1, 0);
+  trie.add("requestId", 1, 0);
+  trie.add("response", 1, 0);
+
+  QCOMPARE(words(trie.prefixMatches("req", 10, 1000)),
+           QStringList({"requestCount", "requestId"}));
+  QCOMPARE(words(trie.prefixMatches("re", 1, 1000)),
+           QStringList({"requestCount"}));
+  QVERIFY(trie.prefixMatches("xyz", 10, 1000).isEmpty());
+}
+
+void TestIdentifierIndex::testPrefixMatchesIgnoreCase() {
+  IdentifierTrie trie;
+  trie.add("QString", 1, 0);
+  trie.add("qstrlen", 1, 0);
+  QCOMPARE(words(trie.prefixMatches("qs", 10, 0)),
+           QStringList({"QString", "qstrlen"}));
+  QCOMPARE(words(trie.prefixMatches("QSTRL", 10, 0)),
+           QStringList({"qstrlen"}));
+}
+
+void TestIdentifierIndex::testRecencyBreaksTies() {
+  IdentifierTrie trie;
+  trie.add("oldName", 1, 1);
+  trie.add("newName", 1, 500);
+  const QList<IdentifierMatch> matches = trie.fuzzyMatches("nme", 10, 500);
+  QCOMPARE(words(matches), QStringList({"newName"}));
+
+  trie.add("nameOld", 1, 1);
+  trie.add("nameNew", 1, 500);
+  QCOMPARE(words(trie.prefixMatches("name", 10, 500)),
+           QStringList({"nameNew", "nameOld"}));
+}
+
+void TestIdentifierIndex::testFuzzyMatches() {
+  IdentifierTrie trie;
+  trie.add("getDocumentUri", 1, 0);
+  trie.add("documentUri", 1, 0);
+  trie.add("getDirty", 1, 0);
+
+  QCOMPARE(words(trie.fuzzyMatches("gdu", 10, 0)),
+           QStringList({"getDocumentUri"}));
+  QCOMPARE(words(trie.fuzzyMatches("GDRTY", 10, 0)),
+           QStringList({"getDirty"}));
+  QVERIFY(trie.fuzzyMatches("xdu", 10, 0).isEmpty());
+}
+
+void TestIdentifierIndex::testLimitedMatchesKeepBest() {
+  IdentifierTrie trie;
+  for (int i = 0; i < 2000; ++i) {
+    const QString word = QString("item%1Value").arg(i);
+    trie.add(word, 2 + (i * 7919) % 13, i);
+    if (i % 3 == 0) {
+      trie.add(word, -1, i);
+    }
+  }
+
+  const QList<IdentifierMatch> allPrefix = trie.prefixMatches("it", -1, 2000);
+  QCOMPARE(allPrefix.size(), 2000);
+  QCOMPARE(words(trie.prefixMatches("it", 10, 2000)),
+           words(allPrefix.mid(0, 10)));
+
+  const QList<IdentifierMatch> allFuzzy = trie.fuzzyMatches("i1v", -1, 2000);
+  QVERIFY(allFuzzy.size() > 10);
+  QCOMPARE(words(trie.fuzzyMatches("i1v", 10, 2000)),
+           words(allFuzzy.mid(0, 10)));
+  QVERIFY(trie.prefixMatches("it", 0, 2000).isEmpty());
+}
+
+void TestIdentifierIndex::testDocumentEditsUpdateIndex() {
+  IdentifierIndex &index = IdentifierIndex::instance();
+  QTextDocument document("first_word second_word\nthird_word");
+  index.watchDocument(&document);
+  QVERIFY(index.isWatching(&document));
+  QCOMPARE(index.count("second_word"), 1);
+
+  QTextCursor cursor(&document);
+  cursor.movePosition(QTextCursor::End);
+  cursor.insertText(" second_word");
+  QCOMPARE(index.count("second_word"), 2);
+
+  cursor.movePosition(QTextCursor::StartOfBlock);
+  cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+  cursor.removeSelectedText();
+  QCOMPARE(index.count("third_word"), 0);
+  QCOMPARE(index.count("second_word"), 1);
+
+  document.setPlainText("replaced_text");
+  QCOMPARE(index.count("first_word"), 0);
+  QCOMPARE(index.count("replaced_text"), 1);
+}
+
+void TestIdentifierIndex::testBlockSplitAndMergeKeepCounts() {
+  IdentifierIndex &index = IdentifierIndex::instance();
+  QTextDocument document("alpha_one beta_two\ngamma_three");
+  index.watchDocument(&document);
+
+  QTextCursor cursor(&document);
+  cursor.setPosition(9);
+  cursor.insertText("\n\n");
+  QCOMPARE(index.count("alpha_one"), 1);
+  QCOMPARE(index.count("beta_two"), 1);
+  QCOMPARE(index.count("gamma_three"), 1);
+
+  cursor.setPosition(0);
+  cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+  cursor.insertText("alpha_one\nalpha_one alpha_one");
+  QCOMPARE(index.count("alpha_one"), 3);
+  QCOMPARE(index.count("beta_two"), 0);
+  QCOMPARE(index.count("gamma_three"), 0);
+
+  cursor.setPosition(9);
+  cursor.deleteChar();
+  QCOMPARE(index.count("alpha_one"), 1);
+  QCOMPARE(index.count("alpha_onealpha_one"), 1);
+}
+
+void TestIdentifierIndex::testDeletedDocumentIsForgotten() {
+  IdentifierIndex &index = IdentifierIndex::instance();
+  const int documents = index.documentCount();
+  auto *document = new QTextDocument("ephemeral_identifier");
+  index.watchDocument(document);
+  index.watchDocument(document);
+  QCOMPARE(index.documentCount(), documents + 1);
+  QCOMPARE(index.count("ephemeral_identifier"), 1);
+
+  delete document;
+  QCOMPARE(index.documentCount(), documents);
+  QCOMPARE(index.count("ephemeral_identifier"), 0);
+}
+
+void TestIdentifierIndex::testProviderSkipsTypedWord() {
+  QTextDocument document("handleRequest handleResponse handl");
+  IdentifierIndex::instance().watchDocument(&document);
+
+  BufferWordCompletionProvider provider;
+  QList<CompletionItem> items;
+  const auto collect = [&items](const QList<CompletionItem> &result) {
+    items = result;
+  };
+  CompletionContext context = CompletionContext::createInvoked(
+      "file:///tmp/a.cpp", "cpp", "handl", 0, 0);
+  provider.requestCompletions(context, collect);
+
+  QStringList labels;
+  for (const CompletionItem &item : items) {
+    QCOMPARE(item.providerId, QString("bufferWords"));
+    labels.append(item.label);
+  }
+  QVERIFY(labels.contains("handleRequest"));
+  QVERIFY(labels.contains("handleResponse"));
+  QVERIFY(!labels.contains("handl"));
+
+  context.prefix = "h";
+  provider.requestCompletions(context, collect);
+  QVERIFY(items.isEmpty());
+}
+
+QTEST_MAIN(TestIdentifierIndex)
+#include "test_identifierindex.moc"
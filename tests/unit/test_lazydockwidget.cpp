@@ -0,0 +1,134 @@
+#include "ui/dockutils.h"
+#include "ui/widgets/lazydockwidget.h"
+
+#include <QLabel>
+#include <QMainWindow>
+#include <QSignalSpy>
+#include <QtTest>
+
+class TestLazyDockWidget : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testFactoryIsNotCalledUntilShown();
+  void testShowMaterializesOnce();
+  void testExplicitMaterializeKeepsDockHidden();
+  void testNullFactoryResultKeepsPlaceholder();
+  void testRestoreStateOnlyMaterializesVisibleDocks();
+};
+
+void TestLazyDockWidget::testFactoryIsNotCalledUntilShown() {
+  int calls = 0;
+  LazyDockWidget dock("Debug", [&calls]() {
+    ++calls;
+    return new QLabel("debug");
+  });
+
+  QCOMPARE(calls, 0);
+  QVERIFY(!dock.isMaterialized());
+  QVERIFY(dock.widget());
+  QVERIFY(!qobject_cast<QLabel *>(dock.widget()));
+}
+
+void TestLazyDockWidget::testShowMaterializesOnce() {
+  QMainWindow window;
+  int calls = 0;
+  auto *dock = new LazyDockWidget("Terminal", [&calls]() {
+    ++calls;
+    return new QLabel("terminal");
+  });
+  window.addDockWidget(Qt::BottomDockWidgetArea, dock);
+  QSignalSpy materializedSpy(dock, &LazyDockWidget::materialized);
+
+  window.show();
+  QVERIFY(QTest::qWaitForWindowExposed(&window));
+  QCOMPARE(calls, 1);
+  QVERIFY(dock->isMaterialized());
+  QCOMPARE(materializedSpy.count(), 1);
+
+  auto *label = qobject_cast<QLabel *>(dock->widget());
+  QVERIFY(label);
+  QVERIFY(label->isVisible());
+
+  dock->hide();
+  dock->show();
+  QCOMPARE(calls, 1);
+  QCOMPARE(dock->materialize(), static_cast<QWidget *>(label));
+  QCOMPARE(materializedSpy.count(), 1);
+}
+
+void TestLazyDockWidget::testExplicitMaterializeKeepsDockHidden() {
+  QMainWindow window;
+  auto *dock =
+      new LazyDockWidget("Tests", []() { return new QLabel("tests"); });
+  window.addDockWidget(Qt::BottomDockWidgetArea, dock);
+  dock->hide();
+  window.show();
+  QVERIFY(QTest::qWaitForWindowExposed(&window));
+  QVERIFY(!dock->isMaterialized());
+
+  QWidget *content = dock->materialize();
+  QVERIFY(qobject_cast<QLabel *>(content));
+  QVERIFY(!dock->isVisible());
+
+  dock->show();
+  QVERIFY(content->isVisible());
+}
+
+void TestLazyDockWidget::testNullFactoryResultKeepsPlaceholder() {
+  LazyDockWidget dock("Empty", []() -> QWidget * { return nullptr; });
+  QWidget *placeholder = dock.widget();
+
+  QCOMPARE(dock.materialize(), placeholder);
+  QVERIFY(dock.isMaterialized());
+  QCOMPARE(dock.widget(), placeholder);
+}
+
+void TestLazyDockWidget::testRestoreStateOnlyMaterializesVisibleDocks() {
+  QByteArray savedState;
+  {
+    QMainWindow window;
+    window.setDockOptions(DockUtils::mainWindowDockOptions());
+    QDockWidget terminal("Terminal");
+    terminal.setObjectName("terminalDock");
+    terminal.setWidget(new QWidget(&terminal));
+    QDockWidget debug("Debug");
+    debug.setObjectName("debugDock");
+    debug.setWidget(new QWidget(&debug));
+    window.addDockWidget(Qt::BottomDockWidgetArea, &terminal);
+    window.addDockWidget(Qt::BottomDockWidgetArea, &debug);
+    debug.hide();
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+    savedState = window.saveState();
+  }
+
+  QMainWindow window;
+  window.setDockOptions(DockUtils::mainWindowDockOptions());
+  int terminalCalls = 0;
+  int debugCalls = 0;
+  auto *terminal = new LazyDockWidget("Terminal", [&terminalCalls]() {
+    ++terminalCalls;
+    return new QLabel("terminal");
+  });
+  terminal->setObjectName("terminalDock");
+  auto *debug = new LazyDockWidget("Debug", [&debugCalls]() {
+    ++debugCalls;
+    return new QLabel("debug");
+  });
+  debug->setObjectName("debugDock");
+  window.addDockWidget(Qt::BottomDockWidgetArea, terminal);
+  window.addDockWidget(Qt::BottomDockWidgetArea, debug);
+  terminal->hide();
+  debug->hide();
+
+  window.show();
+  QVERIFY(QTest::qWaitForWindowExposed(&window));
+  QVERIFY(window.restoreState(savedState));
+  QTRY_COMPARE(terminalCalls, 1);
+  QCOMPARE(debugCalls, 0);
+  QVERIFY(!debug->isMaterialized());
+}
+
+QTEST_MAIN(TestLazyDockWidget)
+#include "test_lazydockwidget.moc"
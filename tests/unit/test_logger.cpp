@@ -16,6 +16,12 @@ private slots:
   void testConsoleLoggingEnabled();
   void testFileLogging();
   void testLogLevelFiltering();
+  void testQueueIsBoundedFifo();
+  void testDisabledLevelSkipsFormatting();
+  void testFormatRecord();
+  void testLogFileRotation();
+  void testRotationCountsEncodedBytes();
+  void testConcurrentProducers();
 
 private:
   QTemporaryDir m_tempDir;
@@ -119,5 +125,141 @@ void TestLogger::testLogLevelFiltering() {
   logger.setLogLevel(LogLevel::Info);
 }
 
+void TestLogger::testQueueIsBoundedFifo() {
+  LogQueue queue(5);
+  QCOMPARE(queue.capacity(), 8);
+  QVERIFY(queue.isEmpty());
+
+  for (int i = 0; i < queue.capacity(); ++i) {
+    LogRecord record;
+    record.line = i;
+    QVERIFY(queue.tryPush(std::move(record)));
+  }
+  QVERIFY(!queue.tryPush(LogRecord()));
+
+  LogRecord record;
+  for (int i = 0; i < queue.capacity(); ++i) {
+    QVERIFY(queue.tryPop(&record));
+    QCOMPARE(record.line, i);
+  }
+  QVERIFY(!queue.tryPop(&record));
+  QVERIFY(queue.isEmpty());
+  QVERIFY(queue.tryPush(LogRecord()));
+}
+
+void TestLogger::testDisabledLevelSkipsFormatting() {
+  Logger &logger = Logger::instance();
+  logger.setLogLevel(LogLevel::Warning);
+
+  int evaluations = 0;
+  auto message = [&evaluations]() {
+    ++evaluations;
+    return QString("expensive");
+  };
+  LOG_DEBUG(message());
+  LOG_INFO(message());
+  QCOMPARE(evaluations, 0);
+  QVERIFY(!logger.isEnabled(LogLevel::Info));
+  QVERIFY(logger.isEnabled(LogLevel::Error));
+
+  logger.setConsoleLoggingEnabled(false);
+  LOG_WARNING(message());
+  QCOMPARE(evaluations, 1);
+  logger.flush();
+  logger.setConsoleLoggingEnabled(true);
+  logger.setLogLevel(LogLevel::Info);
+}
+
+void TestLogger::testFormatRecord() {
+  LogRecord record;
+  record.level = LogLevel::Warning;
+  record.timestampMs = QDateTime(QDate(2024, 1, 2), QTime(3, 4, 5, 6))
+                           .toMSecsSinceEpoch();
+  record.file = "/src/App/core/editor.cpp";
+  record.line = 42;
+  record.message = "disk full";
+  QCOMPARE(Logger::formatRecord(record),
+           QString("[2024-01-02 03:04:05.006] [WARN] [editor.cpp:42] "
+                   "disk full"));
+
+  record.file = nullptr;
+  QCOMPARE(Logger::formatRecord(record),
+           QString("[2024-01-02 03:04:05.006] [WARN] disk full"));
+}
+
+void TestLogger::testLogFileRotation() {
+  Logger &logger = Logger::instance();
+  const QString logPath = m_tempDir.path() + "/rotate.log";
+  logger.setConsoleLoggingEnabled(false);
+  logger.setRotation(256, 2);
+  logger.setFileLoggingEnabled(true, logPath);
+
+  for (int i = 0; i < 40; ++i) {
+    logger.info(QString("rotation line %1").arg(i));
+  }
+  logger.setFileLoggingEnabled(false);
+  logger.setRotation(LOG_ROTATE_BYTES, LOG_ROTATED_FILES);
+  logger.setConsoleLoggingEnabled(true);
+
+  QVERIFY(QFile::exists(logPath + ".1"));
+  QVERIFY(QFile::exists(logPath + ".2"));
+  QVERIFY(!QFile::exists(logPath + ".3"));
+  QVERIFY(QFileInfo(logPath).size() < 512);
+
+  QFile logFile(logPath);
+  QVERIFY(logFile.open(QIODevice::ReadOnly));
+  QVERIFY(QString(logFile.readAll()).contains("rotation line 39"));
+}
+
+void TestLogger::testRotationCountsEncodedBytes() {
+  Logger &logger = Logger::instance();
+  const QString logPath = m_tempDir.path() + "/encoded.log";
+  logger.setConsoleLoggingEnabled(false);
+  logger.setRotation(256, 1);
+  logger.setFileLoggingEnabled(true, logPath);
+
+  for (int i = 0; i < 40; ++i) {
+    logger.info(QString(20, QChar(0x4E2D)));
+  }
+  logger.setFileLoggingEnabled(false);
+  logger.setRotation(LOG_ROTATE_BYTES, LOG_ROTATED_FILES);
+  logger.setConsoleLoggingEnabled(true);
+
+  QVERIFY(QFileInfo(logPath).size() < 256 + 128);
+  QVERIFY(QFileInfo(logPath + ".1").size() < 256 + 128);
+}
+
+void TestLogger::testConcurrentProducers() {
+  Logger &logger = Logger::instance();
+  const QString logPath = m_tempDir.path() + "/concurrent.log";
+  const quint64 droppedBefore = logger.droppedCount(LogLevel::Info);
+  logger.setConsoleLoggingEnabled(false);
+  logger.setFileLoggingEnabled(true, logPath);
+
+  constexpr int THREADS = 4;
+  constexpr int MESSAGES = 500;
+  QList<QThread *> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.append(QThread::create([t]() {
+      for (int i = 0; i < MESSAGES; ++i) {
+        LOG_INFO(QString("producer %1 message %2").arg(t).arg(i));
+      }
+    }));
+    threads.last()->start();
+  }
+  for (QThread *thread : threads) {
+    thread->wait();
+    delete thread;
+  }
+  logger.setFileLoggingEnabled(false);
+  logger.setConsoleLoggingEnabled(true);
+
+  QFile logFile(logPath);
+  QVERIFY(logFile.open(QIODevice::ReadOnly));
+  const int lines = QString(logFile.readAll()).count("producer ");
+  const quint64 dropped = logger.droppedCount(LogLevel::Info) - droppedBefore;
+  QCOMPARE(quint64(lines) + dropped, quint64(THREADS * MESSAGES));
+}
+
 QTEST_MAIN(TestLogger)
 #include "test_logger.moc"
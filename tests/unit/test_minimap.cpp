@@ -14,6 +14,9 @@ private slots:
   void testVisibility();
   void testViewportColor();
   void testLineNumberFromClick();
+  void testLevelOfDetailForLargeDocument();
+  void testTilesRenderInBackground();
+  void testMinimapsShareRasterizer();
 
 private:
   QPlainTextEdit *m_editor;
@@ -103,5 +106,52 @@ void TestMinimap::testLineNumberFromClick() {
   QCOMPARE(minimap.sourceEditor(), &editor);
 }
 
+void TestMinimap::testLevelOfDetailForLargeDocument() {
+  Minimap minimap;
+  QPlainTextEdit editor;
+
+  editor.setPlainText("a\nb\nc");
+  minimap.setSourceEditor(&editor);
+  QCOMPARE(minimap.linesPerRow(), 1);
+
+  QString text;
+  for (int i = 0; i < 100000; ++i) {
+    text += "value = 1;\n";
+  }
+  editor.setPlainText(text);
+  QVERIFY(minimap.linesPerRow() > 1);
+}
+
+void TestMinimap::testTilesRenderInBackground() {
+  Minimap minimap;
+  QPlainTextEdit editor;
+
+  editor.setPlainText("int value = 1;\n");
+  minimap.setSourceEditor(&editor);
+  minimap.resize(100, 300);
+
+  const QColor background(30, 30, 30);
+  QTRY_VERIFY(minimap.grab().toImage().pixelColor(3, 1) != background);
+}
+
+void TestMinimap::testMinimapsShareRasterizer() {
+  QPlainTextEdit editor;
+  editor.setPlainText("int value = 1;\n");
+
+  auto *discarded = new Minimap;
+  discarded->setSourceEditor(&editor);
+  discarded->resize(100, 300);
+  discarded->grab();
+
+  Minimap minimap;
+  minimap.setSourceEditor(&editor);
+  minimap.resize(100, 300);
+  minimap.grab();
+  delete discarded;
+
+  const QColor background(30, 30, 30);
+  QTRY_VERIFY(minimap.grab().toImage().pixelColor(3, 1) != background);
+}
+
 QTEST_MAIN(TestMinimap)
 #include "test_minimap.moc"
@@ -1,5 +1,6 @@
 #include "core/editor/multicursor.h"
 #include <QPlainTextEdit>
+#include <QSignalSpy>
 #include <QtTest/QtTest>
 
 class TestMultiCursor : public QObject {
@@ -22,6 +23,10 @@ private slots:
   void testApplyToAllCursors();
   void testLastSelectedWord();
   void testMergeOverlappingCursors();
+  void testInsertTextIsSingleUndoStep();
+  void testDeletePreviousCharAtAllCursors();
+  void testDeleteCharAtAllCursors();
+  void testEditThousandsOfOccurrences();
   void testNullEditor();
 
 private:
@@ -184,6 +189,88 @@ void TestMultiCursor::testMergeOverlappingCursors() {
   QCOMPARE(m_handler->cursorCount(), 1);
 }
 
+void TestMultiCursor::testInsertTextIsSingleUndoStep() {
+  m_editor->setPlainText("ab\nab\nab\n");
+  QTextCursor cursor = m_editor->textCursor();
+  cursor.movePosition(QTextCursor::Start);
+  cursor.movePosition(QTextCursor::Right);
+  m_editor->setTextCursor(cursor);
+  m_handler->addCursorBelow();
+  m_handler->addCursorBelow();
+  QCOMPARE(m_handler->cursorCount(), 3);
+
+  QSignalSpy changes(m_editor->document(), &QTextDocument::contentsChange);
+  m_handler->insertText("X");
+
+  QCOMPARE(m_editor->toPlainText(), QString("aXb\naXb\naXb\n"));
+  QCOMPARE(changes.count(), 1);
+  QCOMPARE(m_handler->cursorCount(), 3);
+  QCOMPARE(m_editor->textCursor().position(), 2);
+  QCOMPARE(m_handler->extraCursors().at(0).position(), 6);
+  QCOMPARE(m_handler->extraCursors().at(1).position(), 10);
+
+  m_editor->document()->undo();
+  QCOMPARE(m_editor->toPlainText(), QString("ab\nab\nab\n"));
+}
+
+void TestMultiCursor::testDeletePreviousCharAtAllCursors() {
+  m_editor->setPlainText("abc\nabc\n");
+  QTextCursor cursor = m_editor->textCursor();
+  cursor.movePosition(QTextCursor::Start);
+  cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, 2);
+  m_editor->setTextCursor(cursor);
+  m_handler->addCursorBelow();
+
+  m_handler->deletePreviousChar();
+
+  QCOMPARE(m_editor->toPlainText(), QString("ac\nac\n"));
+  QCOMPARE(m_editor->textCursor().position(), 1);
+  QCOMPARE(m_handler->extraCursors().first().position(), 4);
+}
+
+void TestMultiCursor::testDeleteCharAtAllCursors() {
+  m_editor->setPlainText("abc\nabc\n");
+  QTextCursor cursor = m_editor->textCursor();
+  cursor.movePosition(QTextCursor::Start);
+  m_editor->setTextCursor(cursor);
+  m_handler->addCursorBelow();
+
+  m_handler->deleteChar();
+
+  QCOMPARE(m_editor->toPlainText(), QString("bc\nbc\n"));
+}
+
+void TestMultiCursor::testEditThousandsOfOccurrences() {
+  QStringList lines;
+  for (int i = 0; i < 5000; ++i) {
+    lines << QString("value = %1;").arg(i);
+  }
+  m_editor->setPlainText(lines.join('\n'));
+  QTextCursor cursor = m_editor->textCursor();
+  cursor.movePosition(QTextCursor::Start);
+  cursor.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor, 5);
+  m_editor->setTextCursor(cursor);
+
+  m_handler->addCursorsToAllOccurrences();
+  QCOMPARE(m_handler->cursorCount(), 5000);
+
+  QSignalSpy changes(m_editor->document(), &QTextDocument::contentsChange);
+  QElapsedTimer timer;
+  timer.start();
+  m_handler->insertText("total");
+  QVERIFY(timer.elapsed() < 2000);
+
+  QCOMPARE(changes.count(), 1);
+  QCOMPARE(m_handler->cursorCount(), 5000);
+  QVERIFY(!m_editor->toPlainText().contains("value"));
+  QCOMPARE(m_editor->document()->findBlockByNumber(4999).text(),
+           QString("total = 4999;"));
+
+  m_editor->document()->undo();
+  QCOMPARE(m_editor->document()->findBlockByNumber(4999).text(),
+           QString("value = 4999;"));
+}
+
 void TestMultiCursor::testNullEditor() {
   MultiCursorHandler nullHandler(nullptr);
 
@@ -195,6 +282,8 @@ void TestMultiCursor::testNullEditor() {
   nullHandler.addCursorAtNextOccurrence();
   nullHandler.addCursorsToAllOccurrences();
   nullHandler.applyToAllCursors([](QTextCursor &) {});
+  nullHandler.insertText("x");
+  nullHandler.deletePreviousChar();
 
   QCOMPARE(nullHandler.cursorCount(), 1);
 }
@@ -0,0 +1,127 @@
+#include "core/profiling/paintprofiler.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestPaintProfiler : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+  void testDisabledRecordsNothing();
+  void testFrameBreakdown();
+  void testCounters();
+  void testChromeTrace();
+  void testWriteChromeTrace();
+};
+
+void TestPaintProfiler::init() {
+  PaintProfiler::instance().reset();
+  PaintProfiler::instance().setTracing(false);
+  PaintProfiler::instance().setEnabled(true);
+}
+
+void TestPaintProfiler::cleanup() {
+  PaintProfiler::instance().setEnabled(false);
+  PaintProfiler::instance().setTracing(false);
+  PaintProfiler::instance().reset();
+}
+
+void TestPaintProfiler::testDisabledRecordsNothing() {
+  PaintProfiler::instance().setEnabled(false);
+  QSignalSpy spy(&PaintProfiler::instance(), &PaintProfiler::frameFinished);
+
+  {
+    PAINT_PROFILE_FRAME("frame");
+    PAINT_PROFILE_SCOPE("inner");
+    PAINT_PROFILE_COUNT("blocks");
+  }
+
+  QCOMPARE(spy.count(), 0);
+  QVERIFY(PaintProfiler::instance().lastFrame().isEmpty());
+  QVERIFY(PaintProfiler::instance().counters().isEmpty());
+}
+
+void TestPaintProfiler::testFrameBreakdown() {
+  QSignalSpy spy(&PaintProfiler::instance(), &PaintProfiler::frameFinished);
+
+  {
+    PAINT_PROFILE_FRAME("frame");
+    {
+      PAINT_PROFILE_SCOPE("inner");
+      QTest::qWait(2);
+    }
+    {
+      PAINT_PROFILE_SCOPE("inner");
+    }
+  }
+
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(PaintProfiler::instance().frameCount(), 1);
+
+  const PaintProfiler::Breakdown frame = PaintProfiler::instance().lastFrame();
+  QCOMPARE(frame.size(), 2);
+  QCOMPARE(frame.at(0).first, QString("frame"));
+  QCOMPARE(frame.at(1).first, QString("inner"));
+  QVERIFY(frame.at(0).second >= frame.at(1).second);
+  QVERIFY(frame.at(1).second > 0);
+
+  PaintProfiler::instance().finishFrame();
+  QVERIFY(PaintProfiler::instance().lastFrame().isEmpty());
+}
+
+void TestPaintProfiler::testCounters() {
+  PAINT_PROFILE_COUNT("blocksHighlighted");
+  PAINT_PROFILE_COUNT("blocksHighlighted");
+  PaintProfiler::instance().addCount("layoutPasses", 5);
+
+  const QHash<QString, qint64> counters = PaintProfiler::instance().counters();
+  QCOMPARE(counters.value("blocksHighlighted"), 2);
+  QCOMPARE(counters.value("layoutPasses"), 5);
+}
+
+void TestPaintProfiler::testChromeTrace() {
+  PaintProfiler::instance().setTracing(true);
+  {
+    PAINT_PROFILE_FRAME("frame");
+    PAINT_PROFILE_COUNT("rehighlights");
+  }
+
+  const QJsonArray events =
+      PaintProfiler::instance().chromeTrace()["traceEvents"].toArray();
+  QCOMPARE(events.size(), 2);
+
+  const QJsonObject scope = events.at(0).toObject();
+  QCOMPARE(scope["name"].toString(), QString("frame"));
+  QCOMPARE(scope["ph"].toString(), QString("X"));
+  QVERIFY(scope.contains("ts"));
+  QVERIFY(scope.contains("dur"));
+
+  const QJsonObject counter = events.at(1).toObject();
+  QCOMPARE(counter["ph"].toString(), QString("C"));
+  QCOMPARE(counter["args"].toObject()["rehighlights"].toInt(), 1);
+}
+
+void TestPaintProfiler::testWriteChromeTrace() {
+  PaintProfiler::instance().setTracing(true);
+  {
+    PAINT_PROFILE_FRAME("frame");
+  }
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("trace.json");
+  QVERIFY(PaintProfiler::instance().writeChromeTrace(path));
+
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+  QVERIFY(document.isObject());
+  QVERIFY(!document.object()["traceEvents"].toArray().isEmpty());
+}
+
+QTEST_MAIN(TestPaintProfiler)
+#include "test_paintprofiler.moc"
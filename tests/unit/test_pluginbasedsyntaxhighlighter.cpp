@@ -31,6 +31,9 @@ private slots:
   void testShellCommentsOverrideKeywords();
   void testShellStringsOverrideKeywords();
   void testPythonMultilineBlocksOverrideKeywords();
+  void testHighlightersShareCompiledRules();
+  void testRuleNamesMapToPaletteStyles();
+  void testCustomRuleFormatKeepsThemeColor();
 };
 
 void TestPluginBasedSyntaxHighlighter::testShellCommentsOverrideKeywords() {
@@ -90,5 +93,79 @@ void TestPluginBasedSyntaxHighlighter::
            theme.keywordFormat_0);
 }
 
+void TestPluginBasedSyntaxHighlighter::testHighlightersShareCompiledRules() {
+  Theme theme;
+  ShellSyntaxPlugin plugin;
+  std::shared_ptr<const CompiledSyntaxRules> rules =
+      CompiledSyntaxRules::compile(plugin);
+  QTextDocument firstDocument;
+  QTextDocument secondDocument;
+  PluginBasedSyntaxHighlighter first(rules, theme, "", &firstDocument);
+  PluginBasedSyntaxHighlighter second(rules, theme, "", &secondDocument);
+
+  QCOMPARE(first.compiledRules().get(), rules.get());
+  QCOMPARE(second.compiledRules().get(), rules.get());
+
+  const QString text = "echo test # if";
+  firstDocument.setPlainText(text);
+  secondDocument.setPlainText(text);
+  first.rehighlight();
+  second.rehighlight();
+  QCOMPARE(formatAt(firstDocument, 0, text.indexOf("if")),
+           formatAt(secondDocument, 0, text.indexOf("if")));
+}
+
+void TestPluginBasedSyntaxHighlighter::testRuleNamesMapToPaletteStyles() {
+  QCOMPARE(CompiledSyntaxRules::classify("keyword_0"), SyntaxStyle::Keyword0);
+  QCOMPARE(CompiledSyntaxRules::classify("Keyword_Secondary"),
+           SyntaxStyle::Keyword1);
+  QCOMPARE(CompiledSyntaxRules::classify("preprocessor"),
+           SyntaxStyle::Keyword0);
+  QCOMPARE(CompiledSyntaxRules::classify("number"), SyntaxStyle::Number);
+  QCOMPARE(CompiledSyntaxRules::classify("quotation"), SyntaxStyle::String);
+  QCOMPARE(CompiledSyntaxRules::classify("comment"), SyntaxStyle::Comment);
+  QCOMPARE(CompiledSyntaxRules::classify("function"), SyntaxStyle::Function);
+  QCOMPARE(CompiledSyntaxRules::classify("scoped_type"), SyntaxStyle::Class);
+  QCOMPARE(CompiledSyntaxRules::classify("operator"), SyntaxStyle::Plain);
+
+  Theme theme;
+  PythonSyntaxPlugin plugin;
+  std::shared_ptr<const CompiledSyntaxRules> rules =
+      CompiledSyntaxRules::compile(plugin);
+  const QVector<QTextCharFormat> palette =
+      PluginBasedSyntaxHighlighter::buildPalette(*rules, theme);
+  QCOMPARE(palette.size(), SYNTAX_STYLE_COUNT);
+  const QTextCharFormat keyword =
+      palette.at(static_cast<int>(SyntaxStyle::Keyword0));
+  QCOMPARE(keyword.foreground().color(), theme.keywordFormat_0);
+  QCOMPARE(keyword.fontWeight(), int(QFont::Bold));
+  QVERIFY(palette.at(static_cast<int>(SyntaxStyle::Function)).fontItalic());
+}
+
+void TestPluginBasedSyntaxHighlighter::testCustomRuleFormatKeepsThemeColor() {
+  class UnderlinedPlugin : public ShellSyntaxPlugin {
+  public:
+    QVector<SyntaxRule> syntaxRules() const override {
+      SyntaxRule rule;
+      rule.pattern = QRegularExpression("\\btodo\\b");
+      rule.name = "comment";
+      rule.format.setFontUnderline(true);
+      return {rule};
+    }
+  };
+
+  Theme theme;
+  UnderlinedPlugin plugin;
+  QTextDocument document;
+  PluginBasedSyntaxHighlighter highlighter(&plugin, theme, "", &document);
+  QCOMPARE(highlighter.compiledRules()->paletteSize(), SYNTAX_STYLE_COUNT + 1);
+
+  document.setPlainText("a todo");
+  highlighter.rehighlight();
+  const QTextCharFormat format = formatAt(document, 0, 2);
+  QVERIFY(format.fontUnderline());
+  QCOMPARE(format.foreground().color(), theme.singleLineCommentFormat);
+}
+
 QTEST_MAIN(TestPluginBasedSyntaxHighlighter)
 #include "test_pluginbasedsyntaxhighlighter.moc"
@@ -1,6 +1,8 @@
 #include "settings/settingsmanager.h"
 #include <QCoreApplication>
 #include <QDir>
+#include <QFile>
+#include <QJsonDocument>
 #include <QStandardPaths>
 #include <QTemporaryDir>
 #include <QtTest/QtTest>
@@ -19,6 +21,11 @@ private slots:
   void testHasKey();
   void testResetToDefaults();
   void testLoadSaveSettings();
+  void testSettingKeyIsAffectedBy();
+  void testTypedSettingTracksChanges();
+  void testVersionsArePerKey();
+  void testSubscribeFiltersByKey();
+  void testRequestSaveIsDebounced();
 
 private:
   QTemporaryDir m_tempDir;
@@ -159,5 +166,116 @@ void TestSettingsManager::testLoadSaveSettings() {
   sm.saveSettings();
 }
 
+void TestSettingsManager::testSettingKeyIsAffectedBy() {
+  const SettingKey key("diagnostics.debounceMs");
+  QCOMPARE(key.segments(), QStringList({"diagnostics", "debounceMs"}));
+  QVERIFY(key.isAffectedBy(QString()));
+  QVERIFY(key.isAffectedBy("diagnostics"));
+  QVERIFY(key.isAffectedBy("diagnostics.debounceMs"));
+  QVERIFY(key.isAffectedBy("diagnostics.debounceMs.extra"));
+  QVERIFY(!key.isAffectedBy("diagnostics.onType"));
+  QVERIFY(!key.isAffectedBy("diag"));
+  QVERIFY(!key.isAffectedBy("diagnostics.debounce"));
+}
+
+void TestSettingsManager::testTypedSettingTracksChanges() {
+  SettingsManager &sm = SettingsManager::instance();
+  sm.resetToDefaults();
+
+  Setting<int> debounceMs("diagnostics.debounceMs", 0);
+  Setting<bool> onType("diagnostics.onType", false);
+  Setting<QString> missing("missing.key", "fallback");
+  QCOMPARE(debounceMs.value(), 200);
+  QCOMPARE(onType.value(), true);
+  QCOMPARE(missing.value(), QString("fallback"));
+
+  sm.setValue("diagnostics.debounceMs", 50);
+  QCOMPARE(debounceMs.value(), 50);
+
+  onType.setValue(false);
+  QCOMPARE(sm.getValue("diagnostics.onType").toBool(), false);
+  QCOMPARE(onType.value(), false);
+
+  sm.resetToDefaults();
+  QCOMPARE(debounceMs.value(), 200);
+  QCOMPARE(onType.value(), true);
+}
+
+void TestSettingsManager::testVersionsArePerKey() {
+  SettingsManager &sm = SettingsManager::instance();
+  sm.resetToDefaults();
+
+  const SettingKey onType("diagnostics.onType");
+  const SettingKey debounceMs("diagnostics.debounceMs");
+  const SettingKey diagnostics("diagnostics");
+  const quint64 onTypeVersion = sm.version(onType);
+  const quint64 diagnosticsVersion = sm.version(diagnostics);
+
+  sm.setValue("diagnostics.debounceMs", 75);
+  QCOMPARE(sm.version(onType), onTypeVersion);
+  QVERIFY(sm.version(debounceMs) > onTypeVersion);
+  QVERIFY(sm.version(diagnostics) > diagnosticsVersion);
+
+  const quint64 debounceVersion = sm.version(debounceMs);
+  sm.setValue("diagnostics", QVariantMap{{"onType", false}});
+  QVERIFY(sm.version(onType) > onTypeVersion);
+  QVERIFY(sm.version(debounceMs) > debounceVersion);
+
+  const quint64 beforeReset = sm.version(onType);
+  sm.resetToDefaults();
+  QVERIFY(sm.version(onType) > beforeReset);
+}
+
+void TestSettingsManager::testSubscribeFiltersByKey() {
+  SettingsManager &sm = SettingsManager::instance();
+  QObject context;
+  int notifications = 0;
+  sm.subscribe(SettingKey("diagnostics.onSave"), &context,
+               [&notifications]() { ++notifications; });
+
+  sm.setValue("diagnostics.onType", false);
+  QCOMPARE(notifications, 0);
+  sm.setValue("diagnostics.onSave", false);
+  QCOMPARE(notifications, 1);
+  sm.resetToDefaults();
+  QCOMPARE(notifications, 2);
+}
+
+void TestSettingsManager::testRequestSaveIsDebounced() {
+  SettingsManager &sm = SettingsManager::instance();
+  QVERIFY(sm.saveSettings());
+  QSignalSpy savedSpy(&sm, &SettingsManager::settingsSaved);
+
+  sm.setValue("testDebounced", 1);
+  sm.requestSave();
+  sm.setValue("testDebounced", 2);
+  sm.requestSave();
+  QVERIFY(sm.hasPendingSave());
+  QCOMPARE(savedSpy.count(), 0);
+
+  QTRY_VERIFY(!sm.hasPendingSave());
+  QCOMPARE(savedSpy.count(), 1);
+
+  QFile file(sm.getSettingsFilePath());
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  const QJsonObject saved = QJsonDocument::fromJson(file.readAll()).object();
+  QCOMPARE(saved.value("testDebounced").toInt(), 2);
+  file.close();
+
+  sm.setValue("testDebounced", 3);
+  sm.requestSave();
+  sm.flushPendingSave();
+  QVERIFY(!sm.hasPendingSave());
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QCOMPARE(QJsonDocument::fromJson(file.readAll())
+               .object()
+               .value("testDebounced")
+               .toInt(),
+           3);
+
+  sm.resetToDefaults();
+  sm.saveSettings();
+}
+
 QTEST_MAIN(TestSettingsManager)
 #include "test_settingsmanager.moc"
@@ -5,6 +5,7 @@
 #include "ui/mainwindow.h"
 #include "ui/panels/spliteditorcontainer.h"
 
+#include <QJsonObject>
 #include <QSignalSpy>
 #include <QSplitter>
 #include <QtTest>
@@ -199,6 +200,7 @@ private slots:
   void testFocusEventUpdatesCurrentGroup();
   void testSnapshotNotEmpty();
   void testTabThemeUsesThemeDrivenColors();
+  void testDeferredTabMaterializesOnDemand();
 
 private:
   QSplitter *findRootSplitter(SplitEditorContainer &container);
@@ -341,5 +343,41 @@ void TestSplitEditorContainer::testTabThemeUsesThemeDrivenColors() {
   QVERIFY(!closeButton->styleSheet().contains("#e81123"));
 }
 
+void TestSplitEditorContainer::testDeferredTabMaterializesOnDemand() {
+  MainWindow window;
+  LightpadTabWidget tabWidget;
+  tabWidget.setMainWindow(&window);
+  QCOMPARE(tabWidget.count(), 2);
+
+  QJsonObject sessionState;
+  sessionState["cursorPosition"] = 42;
+  tabWidget.addDeferredTab("/project/a.cpp", sessionState);
+  tabWidget.addDeferredTab("/project/b.cpp", QJsonObject());
+
+  QCOMPARE(tabWidget.count(), 4);
+  QCOMPARE(tabWidget.currentIndex(), 0);
+  QVERIFY(tabWidget.isDeferredTab(1));
+  QVERIFY(tabWidget.getPage(1) == nullptr);
+  QCOMPARE(tabWidget.getFilePath(1), QString("/project/a.cpp"));
+  QCOMPARE(tabWidget.tabText(1), QString("a.cpp"));
+  QCOMPARE(tabWidget.deferredTabState(1).value("cursorPosition").toInt(), 42);
+
+  tabWidget.setCurrentIndex(1);
+  QSignalSpy currentSpy(&tabWidget, &QTabWidget::currentChanged);
+  LightpadPage *page = tabWidget.materializeTab(1);
+
+  QVERIFY(page != nullptr);
+  QCOMPARE(tabWidget.getPage(1), page);
+  QCOMPARE(tabWidget.currentIndex(), 1);
+  QVERIFY(!tabWidget.isDeferredTab(1));
+  QCOMPARE(tabWidget.count(), 4);
+  QCOMPARE(currentSpy.count(), 0);
+
+  tabWidget.removeTab(2);
+  QCOMPARE(tabWidget.count(), 3);
+  QVERIFY(!tabWidget.isDeferredTab(2));
+  QCOMPARE(tabWidget.currentIndex(), 1);
+}
+
 QTEST_MAIN(TestSplitEditorContainer)
 #include "test_spliteditorcontainer.moc"
@@ -0,0 +1,159 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+
+namespace {
+constexpr int BENCH_RUNS = 3;
+constexpr int BENCH_PROCESS_TIMEOUT_MS = 30000;
+constexpr int BENCH_SESSION_TABS = 40;
+constexpr int BENCH_SESSION_FILE_LINES = 2000;
+constexpr double BENCH_FIRST_PAINT_BUDGET_MS = 2500.0;
+constexpr double BENCH_INTERACTIVE_BUDGET_MS = 3000.0;
+
+double budget(const char *variable, double fallback) {
+  bool ok = false;
+  const double value = qEnvironmentVariable(variable).toDouble(&ok);
+  return ok && value > 0 ? value : fallback;
+}
+
+double median(QList<double> values) {
+  std::sort(values.begin(), values.end());
+  return values.at(values.size() / 2);
+}
+
+bool writeSession(const QString &home, const QString &projectDir) {
+  QJsonArray openTabs;
+  for (int i = 0; i < BENCH_SESSION_TABS; ++i) {
+    const QString filePath =
+        QDir(projectDir).filePath(QString("module_%1.cpp").arg(i));
+    QFile source(filePath);
+    if (!source.open(QIODevice::WriteOnly)) {
+      return false;
+    }
+    for (int line = 0; line < BENCH_SESSION_FILE_LINES; ++line) {
+      source.write(QString("int function_%1_%2(int value) { return value * "
+                           "%2; }\n")
+                       .arg(i)
+                       .arg(line)
+                       .toUtf8());
+    }
+    QJsonObject tab;
+    tab["path"] = filePath;
+    openTabs.append(tab);
+  }
+
+  QJsonObject settings;
+  settings["openTabs"] = openTabs;
+  settings["currentFilePath"] = openTabs.last().toObject().value("path");
+
+  const QString configDir = QDir(home).filePath(".config/Lightpad/Lightpad");
+  QFile file(QDir(configDir).filePath("settings.json"));
+  return QDir().mkpath(configDir) && file.open(QIODevice::WriteOnly) &&
+         file.write(QJsonDocument(settings).toJson()) > 0;
+}
+} // namespace
+
+class TestStartupBenchmark : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testColdStart_data();
+  void testColdStart();
+
+private:
+  static bool runOnce(const QString &home, const QString &tracePath,
+                      QJsonObject *otherData);
+};
+
+bool TestStartupBenchmark::runOnce(const QString &home,
+                                   const QString &tracePath,
+                                   QJsonObject *otherData) {
+  QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+  environment.insert("HOME", home);
+  environment.insert("XDG_CONFIG_HOME", QDir(home).filePath(".config"));
+  environment.insert("XDG_DATA_HOME", QDir(home).filePath(".local/share"));
+  environment.insert("XDG_CACHE_HOME", QDir(home).filePath(".cache"));
+  environment.insert("QT_QPA_PLATFORM", "offscreen");
+
+  QFile::remove(tracePath);
+  QProcess process;
+  process.setProcessEnvironment(environment);
+  process.setWorkingDirectory(home);
+  process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  process.start(LIGHTPAD_EXECUTABLE, {"--trace-startup=" + tracePath,
+                                      "--quit-after-startup"});
+  if (!process.waitForFinished(BENCH_PROCESS_TIMEOUT_MS)) {
+    process.kill();
+    process.waitForFinished();
+    return false;
+  }
+
+  QFile file(tracePath);
+  if (process.exitCode() != 0 || !file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  const QJsonObject trace = QJsonDocument::fromJson(file.readAll()).object();
+  *otherData = trace.value("otherData").toObject();
+  return otherData->contains("firstPaintMs") &&
+         otherData->contains("interactiveMs");
+}
+
+void TestStartupBenchmark::testColdStart_data() {
+  QTest::addColumn<bool>("restoreSession");
+  QTest::newRow("empty-profile") << false;
+  QTest::newRow("restored-session") << true;
+}
+
+void TestStartupBenchmark::testColdStart() {
+  QFETCH(bool, restoreSession);
+  if (!QFileInfo(LIGHTPAD_EXECUTABLE).isExecutable()) {
+    QSKIP("Lightpad executable has not been built");
+  }
+
+  QList<double> firstPaint;
+  QList<double> interactive;
+  for (int run = 0; run < BENCH_RUNS; ++run) {
+    QTemporaryDir home;
+    QTemporaryDir project;
+    QVERIFY(home.isValid() && project.isValid());
+    if (restoreSession) {
+      QVERIFY(writeSession(home.path(), project.path()));
+    }
+
+    QJsonObject otherData;
+    QVERIFY2(runOnce(home.path(), home.filePath("trace.json"), &otherData),
+             "Lightpad did not produce a startup trace");
+    firstPaint.append(otherData.value("firstPaintMs").toDouble());
+    interactive.append(otherData.value("interactiveMs").toDouble());
+  }
+
+  const double firstPaintMs = median(firstPaint);
+  const double interactiveMs = median(interactive);
+  const double firstPaintBudget = budget("LIGHTPAD_BENCH_FIRST_PAINT_MS",
+                                         BENCH_FIRST_PAINT_BUDGET_MS);
+  const double interactiveBudget = budget("LIGHTPAD_BENCH_INTERACTIVE_MS",
+                                          BENCH_INTERACTIVE_BUDGET_MS);
+  qInfo().noquote() << QString("startup/%1: first paint=%2 ms "
+                               "interactive=%3 ms (median of %4)")
+                           .arg(QString::fromLatin1(QTest::currentDataTag()))
+                           .arg(firstPaintMs, 0, 'f', 1)
+                           .arg(interactiveMs, 0, 'f', 1)
+                           .arg(BENCH_RUNS);
+
+  QVERIFY(interactiveMs >= firstPaintMs);
+  QVERIFY2(firstPaintMs <= firstPaintBudget,
+           qPrintable(QString("%1 ms to first paint").arg(firstPaintMs)));
+  QVERIFY2(interactiveMs <= interactiveBudget,
+           qPrintable(QString("%1 ms to interactive").arg(interactiveMs)));
+}
+
+QTEST_MAIN(TestStartupBenchmark)
+#include "test_startupbenchmark.moc"
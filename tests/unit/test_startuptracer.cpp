@@ -0,0 +1,172 @@
+#include "core/profiling/startuptracer.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QWidget>
+#include <QtTest/QtTest>
+
+class TestStartupTracer : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+  void testConfigureParsesFlags();
+  void testStripArguments();
+  void testDisabledTracerRecordsNothing();
+  void testScopeRecordsPhase();
+  void testTimelineNestsPhases();
+  void testChromeTraceEvents();
+  void testFirstPaintReachesInteractive();
+
+private:
+  static QStringList timelineLines();
+};
+
+QStringList TestStartupTracer::timelineLines() {
+  return StartupTracer::instance().timeline().split('\n');
+}
+
+void TestStartupTracer::init() {
+  StartupTracer &tracer = StartupTracer::instance();
+  tracer.configure({});
+  tracer.reset();
+}
+
+void TestStartupTracer::cleanup() {
+  StartupTracer &tracer = StartupTracer::instance();
+  tracer.configure({});
+  tracer.reset();
+}
+
+void TestStartupTracer::testConfigureParsesFlags() {
+  StartupTracer &tracer = StartupTracer::instance();
+  tracer.configure({"lightpad", "--trace-startup=/tmp/trace.json", "a.txt"});
+  QVERIFY(tracer.isEnabled());
+  QVERIFY(!tracer.quitAfterStartup());
+  QCOMPARE(tracer.tracePath(), QString("/tmp/trace.json"));
+
+  tracer.configure({"lightpad", "--trace-startup"});
+  QCOMPARE(tracer.tracePath(), StartupTracer::defaultTracePath());
+
+  tracer.configure({"lightpad", "--quit-after-startup"});
+  QVERIFY(tracer.isEnabled());
+  QVERIFY(tracer.quitAfterStartup());
+
+  tracer.configure({"lightpad", "a.txt"});
+  QVERIFY(!tracer.isEnabled());
+  QVERIFY(!tracer.quitAfterStartup());
+  QVERIFY(tracer.tracePath().isEmpty());
+}
+
+void TestStartupTracer::testStripArguments() {
+  const QStringList stripped = StartupTracer::stripArguments(
+      {"a.txt", "--trace-startup", "--trace-startup=/tmp/t.json",
+       "--quit-after-startup", "b.txt", "--trace-startups"});
+  QCOMPARE(stripped, QStringList({"a.txt", "b.txt", "--trace-startups"}));
+}
+
+void TestStartupTracer::testDisabledTracerRecordsNothing() {
+  StartupTracer &tracer = StartupTracer::instance();
+  {
+    STARTUP_TRACE_SCOPE("ignored");
+  }
+  tracer.mark(STARTUP_FIRST_PAINT_MARK);
+  QVERIFY(tracer.phases().isEmpty());
+  QCOMPARE(tracer.markNanoseconds(STARTUP_FIRST_PAINT_MARK), qint64(-1));
+}
+
+void TestStartupTracer::testScopeRecordsPhase() {
+  StartupTracer &tracer = StartupTracer::instance();
+  tracer.setEnabled(true);
+  {
+    STARTUP_TRACE_SCOPE("outer");
+    STARTUP_TRACE_SCOPE("inner");
+    QTest::qWait(5);
+  }
+
+  const QList<StartupPhase> phases = tracer.phases();
+  QCOMPARE(phases.size(), 2);
+  QCOMPARE(QByteArray(phases.at(0).name), QByteArray("inner"));
+  QCOMPARE(QByteArray(phases.at(1).name), QByteArray("outer"));
+  QVERIFY(phases.at(0).durationNs > 0);
+  QVERIFY(phases.at(1).startNs <= phases.at(0).startNs);
+  QVERIFY(phases.at(1).durationNs >= phases.at(0).durationNs);
+}
+
+void TestStartupTracer::testTimelineNestsPhases() {
+  StartupTracer &tracer = StartupTracer::instance();
+  tracer.setEnabled(true);
+  tracer.recordPhase("inner", 10000000, 20000000);
+  tracer.recordPhase("outer", 0, 100000000);
+  tracer.recordPhase("next", 200000000, 5000000);
+
+  const QStringList lines = timelineLines();
+  QCOMPARE(lines.size(), 3);
+  QVERIFY(lines.at(0).startsWith("outer  100.0 ms"));
+  QVERIFY(lines.at(1).startsWith("  inner  20.0 ms"));
+  QVERIFY(lines.at(2).startsWith("next  5.0 ms"));
+}
+
+void TestStartupTracer::testChromeTraceEvents() {
+  StartupTracer &tracer = StartupTracer::instance();
+  tracer.setEnabled(true);
+  tracer.recordPhase("MainWindow", 1000000, 3000000);
+  tracer.mark(STARTUP_FIRST_PAINT_MARK);
+
+  const QJsonObject trace = tracer.chromeTrace();
+  const QJsonArray events = trace.value("traceEvents").toArray();
+  QCOMPARE(events.size(), 2);
+
+  const QJsonObject phase = events.at(0).toObject();
+  QCOMPARE(phase.value("name").toString(), QString("MainWindow"));
+  QCOMPARE(phase.value("ph").toString(), QString("X"));
+  QCOMPARE(phase.value("ts").toDouble(), 1000.0);
+  QCOMPARE(phase.value("dur").toDouble(), 3000.0);
+
+  const QJsonObject mark = events.at(1).toObject();
+  QCOMPARE(mark.value("name").toString(), QString("first-paint"));
+  QCOMPARE(mark.value("ph").toString(), QString("i"));
+
+  const QJsonObject otherData = trace.value("otherData").toObject();
+  QVERIFY(otherData.contains("firstPaintMs"));
+  QVERIFY(!otherData.contains("interactiveMs"));
+}
+
+void TestStartupTracer::testFirstPaintReachesInteractive() {
+  QTemporaryDir dir;
+  const QString tracePath = dir.filePath("trace.json");
+  StartupTracer &tracer = StartupTracer::instance();
+  tracer.configure({"lightpad", "--trace-startup=" + tracePath});
+  tracer.reset();
+
+  QWidget window;
+  window.resize(200, 100);
+  tracer.watchWindow(&window);
+  QSignalSpy interactiveSpy(&tracer, &StartupTracer::interactive);
+  {
+    STARTUP_TRACE_SCOPE("show");
+    window.show();
+  }
+
+  QTRY_COMPARE(interactiveSpy.count(), 1);
+  QVERIFY(!tracer.isEnabled());
+  const qint64 firstPaint = tracer.markNanoseconds(STARTUP_FIRST_PAINT_MARK);
+  const qint64 interactive = tracer.markNanoseconds(STARTUP_INTERACTIVE_MARK);
+  QVERIFY(firstPaint >= 0);
+  QVERIFY(interactive >= firstPaint);
+
+  QFile file(tracePath);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  const QJsonObject otherData = QJsonDocument::fromJson(file.readAll())
+                                    .object()
+                                    .value("otherData")
+                                    .toObject();
+  QVERIFY(otherData.value("interactiveMs").toDouble() >=
+          otherData.value("firstPaintMs").toDouble());
+}
+
+QTEST_MAIN(TestStartupTracer)
+#include "test_startuptracer.moc"
@@ -39,6 +39,7 @@ private slots:
   void testIsLanguageSupported();
   void testIsExtensionSupported();
   void testPluginReplacement();
+  void testCompiledRulesAreSharedPerLanguage();
   void testAllBuiltInPlugins();
   void testCppPreprocessorAndScopePatterns();
   void testLanguageCatalogIncludesLatex();
@@ -191,6 +192,31 @@ void TestSyntaxPluginRegistry::testPluginReplacement() {
   QCOMPARE(registry.getAllLanguageIds().size(), 1);
 }
 
+void TestSyntaxPluginRegistry::testCompiledRulesAreSharedPerLanguage() {
+  auto &registry = SyntaxPluginRegistry::instance();
+  QVERIFY(!registry.compiledRules("cpp"));
+
+  registry.registerPlugin(std::make_unique<CppSyntaxPlugin>());
+  std::shared_ptr<const CompiledSyntaxRules> first =
+      registry.compiledRules("cpp");
+  QVERIFY(first);
+  QCOMPARE(first->languageId, QString("cpp"));
+  QCOMPARE(first->ruleCount(),
+           static_cast<int>(
+               registry.getPluginByLanguageId("cpp")->syntaxRules().size()));
+  QCOMPARE(registry.compiledRules("cpp").get(), first.get());
+
+  registry.registerPlugin(std::make_unique<CppSyntaxPlugin>());
+  std::shared_ptr<const CompiledSyntaxRules> replaced =
+      registry.compiledRules("cpp");
+  QVERIFY(replaced);
+  QVERIFY(replaced.get() != first.get());
+
+  registry.clear();
+  QVERIFY(!registry.compiledRules("cpp"));
+  QVERIFY(first->ruleCount() > 0);
+}
+
 void TestSyntaxPluginRegistry::testAllBuiltInPlugins() {
   auto &registry = SyntaxPluginRegistry::instance();
 
@@ -2,15 +2,39 @@
 #include "ui/panels/shellprofile.h"
 #include "ui/panels/terminal.h"
 #undef private
+#ifndef Q_OS_WIN
+#include "ui/panels/terminalpty.h"
+#endif
+#include "ui/panels/terminalscreen.h"
+#include "ui/panels/terminalscreenview.h"
 #include "theme/themeengine.h"
 #include <QDir>
 #include <QLabel>
 #include <QMenu>
 #include <QPlainTextEdit>
 #include <QSignalSpy>
+#include <QTextBlock>
 #include <QToolButton>
 #include <QtTest/QtTest>
 
+static bool screenHasText(const TerminalScreen *screen) {
+  for (int row = 0; row < screen->rows(); ++row) {
+    if (!screen->rowText(row).trimmed().isEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool screenContains(const TerminalScreen *screen, const QString &text) {
+  for (int row = 0; row < screen->rows(); ++row) {
+    if (screen->rowText(row).contains(text)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 class TestTerminal : public QObject {
   Q_OBJECT
 
@@ -30,6 +54,7 @@ private slots:
   void testPtyClearRedrawsPrompt();
   void testTerminalDocumentMarginIsZero();
   void testPtyGridFitsViewport();
+  void testPtyShellRendersIntoScreenView();
 
   void testShellStartedSignal();
 
@@ -38,6 +63,8 @@ private slots:
 
   void testShellProfiles();
   void testScrollbackLines();
+  void testScrollbackTrimKeepsNewestLines();
+  void testScrollbackMemoryLimit();
   void testLinkDetection();
   void testSendText();
   void testInterruptActiveRunProcess();
@@ -66,8 +93,10 @@ private slots:
   void testPtyCursorStatePersistsAcrossChunks();
   void testPtyAlternateScreenRestoreRemovesTransientUi();
   void testPtyAlternateScreenExitSplitAcrossChunksRestoresPrimaryScreen();
+  void testPtyAlternateScreenRendersIntoCellGrid();
   void testPtyDumbVimStartupDoesNotLeakControlCharacters();
   void testPtyMouseClickDoesNotMoveInputCursor();
+  void testPtyReaderPausesWhenBufferIsFull();
   void testRunProcessAcceptsInteractiveInput();
   void testRunInputIndicatorVisibility();
   void testLooksLikeInputPromptPatterns();
@@ -159,14 +188,17 @@ void TestTerminal::testClear() {
 
 void TestTerminal::testPtyClearRedrawsPrompt() {
   Terminal terminal;
-  QPlainTextEdit *textEdit = terminal.findChild<QPlainTextEdit *>("textEdit");
-  QVERIFY(textEdit != nullptr);
+  TerminalScreenView *screenView =
+      terminal.findChild<TerminalScreenView *>("terminalScreenView");
+  QVERIFY(screenView != nullptr);
 
   QTRY_VERIFY_WITH_TIMEOUT(terminal.isRunning(), 3000);
   terminal.appendOutput("temporary output\n");
+  QVERIFY(screenContains(screenView->screen(), "temporary output"));
   terminal.clear();
 
-  QTRY_VERIFY_WITH_TIMEOUT(!textEdit->toPlainText().trimmed().isEmpty(), 3000);
+  QVERIFY(!screenContains(screenView->screen(), "temporary output"));
+  QTRY_VERIFY_WITH_TIMEOUT(screenHasText(screenView->screen()), 3000);
 
   terminal.stopShell();
 }
@@ -181,26 +213,50 @@ void TestTerminal::testTerminalDocumentMarginIsZero() {
 
 void TestTerminal::testPtyGridFitsViewport() {
   Terminal terminal;
-  QPlainTextEdit *textEdit = terminal.findChild<QPlainTextEdit *>("textEdit");
-  QVERIFY(textEdit != nullptr);
+  TerminalScreenView *screenView =
+      terminal.findChild<TerminalScreenView *>("terminalScreenView");
+  QVERIFY(screenView != nullptr);
 
   terminal.resize(900, 320);
   terminal.show();
   QTest::qWait(50);
   terminal.updatePtySize();
 
-  const QFontMetrics metrics(textEdit->font());
-  const QRect viewport = textEdit->viewport()->rect();
-  QVERIFY(terminal.m_terminalColumns *
-                  qMax(1, metrics.horizontalAdvance(QLatin1Char('M'))) +
-              textEdit->cursorWidth() <=
-          viewport.width());
-  QVERIFY(terminal.m_terminalRows * qMax(1, metrics.lineSpacing()) <=
-          viewport.height());
+  const QSize cell = screenView->cellSize();
+  QVERIFY(terminal.m_terminalColumns * cell.width() <= screenView->width());
+  QVERIFY(terminal.m_terminalRows * cell.height() <= screenView->height());
+  QCOMPARE(screenView->screen()->columns(), terminal.m_terminalColumns);
+  QCOMPARE(screenView->screen()->rows(), terminal.m_terminalRows);
 
   terminal.stopShell();
 }
 
+void TestTerminal::testPtyShellRendersIntoScreenView() {
+  Terminal terminal;
+  QPlainTextEdit *textEdit = terminal.findChild<QPlainTextEdit *>("textEdit");
+  TerminalScreenView *screenView =
+      terminal.findChild<TerminalScreenView *>("terminalScreenView");
+  QVERIFY(textEdit != nullptr);
+  QVERIFY(screenView != nullptr);
+
+  QTRY_VERIFY_WITH_TIMEOUT(terminal.isRunning(), 3000);
+  QVERIFY(textEdit->isHidden());
+  QVERIFY(!screenView->isHidden());
+
+  const QString before = textEdit->toPlainText();
+  terminal.sendText("printf 'grid%sok\\n' -", true);
+  QTRY_VERIFY_WITH_TIMEOUT(screenContains(screenView->screen(), "grid-ok"),
+                           5000);
+  QCOMPARE(textEdit->toPlainText(), before);
+
+  terminal.appendOutput("failure\n", true);
+  QVERIFY(screenContains(screenView->screen(), "failure"));
+
+  terminal.stopShell();
+  QVERIFY(screenView->isHidden());
+  QVERIFY(!textEdit->isHidden());
+}
+
 void TestTerminal::testShellStartedSignal() {
   Terminal terminal;
   terminal.stopShell();
@@ -284,14 +340,60 @@ void TestTerminal::testScrollbackLines() {
 
   terminal.setScrollbackLines(5000);
   QCOMPARE(terminal.scrollbackLines(), 5000);
+  QCOMPARE(terminal.m_gridScreen->scrollback().capacity(), 5000);
 
   terminal.setScrollbackLines(0);
   QCOMPARE(terminal.scrollbackLines(), 0);
+  QCOMPARE(terminal.m_gridScreen->scrollback().capacity(),
+           TERMINAL_MAX_SCROLLBACK_LINES);
 
   terminal.setScrollbackLines(1000);
   QCOMPARE(terminal.scrollbackLines(), 1000);
 }
 
+void TestTerminal::testScrollbackTrimKeepsNewestLines() {
+  Terminal terminal;
+  terminal.stopShell();
+  QTest::qWait(200);
+
+  QPlainTextEdit *textEdit = terminal.findChild<QPlainTextEdit *>("textEdit");
+  QVERIFY(textEdit != nullptr);
+  terminal.setScrollbackLines(50);
+
+  for (int i = 0; i < 200; ++i) {
+    terminal.appendOutput(QString::number(i) + "\n");
+  }
+
+  QCOMPARE(textEdit->document()->blockCount(), 50);
+  QCOMPARE(textEdit->document()->firstBlock().text(), QString("151"));
+  QCOMPARE(textEdit->document()->lastBlock().previous().text(),
+           QString("199"));
+}
+
+void TestTerminal::testScrollbackMemoryLimit() {
+  Terminal terminal;
+  terminal.stopShell();
+  QTest::qWait(200);
+
+  QPlainTextEdit *textEdit = terminal.findChild<QPlainTextEdit *>("textEdit");
+  QVERIFY(textEdit != nullptr);
+  terminal.m_terminalColumns = 2048;
+  terminal.setScrollbackLines(0);
+  terminal.setScrollbackMemoryLimit(1);
+  QCOMPARE(terminal.scrollbackMemoryLimit(), 1);
+
+  const QString line = QString(1023, QChar('x')) + "\n";
+  for (int i = 0; i < 1024; ++i) {
+    terminal.appendOutput(line);
+  }
+
+  QTextDocument *document = textEdit->document();
+  QVERIFY(document->characterCount() <=
+          1024 * 1024 / static_cast<int>(sizeof(QChar)));
+  QVERIFY(document->blockCount() > 256);
+  QCOMPARE(document->firstBlock().text(), QString(1023, QChar('x')));
+}
+
 void TestTerminal::testLinkDetection() {
   Terminal terminal;
   terminal.stopShell();
@@ -750,6 +852,34 @@ void TestTerminal::
   QCOMPARE(textEdit->toPlainText(), QString("$ vim README.md\n"));
 }
 
+void TestTerminal::testPtyAlternateScreenRendersIntoCellGrid() {
+  Terminal terminal;
+  terminal.stopShell();
+  QTest::qWait(200);
+
+  QPlainTextEdit *textEdit = terminal.findChild<QPlainTextEdit *>("textEdit");
+  TerminalScreenView *screenView =
+      terminal.findChild<TerminalScreenView *>("terminalScreenView");
+  QVERIFY(textEdit != nullptr);
+  QVERIFY(screenView != nullptr);
+
+  terminal.appendOutput("$ top\n");
+  terminal.appendOutput("\x1b[?1049h\x1b[2;3H\x1b[7mPID\x1b[m");
+
+  QVERIFY(terminal.m_alternateScreenActive);
+  QVERIFY(textEdit->isHidden());
+  QVERIFY(!screenView->isHidden());
+  QCOMPARE(screenView->screen()->rowText(1), QString("  PID"));
+  QCOMPARE(textEdit->toPlainText(), QString("$ top\n"));
+
+  terminal.appendOutput("\x1b[?1049ldone");
+
+  QVERIFY(!terminal.m_alternateScreenActive);
+  QVERIFY(screenView->isHidden());
+  QVERIFY(!textEdit->isHidden());
+  QCOMPARE(textEdit->toPlainText(), QString("$ top\ndone"));
+}
+
 void TestTerminal::testPtyDumbVimStartupDoesNotLeakControlCharacters() {
   Terminal terminal;
   terminal.stopShell();
@@ -764,27 +894,63 @@ void TestTerminal::testPtyDumbVimStartupDoesNotLeakControlCharacters() {
   QVERIFY(textEdit->toPlainText().trimmed().isEmpty());
 }
 
+void TestTerminal::testPtyReaderPausesWhenBufferIsFull() {
+#ifdef Q_OS_WIN
+  QSKIP("PTY reader is not available on Windows");
+#else
+  TerminalPty pty;
+  QSignalSpy readySpy(&pty, &TerminalPty::readyRead);
+  const qint64 total = TERMINAL_PTY_BUFFER_LIMIT * 4;
+  QVERIFY(pty.start("sh",
+                    QStringList()
+                        << "-c"
+                        << QString("head -c %1 /dev/zero | tr '\\000' x")
+                               .arg(total),
+                    QDir::tempPath(), QMap<QString, QString>()));
+
+  QTRY_VERIFY_WITH_TIMEOUT(pty.bytesAvailable() >= TERMINAL_PTY_BUFFER_LIMIT,
+                           5000);
+  QTest::qWait(100);
+  QVERIFY(pty.bytesAvailable() <
+          TERMINAL_PTY_BUFFER_LIMIT + TERMINAL_PTY_READ_CHUNK);
+  QCOMPARE(readySpy.count(), 1);
+
+  qint64 received = 0;
+  QElapsedTimer timer;
+  timer.start();
+  while (received < total && timer.elapsed() < 10000) {
+    received += pty.read(TERMINAL_PTY_READ_CHUNK * 8).count('x');
+    QTest::qWait(1);
+  }
+  QCOMPARE(received, total);
+  pty.stop();
+#endif
+}
+
 void TestTerminal::testPtyMouseClickDoesNotMoveInputCursor() {
   Terminal terminal;
-  QPlainTextEdit *textEdit = terminal.findChild<QPlainTextEdit *>("textEdit");
-  QVERIFY(textEdit != nullptr);
+  TerminalScreenView *screenView =
+      terminal.findChild<TerminalScreenView *>("terminalScreenView");
+  QVERIFY(screenView != nullptr);
 
   QTRY_VERIFY_WITH_TIMEOUT(terminal.isRunning(), 3000);
-  QTRY_VERIFY_WITH_TIMEOUT(!textEdit->toPlainText().trimmed().isEmpty(), 3000);
-  const QString beforeClick = textEdit->toPlainText();
-  QVERIFY(textEdit->isReadOnly());
+  QTRY_VERIFY_WITH_TIMEOUT(screenHasText(screenView->screen()), 3000);
 
   terminal.show();
-  textEdit->setFocus();
-  QTest::qWait(50);
-  QTest::mouseClick(textEdit->viewport(), Qt::LeftButton, Qt::NoModifier,
-                    QPoint(4, 4));
+  screenView->setFocus();
+  QTest::qWait(100);
+  const TerminalScreen *screen = screenView->screen();
+  const int cursorRow = screen->cursorRow();
+  const int cursorColumn = screen->cursorColumn();
+  const QString promptRow = screen->rowText(cursorRow);
+
+  QTest::mouseClick(screenView, Qt::LeftButton, Qt::NoModifier, QPoint(4, 4));
   QTest::qWait(100);
 
-  QTextCursor endCursor(textEdit->document());
-  endCursor.movePosition(QTextCursor::End);
-  QCOMPARE(textEdit->toPlainText(), beforeClick);
-  QCOMPARE(textEdit->textCursor().position(), endCursor.position());
+  QCOMPARE(screen->cursorRow(), cursorRow);
+  QCOMPARE(screen->cursorColumn(), cursorColumn);
+  QCOMPARE(screen->rowText(cursorRow), promptRow);
+  QVERIFY(!screenView->hasSelection());
 
   terminal.stopShell();
 }
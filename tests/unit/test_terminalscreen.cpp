@@ -0,0 +1,285 @@
+#include "ui/panels/terminalparser.h"
+#include "ui/panels/terminalscreen.h"
+#include "ui/panels/terminalscreenview.h"
+#include <QtTest/QtTest>
+
+class TestTerminalScreen : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testPrintAndAutoWrap();
+  void testCursorAddressingAndErase();
+  void testSgrInternsAttributeRuns();
+  void testSequencesSplitAcrossChunks();
+  void testScrollingFeedsScrollbackRing();
+  void testScrollbackRingOverwritesOldest();
+  void testScrollbackRingHonoursMemoryBudget();
+  void testScrollRegionAndLineEditing();
+  void testAlternateScreenSwitchStopsFeed();
+  void testDamageTracksTouchedRows();
+  void testCursorPositionReport();
+  void testViewRefreshCoversOnlyDamagedRows();
+  void testViewScrollsThroughScrollback();
+  void testViewSelectionSpansScrollback();
+};
+
+void TestTerminalScreen::testPrintAndAutoWrap() {
+  TerminalScreen screen(5, 3);
+  TerminalParser parser(&screen);
+
+  parser.feed(u"hello");
+  QCOMPARE(screen.rowText(0), QString("hello"));
+  QCOMPARE(screen.cursorRow(), 0);
+  QCOMPARE(screen.cursorColumn(), 4);
+
+  parser.feed(u"!");
+  QCOMPARE(screen.rowText(1), QString("!"));
+  QVERIFY(screen.isRowWrapped(0));
+  QCOMPARE(screen.cursorRow(), 1);
+  QCOMPARE(screen.cursorColumn(), 1);
+}
+
+void TestTerminalScreen::testCursorAddressingAndErase() {
+  TerminalScreen screen(10, 4);
+  TerminalParser parser(&screen);
+
+  parser.feed(u"\x1b[2;3Hab\x1b[1;1Htop\x1b[4;10Hz");
+  QCOMPARE(screen.rowText(0), QString("top"));
+  QCOMPARE(screen.rowText(1), QString("  ab"));
+  QCOMPARE(screen.rowText(3), QString("         z"));
+
+  parser.feed(u"\x1b[2;4H\x1b[K");
+  QCOMPARE(screen.rowText(1), QString("  a"));
+
+  parser.feed(u"\x1b[99;99H");
+  QCOMPARE(screen.cursorRow(), 3);
+  QCOMPARE(screen.cursorColumn(), 9);
+
+  parser.feed(u"\x1b[2J");
+  for (int row = 0; row < screen.rows(); ++row) {
+    QVERIFY(screen.rowText(row).isEmpty());
+  }
+}
+
+void TestTerminalScreen::testSgrInternsAttributeRuns() {
+  TerminalScreen screen(10, 2);
+  TerminalParser parser(&screen);
+
+  parser.feed(u"\x1b[1;31mab\x1b[0mc\x1b[38;2;1;2;3mde\x1b[m");
+  QVector<TerminalAttributeRun> runs = screen.rowRuns(0);
+  QCOMPARE(runs.size(), 4);
+  QCOMPARE(runs[0].length, 2);
+  QVERIFY(runs[0].attributes.hasFlag(TerminalCellAttributes::Bold));
+  QCOMPARE(runs[0].attributes.foreground, TerminalColor::indexed(1));
+  QCOMPARE(runs[1].attributes, TerminalCellAttributes());
+  QCOMPARE(runs[2].attributes.foreground, TerminalColor::rgb(1, 2, 3));
+  QCOMPARE(runs[3].start, 5);
+
+  QCOMPARE(screen.cell(0, 0).attributes, screen.cell(0, 1).attributes);
+}
+
+void TestTerminalScreen::testSequencesSplitAcrossChunks() {
+  TerminalScreen screen(10, 3);
+  TerminalParser parser(&screen);
+
+  parser.feed(u"\x1b[");
+  parser.feed(u"3");
+  parser.feed(u";2Hx\x1b]0;ti");
+  parser.feed(u"tle\x07y");
+  QCOMPARE(screen.rowText(2), QString(" xy"));
+  QCOMPARE(screen.title(), QString("title"));
+
+  parser.feed(u"\x1b(B\x1b)0z");
+  QCOMPARE(screen.rowText(2), QString(" xyz"));
+}
+
+void TestTerminalScreen::testScrollingFeedsScrollbackRing() {
+  TerminalScreen screen(8, 2);
+  TerminalParser parser(&screen);
+
+  parser.feed(u"one\r\ntwo\r\n\x1b[32mthree\x1b[0m\r\nfour");
+  QCOMPARE(screen.rowText(0), QString("three"));
+  QCOMPARE(screen.rowText(1), QString("four"));
+  QCOMPARE(screen.scrollback().size(), 2);
+  QCOMPARE(screen.scrollback().at(0).text, QString("one"));
+  QCOMPARE(screen.scrollback().at(1).text, QString("two"));
+
+  parser.feed(u"\r\n");
+  const TerminalScrollbackLine &line = screen.scrollback().at(2);
+  QCOMPARE(line.text, QString("three"));
+  QCOMPARE(line.runs.size(), 1);
+  QCOMPARE(line.runs[0].attributes.foreground, TerminalColor::indexed(2));
+}
+
+void TestTerminalScreen::testScrollbackRingOverwritesOldest() {
+  TerminalScrollbackRing ring(3);
+  for (int i = 0; i < 5; ++i) {
+    TerminalScrollbackLine line;
+    line.text = QString::number(i);
+    ring.push(line);
+  }
+  QCOMPARE(ring.size(), 3);
+  QCOMPARE(ring.at(0).text, QString("2"));
+  QCOMPARE(ring.at(2).text, QString("4"));
+
+  ring.setCapacity(2);
+  QCOMPARE(ring.size(), 2);
+  QCOMPARE(ring.at(0).text, QString("3"));
+  QCOMPARE(ring.at(1).text, QString("4"));
+}
+
+void TestTerminalScreen::testScrollbackRingHonoursMemoryBudget() {
+  TerminalScrollbackRing ring(100);
+  TerminalScrollbackLine line;
+  line.text = QString(64, QChar('x'));
+  const qint64 lineBytes = TerminalScrollbackRing::footprint(line);
+  ring.setMemoryBudget(lineBytes * 4);
+
+  for (int i = 0; i < 10; ++i) {
+    line.text = QString(63, QChar('x')) + QString::number(i);
+    ring.push(line);
+  }
+  QCOMPARE(ring.size(), 4);
+  QCOMPARE(ring.memoryUsage(), lineBytes * 4);
+  QVERIFY(ring.at(0).text.endsWith(QLatin1Char('6')));
+  QVERIFY(ring.at(3).text.endsWith(QLatin1Char('9')));
+
+  ring.setMemoryBudget(lineBytes * 2);
+  QCOMPARE(ring.size(), 2);
+  QVERIFY(ring.at(0).text.endsWith(QLatin1Char('8')));
+
+  ring.clear();
+  QCOMPARE(ring.memoryUsage(), qint64(0));
+}
+
+void TestTerminalScreen::testScrollRegionAndLineEditing() {
+  TerminalScreen screen(6, 4);
+  TerminalParser parser(&screen);
+
+  parser.feed(u"a\r\nb\r\nc\r\nd");
+  parser.feed(u"\x1b[2;3r\x1b[3;1H\r\n");
+  QCOMPARE(screen.rowText(0), QString("a"));
+  QCOMPARE(screen.rowText(1), QString("c"));
+  QCOMPARE(screen.rowText(2), QString());
+  QCOMPARE(screen.rowText(3), QString("d"));
+  QVERIFY(screen.scrollback().isEmpty());
+
+  parser.feed(u"\x1b[r\x1b[1;1H\x1b[L");
+  QCOMPARE(screen.rowText(0), QString());
+  QCOMPARE(screen.rowText(1), QString("a"));
+
+  parser.feed(u"\x1b[2;1Hxyz\x1b[2;2H\x1b[P");
+  QCOMPARE(screen.rowText(1), QString("xz"));
+  parser.feed(u"\x1b[2@");
+  QCOMPARE(screen.rowText(1), QString("x  z"));
+}
+
+void TestTerminalScreen::testAlternateScreenSwitchStopsFeed() {
+  TerminalScreen screen(10, 3);
+  TerminalParser parser(&screen);
+
+  parser.feed(u"prompt");
+  const QString input = "\x1b[?1049hvim\x1b[?1049lafter";
+  const int consumed = parser.feed(input);
+  QCOMPARE(consumed, 8);
+  QVERIFY(screen.isAlternateScreen());
+  QVERIFY(screen.rowText(0).isEmpty());
+
+  const int rest = parser.feed(QStringView(input).mid(consumed));
+  QVERIFY(!screen.isAlternateScreen());
+  QCOMPARE(rest, 11);
+  QCOMPARE(screen.rowText(0), QString("prompt"));
+  QCOMPARE(screen.cursorColumn(), 6);
+}
+
+void TestTerminalScreen::testDamageTracksTouchedRows() {
+  TerminalScreen screen(10, 5);
+  TerminalParser parser(&screen);
+  screen.takeDamage();
+  QVERIFY(!screen.hasDamage());
+
+  parser.feed(u"\x1b[3;1Hx");
+  QVERIFY(screen.hasDamage());
+  QBitArray damage = screen.takeDamage();
+  QCOMPARE(damage.count(true), 1);
+  QVERIFY(damage.testBit(2));
+  QVERIFY(!screen.hasDamage());
+
+  parser.feed(u"\x1b[1;1H");
+  QVERIFY(!screen.hasDamage());
+}
+
+void TestTerminalScreen::testCursorPositionReport() {
+  TerminalScreen screen(10, 5);
+  TerminalParser parser(&screen);
+
+  parser.feed(u"\x1b[2;4H\x1b[6n");
+  QCOMPARE(screen.takeResponses(), QByteArray("\x1b[2;4R"));
+  QVERIFY(screen.takeResponses().isEmpty());
+}
+
+void TestTerminalScreen::testViewRefreshCoversOnlyDamagedRows() {
+  TerminalScreen screen(20, 6);
+  TerminalParser parser(&screen);
+  TerminalScreenView view;
+  view.resize(400, 200);
+  view.setScreen(&screen);
+  view.refresh();
+
+  parser.feed(u"\x1b[4;1Hrow");
+  const QRegion region = view.refresh();
+  QVERIFY(region.contains(view.rowRect(3)));
+  QVERIFY(region.contains(view.rowRect(0)));
+  QVERIFY(!region.intersects(view.rowRect(1)));
+  QVERIFY(!region.intersects(view.rowRect(5)));
+
+  QVERIFY(view.refresh().isEmpty());
+}
+
+void TestTerminalScreen::testViewScrollsThroughScrollback() {
+  TerminalScreen screen(10, 3);
+  TerminalParser parser(&screen);
+  TerminalScreenView view;
+  view.resize(400, 200);
+  view.setScreen(&screen);
+
+  parser.feed(u"l0\r\nl1\r\nl2\r\nl3\r\nl4");
+  view.refresh();
+  QCOMPARE(screen.scrollback().size(), 2);
+  QCOMPARE(view.lineText(view.cellAt(QPoint(0, 0)).y()), QString("l2"));
+
+  view.setScrollOffset(99);
+  QCOMPARE(view.scrollOffset(), 2);
+  QCOMPARE(view.lineText(view.cellAt(QPoint(0, 0)).y()), QString("l0"));
+
+  parser.feed(u"\r\nl5");
+  view.refresh();
+  QCOMPARE(view.scrollOffset(), 3);
+  QCOMPARE(view.lineText(view.cellAt(QPoint(0, 0)).y()), QString("l0"));
+
+  view.scrollToBottom();
+  QCOMPARE(view.lineText(view.cellAt(QPoint(0, 0)).y()), QString("l3"));
+}
+
+void TestTerminalScreen::testViewSelectionSpansScrollback() {
+  TerminalScreen screen(10, 2);
+  TerminalParser parser(&screen);
+  TerminalScreenView view;
+  view.resize(400, 200);
+  view.setScreen(&screen);
+
+  parser.feed(u"first\r\nsecond\r\nthird");
+  view.refresh();
+  QVERIFY(!view.hasSelection());
+
+  view.selectAll();
+  QVERIFY(view.hasSelection());
+  QCOMPARE(view.selectedText(), QString("first\nsecond\nthird"));
+
+  view.clearSelection();
+  QVERIFY(!view.hasSelection());
+  QVERIFY(view.selectedText().isEmpty());
+}
+
+QTEST_MAIN(TestTerminalScreen)
+#include "test_terminalscreen.moc"
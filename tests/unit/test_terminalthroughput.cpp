@@ -0,0 +1,307 @@
+#define private public
+#include "ui/panels/terminal.h"
+#undef private
+#include "ui/panels/terminalscreen.h"
+#include "ui/panels/terminalscreenview.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringDecoder>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+namespace {
+constexpr int BENCH_COLUMNS = 120;
+constexpr int BENCH_ROWS = 40;
+constexpr int BENCH_FRAME_BYTES = 16 * 1024;
+constexpr int BENCH_PTY_STREAM_BYTES = 4 * 1024 * 1024;
+constexpr int BENCH_PTY_TIMEOUT_MS = 60000;
+constexpr int BENCH_DOCUMENT_STREAM_BYTES = 1024 * 1024;
+constexpr qint64 BENCH_MAX_PEAK_MEMORY_KB = 1024 * 1024;
+
+QByteArray plainStream(int targetBytes) {
+  QByteArray data;
+  data.reserve(targetBytes + 128);
+  int line = 0;
+  while (data.size() < targetBytes) {
+    data += "[" + QByteArray::number(line % 100) +
+            "%] Building CXX object src/CMakeFiles/app.dir/module_" +
+            QByteArray::number(line) + ".cpp.o\r\n";
+    ++line;
+  }
+  return data;
+}
+
+QByteArray sgrStream(int targetBytes) {
+  QByteArray data;
+  data.reserve(targetBytes + 128);
+  int cell = 0;
+  while (data.size() < targetBytes) {
+    data += "\x1b[38;5;" + QByteArray::number(cell % 256) + "m";
+    if (cell % 7 == 0) {
+      data += "\x1b[1;48;2;" + QByteArray::number(cell % 200) + ";40;60m";
+    }
+    data += static_cast<char>('a' + cell % 26);
+    if (cell % 7 == 0) {
+      data += "\x1b[0m";
+    }
+    if (++cell % BENCH_COLUMNS == 0) {
+      data += "\r\n";
+    }
+  }
+  return data;
+}
+
+QByteArray fullScreenStream(int targetBytes) {
+  QByteArray data("\x1b[?1049h\x1b[?25l");
+  data.reserve(targetBytes + 4096);
+  int frame = 0;
+  while (data.size() < targetBytes) {
+    data += "\x1b[H\x1b[7m top - frame " + QByteArray::number(frame) +
+            "\x1b[K\x1b[m";
+    for (int row = 2; row <= BENCH_ROWS; ++row) {
+      data += "\x1b[" + QByteArray::number(row) + ";1H";
+      data += QByteArray::number(1000 + (row * 37 + frame) % 9000);
+      data += " user      20   0  ";
+      data += QByteArray::number((row * frame) % 100) + ".0 ";
+      data += "\x1b[32mprocess_" + QByteArray::number(row) + "\x1b[m\x1b[K";
+    }
+    ++frame;
+  }
+  data += "\x1b[?25h\x1b[?1049l";
+  return data;
+}
+
+QByteArray longLineStream(int targetBytes) {
+  QByteArray data;
+  data.reserve(targetBytes + 128);
+  const QByteArray chunk("0123456789abcdefghijklmnopqrstuvwxyz");
+  while (data.size() < targetBytes) {
+    for (int i = 0; i < 16384 / chunk.size(); ++i) {
+      data += chunk;
+    }
+    data += "\r\n";
+  }
+  return data;
+}
+
+QByteArray streamByName(const QByteArray &name, int targetBytes) {
+  if (name == "plain") {
+    return plainStream(targetBytes);
+  }
+  if (name == "sgr") {
+    return sgrStream(targetBytes);
+  }
+  if (name == "fullscreen") {
+    return fullScreenStream(targetBytes);
+  }
+  return longLineStream(targetBytes);
+}
+
+qint64 peakResidentKilobytes() {
+  QFile status("/proc/self/status");
+  if (!status.open(QIODevice::ReadOnly)) {
+    return -1;
+  }
+  while (!status.atEnd()) {
+    const QByteArray line = status.readLine();
+    if (line.startsWith("VmHWM:")) {
+      return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+  }
+  return -1;
+}
+
+bool screenHasText(const TerminalScreen *screen) {
+  for (int row = 0; row < screen->rows(); ++row) {
+    if (!screen->rowText(row).trimmed().isEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool screenContains(const TerminalScreen *screen, const QString &text) {
+  for (int row = 0; row < screen->rows(); ++row) {
+    if (screen->rowText(row).contains(text)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+double megabytesPerSecond(qint64 bytes, qint64 nanoseconds) {
+  const double seconds = qMax<qint64>(1, nanoseconds) / 1e9;
+  return bytes / (1024.0 * 1024.0) / seconds;
+}
+
+class FrameTimer : public QObject {
+public:
+  explicit FrameTimer(QWidget *window) : m_window(window) {
+    m_window->installEventFilter(this);
+  }
+
+  int frames() const { return m_frames; }
+  qint64 totalNs() const { return m_totalNs; }
+  qint64 worstNs() const { return m_worstNs; }
+
+protected:
+  bool eventFilter(QObject *watched, QEvent *event) override {
+    if (watched != m_window || event->type() != QEvent::UpdateRequest ||
+        m_inside) {
+      return false;
+    }
+    m_inside = true;
+    QElapsedTimer timer;
+    timer.start();
+    QCoreApplication::sendEvent(m_window, event);
+    const qint64 elapsed = timer.nsecsElapsed();
+    m_inside = false;
+    m_totalNs += elapsed;
+    m_worstNs = qMax(m_worstNs, elapsed);
+    ++m_frames;
+    return true;
+  }
+
+private:
+  QWidget *m_window;
+  bool m_inside = false;
+  int m_frames = 0;
+  qint64 m_totalNs = 0;
+  qint64 m_worstNs = 0;
+};
+} // namespace
+
+class TestTerminalThroughput : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testPtyThroughput_data();
+  void testPtyThroughput();
+  void testDocumentThroughput_data();
+  void testDocumentThroughput();
+};
+
+void TestTerminalThroughput::testPtyThroughput_data() {
+  QTest::addColumn<QByteArray>("stream");
+  QTest::addColumn<double>("minMegabytesPerSecond");
+  QTest::addColumn<double>("maxAverageFrameMs");
+
+  QTest::newRow("plain") << QByteArray("plain") << 2.0 << 16.0;
+  QTest::newRow("sgr") << QByteArray("sgr") << 1.0 << 16.0;
+  QTest::newRow("fullscreen") << QByteArray("fullscreen") << 1.0 << 16.0;
+  QTest::newRow("longlines") << QByteArray("longlines") << 2.0 << 16.0;
+}
+
+void TestTerminalThroughput::testPtyThroughput() {
+  QFETCH(QByteArray, stream);
+  QFETCH(double, minMegabytesPerSecond);
+  QFETCH(double, maxAverageFrameMs);
+#ifdef Q_OS_WIN
+  QSKIP("PTY shell is not available on Windows");
+#endif
+
+  QTemporaryDir directory;
+  QVERIFY(directory.isValid());
+  const QByteArray data = streamByName(stream, BENCH_PTY_STREAM_BYTES);
+  QFile file(directory.filePath("stream.txt"));
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  QCOMPARE(file.write(data), static_cast<qint64>(data.size()));
+  file.close();
+
+  Terminal terminal;
+  terminal.resize(BENCH_COLUMNS * 8, BENCH_ROWS * 16);
+  terminal.show();
+  QVERIFY(QTest::qWaitForWindowExposed(&terminal));
+  QTRY_VERIFY_WITH_TIMEOUT(terminal.isRunning(), 5000);
+  TerminalScreenView *view =
+      terminal.findChild<TerminalScreenView *>("terminalScreenView");
+  QVERIFY(view != nullptr);
+  QTRY_VERIFY_WITH_TIMEOUT(screenHasText(view->screen()), 5000);
+
+  FrameTimer frames(&terminal);
+  QElapsedTimer total;
+  total.start();
+  terminal.sendText(QString("cat '%1'; printf 'bench%sdone\\n' -")
+                        .arg(file.fileName()),
+                    true);
+  QTRY_VERIFY_WITH_TIMEOUT(screenContains(view->screen(), "bench-done"),
+                           BENCH_PTY_TIMEOUT_MS);
+  const qint64 totalNs = total.nsecsElapsed();
+
+  const double rate = megabytesPerSecond(data.size(), totalNs);
+  const double averageFrameMs =
+      frames.totalNs() / 1e6 / qMax(1, frames.frames());
+  const qint64 peakKb = peakResidentKilobytes();
+  qInfo().noquote() << QString("pty/%1: %2 MB %3 MB/s grid=%4x%5 frames=%6 "
+                               "paint avg=%7 ms worst=%8 ms peak=%9 KB")
+                           .arg(QString::fromLatin1(stream))
+                           .arg(data.size() / (1024.0 * 1024.0), 0, 'f', 1)
+                           .arg(rate, 0, 'f', 1)
+                           .arg(view->screen()->columns())
+                           .arg(view->screen()->rows())
+                           .arg(frames.frames())
+                           .arg(averageFrameMs, 0, 'f', 2)
+                           .arg(frames.worstNs() / 1e6, 0, 'f', 2)
+                           .arg(peakKb);
+
+  terminal.stopShell();
+  QVERIFY(frames.frames() > 0);
+  QVERIFY2(rate >= minMegabytesPerSecond,
+           qPrintable(QString("%1 MB/s").arg(rate)));
+  QVERIFY2(averageFrameMs <= maxAverageFrameMs,
+           qPrintable(QString("%1 ms/frame").arg(averageFrameMs)));
+  if (peakKb > 0) {
+    QVERIFY2(peakKb <= BENCH_MAX_PEAK_MEMORY_KB,
+             qPrintable(QString("%1 KB peak").arg(peakKb)));
+  }
+}
+
+void TestTerminalThroughput::testDocumentThroughput_data() {
+  QTest::addColumn<QByteArray>("stream");
+  QTest::addColumn<double>("minMegabytesPerSecond");
+
+  QTest::newRow("plain") << QByteArray("plain") << 0.25;
+  QTest::newRow("sgr") << QByteArray("sgr") << 0.1;
+  QTest::newRow("fullscreen") << QByteArray("fullscreen") << 0.5;
+  QTest::newRow("longlines") << QByteArray("longlines") << 0.25;
+}
+
+void TestTerminalThroughput::testDocumentThroughput() {
+  QFETCH(QByteArray, stream);
+  QFETCH(double, minMegabytesPerSecond);
+
+  Terminal terminal;
+  terminal.stopShell();
+  terminal.resize(BENCH_COLUMNS * 8, BENCH_ROWS * 16);
+  terminal.m_terminalColumns = BENCH_COLUMNS;
+  terminal.m_terminalRows = BENCH_ROWS;
+
+  const QByteArray data = streamByName(stream, BENCH_DOCUMENT_STREAM_BYTES);
+  QStringDecoder decoder(QStringDecoder::Utf8);
+  QElapsedTimer timer;
+  timer.start();
+  for (int offset = 0; offset < data.size(); offset += BENCH_FRAME_BYTES) {
+    terminal.appendOutput(decoder.decode(
+        QByteArrayView(data).mid(offset, BENCH_FRAME_BYTES)));
+  }
+  const qint64 elapsedNs = timer.nsecsElapsed();
+
+  const double rate = megabytesPerSecond(data.size(), elapsedNs);
+  const qint64 peakKb = peakResidentKilobytes();
+  qInfo().noquote() << QString("document/%1: %2 MB %3 MB/s peak=%4 KB")
+                           .arg(QString::fromLatin1(stream))
+                           .arg(data.size() / (1024.0 * 1024.0), 0, 'f', 1)
+                           .arg(rate, 0, 'f', 2)
+                           .arg(peakKb);
+
+  QVERIFY(!terminal.m_alternateScreenActive);
+  QVERIFY2(rate >= minMegabytesPerSecond,
+           qPrintable(QString("%1 MB/s").arg(rate)));
+  if (peakKb > 0) {
+    QVERIFY2(peakKb <= BENCH_MAX_PEAK_MEMORY_KB,
+             qPrintable(QString("%1 KB peak").arg(peakKb)));
+  }
+}
+
+QTEST_MAIN(TestTerminalThroughput)
+#include "test_terminalthroughput.moc"